@@ -31,8 +31,11 @@
 #include <rxcpp/rx-subscription.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <shogun/base/ParameterInterface.h>
@@ -72,6 +75,12 @@ namespace shogun
 
 	class SGObject::Self: public detail::ParameterInterface<ParameterBackend> {};
 
+	/** number of objects with deferred parameters */
+	static std::atomic<int64_t> num_lazy_objects(0);
+
+	/** held while deferred parameters are read */
+	static std::recursive_mutex lazy_loader_mutex;
+
 	class Parallel;
 
 	template<> void SGObject::set_generic<bool>()
@@ -186,6 +195,8 @@ SGObject::SGObject(const SGObject& orig)
 SGObject::~SGObject()
 {
 	SG_TRACE("SGObject destroyed ({})", fmt::ptr(this));
+	if (m_lazy_loader)
+		--num_lazy_objects;
 }
 
 std::shared_ptr<SGObject> SGObject::deep_copy() const
@@ -323,6 +334,7 @@ std::shared_ptr<SGObject> SGObject::clone(ParameterProperties pp) const
 	          "SGObject::create_empty() overridden.\n",
 	    get_name());
 
+	load_lazily();
 	for (const auto& it : self->filter(pp))
 	{
 		const BaseTag& tag = it.first;
@@ -361,6 +373,7 @@ const AnyParameter& SGObject::get_parameter(const BaseTag& _tag) const
 			"Parameter {}::{} does not exist.", get_name(),
 			_tag.name().c_str());
 	}
+	load_lazily();
 	
 	const auto& parameter = self->at(_tag);
 	
@@ -383,6 +396,7 @@ AnyParameter& SGObject::get_parameter(const BaseTag& _tag)
 			"Parameter {}::{} does not exist.", get_name(),
 			_tag.name().c_str());
 	}
+	load_lazily();
 
 	auto& parameter = self->at(_tag);
 
@@ -516,6 +530,7 @@ std::string SGObject::to_string() const
 	std::unique_ptr<AnyVisitor> visitor(new ToStringVisitor(&ss));
 	ss << get_name();
 	ss << "(";
+	load_lazily();
 	for (auto it = self->begin(); it != self->end(); ++it)
 	{
 		ss << it->first.name() << "=";
@@ -544,6 +559,7 @@ std::string SGObject::to_string() const
 std::map<std::string, std::shared_ptr<const AnyParameter>> SGObject::get_params() const
 {
 	std::map<std::string, std::shared_ptr<const AnyParameter>> result;
+	load_lazily();
 	for (auto const& each: *self) {
 		result.emplace(std::string(each.first.name()), 
 			std::make_shared<const AnyParameter>(each.second));
@@ -572,6 +588,7 @@ bool SGObject::equals(const SGObject* other) const
 	}
 
 	/* Assumption: objects of same type have same set of tags. */
+	load_lazily();
 	for (const auto& it : *self)
 	{
 		const BaseTag& tag = it.first;
@@ -623,6 +640,7 @@ void SGObject::for_each_param_of_type(
 {
 	auto visitor = std::make_unique<FilterVisitor<T>>(operation);
 
+	load_lazily();
 	std::for_each(self->begin(), self->end(), [&](auto& pair) {
 		Any any_param = pair.second.get_value();
 		if (any_param.safe_visitable())
@@ -637,6 +655,60 @@ void SGObject::for_each_param_of_type(
 template void shogun::SGObject::for_each_param_of_type<SGObject*>(
     std::function<void(const std::string&, SGObject**)>);
 
+void SGObject::set_lazy_loader(std::function<void()> loader)
+{
+	std::lock_guard<std::recursive_mutex> lock(lazy_loader_mutex);
+	num_lazy_objects += bool(loader) - bool(m_lazy_loader);
+	m_is_lazy = bool(loader);
+	m_lazy_loader = std::move(loader);
+}
+
+void SGObject::load_lazily() const
+{
+	if (!m_is_lazy)
+		return;
+
+	// other threads wait until the parameters are read, and loaders of
+	// different objects don't read their shared stream at the same time
+	std::lock_guard<std::recursive_mutex> lock(lazy_loader_mutex);
+	if (!m_lazy_loader)
+		return;
+
+	// the loader accesses the parameters itself, so clear it first
+	auto loader = std::move(m_lazy_loader);
+	m_lazy_loader = nullptr;
+	--num_lazy_objects;
+	loader();
+	m_is_lazy = false;
+}
+
+bool SGObject::is_lazy() const
+{
+	return m_is_lazy;
+}
+
+static void materialize_objects(
+    SGObject* obj, std::unordered_set<const SGObject*>& visited)
+{
+	if (!visited.insert(obj).second)
+		return;
+
+	obj->for_each_param_of_type<SGObject*>(
+	    [&](const std::string& name, SGObject** param) {
+		    materialize_objects(*param, visited);
+	    });
+}
+
+void SGObject::materialize()
+{
+	// walking the parameters is expensive, skip it if nothing is deferred
+	if (!num_lazy_objects)
+		return;
+
+	std::unordered_set<const SGObject*> visited;
+	materialize_objects(this, visited);
+}
+
 bool SGObject::equals(const std::shared_ptr<const SGObject>& other) const
 {
 	return this->equals(other.get());
@@ -666,6 +738,8 @@ std::shared_ptr<SGObject> SGObject::get(std::string_view name, index_t index) co
 			get_name(), name.data(), index,
 			self->find(BaseTag(name))->second.get_value().type().c_str());
 	}
+	if (result)
+		result->materialize();
 	return result;
 }
 
@@ -683,6 +757,7 @@ std::shared_ptr<SGObject> SGObject::get(std::string_view name) const noexcept(fa
 	}
 	if (auto result = get(name, std::nothrow))
 	{
+		result->materialize();
 		return result;
 	}
 	error(
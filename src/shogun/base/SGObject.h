@@ -27,6 +27,8 @@
 #include <shogun/lib/tag.h>
 #include <shogun/util/clone.h>
 
+#include <atomic>
+#include <functional>
 #include <map>
 #include <unordered_map>
 #include <utility>
@@ -629,7 +631,33 @@ public:
 	template <typename T>
 	void for_each_param_of_type(
 		std::function<void(const std::string&, T*)> operation);
+
+	/** Sets a function that reads the parameters of this object, whose
+	 * deserialization was deferred until they are first accessed, see
+	 * io::BitseryDeserializer::set_lazy_threshold
+	 *
+	 * @param loader function that reads the parameters
+	 */
+	void set_lazy_loader(std::function<void()> loader);
 #endif
+
+	/** Reads the parameters of this object and of all objects it refers
+	 * to whose deserialization was deferred.
+	 * Parameters are read on their first access through the parameter
+	 * framework anyway, this is only needed before code accesses the
+	 * members directly, which Machine::train() and Machine::apply() do
+	 * for their machine.
+	 * Deferred parameters are read under a global lock, so calling this
+	 * before an object is shared among threads avoids that they wait for
+	 * each other.
+	 */
+	void materialize();
+
+	/** @return whether parameters of this object whose deserialization was
+	 * deferred have not been read yet, see materialize()
+	 */
+	bool is_lazy() const;
+
 	/** Specializes a provided object to the specified type.
 	 * Throws exception if the object cannot be specialized.
 	 *
@@ -1205,6 +1233,10 @@ private:
 	 */
 	const AnyParameter& get_function(const BaseTag& _tag) const;
 
+	/** Reads the parameters of this object if their deserialization was
+	 * deferred */
+	void load_lazily() const;
+
 	class Self;
 	std::unique_ptr<Self> self;
 
@@ -1341,6 +1373,12 @@ protected:
 		/** List of subscription for this SGObject */
 		std::map<int64_t, rxcpp::subscription> m_subscriptions;
 		int64_t m_next_subscription_index;
+
+		/** Reads the deferred parameters, empty if there are none */
+		mutable std::function<void()> m_lazy_loader;
+
+		/** Whether m_lazy_loader is set, read without the lock */
+		mutable std::atomic<bool> m_is_lazy{false};
 	};
 
 template <class T>
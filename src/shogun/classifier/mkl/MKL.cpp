@@ -10,6 +10,7 @@
 #include <shogun/classifier/mkl/MKL.h>
 #include <shogun/classifier/svm/LibSVM.h>
 #include <shogun/kernel/CombinedKernel.h>
+#include <shogun/kernel/normalizer/IdentityKernelNormalizer.h>
 #include <shogun/lib/Signal.h>
 #include <utility>
 
@@ -729,7 +730,6 @@ void MKL::elasticnet_dual(float64_t *ff, float64_t *gg, float64_t *hh,
 // assumes that all constraints are satisfied
 float64_t MKL::compute_elasticnet_dual_objective()
 {
-	int32_t n=get_num_support_vectors();
 	int32_t num_kernels = kernel->get_num_subkernels();
 	float64_t mkl_obj=0;
 
@@ -742,28 +742,15 @@ float64_t MKL::compute_elasticnet_dual_objective()
 
 		int32_t k=0;
 		auto combined_kernel = std::static_pointer_cast<CombinedKernel>(kernel);
+		SGVector<float64_t> sums=combined_kernel->compute_subkernel_quadratic_forms(
+			get_support_vectors(), get_alphas());
 		for (index_t k_idx=0; k_idx<combined_kernel->get_num_kernels(); k_idx++)
 		{
-			auto kn = combined_kernel->get_kernel(k_idx);
-			float64_t sum=0;
-			for (int32_t i=0; i<n; i++)
-			{
-				int32_t ii=get_support_vector(i);
-
-				for (int32_t j=0; j<n; j++)
-				{
-					int32_t jj=get_support_vector(j);
-					sum+=get_alpha(i)*get_alpha(j)*kn->kernel(ii,jj);
-				}
-			}
-			nm[k]= Math::pow(sum, 0.5);
+			nm[k]= Math::pow(sums[k_idx], 0.5);
 			del = Math::max(del, nm[k]);
 
 			// io::print("nm[{}]={}\n",k,nm[k]);
 			k++;
-
-
-
 		}
 		// initial delta
 		del = del / std::sqrt(2 * (1 - ent_lambda));
@@ -1637,6 +1624,20 @@ void MKL::compute_sum_beta(float64_t* sumw)
 		sumw[i]=0;
 	}
 
+	// with one weight per subkernel, all subkernels are done in one pass
+	auto combined_kernel=std::dynamic_pointer_cast<CombinedKernel>(kernel);
+	if (combined_kernel && !combined_kernel->get_append_subkernel_weights() &&
+		std::dynamic_pointer_cast<IdentityKernelNormalizer>(kernel->get_normalizer()))
+	{
+		SGVector<float64_t> sums=combined_kernel->compute_subkernel_quadratic_forms(
+			svm->get_support_vectors(), svm->get_alphas());
+		for (int32_t n=0; n<num_kernels; n++)
+			sumw[n]=0.5*sums[n];
+
+		mkl_iterations++;
+		return;
+	}
+
 	for (int32_t n=0; n<num_kernels; n++)
 	{
 		beta.vector[n]=1.0;
@@ -1671,26 +1672,16 @@ float64_t MKL::compute_mkl_dual_objective()
 		return compute_elasticnet_dual_objective();
 	}
 
-	int32_t n=get_num_support_vectors();
 	float64_t mkl_obj=0;
 
 	if (m_labels && kernel && kernel->get_kernel_type() == K_COMBINED)
 	{
 		auto combined_kernel = std::static_pointer_cast<CombinedKernel>(kernel);
+		SGVector<float64_t> sums=combined_kernel->compute_subkernel_quadratic_forms(
+			get_support_vectors(), get_alphas());
 		for (index_t k_idx=0; k_idx<combined_kernel->get_num_kernels(); k_idx++)
 		{
-			auto kn = combined_kernel->get_kernel(k_idx);
-			float64_t sum=0;
-			for (int32_t i=0; i<n; i++)
-			{
-				int32_t ii=get_support_vector(i);
-
-				for (int32_t j=0; j<n; j++)
-				{
-					int32_t jj=get_support_vector(j);
-					sum+=get_alpha(i)*get_alpha(j)*kn->kernel(ii,jj);
-				}
-			}
+			float64_t sum=sums[k_idx];
 
 			if (mkl_norm==1.0)
 				mkl_obj = Math::max(mkl_obj, sum);
@@ -42,6 +42,8 @@ void LibSVM::register_params()
 	    (machine_int_t*)&solver_type, "libsvm_solver_type",
 	    "LibSVM Solver type", ParameterProperties::SETTING,
 	    SG_OPTIONS(LIBSVM_C_SVC, LIBSVM_NU_SVC));
+	SG_ADD(&m_initial_alphas, "initial_alphas",
+	    "Alphas to start training from.");
 }
 
 bool LibSVM::train_machine(std::shared_ptr<Features> data)
@@ -140,6 +142,22 @@ bool LibSVM::train_machine(std::shared_ptr<Features> data)
 	param.weight = weights;
 	param.use_bias = get_bias_enabled();
 
+	// libsvm takes the class of the first vector as positive class
+	SGVector<float64_t> alpha_init;
+	if (m_initial_alphas.vlen)
+	{
+		require(solver_type==LIBSVM_C_SVC,
+			"Initial alphas are only supported by C-SVC");
+		require(m_initial_alphas.vlen==problem.l,
+			"Number of initial alphas ({}) must match number of labels ({})",
+			m_initial_alphas.vlen, problem.l);
+
+		alpha_init=m_initial_alphas.clone();
+		if (problem.y[0]<0)
+			alpha_init.scale(-1.0);
+		param.alpha_init=alpha_init.vector;
+	}
+
 	const char* error_msg = svm_check_parameter(&problem, &param);
 
 	if(error_msg)
@@ -54,6 +54,24 @@ class LibSVM : public SVM
 		 */
 		EMachineType get_classifier_type() override { return CT_LIBSVM; }
 
+		/** set the alphas the C-SVC solver starts from, e.g. the solution of
+		 * a related problem (warm start). The alphas are signed like the
+		 * ones of a trained SVM and clipped to a feasible solution first.
+		 *
+		 * @param alphas one alpha per training vector or an empty vector to
+		 * start from zero
+		 */
+		void set_initial_alphas(SGVector<float64_t> alphas)
+		{
+			m_initial_alphas=alphas;
+		}
+
+		/** @return alphas the C-SVC solver starts from */
+		SGVector<float64_t> get_initial_alphas() const
+		{
+			return m_initial_alphas;
+		}
+
 		/** @return object name */
 		const char* get_name() const override { return "LibSVM"; }
 
@@ -74,6 +92,9 @@ class LibSVM : public SVM
 	protected:
 		/** solver type */
 		LIBSVM_SOLVER_TYPE solver_type;
+
+		/** alphas to start training from, empty to start from zero */
+		SGVector<float64_t> m_initial_alphas;
 };
 }
 #endif
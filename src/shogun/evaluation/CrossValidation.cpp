@@ -7,16 +7,27 @@
  */
 
 #include <shogun/base/progress.h>
+#include <shogun/classifier/svm/LibSVM.h>
 #include <shogun/evaluation/CrossValidation.h>
 #include <shogun/evaluation/CrossValidationStorage.h>
 #include <shogun/evaluation/Evaluation.h>
 #include <shogun/evaluation/SplittingStrategy.h>
+#include <shogun/features/DenseFeatures.h>
+#include <shogun/features/SubsetStack.h>
+#include <shogun/kernel/CachedKernel.h>
+#include <shogun/kernel/normalizer/IdentityKernelNormalizer.h>
 #include <shogun/lib/observers/ObservedValueTemplated.h>
+#include <shogun/machine/KernelMachine.h>
 #include <shogun/machine/Machine.h>
 #include <shogun/mathematics/Statistics.h>
 #include <shogun/lib/View.h>
 
 #include <utility>
+#include <vector>
+
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
 
 using namespace shogun;
 
@@ -50,8 +61,14 @@ CrossValidation::~CrossValidation()
 void CrossValidation::init()
 {
 	m_num_runs = 1;
+	m_kernel_cache_size = 0;
+	m_warm_start = false;
 
 	SG_ADD(&m_num_runs, kNumRuns, "Number of repetitions");
+	SG_ADD(&m_kernel_cache_size, "kernel_cache_size",
+		"Size of the kernel value cache shared by the folds in MB");
+	SG_ADD(&m_warm_start, "warm_start",
+		"Whether LibSVM is warm started from the previous fold");
 }
 
 std::shared_ptr<EvaluationResult> CrossValidation::evaluate_impl() const
@@ -85,6 +102,12 @@ void CrossValidation::set_num_runs(int32_t num_runs)
 	m_num_runs = num_runs;
 }
 
+void CrossValidation::set_kernel_cache_size(int32_t size)
+{
+	require(size >= 0, "Kernel cache size ({}) must be non-negative", size);
+	m_kernel_cache_size = size;
+}
+
 float64_t CrossValidation::evaluate_one_run(int64_t index) const
 {
 	SG_TRACE("entering {}::evaluate_one_run()", get_name());
@@ -95,7 +118,48 @@ float64_t CrossValidation::evaluate_one_run(int64_t index) const
 
 	SGVector<float64_t> results(num_subsets);
 
-	#pragma omp parallel for shared(results)
+	// kernel values between the vectors of all folds, by original index
+	std::shared_ptr<KernelValueCache> kernel_cache;
+	if (m_kernel_cache_size > 0 && m_features &&
+	    std::dynamic_pointer_cast<KernelMachine>(m_machine))
+	{
+		auto subset_stack = m_features->get_subset_stack();
+		index_t num_vectors = 0;
+		for (index_t i = 0; i < m_features->get_num_vectors(); ++i)
+			num_vectors = std::max(
+				num_vectors, subset_stack->subset_idx_conversion(i) + 1);
+
+		kernel_cache = std::make_shared<KernelValueCache>(
+			num_vectors, m_kernel_cache_size);
+	}
+
+	// signed alphas of the previous fold, by index into m_features
+	const bool warm_start = m_warm_start &&
+		m_machine->get_classifier_type() == CT_LIBSVM &&
+		m_machine->get<machine_int_t>("libsvm_solver_type") == LIBSVM_C_SVC;
+	SGVector<float64_t> alphas;
+	if (warm_start)
+	{
+		alphas = SGVector<float64_t>(m_labels->get_num_labels());
+		alphas.zero();
+	}
+
+	// the training vectors of a fold are gathered into one matrix per thread,
+	// whose memory is reused by the next fold. Kernels that share values
+	// between the folds need the original indices of the vectors
+	auto dense_features =
+		std::dynamic_pointer_cast<DenseFeatures<float64_t>>(m_features);
+	std::vector<SGMatrix<float64_t>> scratch;
+	if (dense_features && !kernel_cache)
+	{
+#ifdef HAVE_OPENMP
+		scratch.resize(omp_get_max_threads());
+#else
+		scratch.resize(1);
+#endif
+	}
+
+	#pragma omp parallel for shared(results, scratch) if(!warm_start)
 	for (auto i = 0; i<num_subsets; ++i)
 	{
 		// only need to clone hyperparameters and settings of machine
@@ -110,15 +174,66 @@ float64_t CrossValidation::evaluate_one_run(int64_t index) const
 			m_splitting_strategy->generate_subset_indices(i);
 
 		auto features_train = view(m_features, idx_train);
+		if (!scratch.empty())
+		{
+#ifdef HAVE_OPENMP
+			auto& fold_scratch = scratch[omp_get_thread_num()];
+#else
+			auto& fold_scratch = scratch[0];
+#endif
+			features_train = std::make_shared<DenseFeatures<float64_t>>(
+				features_train->as<DenseFeatures<float64_t>>()
+					->gather_feature_matrix(fold_scratch));
+		}
 		auto labels_train = view(m_labels, idx_train);
 		auto features_test = view(m_features, idx_test);
 		auto labels_test = view(m_labels, idx_test);
 
 		auto evaluation_criterion = make_clone(m_evaluation_criterion);
 
+		if (kernel_cache)
+		{
+			auto kernel_machine =
+				std::static_pointer_cast<KernelMachine>(machine);
+			auto kernel = kernel_machine->get_kernel();
+			// combined and custom kernels index subkernels and matrices
+			// by their own features. Normalizers like AvgDiag depend on
+			// the vectors of the fold, so only unnormalized values are
+			// shared between the folds
+			if (kernel && kernel->get_kernel_type() != K_COMBINED &&
+			    kernel->get_kernel_type() != K_CUSTOM &&
+			    !std::dynamic_pointer_cast<CachedKernel>(kernel) &&
+			    std::dynamic_pointer_cast<IdentityKernelNormalizer>(
+			        kernel->get_normalizer()))
+			{
+				kernel_machine->set_kernel(
+					std::make_shared<CachedKernel>(kernel, kernel_cache));
+			}
+		}
+
+		if (warm_start && i > 0)
+		{
+			SGVector<float64_t> initial_alphas(idx_train.vlen);
+			for (index_t j = 0; j < idx_train.vlen; ++j)
+				initial_alphas[j] = alphas[idx_train[j]];
+			machine->put("initial_alphas", initial_alphas);
+		}
+
 		machine->set_labels(labels_train);
 		machine->train(features_train);
 
+		if (warm_start)
+		{
+			auto kernel_machine =
+				std::static_pointer_cast<KernelMachine>(machine);
+			auto svs = kernel_machine->get_support_vectors();
+			auto sv_alphas = kernel_machine->get_alphas();
+
+			alphas.zero();
+			for (index_t j = 0; j < svs.vlen; ++j)
+				alphas[idx_train[svs[j]]] = sv_alphas[j];
+		}
+
 		auto result_labels = machine->apply(features_test);
 
 		results[i] = evaluation_criterion->evaluate(result_labels, labels_test);
@@ -159,6 +159,39 @@ namespace shogun
 		/** setter for the number of runs to use for evaluation */
 		void set_num_runs(int32_t num_runs);
 
+		/** set the size of the cache of kernel values shared by the folds of
+		 * a run. If the machine is a KernelMachine, its kernel values are
+		 * then computed at most once per run (as long as the cache holds
+		 * them) instead of once per fold. Kernels with a normalizer other
+		 * than IdentityKernelNormalizer are not cached, as their values
+		 * depend on the vectors of the fold.
+		 *
+		 * @param size cache size in MB, 0 disables the cache
+		 */
+		void set_kernel_cache_size(int32_t size);
+
+		/** @return size of the kernel value cache in MB */
+		int32_t get_kernel_cache_size() const
+		{
+			return m_kernel_cache_size;
+		}
+
+		/** start training LibSVM (C-SVC) on a fold from the alphas of the
+		 * previous fold. Folds are then trained one after another.
+		 *
+		 * @param warm_start whether to warm start
+		 */
+		void set_warm_start(bool warm_start)
+		{
+			m_warm_start = warm_start;
+		}
+
+		/** @return whether LibSVM is warm started */
+		bool get_warm_start() const
+		{
+			return m_warm_start;
+		}
+
 		/** @return name of the SGSerializable */
 		const char* get_name() const override
 		{
@@ -189,6 +222,12 @@ namespace shogun
 		/** number of evaluation runs for one fold */
 		int32_t m_num_runs;
 
+		/** size of the kernel value cache in MB, 0 if disabled */
+		int32_t m_kernel_cache_size;
+
+		/** whether LibSVM is warm started from the previous fold */
+		bool m_warm_start;
+
 	#ifndef SWIG
 	public:
 		static constexpr std::string_view kNumRuns = "num_runs";
@@ -9,14 +9,21 @@
  */
 
 #include <shogun/features/DenseFeatures.h>
+#include <shogun/features/FeatureFileFormat.h>
 #include <shogun/preprocessor/DensePreprocessor.h>
 #include <shogun/io/SGIO.h>
+#include <shogun/lib/cpu.h>
 #include <shogun/mathematics/Math.h>
 #include <shogun/mathematics/eigen3.h>
 #include <shogun/mathematics/linalg/LinalgNamespace.h>
 #include <algorithm>
 #include <string.h>
 
+/** number of vectors the subset gather prefetches ahead */
+#define GATHER_PREFETCH_DISTANCE 8
+/** minimum number of elements for gathering a subset in parallel */
+#define GATHER_PARALLEL_MIN_SIZE (1<<16)
+
 #define ASSERT_FLOATING_POINT                                                  \
 	switch (get_feature_type())                                                \
 	{                                                                          \
@@ -44,6 +51,15 @@ template<class ST> DenseFeatures<ST>::DenseFeatures(const DenseFeatures & orig)
 	set_feature_matrix(orig.feature_matrix);
 	initialize_cache();
 
+	// the copy shares the mapped matrix or compressed vectors
+	m_mapped_file=orig.m_mapped_file;
+	if (orig.m_compressed)
+	{
+		m_compressed=orig.m_compressed;
+		num_vectors=orig.num_vectors;
+		num_features=orig.num_features;
+	}
+
 	if (orig.m_subset_stack != NULL)
 	{
 
@@ -114,6 +130,8 @@ template<class ST> void DenseFeatures<ST>::free_feature_matrix()
 {
 	m_subset_stack->remove_all_subsets();
 	feature_matrix=SGMatrix<ST>();
+	m_mapped_file=nullptr;
+	m_compressed=nullptr;
 	num_vectors = 0;
 	num_features = 0;
 }
@@ -132,20 +150,23 @@ template<class ST> ST* DenseFeatures<ST>::get_feature_vector(int32_t num, int32_
 	{
 		feat = &feature_matrix.matrix[real_num * int64_t(num_features)];
 	}
+	else if (m_compressed)
+	{
+		dofree = true;
+		feat = SG_MALLOC(ST, num_features);
+		m_compressed->get(real_num, feat);
+	}
 	else
 	{
+		dofree = true;
 		if (feature_cache)
-		{
-			feat = feature_cache->lock_entry(real_num);
-
-			if (!feat)
-				feat = feature_cache->set_entry(real_num);
-		}
+			feat = feature_cache->get(real_num, len);
 
 		if (!feat)
 		{
-			dofree = true;
-			feat = compute_feature_vector(num, len, feat);
+			feat = compute_feature_vector(num, len, NULL);
+			if (feature_cache && feat)
+				feature_cache->put(real_num, feat, len);
 		}
 	}
 
@@ -193,9 +214,6 @@ template<class ST> SGVector<ST> DenseFeatures<ST>::get_feature_vector(int32_t nu
 
 template<class ST> void DenseFeatures<ST>::free_feature_vector(ST* feat_vec, int32_t num, bool dofree) const
 {
-	if (feature_cache)
-		feature_cache->unlock_entry(m_subset_stack->subset_idx_conversion(num));
-
 	if (dofree)
 		SG_FREE(feat_vec);
 }
@@ -210,6 +228,8 @@ template<class ST> void DenseFeatures<ST>::vector_subset(int32_t* idx, int32_t i
 {
 	if (m_subset_stack->has_subsets())
 		error("A subset is set, cannot call vector_subset");
+	require(!m_compressed, "Features are compressed, call decompress() "
+		"before vector_subset");
 
 	ASSERT(feature_matrix.matrix)
 	ASSERT(idx_len<=num_vectors)
@@ -241,6 +261,8 @@ template<class ST> void DenseFeatures<ST>::feature_subset(int32_t* idx, int32_t
 {
 	if (m_subset_stack->has_subsets())
 		error("A subset is set, cannot call feature_subset");
+	require(!m_compressed, "Features are compressed, call decompress() "
+		"before feature_subset");
 
 	ASSERT(feature_matrix.matrix)
 	ASSERT(idx_len<=num_features)
@@ -269,7 +291,7 @@ template<class ST> void DenseFeatures<ST>::feature_subset(int32_t* idx, int32_t
 template <class ST>
 SGMatrix<ST> DenseFeatures<ST>::get_feature_matrix() const
 {
-	if (!m_subset_stack->has_subsets())
+	if (!m_subset_stack->has_subsets() && !m_compressed)
 		return feature_matrix;
 
 	SGMatrix<ST> target(num_features, get_num_vectors());
@@ -281,7 +303,7 @@ template <class ST>
 void DenseFeatures<ST>::copy_feature_matrix(SGMatrix<ST>& target, index_t column_offset) const
 {
 	require(column_offset>=0, "Column offset ({}) cannot be negative!", column_offset);
-	require(!target.equals(feature_matrix), "Source and target feature matrices cannot be the same");
+	require(target.matrix!=feature_matrix.matrix, "Source and target feature matrices cannot be the same");
 
 	index_t num_vecs=get_num_vectors();
 	index_t num_cols=num_vecs+column_offset;
@@ -294,7 +316,17 @@ void DenseFeatures<ST>::copy_feature_matrix(SGMatrix<ST>& target, index_t column
 			"Number of cols of given matrix ({}) should be at least {}!",
 			target.num_cols, num_cols);
 
-	if (!m_subset_stack->has_subsets())
+	if (m_compressed)
+	{
+		#pragma omp parallel for
+		for (int32_t i=0; i<num_vecs; ++i)
+		{
+			auto real_i=m_subset_stack->subset_idx_conversion(i);
+			m_compressed->get(real_i,
+				target.matrix+int64_t(num_features)*(column_offset+i));
+		}
+	}
+	else if (!m_subset_stack->has_subsets())
 	{
 		auto src=feature_matrix.matrix;
 		auto dest=target.matrix+int64_t(num_features)*column_offset;
@@ -302,16 +334,40 @@ void DenseFeatures<ST>::copy_feature_matrix(SGMatrix<ST>& target, index_t column
 	}
 	else
 	{
+		/* the composed subset indices are random accesses into the
+		 * matrix, so prefetch the next vectors while copying */
+		const index_t* idx=m_subset_stack->get_last_subset()->get_subset_idx().vector;
+		#pragma omp parallel for if (int64_t(num_vecs)*num_features>=GATHER_PARALLEL_MIN_SIZE)
 		for (int32_t i=0; i<num_vecs; ++i)
 		{
-			auto real_i=m_subset_stack->subset_idx_conversion(i);
-			auto src=feature_matrix.matrix+real_i*int64_t(num_features);
+			if (i+GATHER_PREFETCH_DISTANCE<num_vecs)
+				CpuPrefetch(feature_matrix.matrix+
+					idx[i+GATHER_PREFETCH_DISTANCE]*int64_t(num_features));
+
+			auto src=feature_matrix.matrix+idx[i]*int64_t(num_features);
 			auto dest=target.matrix+int64_t(num_features)*(column_offset+i);
 			sg_memcpy(dest, src, num_features*sizeof(ST));
 		}
 	}
 }
 
+template <class ST>
+SGMatrix<ST> DenseFeatures<ST>::gather_feature_matrix(SGMatrix<ST>& scratch) const
+{
+	if (!m_subset_stack->has_subsets() && !m_compressed)
+		return feature_matrix;
+
+	const index_t num_vecs=get_num_vectors();
+	if (scratch.num_rows!=num_features || scratch.num_cols<num_vecs)
+		scratch=SGMatrix<ST>(num_features, num_vecs);
+
+	copy_feature_matrix(scratch);
+	if (scratch.num_cols==num_vecs)
+		return scratch;
+
+	return SGMatrix<ST>(scratch.matrix, num_features, num_vecs, false);
+}
+
 template<class ST> void DenseFeatures<ST>::set_feature_matrix(SGMatrix<ST> matrix)
 {
 	m_subset_stack->remove_all_subsets();
@@ -325,6 +381,9 @@ template <class ST>
 ST* DenseFeatures<ST>::get_feature_matrix(
 	int32_t& num_feat, int32_t& num_vec) const
 {
+	require(!m_compressed, "Features are compressed, call decompress() "
+		"before accessing the feature matrix");
+
 	num_feat = num_features;
 	num_vec = num_vectors;
 	return feature_matrix.matrix;
@@ -388,13 +447,9 @@ template<class ST> void DenseFeatures<ST>::initialize_cache()
 	if (m_subset_stack->has_subsets())
 		error("A subset is set, cannot call initialize_cache");
 
-	if (num_features && num_vectors)
-	{
-
-		feature_cache = std::make_shared<Cache<ST>>(get_cache_size(), num_features,
-				num_vectors);
-
-	}
+	feature_cache = NULL;
+	if (num_features && num_vectors && get_cache_size()>0)
+		feature_cache = std::make_shared<ShardedVectorCache<ST>>(get_cache_size());
 }
 
 template<class ST> EFeatureClass DenseFeatures<ST>::get_feature_class() const  { return C_DENSE; }
@@ -526,9 +581,14 @@ template<class ST> std::shared_ptr<Features> DenseFeatures<ST>::copy_subset(SGVe
 	for (index_t i=0; i<indices.vlen; ++i)
 	{
 		index_t real_idx=m_subset_stack->subset_idx_conversion(indices.vector[i]);
-		sg_memcpy(&feature_matrix_copy.matrix[i*num_features],
-				&feature_matrix.matrix[real_idx*num_features],
-				num_features*sizeof(ST));
+		if (m_compressed)
+			m_compressed->get(real_idx, &feature_matrix_copy.matrix[i*num_features]);
+		else
+		{
+			sg_memcpy(&feature_matrix_copy.matrix[i*num_features],
+					&feature_matrix.matrix[real_idx*num_features],
+					num_features*sizeof(ST));
+		}
 	}
 
 	return std::make_shared<DenseFeatures>(feature_matrix_copy);
@@ -548,12 +608,25 @@ std::shared_ptr<Features> DenseFeatures<ST>::copy_dimension_subset(SGVector<inde
 
 	SGMatrix<ST> feature_matrix_copy(dims.vlen, get_num_vectors());
 
-	for (index_t i=0; i<dims.vlen; ++i)
+	if (m_compressed)
 	{
+		SGVector<ST> vec(num_features);
 		for (index_t j=0; j<get_num_vectors(); ++j)
 		{
-			index_t real_idx=m_subset_stack->subset_idx_conversion(j);
-			feature_matrix_copy(i, j)=feature_matrix(dims[i], real_idx);
+			m_compressed->get(m_subset_stack->subset_idx_conversion(j), vec.vector);
+			for (index_t i=0; i<dims.vlen; ++i)
+				feature_matrix_copy(i, j)=vec[dims[i]];
+		}
+	}
+	else
+	{
+		for (index_t i=0; i<dims.vlen; ++i)
+		{
+			for (index_t j=0; j<get_num_vectors(); ++j)
+			{
+				index_t real_idx=m_subset_stack->subset_idx_conversion(j);
+				feature_matrix_copy(i, j)=feature_matrix(dims[i], real_idx);
+			}
 		}
 	}
 
@@ -568,7 +641,14 @@ std::shared_ptr<Features> DenseFeatures<ST>::shallow_subset_copy()
 
 	SG_DEBUG("Using underlying feature matrix with {} dimensions and {} feature vectors!", num_features, num_vectors);
 	SGMatrix<ST> shallow_copy_matrix(feature_matrix);
-	shallow_copy_features=std::make_shared<DenseFeatures>(shallow_copy_matrix);
+	auto copy=std::make_shared<DenseFeatures>(shallow_copy_matrix);
+	if (m_compressed)
+	{
+		copy->m_compressed=m_compressed;
+		copy->num_vectors=num_vectors;
+		copy->num_features=num_features;
+	}
+	shallow_copy_features=copy;
 
 	if (m_subset_stack->has_subsets())
 		shallow_copy_features->add_subset(m_subset_stack->get_last_subset()->get_subset_idx());
@@ -721,7 +801,123 @@ void DenseFeatures<ST>::load(std::shared_ptr<File> loader)
 template<class ST>
 void DenseFeatures<ST>::save(std::shared_ptr<File> writer)
 {
-	feature_matrix.save(writer);
+	if (m_compressed)
+		decompress_all().save(writer);
+	else
+		feature_matrix.save(writer);
+}
+
+template<class ST>
+void DenseFeatures<ST>::compress(E_COMPRESSION_TYPE compression,
+	int32_t vectors_per_block, int32_t level)
+{
+	require(feature_matrix.matrix, "{}::compress(): No uncompressed feature "
+		"matrix", get_name());
+
+	auto store=std::make_shared<CompressedVectorStore>(compression,
+		vectors_per_block, level);
+	for (int32_t i=0; i<num_vectors; i++)
+		store->append(feature_matrix.get_column_vector(i), num_features*sizeof(ST));
+	store->finalize();
+
+	SG_DEBUG("Compressed {} bytes of features to {} bytes",
+		store->get_uncompressed_size(), store->get_compressed_size());
+
+	feature_matrix=SGMatrix<ST>();
+	m_mapped_file=nullptr;
+	m_compressed=store;
+}
+
+template<class ST>
+void DenseFeatures<ST>::decompress()
+{
+	if (!m_compressed)
+		return;
+
+	feature_matrix=decompress_all();
+	m_compressed=nullptr;
+}
+
+template<class ST>
+SGMatrix<ST> DenseFeatures<ST>::decompress_all() const
+{
+	SGMatrix<ST> matrix(num_features, num_vectors);
+	#pragma omp parallel for
+	for (int32_t i=0; i<num_vectors; i++)
+		m_compressed->get(i, matrix.get_column_vector(i));
+
+	return matrix;
+}
+
+template<class ST>
+std::shared_ptr<SGObject> DenseFeatures<ST>::clone(ParameterProperties pp) const
+{
+	auto clone=std::static_pointer_cast<DenseFeatures<ST>>(DotFeatures::clone(pp));
+
+	// the compressed vectors are never modified, so the clone shares them
+	clone->m_compressed=m_compressed;
+	return clone;
+}
+
+template<class ST>
+void DenseFeatures<ST>::save_serializable_pre() noexcept(false)
+{
+	DotFeatures::save_serializable_pre();
+
+	// compressed vectors are serialized as the decompressed matrix
+	if (m_compressed)
+		feature_matrix=decompress_all();
+}
+
+template<class ST>
+void DenseFeatures<ST>::save_serializable_post() noexcept(false)
+{
+	DotFeatures::save_serializable_post();
+
+	if (m_compressed)
+		feature_matrix=SGMatrix<ST>();
+}
+
+template<class ST>
+void DenseFeatures<ST>::save_mapped(const char* fname) const
+{
+	const int32_t num_vec=get_num_vectors();
+	auto header=FeatureFileHeader::create(FEATURE_FILE_DENSE,
+		get_feature_type(), sizeof(ST), num_features, num_vec,
+		int64_t(num_features)*num_vec);
+
+	MemoryMappedFile<char> file(fname, 'w', header.file_size);
+	file.set_truncate_size(header.file_size);
+	char* map=file.get_map();
+	memcpy(map, &header, sizeof(header));
+
+	ST* data=(ST*) (map+header.data_offset);
+	for (int32_t i=0; i<num_vec; i++)
+	{
+		int32_t len;
+		bool do_free;
+		ST* vec=get_feature_vector(i, len, do_free);
+		ASSERT(len==num_features)
+		sg_memcpy(data+int64_t(i)*num_features, vec, len*sizeof(ST));
+		free_feature_vector(vec, i, do_free);
+	}
+}
+
+template<class ST>
+void DenseFeatures<ST>::load_mapped(const char* fname)
+{
+	auto file=FeatureFileHeader::open(fname, FEATURE_FILE_DENSE,
+		get_feature_type(), sizeof(ST));
+	const auto* header=(const FeatureFileHeader*) file->get_map();
+	require(header->num_features<=std::numeric_limits<index_t>::max() &&
+		header->num_vectors<=std::numeric_limits<index_t>::max(),
+		"{}::load_mapped(): {} has too many features or vectors",
+		get_name(), fname);
+
+	set_feature_matrix(SGMatrix<ST>(
+		(ST*) (file->get_map()+header->data_offset), header->num_features,
+		header->num_vectors, false));
+	m_mapped_file=file;
 }
 
 template< class ST > std::shared_ptr<DenseFeatures< ST >> DenseFeatures< ST >::obtain_from_generic(std::shared_ptr<Features> base_features)
@@ -15,8 +15,10 @@
 #include <shogun/features/StringFeatures.h>
 #include <shogun/io/File.h>
 #include <shogun/lib/Cache.h>
+#include <shogun/lib/CompressedVectorStore.h>
 #include <shogun/lib/DataType.h>
 #include <shogun/lib/SGMatrix.h>
+#include <shogun/lib/ShardedVectorCache.h>
 #include <shogun/lib/common.h>
 #include <shogun/util/container_iterators.h>
 
@@ -24,6 +26,7 @@ namespace shogun {
 template<class ST> class StringFeatures;
 template<class ST> class DenseFeatures;
 template<class ST> class SGMatrix;
+template<class T> class MemoryMappedFile;
 class DotFeatures;
 
 /** @brief The class DenseFeatures implements dense feature matrices.
@@ -193,6 +196,20 @@ public:
 	 */
 	SGMatrix<ST> get_feature_matrix() const;
 
+	/** Gather the feature vectors (with subset) into a contiguous matrix
+	 * in parallel, reusing the memory of a scratch matrix. This avoids
+	 * an allocation per call when the same features are gathered under
+	 * different subsets, e.g. for bags or cross-validation folds.
+	 *
+	 * Without subset the feature matrix is returned without copying.
+	 *
+	 * @param scratch matrix whose memory is reused if it has
+	 * get_num_features() rows and at least get_num_vectors() columns,
+	 * otherwise it is replaced by a new matrix of the required size
+	 * @return the gathered matrix, a view of the memory of scratch
+	 */
+	SGMatrix<ST> gather_feature_matrix(SGMatrix<ST>& scratch) const;
+
 	/** get the pointer to the feature matrix
 	 * num_feat,num_vectors are returned by reference
 	 *
@@ -251,7 +268,9 @@ public:
 	 */
 	void set_num_vectors(int32_t num);
 
-	/** Initialize cache
+	/** Initialize the cache of vectors computed on the fly, see
+	 * ShardedVectorCache, with a budget of get_cache_size() MB. Without a
+	 * budget no cache is used.
 	 *
 	 * not possible with subset
 	 */
@@ -379,6 +398,55 @@ public:
 	 */
 	void save(std::shared_ptr<File> saver) override;
 
+	/** save the feature vectors (with subset) to a binary feature file,
+	 * see FeatureFileFormat.h, which can be memory mapped with load_mapped()
+	 *
+	 * @param fname name of the file
+	 */
+	void save_mapped(const char* fname) const;
+
+	/** memory map the feature matrix from a binary feature file written by
+	 * save_mapped(), without reading or copying it. The mapping is
+	 * copy-on-write, modifications of the features are never written back
+	 * to the file.
+	 *
+	 * Any subset is removed
+	 *
+	 * @param fname name of the file
+	 */
+	void load_mapped(const char* fname);
+
+	/** @return whether the feature matrix is memory mapped from a file */
+	bool is_memory_mapped() const
+	{
+		return m_mapped_file!=nullptr;
+	}
+
+	/** compress the feature matrix in memory, see CompressedVectorStore.
+	 * The uncompressed matrix is released and get_feature_vector()
+	 * decompresses vectors on demand, get_feature_matrix() returns a
+	 * decompressed copy. Subsets are kept. Clones share the compressed
+	 * vectors, save() and serialization write the decompressed matrix.
+	 * Functions that access or modify the matrix in place need
+	 * decompress() first.
+	 *
+	 * @param compression compression algorithm
+	 * @param vectors_per_block number of vectors compressed together
+	 * @param level compression level between 1 and 9
+	 */
+	void compress(E_COMPRESSION_TYPE compression,
+		int32_t vectors_per_block=COMPRESSED_STORE_DEFAULT_BLOCK_SIZE,
+		int32_t level=1);
+
+	/** restore the uncompressed feature matrix after compress() */
+	void decompress();
+
+	/** @return whether the feature matrix is compressed in memory */
+	bool is_compressed() const
+	{
+		return m_compressed!=nullptr;
+	}
+
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
 	/** iterator for dense features */
 	struct dense_feature_iterator
@@ -489,6 +557,8 @@ public:
 #endif
 	static std::shared_ptr<DenseFeatures> obtain_from_generic(std::shared_ptr<Features> base_features);
 
+	bool supports_shallow_subset_copy() const override { return true; }
+
 #ifndef SWIG // SWIG should skip this part
 	std::shared_ptr<Features> shallow_subset_copy() override;
 #endif
@@ -496,6 +566,28 @@ public:
 	/** @return object name */
 	const char* get_name() const override { return "DenseFeatures"; }
 
+	std::shared_ptr<SGObject> clone(ParameterProperties pp = ParameterProperties::ALL) const override;
+
+	/** Can (optionally) be overridden to pre-initialize some member
+	 *  variables which are not PARAMETER::ADD'ed.  Make sure that at
+	 *  first the overridden method BASE_CLASS::SAVE_SERIALIZABLE_PRE
+	 *  is called.
+	 *
+	 *  @exception ShogunException Will be thrown if an error
+	 *                             occurres.
+	 */
+	void save_serializable_pre() override;
+
+	/** Can (optionally) be overridden to post-initialize some member
+	 *  variables which are not PARAMETER::ADD'ed.  Make sure that at
+	 *  first the overridden method BASE_CLASS::SAVE_SERIALIZABLE_POST
+	 *  is called.
+	 *
+	 *  @exception ShogunException Will be thrown if an error
+	 *                             occurres.
+	 */
+	void save_serializable_post() override;
+
 protected:
 	/** compute feature vector for sample num
 	 * if target is set the vector is written to target
@@ -533,6 +625,9 @@ protected:
 private:
 	void init();
 
+	/** @return all vectors of the compressed matrix, ignoring subsets */
+	SGMatrix<ST> decompress_all() const;
+
 protected:
 	/*
 	 * Helper method which copies the working feature matrix into the pre-allocated
@@ -555,8 +650,14 @@ protected:
 	 * */
 	SGMatrix<ST> feature_matrix;
 
-	/** feature cache */
-	std::shared_ptr<Cache<ST>> feature_cache;
+	/** cache of the vectors computed on the fly */
+	std::shared_ptr<ShardedVectorCache<ST>> feature_cache;
+
+	/** file the feature matrix is mapped from, if any */
+	std::shared_ptr<MemoryMappedFile<char>> m_mapped_file;
+
+	/** compressed feature vectors, if the matrix is compressed */
+	std::shared_ptr<CompressedVectorStore> m_compressed;
 };
 }
 #endif // _DENSEFEATURES__H__
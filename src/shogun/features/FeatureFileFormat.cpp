@@ -0,0 +1,82 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <shogun/features/FeatureFileFormat.h>
+#include <shogun/io/SGIO.h>
+
+#include <string.h>
+
+using namespace shogun;
+
+namespace
+{
+	const char FEATURE_FILE_MAGIC[8]="SGFEATS";
+
+	int64_t align(int64_t offset)
+	{
+		return (offset+FEATURE_FILE_ALIGNMENT-1)/FEATURE_FILE_ALIGNMENT*
+			FEATURE_FILE_ALIGNMENT;
+	}
+}
+
+FeatureFileHeader FeatureFileHeader::create(EFeatureFileLayout layout,
+	EFeatureType feature_type, size_t element_size, int64_t num_features,
+	int64_t num_vectors, int64_t num_elements)
+{
+	FeatureFileHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, FEATURE_FILE_MAGIC, sizeof(header.magic));
+	header.version=FEATURE_FILE_VERSION;
+	header.layout=layout;
+	header.feature_type=feature_type;
+	header.element_size=element_size;
+	header.num_features=num_features;
+	header.num_vectors=num_vectors;
+	header.num_elements=num_elements;
+
+	header.data_offset=align(sizeof(header));
+	if (layout==FEATURE_FILE_SPARSE)
+	{
+		header.entries_offset=align(
+			header.data_offset+(num_vectors+1)*sizeof(int64_t));
+	}
+	else
+		header.entries_offset=header.data_offset;
+	header.file_size=header.entries_offset+num_elements*element_size;
+
+	return header;
+}
+
+std::shared_ptr<MemoryMappedFile<char>> FeatureFileHeader::open(
+	const char* fname, EFeatureFileLayout layout, EFeatureType feature_type,
+	size_t element_size)
+{
+	auto file=std::make_shared<MemoryMappedFile<char>>(fname, 'c');
+	require(file->get_size()>=sizeof(FeatureFileHeader),
+		"{} is too small to be a feature file", fname);
+
+	const auto* header=(const FeatureFileHeader*) file->get_map();
+	require(!memcmp(header->magic, FEATURE_FILE_MAGIC, sizeof(header->magic)),
+		"{} is not a feature file", fname);
+	require(header->version==FEATURE_FILE_VERSION,
+		"{} has feature file version {}, expected {}", fname,
+		header->version, FEATURE_FILE_VERSION);
+	require(header->layout==uint32_t(layout),
+		"{} has layout {}, expected {}", fname, header->layout, layout);
+	require(header->feature_type==feature_type &&
+		header->element_size==element_size,
+		"{} has feature type {} with {} bytes per element, expected {} with "
+		"{} bytes", fname, header->feature_type, header->element_size,
+		feature_type, element_size);
+
+	auto expected=create(layout, feature_type, element_size,
+		header->num_features, header->num_vectors, header->num_elements);
+	require(header->data_offset==expected.data_offset &&
+		header->entries_offset==expected.entries_offset &&
+		header->file_size==expected.file_size &&
+		int64_t(file->get_size())>=header->file_size,
+		"{} is truncated or corrupt", fname);
+
+	return file;
+}
@@ -0,0 +1,95 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#ifndef _FEATUREFILEFORMAT_H__
+#define _FEATUREFILEFORMAT_H__
+
+#include <shogun/lib/config.h>
+
+#include <shogun/features/FeatureTypes.h>
+#include <shogun/io/MemoryMappedFile.h>
+#include <shogun/lib/common.h>
+
+#include <memory>
+
+/** version of the binary feature file format */
+#define FEATURE_FILE_VERSION 1
+/** alignment of the data blocks of a feature file in bytes */
+#define FEATURE_FILE_ALIGNMENT 64
+
+namespace shogun
+{
+/** layout of the data of a feature file */
+enum EFeatureFileLayout
+{
+	/** column-major matrix, one column per vector */
+	FEATURE_FILE_DENSE = 0,
+	/** compressed sparse vectors: num_vectors+1 int64_t offsets followed by
+	 * the SGSparseVectorEntry entries of all vectors */
+	FEATURE_FILE_SPARSE = 1
+};
+
+/** @brief header of a binary feature file, which DenseFeatures and
+ * SparseFeatures can memory map to use the features in the file without
+ * reading or copying them.
+ *
+ * The header is followed by the data blocks, each of which starts at a
+ * multiple of FEATURE_FILE_ALIGNMENT bytes. Values are stored in the native
+ * byte order and type sizes of the writing machine, which are checked when
+ * a file is opened.
+ */
+struct FeatureFileHeader
+{
+	/** "SGFEATS" */
+	char magic[8];
+	/** format version */
+	uint32_t version;
+	/** EFeatureFileLayout */
+	uint32_t layout;
+	/** EFeatureType of the values */
+	int32_t feature_type;
+	/** size of a stored element (value or sparse entry) in bytes */
+	uint32_t element_size;
+	/** number of features (dimensions) */
+	int64_t num_features;
+	/** number of vectors */
+	int64_t num_vectors;
+	/** number of stored elements */
+	int64_t num_elements;
+	/** offset of the dense matrix or of the sparse offsets in bytes */
+	int64_t data_offset;
+	/** offset of the sparse entries in bytes */
+	int64_t entries_offset;
+	/** size of the file in bytes */
+	int64_t file_size;
+
+	/** create a header and compute the block offsets
+	 *
+	 * @param layout layout
+	 * @param feature_type type of the values
+	 * @param element_size size of a stored element
+	 * @param num_features number of features
+	 * @param num_vectors number of vectors
+	 * @param num_elements number of stored elements
+	 * @return header
+	 */
+	static FeatureFileHeader create(EFeatureFileLayout layout,
+		EFeatureType feature_type, size_t element_size, int64_t num_features,
+		int64_t num_vectors, int64_t num_elements);
+
+	/** map a feature file and check its header against the expected
+	 * layout and type
+	 *
+	 * @param fname file name
+	 * @param layout expected layout
+	 * @param feature_type expected type of the values
+	 * @param element_size expected size of a stored element
+	 * @return the file, mapped copy-on-write
+	 */
+	static std::shared_ptr<MemoryMappedFile<char>> open(const char* fname,
+		EFeatureFileLayout layout, EFeatureType feature_type,
+		size_t element_size);
+};
+}
+#endif /* _FEATUREFILEFORMAT_H__ */
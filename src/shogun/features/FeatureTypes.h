@@ -63,7 +63,8 @@ namespace shogun
 	{
 		FP_NONE = 0,
 		FP_DOT = 1,
-		FP_STREAMING_DOT = 2
+		FP_STREAMING_DOT = 2,
+		FP_STREAMING_BATCH = 4
 	};
 	std::string feature_type(EFeatureType f);
 }
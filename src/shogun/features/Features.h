@@ -322,6 +322,9 @@ class Features : public SGObject
 		 */
 		virtual bool get_feature_class_compatibility (EFeatureClass rhs) const;
 
+		/** @return whether shallow_subset_copy() is implemented */
+		virtual bool supports_shallow_subset_copy() const { return false; }
+
 #ifndef SWIG // SWIG should skip this part
 		virtual std::shared_ptr<Features> shallow_subset_copy()
 		{
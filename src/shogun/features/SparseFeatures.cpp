@@ -1,5 +1,6 @@
 #include <shogun/lib/common.h>
 #include <shogun/lib/memory.h>
+#include <shogun/features/FeatureFileFormat.h>
 #include <shogun/features/SparseFeatures.h>
 #include <shogun/preprocessor/SparsePreprocessor.h>
 #include <shogun/mathematics/Math.h>
@@ -33,7 +34,7 @@ template<class ST> SparseFeatures<ST>::SparseFeatures(SGMatrix<ST> dense)
 
 template<class ST> SparseFeatures<ST>::SparseFeatures(const SparseFeatures & orig)
 : DotFeatures(orig), sparse_feature_matrix(orig.sparse_feature_matrix),
-	feature_cache(orig.feature_cache)
+	feature_cache(orig.feature_cache), m_mapped_file(orig.m_mapped_file)
 {
 	init();
 
@@ -286,6 +287,7 @@ template<class ST> void SparseFeatures<ST>::free_sparse_features()
 template<class ST> void SparseFeatures<ST>::free_sparse_feature_matrix()
 {
 	sparse_feature_matrix=SGSparseMatrix<ST>();
+	m_mapped_file=nullptr;
 }
 
 template<class ST> void SparseFeatures<ST>::set_full_feature_matrix(SGMatrix<ST> full)
@@ -637,6 +639,73 @@ template<class ST> void SparseFeatures<ST>::save(std::shared_ptr<File> writer)
 	sparse_feature_matrix.save(writer);
 }
 
+template<class ST> void SparseFeatures<ST>::save_mapped(const char* fname) const
+{
+	const int32_t num_vec=get_num_vectors();
+	SGVector<int64_t> offsets(num_vec+1);
+	offsets[0]=0;
+	for (int32_t i=0; i<num_vec; i++)
+	{
+		offsets[i+1]=offsets[i]+get_sparse_feature_vector(i).num_feat_entries;
+		free_sparse_feature_vector(i);
+	}
+
+	auto header=FeatureFileHeader::create(FEATURE_FILE_SPARSE,
+		get_feature_type(), sizeof(SGSparseVectorEntry<ST>),
+		get_num_features(), num_vec, offsets[num_vec]);
+
+	MemoryMappedFile<char> file(fname, 'w', header.file_size);
+	file.set_truncate_size(header.file_size);
+	char* map=file.get_map();
+	memcpy(map, &header, sizeof(header));
+	sg_memcpy(map+header.data_offset, offsets.vector,
+		offsets.vlen*sizeof(int64_t));
+
+	auto entries=(SGSparseVectorEntry<ST>*) (map+header.entries_offset);
+	for (int32_t i=0; i<num_vec; i++)
+	{
+		SGSparseVector<ST> sv=get_sparse_feature_vector(i);
+		sg_memcpy(entries+offsets[i], sv.features,
+			sv.num_feat_entries*sizeof(SGSparseVectorEntry<ST>));
+		free_sparse_feature_vector(i);
+	}
+}
+
+template<class ST> void SparseFeatures<ST>::load_mapped(const char* fname)
+{
+	auto file=FeatureFileHeader::open(fname, FEATURE_FILE_SPARSE,
+		get_feature_type(), sizeof(SGSparseVectorEntry<ST>));
+	const auto* header=(const FeatureFileHeader*) file->get_map();
+	require(header->num_features<=std::numeric_limits<index_t>::max() &&
+		header->num_vectors<=std::numeric_limits<index_t>::max(),
+		"{}::load_mapped(): {} has too many features or vectors",
+		get_name(), fname);
+
+	const auto* offsets=(const int64_t*) (file->get_map()+header->data_offset);
+	auto entries=(SGSparseVectorEntry<ST>*) (
+		file->get_map()+header->entries_offset);
+	require(offsets[0]==0 && offsets[header->num_vectors]==header->num_elements,
+		"{}::load_mapped(): {} is corrupt", get_name(), fname);
+
+	// only the vector headers are allocated, they point into the file
+	const index_t num_vec=header->num_vectors;
+	SGSparseVector<ST>* vectors=SG_MALLOC(SGSparseVector<ST>, num_vec);
+	for (index_t i=0; i<num_vec; i++)
+	{
+		require(offsets[i]<=offsets[i+1] &&
+			offsets[i+1]-offsets[i]<=std::numeric_limits<index_t>::max(),
+			"{}::load_mapped(): {} is corrupt", get_name(), fname);
+		vectors[i]=SGSparseVector<ST>(entries+offsets[i],
+			offsets[i+1]-offsets[i], false);
+	}
+
+	remove_all_subsets();
+	free_sparse_feature_matrix();
+	sparse_feature_matrix=SGSparseMatrix<ST>(vectors, header->num_features,
+		num_vec);
+	m_mapped_file=file;
+}
+
 template<class ST> void SparseFeatures<ST>::save_with_labels(const std::shared_ptr<File>& writer, SGVector<float64_t> labels)
 {
 	if (m_subset_stack->has_subsets())
@@ -27,6 +27,7 @@ class LibSVMFile;
 class Features;
 template <class ST> class DenseFeatures;
 template <class T> class Cache;
+template <class T> class MemoryMappedFile;
 
 /** @brief Template class SparseFeatures implements sparse matrices.
  *
@@ -347,6 +348,32 @@ template <class ST> class SparseFeatures : public DotFeatures
 		 */
 		void save(std::shared_ptr<File> writer) override;
 
+		/** save the feature vectors (with subset) to a binary feature file,
+		 * see FeatureFileFormat.h, which can be memory mapped with
+		 * load_mapped()
+		 *
+		 * @param fname name of the file
+		 */
+		void save_mapped(const char* fname) const;
+
+		/** memory map the sparse feature vectors from a binary feature file
+		 * written by save_mapped(). The entries of the vectors are used in
+		 * place, without reading or copying them. The mapping is
+		 * copy-on-write, modifications of the features are never written
+		 * back to the file.
+		 *
+		 * any subset is removed before
+		 *
+		 * @param fname name of the file
+		 */
+		void load_mapped(const char* fname);
+
+		/** @return whether the feature vectors are memory mapped from a file */
+		bool is_memory_mapped() const
+		{
+			return m_mapped_file!=nullptr;
+		}
+
 		/** save features to file
 		 *
 		 * not possible with subset
@@ -482,6 +509,9 @@ template <class ST> class SparseFeatures : public DotFeatures
 
 		/** feature cache */
 		std::shared_ptr<Cache< SGSparseVectorEntry<ST> >> feature_cache;
+
+		/** file the feature vectors are mapped from, if any */
+		std::shared_ptr<MemoryMappedFile<char>> m_mapped_file;
 };
 }
 #endif /* _SPARSEFEATURES__H__ */
@@ -100,6 +100,7 @@ template<class ST> void StringFeatures<ST>::cleanup()
 	*/
 
 	features.clear();
+	m_compressed=nullptr;
 	symbol_mask_table = SGVector<ST>();
 
 	/* start with a fresh alphabet, but instead of emptying the histogram
@@ -200,7 +201,7 @@ template<class ST> ST* StringFeatures<ST>::get_feature_vector(int32_t num, int32
 
 	int32_t real_num=m_subset_stack->subset_idx_conversion(num);
 
-	if (!preprocess_on_get)
+	if (!preprocess_on_get && (features[real_num].vector || !m_compressed))
 	{
 		dofree=false;
 		len=features[real_num].vlen;
@@ -212,7 +213,7 @@ template<class ST> ST* StringFeatures<ST>::get_feature_vector(int32_t num, int32
 		ST* feat=compute_feature_vector(num, len);
 		dofree=true;
 
-		if (get_num_preprocessors())
+		if (preprocess_on_get && get_num_preprocessors())
 		{
 			ST* tmp_feat_before=feat;
 
@@ -229,6 +230,86 @@ template<class ST> ST* StringFeatures<ST>::get_feature_vector(int32_t num, int32
 	}
 }
 
+template<class ST> void StringFeatures<ST>::compress(
+		E_COMPRESSION_TYPE compression, int32_t vectors_per_block, int32_t level)
+{
+	require(!m_compressed, "Strings are already compressed");
+	require(!single_string.vector, "Cannot compress sliding window features");
+
+	auto store=std::make_shared<CompressedVectorStore>(compression,
+			vectors_per_block, level);
+	for (const auto& string : features)
+		store->append(string.vector, string.vlen*sizeof(ST));
+	store->finalize();
+
+	SG_DEBUG("Compressed {} bytes of strings to {} bytes",
+			store->get_uncompressed_size(), store->get_compressed_size());
+
+	/* keep the lengths, but release the strings */
+	for (auto& string : features)
+		string=SGVector<ST>(NULL, string.vlen, false);
+	m_compressed=store;
+}
+
+template<class ST> void StringFeatures<ST>::decompress()
+{
+	if (!m_compressed)
+		return;
+
+	features=decompress_all();
+	m_compressed=nullptr;
+}
+
+template<class ST> std::vector<SGVector<ST>> StringFeatures<ST>::decompress_all() const
+{
+	std::vector<SGVector<ST>> string_list(features);
+
+	#pragma omp parallel for
+	for (index_t i=0; i<(index_t) string_list.size(); i++)
+	{
+		if (!string_list[i].vector && string_list[i].vlen>0)
+		{
+			SGVector<ST> string(string_list[i].vlen);
+			m_compressed->get(i, string.vector);
+			string_list[i]=string;
+		}
+	}
+
+	return string_list;
+}
+
+template<class ST> std::shared_ptr<SGObject> StringFeatures<ST>::clone(ParameterProperties pp) const
+{
+	/* released strings are cloned with their length only, the compressed
+	 * strings are never modified so the clone shares them */
+	auto clone=std::static_pointer_cast<StringFeatures<ST>>(Features::clone(pp));
+	clone->m_compressed=m_compressed;
+	return clone;
+}
+
+template<class ST> void StringFeatures<ST>::save_serializable_pre() noexcept(false)
+{
+	Features::save_serializable_pre();
+
+	/* compressed strings are serialized decompressed */
+	if (m_compressed)
+	{
+		m_released_strings=decompress_all();
+		std::swap(features, m_released_strings);
+	}
+}
+
+template<class ST> void StringFeatures<ST>::save_serializable_post() noexcept(false)
+{
+	Features::save_serializable_post();
+
+	if (m_compressed)
+	{
+		std::swap(features, m_released_strings);
+		m_released_strings.clear();
+	}
+}
+
 template<class ST> std::shared_ptr<StringFeatures<ST>> StringFeatures<ST>::get_transposed()
 {
 	return std::make_shared<StringFeatures<ST>>(get_transposed_matrix(), alphabet);
@@ -316,6 +397,10 @@ template<class ST> int32_t StringFeatures<ST>::get_vector_length(int32_t vec_num
 {
 	ASSERT(vec_num<get_num_vectors())
 
+	/* the length of released compressed strings is kept */
+	if (!preprocess_on_get)
+		return features[m_subset_stack->subset_idx_conversion(vec_num)].vlen;
+
 	int32_t len;
 	bool free_vec;
 	ST* vec=get_feature_vector(vec_num, len, free_vec);
@@ -808,14 +893,16 @@ template<class ST> bool StringFeatures<ST>::append_features(std::shared_ptr<Stri
 	if (m_subset_stack->has_subsets())
 		error("Cannot call set_features() with subset.");
 
-	std::vector<SGVector<ST>> new_features;
-	new_features.reserve(sf->get_num_vectors());
-
 	index_t sf_num_str=sf->get_num_vectors();
+	std::vector<SGVector<ST>> new_features(sf_num_str);
+
 	for (int32_t i=0; i<sf_num_str; i++)
 	{
-		int32_t real_i = sf->m_subset_stack->subset_idx_conversion(i);
-		new_features[i] = sf->features[real_i].clone();
+		int32_t len;
+		bool free_vec;
+		ST* vec=sf->get_feature_vector(i, len, free_vec);
+		new_features[i]=SGVector<ST>(SGVector<ST>::clone_vector(vec, len), len);
+		sf->free_feature_vector(vec, i, free_vec);
 	}
 	return append_features(new_features);
 }
@@ -868,6 +955,8 @@ template<class ST> const std::vector<SGVector<ST>>& StringFeatures<ST>::get_stri
 {
 	if (m_subset_stack->has_subsets())
 		error("get features() is not possible on subset");
+	require(!m_compressed, "get features() is not possible on compressed "
+			"strings, call decompress() first");
 
 	return features;
 }
@@ -1060,6 +1149,9 @@ template<class ST> int32_t StringFeatures<ST>::obtain_by_sliding_window(int32_t
 	if (m_subset_stack->has_subsets())
 		not_implemented(SOURCE_LOCATION);
 
+	require(!m_compressed, "Cannot slide a window over compressed strings, "
+			"call decompress() first");
+
 	int32_t num_vectors = get_num_vectors();
 	int32_t max_string_length = get_max_vector_length();
 
@@ -1098,6 +1190,9 @@ template<class ST> int32_t StringFeatures<ST>::obtain_by_position_list(int32_t w
 	if (m_subset_stack->has_subsets())
 		not_implemented(SOURCE_LOCATION);
 
+	require(!m_compressed, "Cannot slide a window over compressed strings, "
+			"call decompress() first");
+
 	int32_t num_vectors = get_num_vectors();
 	int32_t max_string_length = get_max_vector_length();
 
@@ -1177,6 +1272,8 @@ template<class ST> void StringFeatures<ST>::embed_features(int32_t p_order)
 {
 	if (m_subset_stack->has_subsets())
 		not_implemented(SOURCE_LOCATION);
+	require(!m_compressed, "Cannot embed compressed strings, call "
+			"decompress() first");
 
 	ASSERT(alphabet->get_num_symbols_in_histogram() > 0)
 
@@ -1460,8 +1557,17 @@ template<class ST> std::shared_ptr<Features> StringFeatures<ST>::copy_subset(
 
 		/* copy string */
 		SGVector<ST> current_string=features[real_idx];
-		SGVector<ST> string_copy = current_string.clone();
-		list_copy[i]=string_copy;
+		if (!current_string.vector && current_string.vlen>0 && m_compressed)
+		{
+			SGVector<ST> string_copy(current_string.vlen);
+			m_compressed->get(real_idx, string_copy.vector);
+			list_copy[i]=string_copy;
+		}
+		else
+		{
+			SGVector<ST> string_copy = current_string.clone();
+			list_copy[i]=string_copy;
+		}
 	}
 
 	/* create copy instance */
@@ -1490,7 +1596,10 @@ template<class ST> ST* StringFeatures<ST>::compute_feature_vector(int32_t num, i
 		return NULL;
 
 	ST* target=SG_MALLOC(ST, len);
-	sg_memcpy(target, features[real_num].vector, len*sizeof(ST));
+	if (!features[real_num].vector && m_compressed)
+		m_compressed->get(real_num, target);
+	else
+		sg_memcpy(target, features[real_num].vector, len*sizeof(ST));
 	return target;
 }
 
@@ -1504,6 +1613,7 @@ template<class ST> void StringFeatures<ST>::init()
 	order=0;
 	preprocess_on_get=false;
 	feature_cache=NULL;
+	m_compressed=nullptr;
 	symbol_mask_table=SGVector<ST>();
 	num_symbols=0.0;
 	original_num_symbols=0;
@@ -1784,6 +1894,8 @@ template<> void StringFeatures<sg_type>::save(std::shared_ptr<File> writer)		\
 {																			\
 	if (m_subset_stack->has_subsets())															\
 		error("save() is not possible on subset");						\
+	require(!m_compressed, "save() is not possible on compressed "		\
+			"strings, call decompress() first");						\
 	SG_SET_LOCALE_C;													\
 	ASSERT(writer)															\
 	writer->f_write(features.data(), get_num_vectors());				\
@@ -1830,12 +1942,15 @@ bool StringFeatures<ST>::obtain_from_char_features(std::shared_ptr<StringFeature
 		int32_t len=-1;
 		bool vfree;
 		CT* c=sf->get_feature_vector(i, len, vfree);
-		ASSERT(!vfree) // won't work when preprocessors are attached
+		// won't work when preprocessors are attached
+		ASSERT(!vfree || sf->is_compressed())
 
 		features.emplace_back(len);
 
 		for (int32_t j=0; j<len; j++)
 			features.back()[j]=(ST) alpha->remap_to_bin(c[j]);
+
+		sf->free_feature_vector(c, i, vfree);
 	}
 
 	original_num_symbols=alpha->get_num_symbols();
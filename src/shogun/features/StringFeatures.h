@@ -13,6 +13,7 @@
 
 #include <shogun/lib/common.h>
 #include <shogun/lib/Cache.h>
+#include <shogun/lib/CompressedVectorStore.h>
 #include <shogun/lib/Compressor.h>
 #include <shogun/io/File.h>
 
@@ -414,6 +415,9 @@ template <class ST> class StringFeatures : public Features
 		bool append_features(const std::vector<SGVector<ST>>& p_features);
 
 		/** returns a copy of the string_list vector (swig friendly)
+		 *
+		 * not possible with compressed strings
+		 *
 		 * @return string_list
 		 */
 		const std::vector<SGVector<ST>>& get_string_list() const;
@@ -473,6 +477,35 @@ template <class ST> class StringFeatures : public Features
 		 */
 		virtual bool save_compressed(char* dest, E_COMPRESSION_TYPE compression, int level);
 
+		/** compress the strings in memory, see CompressedVectorStore. The
+		 * uncompressed strings are released and get_feature_vector()
+		 * decompresses them on demand, which lets string data sets much
+		 * larger than the memory (e.g. DNA for WD kernels) stay resident.
+		 *
+		 * get_string_list(), save(), embed_features() and the sliding
+		 * window functions need decompress() first, strings set or appended
+		 * later are kept uncompressed. Clones share the compressed strings,
+		 * serialization writes them decompressed.
+		 *
+		 * not possible with sliding window features
+		 *
+		 * @param compression compression algorithm
+		 * @param vectors_per_block number of strings compressed together
+		 * @param level compression level between 1 and 9
+		 */
+		void compress(E_COMPRESSION_TYPE compression,
+			int32_t vectors_per_block=COMPRESSED_STORE_DEFAULT_BLOCK_SIZE,
+			int32_t level=1);
+
+		/** restore the uncompressed strings after compress() */
+		void decompress();
+
+		/** @return whether the strings are compressed in memory */
+		bool is_compressed() const
+		{
+			return m_compressed!=nullptr;
+		}
+
 		/** slides a window of size window_size over the current single string
 		 * step_size is the amount by which the window is shifted.
 		 * creates (string_len-window_size)/step_size many feature obj
@@ -621,6 +654,28 @@ template <class ST> class StringFeatures : public Features
 		/** post method when subset is changed */
 		void subset_changed_post() override;
 
+		std::shared_ptr<SGObject> clone(ParameterProperties pp = ParameterProperties::ALL) const override;
+
+		/** Can (optionally) be overridden to pre-initialize some member
+		 *  variables which are not PARAMETER::ADD'ed.  Make sure that at
+		 *  first the overridden method BASE_CLASS::SAVE_SERIALIZABLE_PRE
+		 *  is called.
+		 *
+		 *  @exception ShogunException Will be thrown if an error
+		 *                             occurres.
+		 */
+		void save_serializable_pre() override;
+
+		/** Can (optionally) be overridden to post-initialize some member
+		 *  variables which are not PARAMETER::ADD'ed.  Make sure that at
+		 *  first the overridden method BASE_CLASS::SAVE_SERIALIZABLE_POST
+		 *  is called.
+		 *
+		 *  @exception ShogunException Will be thrown if an error
+		 *                             occurres.
+		 */
+		void save_serializable_post() override;
+
 	protected:
 		/** compute feature vector for sample num
 		 * if target is set the vector is written to target
@@ -637,6 +692,10 @@ template <class ST> class StringFeatures : public Features
 	private:
 		void init();
 
+		/** @return the string list with the released compressed strings
+		 * decompressed, ignoring subsets */
+		std::vector<SGVector<ST>> decompress_all() const;
+
 	protected:
 		/** alphabet */
 		std::shared_ptr<Alphabet> alphabet;
@@ -664,6 +723,13 @@ template <class ST> class StringFeatures : public Features
 
 		/** feature cache */
 		Cache<ST>* feature_cache;
+
+		/** compressed strings, if compressed in memory. Only strings whose
+		 * vector is NULL are read from it */
+		std::shared_ptr<CompressedVectorStore> m_compressed;
+
+		/** compressed string list while the decompressed one is serialized */
+		std::vector<SGVector<ST>> m_released_strings;
 };
 }
 #endif // _CSTRINGFEATURES__H__
@@ -63,7 +63,7 @@ void SubsetStack::init()
 	m_active_subset=NULL;
 }
 
-void SubsetStack::add_subset(const SGVector<index_t>& subset)
+void SubsetStack::check_subset(const SGVector<index_t>& subset) const
 {
 	/* if there are already subsets on stack, do some legality checks */
 	if (!m_active_subsets_stack.empty())
@@ -88,6 +88,11 @@ void SubsetStack::add_subset(const SGVector<index_t>& subset)
 					" indices larger than possible range!", get_name());
 		}
 	}
+}
+
+void SubsetStack::add_subset(const SGVector<index_t>& subset)
+{
+	check_subset(subset);
 
 	/* active subset will be changed anyway, no setting to NULL */
 
@@ -130,7 +135,24 @@ void SubsetStack::add_subset(const SGVector<index_t>& subset)
 
 void SubsetStack::add_subset_in_place(SGVector<index_t> subset)
 {
-	not_implemented(SOURCE_LOCATION);;
+	if (m_active_subsets_stack.empty())
+	{
+		add_subset(subset);
+		return;
+	}
+
+	check_subset(subset);
+
+	/* compose the given subset with the active one, and replace the active
+	 * one by the result. The active subset might be shared with copies of
+	 * this stack, so it is not modified */
+	const index_t* active=m_active_subset->m_subset_idx.vector;
+	SGVector<index_t> new_active_subset(subset.vlen);
+	for (index_t i=0; i<subset.vlen; ++i)
+		new_active_subset.vector[i]=active[subset.vector[i]];
+
+	m_active_subset=std::make_shared<Subset>(new_active_subset);
+	m_active_subsets_stack.back()=m_active_subset;
 }
 
 void SubsetStack::remove_subset()
@@ -109,6 +109,12 @@ private:
 	/** registers and initializes parameters */
 	void init();
 
+	/** checks that a subset can be added on top of the active one
+	 *
+	 * @param subset subset of indices to check
+	 */
+	void check_subset(const SGVector<index_t>& subset) const;
+
 private:
 	/** stack of active subsets. All active subsets are stored to avoid
 	 * recomputing them when subsets are removed. There is always the identity
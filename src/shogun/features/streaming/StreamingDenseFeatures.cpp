@@ -10,8 +10,61 @@
 #include <shogun/features/streaming/StreamingDenseFeatures.h>
 #include <shogun/io/streaming/StreamingFileFromDenseFeatures.h>
 
+#include <type_traits>
+
 namespace shogun
 {
+namespace
+{
+	/** r=X^T w for a matrix of any type, the float types use linalg */
+	template <class T>
+	SGVector<float32_t> transposed_matrix_prod(
+			const SGMatrix<T>& X, const SGVector<float32_t>& w)
+	{
+		if constexpr (std::is_same_v<T, float32_t>)
+			return linalg::matrix_prod(X, w, true);
+		else if constexpr (std::is_same_v<T, float64_t>)
+			return linalg::matrix_prod(X, w.as<float64_t>(), true).template as<float32_t>();
+		else
+		{
+			SGVector<float32_t> result(X.num_cols);
+			#pragma omp parallel for
+			for (index_t j=0; j<X.num_cols; j++)
+			{
+				const T* col=X.get_column_vector(j);
+				float32_t sum=0;
+				for (index_t i=0; i<X.num_rows; i++)
+					sum+=col[i]*w[i];
+				result[j]=sum;
+			}
+			return result;
+		}
+	}
+
+	/** r=X a for a matrix of any type, the float types use linalg */
+	template <class T>
+	SGVector<float32_t> matrix_prod(
+			const SGMatrix<T>& X, const SGVector<float32_t>& a)
+	{
+		if constexpr (std::is_same_v<T, float32_t>)
+			return linalg::matrix_prod(X, a);
+		else if constexpr (std::is_same_v<T, float64_t>)
+			return linalg::matrix_prod(X, a.as<float64_t>()).template as<float32_t>();
+		else
+		{
+			SGVector<float32_t> result(X.num_rows);
+			result.zero();
+			for (index_t j=0; j<X.num_cols; j++)
+			{
+				const T* col=X.get_column_vector(j);
+				for (index_t i=0; i<X.num_rows; i++)
+					result[i]+=a[j]*col[i];
+			}
+			return result;
+		}
+	}
+}
+
 template<class T>
 StreamingDenseFeatures<T>::StreamingDenseFeatures() :
 		StreamingDotFeatures()
@@ -131,6 +184,111 @@ template<class T> void StreamingDenseFeatures<T>::add_to_dense_vec(
 	}
 }
 
+template<class T> int32_t StreamingDenseFeatures<T>::get_next_batch(
+		int32_t num_vectors)
+{
+	require(num_vectors>0, "Requested number of feature vectors ({}) must be "
+			"positive", num_vectors);
+
+	SGMatrix<T> matrix;
+	SGVector<float64_t> labels(has_labels ? num_vectors : 0);
+	int32_t num_fetched=0;
+	for (; num_fetched<num_vectors && get_next_example(); num_fetched++)
+	{
+		/* allocate matrix memory for the first example */
+		if (!matrix.matrix)
+			matrix=SGMatrix<T>(current_vector.vlen, num_vectors);
+
+		require(current_vector.vlen==matrix.num_rows,
+				"Dimension of streamed vector ({}) does not match "
+				"dimensions of previous vectors ({})",
+				current_vector.vlen, matrix.num_rows);
+
+		sg_memcpy(matrix.get_column_vector(num_fetched), current_vector.vector,
+				current_vector.vlen*sizeof(T));
+		if (has_labels)
+			labels[num_fetched]=current_label;
+
+		release_example();
+	}
+
+	/* shrink if the stream ended */
+	if (num_fetched<num_vectors)
+	{
+		SGMatrix<T> so_far(matrix.num_rows, num_fetched);
+		sg_memcpy(so_far.matrix, matrix.matrix,
+				so_far.num_rows*so_far.num_cols*sizeof(T));
+		matrix=so_far;
+
+		if (has_labels)
+			labels=SGVector<float64_t>(labels.vector, num_fetched, false).clone();
+	}
+
+	batch_matrix=matrix;
+	batch_labels=labels;
+	return num_fetched;
+}
+
+template<class T> int32_t StreamingDenseFeatures<T>::get_batch_size() const
+{
+	return batch_matrix.num_cols;
+}
+
+template<class T> SGVector<float64_t> StreamingDenseFeatures<T>::get_batch_labels() const
+{
+	ASSERT(has_labels)
+
+	return batch_labels;
+}
+
+template<class T> SGMatrix<T> StreamingDenseFeatures<T>::get_batch() const
+{
+	return batch_matrix;
+}
+
+template<class T> SGVector<float32_t> StreamingDenseFeatures<T>::dense_dot_batch(
+		const SGVector<float32_t>& w, float32_t b)
+{
+	require(w.vlen==batch_matrix.num_rows || !batch_matrix.num_cols,
+			"Length of vector ({}) does not match dimension of features ({})",
+			w.vlen, batch_matrix.num_rows);
+
+	if (!batch_matrix.num_cols)
+		return SGVector<float32_t>(0);
+
+	SGVector<float32_t> result=transposed_matrix_prod(batch_matrix, w);
+	if (b!=0)
+		linalg::add_scalar(result, b);
+
+	return result;
+}
+
+template<class T> void StreamingDenseFeatures<T>::add_to_dense_vec_batch(
+		const SGVector<float32_t>& alphas, SGVector<float32_t>& vec, bool abs_val)
+{
+	require(alphas.vlen==batch_matrix.num_cols,
+			"Number of alphas ({}) does not match batch size ({})",
+			alphas.vlen, batch_matrix.num_cols);
+	require(vec.vlen==batch_matrix.num_rows || !batch_matrix.num_cols,
+			"Length of vector ({}) does not match dimension of features ({})",
+			vec.vlen, batch_matrix.num_rows);
+
+	if (!batch_matrix.num_cols)
+		return;
+
+	if (abs_val)
+	{
+		for (index_t j=0; j<batch_matrix.num_cols; j++)
+		{
+			const T* col=batch_matrix.get_column_vector(j);
+			for (index_t i=0; i<batch_matrix.num_rows; i++)
+				vec[i]+=alphas[j]*Math::abs(col[i]);
+		}
+	}
+	else
+		linalg::add(vec, matrix_prod(batch_matrix, alphas), vec);
+}
+
 template<class T> int32_t StreamingDenseFeatures<T>::get_nnz_features_for_vector()
 {
 	return current_vector.vlen;
@@ -184,6 +342,7 @@ void StreamingDenseFeatures<T>::init()
 	current_vector.vector=NULL;
 	current_vector.vlen=-1;
 
+	set_property(FP_STREAMING_BATCH);
 	set_generic<T>();
 }
 
@@ -199,6 +358,12 @@ void StreamingDenseFeatures<T>::init(std::shared_ptr<StreamingFile> file, bool i
 	seekable=false;
 }
 
+template<class T>
+void StreamingDenseFeatures<T>::set_num_parse_threads(int32_t num_threads, bool ordered)
+{
+	parser.set_num_parse_threads(num_threads, ordered);
+}
+
 template<class T>
 void StreamingDenseFeatures<T>::start_parser()
 {
@@ -298,55 +463,11 @@ std::shared_ptr<Features> StreamingDenseFeatures<T>::get_streamed_features(
 	require(num_elements>0, "Requested number of feature vectors ({}) must be "
 			"positive", num_elements);
 
-	/* init matrix empty, as we dont know the dimension yet */
-	SGMatrix<T> matrix;
+	if (get_next_batch(num_elements)<num_elements)
+		io::warn("Ran out of streaming data, reallocating matrix and "
+				"returning!");
 
-	for (index_t i=0; i<num_elements; ++i)
-	{
-		/* check if we run out of data */
-		if (!get_next_example())
-		{
-			io::warn("Ran out of streaming data, reallocating matrix and "
-					"returning!");
-
-			/* allocating space for data so far, not this mighe be 0 bytes */
-			SGMatrix<T> so_far(matrix.num_rows, i);
-
-			/* copy */
-			sg_memcpy(so_far.matrix, matrix.matrix,
-					so_far.num_rows*so_far.num_cols*sizeof(T));
-
-			matrix=so_far;
-			break;
-		}
-		else
-		{
-			/* allocate matrix memory in first iteration */
-			if (!matrix.matrix)
-			{
-				SG_DEBUG("Allocating {}x{} matrix",
-						current_vector.vlen, num_elements);
-				matrix=SGMatrix<T>(current_vector.vlen, num_elements);
-			}
-
-			/* get an example from stream and copy to feature matrix */
-			SGVector<T> vec=get_vector();
-
-			/* check for inconsistent dimensions */
-			require(vec.vlen==matrix.num_rows,
-					"Dimension of streamed vector ({}) does not match "
-					"dimensions of previous vectors ({})",
-					vec.vlen, matrix.num_rows);
-
-			/* copy vector into matrix */
-			sg_memcpy(&matrix.matrix[current_vector.vlen*i], vec.vector,
-					vec.vlen*sizeof(T));
-
-			/* clean up */
-			release_example();
-		}
-
-	}
+	SGMatrix<T> matrix=get_batch();
 
 	/* create new feature object from collected data */
 	SG_DEBUG("leaving returning {}x{} matrix", matrix.num_rows,
@@ -87,6 +87,18 @@ public:
 	 */
 	void set_vector_and_label_reader() override;
 
+	/**
+	 * Sets the number of threads parsing the input. Chunks of lines
+	 * of text input are then parsed concurrently, see
+	 * InputParser::set_num_parse_threads().
+	 *
+	 * To be called before start_parser().
+	 *
+	 * @param num_threads number of parse threads
+	 * @param ordered whether examples keep the order of the input
+	 */
+	void set_num_parse_threads(int32_t num_threads, bool ordered=true);
+
 	/**
 	 * Starts the parsing thread.
 	 *
@@ -213,6 +225,44 @@ public:
 	virtual void add_to_dense_vec(float64_t alpha, float64_t* vec2,
 			int32_t vec2_len, bool abs_val=false);
 
+	/** Fetch the next examples and store them as the columns of a
+	 * matrix, see get_batch().
+	 *
+	 * @param num_vectors maximum number of examples to fetch
+	 * @return number of examples in the batch
+	 */
+	int32_t get_next_batch(int32_t num_vectors) override;
+
+	/** @return number of examples in the current batch */
+	int32_t get_batch_size() const override;
+
+	/** @return labels of the examples in the current batch */
+	SGVector<float64_t> get_batch_labels() const override;
+
+	/** @return the examples of the current batch as the columns of a
+	 * matrix */
+	SGMatrix<T> get_batch() const;
+
+	/** Dot products of the examples of the current batch with a dense
+	 * vector, as one matrix-vector product.
+	 *
+	 * @param w dense vector
+	 * @param b bias
+	 * @return dot products, one per example
+	 */
+	SGVector<float32_t> dense_dot_batch(
+			const SGVector<float32_t>& w, float32_t b=0) override;
+
+	/** Add the examples of the current batch multiplied with alphas to a
+	 * dense vector, as one matrix-vector product.
+	 *
+	 * @param alphas one scalar per example
+	 * @param vec dense vector to add to
+	 * @param abs_val if true add the absolute values
+	 */
+	void add_to_dense_vec_batch(const SGVector<float32_t>& alphas,
+			SGVector<float32_t>& vec, bool abs_val=false) override;
+
 	/** get number of non-zero features in vector
 	 *
 	 * @return number of non-zero features in vector
@@ -295,6 +345,12 @@ protected:
 
 	/// The current example's label.
 	float64_t current_label;
+
+	/// Examples of the current batch, one per column
+	SGMatrix<T> batch_matrix;
+
+	/// Labels of the current batch
+	SGVector<float64_t> batch_labels;
 };
 }
 #endif // _STREAMINGDENSEFEATURES__H__
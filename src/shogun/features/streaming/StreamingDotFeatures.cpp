@@ -46,6 +46,37 @@ void StreamingDotFeatures::dense_dot_range(float32_t* output, float32_t* alphas,
 	end_parser();
 }
 
+int32_t StreamingDotFeatures::get_next_batch(int32_t num_vectors)
+{
+	not_implemented(SOURCE_LOCATION);
+	return 0;
+}
+
+int32_t StreamingDotFeatures::get_batch_size() const
+{
+	not_implemented(SOURCE_LOCATION);
+	return 0;
+}
+
+SGVector<float64_t> StreamingDotFeatures::get_batch_labels() const
+{
+	not_implemented(SOURCE_LOCATION);
+	return SGVector<float64_t>();
+}
+
+SGVector<float32_t> StreamingDotFeatures::dense_dot_batch(
+		const SGVector<float32_t>& w, float32_t b)
+{
+	not_implemented(SOURCE_LOCATION);
+	return SGVector<float32_t>();
+}
+
+void StreamingDotFeatures::add_to_dense_vec_batch(
+		const SGVector<float32_t>& alphas, SGVector<float32_t>& vec, bool abs_val)
+{
+	not_implemented(SOURCE_LOCATION);
+}
+
 void StreamingDotFeatures::expand_if_required(float32_t*& vec, int32_t &len)
 {
 	int32_t dim = get_dim_feature_space();
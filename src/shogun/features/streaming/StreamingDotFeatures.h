@@ -13,6 +13,9 @@
 #include <shogun/features/FeatureTypes.h>
 #include <shogun/lib/SGSparseVector.h>
 
+/** default number of examples fetched at once by batch consumers */
+#define STREAMING_DEFAULT_BATCH_SIZE 1024
+
 namespace shogun
 {
 class DotFeatures;
@@ -38,6 +41,10 @@ class StreamingFile;
  *
  * - iteration over all (potentially) non-zero features of \f${\bf x}\f$
  *
+ * Streaming features with the FP_STREAMING_BATCH property can also fetch a
+ * batch of examples at once with get_next_batch(), which is stored in a
+ * block, and compute dot products with and additions to a dense vector for
+ * the whole batch (dense_dot_batch(), add_to_dense_vec_batch()).
  */
 
 class StreamingDotFeatures : public StreamingFeatures
@@ -110,6 +117,48 @@ public:
 	virtual void dense_dot_range(float32_t* output, float32_t* alphas,
 			float32_t* vec, int32_t dim, float32_t b, int32_t num_vec=0);
 
+	/** Fetch the next examples from the stream at once and store them in a
+	 * block, which replaces the previous batch. The examples are released
+	 * to the parser right away, do not call release_example() for them.
+	 *
+	 * Only supported if the features have the FP_STREAMING_BATCH property.
+	 *
+	 * @param num_vectors maximum number of examples to fetch
+	 * @return number of examples in the batch, less than num_vectors if
+	 * the stream ended
+	 */
+	virtual int32_t get_next_batch(int32_t num_vectors);
+
+	/** @return number of examples in the current batch */
+	virtual int32_t get_batch_size() const;
+
+	/** @return labels of the examples in the current batch */
+	virtual SGVector<float64_t> get_batch_labels() const;
+
+	/** compute the dot products of all examples of the current batch with
+	 * a dense vector
+	 *
+	 * \f$r_i = {\bf x}_i \cdot {\bf w} + b\f$
+	 *
+	 * @param w dense vector
+	 * @param b bias
+	 * @return dot products, one per example
+	 */
+	virtual SGVector<float32_t> dense_dot_batch(
+			const SGVector<float32_t>& w, float32_t b=0);
+
+	/** add the examples of the current batch multiplied with alphas to a
+	 * dense vector
+	 *
+	 * \f${\bf z'} = \sum_i \alpha_i {\bf x}_i + {\bf z}\f$
+	 *
+	 * @param alphas one scalar per example
+	 * @param vec dense vector to add to
+	 * @param abs_val if true add the absolute values
+	 */
+	virtual void add_to_dense_vec_batch(const SGVector<float32_t>& alphas,
+			SGVector<float32_t>& vec, bool abs_val=false);
+
 	/** add current vector multiplied with alpha to dense vector, 'vec'
 	 *
 	 * @param alpha scalar alpha
@@ -132,6 +132,11 @@ EFeatureClass StreamingHashedDocDotFeatures::get_feature_class() const
 	return C_STREAMING_SPARSE;
 }
 
+void StreamingHashedDocDotFeatures::set_num_parse_threads(int32_t num_threads, bool ordered)
+{
+	parser.set_num_parse_threads(num_threads, ordered);
+}
+
 void StreamingHashedDocDotFeatures::start_parser()
 {
 	if (!parser.is_running())
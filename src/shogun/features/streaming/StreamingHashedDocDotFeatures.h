@@ -161,6 +161,18 @@ public:
 	 */
 	EFeatureClass get_feature_class() const override;
 
+	/**
+	 * Sets the number of threads parsing the input. Chunks of lines
+	 * of text input are then parsed concurrently, see
+	 * InputParser::set_num_parse_threads().
+	 *
+	 * To be called before start_parser().
+	 *
+	 * @param num_threads number of parse threads
+	 * @param ordered whether examples keep the order of the input
+	 */
+	void set_num_parse_threads(int32_t num_threads, bool ordered=true);
+
 	/**
 	 * Start the parser.
 	 * It stores parsed examples from the input in a separate thread.
@@ -203,6 +203,114 @@ float32_t StreamingSparseFeatures<T>::compute_squared()
 	return sq;
 }
 
+template <class T>
+int32_t StreamingSparseFeatures<T>::get_next_batch(int32_t num_vectors)
+{
+	require(num_vectors>0, "Requested number of feature vectors ({}) must be "
+			"positive", num_vectors);
+
+	batch_entries.clear();
+	SGVector<index_t> offsets(num_vectors+1);
+	SGVector<float64_t> labels(has_labels ? num_vectors : 0);
+	offsets[0]=0;
+
+	int32_t num_fetched=0;
+	for (; num_fetched<num_vectors && get_next_example(); num_fetched++)
+	{
+		batch_entries.insert(batch_entries.end(), current_sgvector.features,
+				current_sgvector.features+current_sgvector.num_feat_entries);
+		offsets[num_fetched+1]=batch_entries.size();
+		if (has_labels)
+			labels[num_fetched]=current_label;
+
+		release_example();
+	}
+
+	if (num_fetched<num_vectors)
+	{
+		offsets=SGVector<index_t>(offsets.vector, num_fetched+1, false).clone();
+		if (has_labels)
+			labels=SGVector<float64_t>(labels.vector, num_fetched, false).clone();
+	}
+
+	batch_offsets=offsets;
+	batch_labels=labels;
+	return num_fetched;
+}
+
+template <class T>
+int32_t StreamingSparseFeatures<T>::get_batch_size() const
+{
+	return Math::max(batch_offsets.vlen-1, 0);
+}
+
+template <class T>
+SGVector<float64_t> StreamingSparseFeatures<T>::get_batch_labels() const
+{
+	ASSERT(has_labels)
+
+	return batch_labels;
+}
+
+template <class T>
+SGSparseVector<T> StreamingSparseFeatures<T>::get_batch_vector(int32_t num) const
+{
+	require(num>=0 && num<get_batch_size(),
+			"Index {} out of bounds for batch of size {}", num, get_batch_size());
+
+	return SGSparseVector<T>(
+			const_cast<SGSparseVectorEntry<T>*>(batch_entries.data())+batch_offsets[num],
+			batch_offsets[num+1]-batch_offsets[num], false);
+}
+
+template <class T>
+SGVector<float32_t> StreamingSparseFeatures<T>::dense_dot_batch(
+		const SGVector<float32_t>& w, float32_t b)
+{
+	const int32_t num_vectors=get_batch_size();
+	SGVector<float32_t> result(num_vectors);
+
+	#pragma omp parallel for
+	for (int32_t j=0; j<num_vectors; j++)
+	{
+		float32_t sum=b;
+		for (index_t k=batch_offsets[j]; k<batch_offsets[j+1]; k++)
+		{
+			const auto& entry=batch_entries[k];
+			if (entry.feat_index<w.vlen)
+				sum+=w[entry.feat_index]*entry.entry;
+		}
+		result[j]=sum;
+	}
+
+	return result;
+}
+
+template <class T>
+void StreamingSparseFeatures<T>::add_to_dense_vec_batch(
+		const SGVector<float32_t>& alphas, SGVector<float32_t>& vec, bool abs_val)
+{
+	const int32_t num_vectors=get_batch_size();
+	require(alphas.vlen==num_vectors,
+			"Number of alphas ({}) does not match batch size ({})",
+			alphas.vlen, num_vectors);
+	if (vec.vlen < current_num_features)
+	{
+		error("dimension of vec (={}) does not match number of features (={})",
+			 vec.vlen, current_num_features);
+	}
+
+	for (int32_t j=0; j<num_vectors; j++)
+	{
+		for (index_t k=batch_offsets[j]; k<batch_offsets[j+1]; k++)
+		{
+			const auto& entry=batch_entries[k];
+			vec[entry.feat_index]+=alphas[j]*
+				(abs_val ? Math::abs(entry.entry) : entry.entry);
+		}
+	}
+}
+
 template <class T>
 void StreamingSparseFeatures<T>::sort_features()
 {
@@ -262,6 +370,7 @@ void StreamingSparseFeatures<T>::init()
 	working_file=NULL;
 	current_vec_index=0;
 	current_num_features=-1;
+	set_property(FP_STREAMING_BATCH);
 
 	set_generic<T>();
 }
@@ -279,6 +388,12 @@ void StreamingSparseFeatures<T>::init(std::shared_ptr<StreamingFile> file,
 	parser.set_free_vector_after_release(false);
 }
 
+template <class T>
+void StreamingSparseFeatures<T>::set_num_parse_threads(int32_t num_threads, bool ordered)
+{
+	parser.set_num_parse_threads(num_threads, ordered);
+}
+
 template <class T>
 void StreamingSparseFeatures<T>::start_parser()
 {
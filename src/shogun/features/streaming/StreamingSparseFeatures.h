@@ -15,6 +15,8 @@
 #include <shogun/lib/SGSparseVector.h>
 #include <shogun/features/FeatureTypes.h>
 
+#include <vector>
+
 namespace shogun
 {
 class StreamingFile;
@@ -95,6 +97,18 @@ public:
 	 */
 	void set_vector_and_label_reader() override;
 
+	/**
+	 * Sets the number of threads parsing the input. Chunks of lines
+	 * of text input are then parsed concurrently, see
+	 * InputParser::set_num_parse_threads().
+	 *
+	 * To be called before start_parser().
+	 *
+	 * @param num_threads number of parse threads
+	 * @param ordered whether examples keep the order of the input
+	 */
+	void set_num_parse_threads(int32_t num_threads, bool ordered=true);
+
 	/**
 	 * Starts the parsing thread.
 	 *
@@ -256,6 +270,61 @@ public:
 	 */
 	void add_to_dense_vec(float32_t alpha, float32_t* vec2, int32_t vec2_len, bool abs_val=false) override;
 
+	/**
+	 * Fetch the next examples and store them as one compressed sparse
+	 * row block, see get_batch_vector().
+	 *
+	 * @param num_vectors maximum number of examples to fetch
+	 * @return number of examples in the batch
+	 */
+	int32_t get_next_batch(int32_t num_vectors) override;
+
+	/**
+	 * Return the number of examples in the current batch.
+	 *
+	 * @return batch size
+	 */
+	int32_t get_batch_size() const override;
+
+	/**
+	 * Return the labels of the examples in the current batch.
+	 *
+	 * @return labels
+	 */
+	SGVector<float64_t> get_batch_labels() const override;
+
+	/**
+	 * Return an example of the current batch. The vector is a view into
+	 * the batch and valid until the next call to get_next_batch().
+	 *
+	 * @param num index of the example in the batch
+	 * @return sparse vector
+	 */
+	SGSparseVector<T> get_batch_vector(int32_t num) const;
+
+	/**
+	 * Dot products of the examples of the current batch with a dense
+	 * vector. Features beyond the length of w are ignored, like in
+	 * dense_dot().
+	 *
+	 * @param w dense vector
+	 * @param b bias
+	 * @return dot products, one per example
+	 */
+	SGVector<float32_t> dense_dot_batch(
+			const SGVector<float32_t>& w, float32_t b=0) override;
+
+	/**
+	 * Add the examples of the current batch multiplied with alphas to a
+	 * dense vector.
+	 *
+	 * @param alphas one scalar per example
+	 * @param vec dense vector to add to
+	 * @param abs_val true if abs of the examples should be taken
+	 */
+	void add_to_dense_vec_batch(const SGVector<float32_t>& alphas,
+			SGVector<float32_t>& vec, bool abs_val=false) override;
+
 	/**
 	 * Get number of non-zero entries in current sparse vector
 	 *
@@ -350,6 +419,15 @@ protected:
 
 	/// Number of features in current vector (as seen so far upto the current vector)
 	int32_t current_num_features;
+
+	/// Entries of all examples of the current batch
+	std::vector<SGSparseVectorEntry<T>> batch_entries;
+
+	/// Offsets of the examples into batch_entries, batch size+1 of them
+	SGVector<index_t> batch_offsets;
+
+	/// Labels of the current batch
+	SGVector<float64_t> batch_labels;
 };
 
 }
@@ -10,11 +10,88 @@
 #include <shogun/io/SGIO.h>
 #include <shogun/lib/SGVector.h>
 #include <shogun/io/LineReader.h>
+#include <shogun/io/MappedTextReader.h>
 #include <shogun/io/Parser.h>
 #include <shogun/lib/DelimiterTokenizer.h>
 
 using namespace shogun;
 
+namespace
+{
+	/** parse a mapped CSV file into a matrix in parallel, every chunk of
+	 * lines is parsed directly into its columns (rows if transposed) */
+	template <class T>
+	void parse_mapped_matrix(MappedTextReader& reader, const bool* delimiters,
+		int32_t num_to_skip, bool transposed, T*& matrix, int32_t& num_feat,
+		int32_t& num_vec)
+	{
+		reader.skip_lines(num_to_skip);
+		auto chunks=reader.split();
+		const int32_t num_chunks=chunks.size()-1;
+
+		// tokens of the first line
+		int32_t num_tokens=0;
+		const char* pos=reader.begin();
+		const char *line_begin, *line_end, *token_begin, *token_end;
+		if (MappedTextReader::next_line(pos, reader.end(), line_begin, line_end))
+		{
+			while (MappedTextReader::next_token(line_begin, line_end,
+					delimiters, token_begin, token_end))
+				num_tokens++;
+		}
+
+		// first line of every chunk
+		std::vector<index_t> offsets(num_chunks+1, 0);
+#pragma omp parallel for
+		for (int32_t c=0; c<num_chunks; c++)
+		{
+			offsets[c+1]=MappedTextReader::count_lines(chunks[c], chunks[c+1]);
+		}
+		for (int32_t c=0; c<num_chunks; c++)
+			offsets[c+1]+=offsets[c];
+		const index_t num_lines=offsets[num_chunks];
+
+		matrix=SG_MALLOC(T, int64_t(num_lines)*num_tokens);
+
+		SG_SET_LOCALE_C;
+#pragma omp parallel for schedule(dynamic)
+		for (int32_t c=0; c<num_chunks; c++)
+		{
+			const char* chunk_pos=chunks[c];
+			const char *l_begin, *l_end, *t_begin, *t_end;
+			for (index_t line=offsets[c]; MappedTextReader::next_line(
+					chunk_pos, chunks[c+1], l_begin, l_end); line++)
+			{
+				for (int32_t i=0; i<num_tokens; i++)
+				{
+					// missing tokens are zero
+					T value=0;
+					if (MappedTextReader::next_token(l_begin, l_end,
+							delimiters, t_begin, t_end))
+						value=MappedTextReader::parse<T>(t_begin, t_end);
+
+					if (!transposed)
+						matrix[i+int64_t(line)*num_tokens]=value;
+					else
+						matrix[line+int64_t(i)*num_lines]=value;
+				}
+			}
+		}
+		SG_RESET_LOCALE;
+
+		if (!transposed)
+		{
+			num_feat=num_tokens;
+			num_vec=num_lines;
+		}
+		else
+		{
+			num_feat=num_lines;
+			num_vec=num_tokens;
+		}
+	}
+}
+
 CSVFile::CSVFile()
 {
 	init();
@@ -171,6 +248,14 @@ GET_VECTOR(read_ulong, uint64_t)
 #define GET_MATRIX(read_func, sg_type) \
 void CSVFile::get_matrix(sg_type*& matrix, int32_t& num_feat, int32_t& num_vec) \
 { \
+	MappedTextReader reader(file); \
+	if (reader.is_mapped()) \
+	{ \
+		parse_mapped_matrix(reader, m_tokenizer->delimiters.vector, \
+			m_num_to_skip, is_data_transposed, matrix, num_feat, num_vec); \
+		return; \
+	} \
+	\
 	int32_t num_lines=0; \
 	int32_t num_tokens=-1; \
 	int32_t current_line_idx=0; \
@@ -181,22 +266,24 @@ void CSVFile::get_matrix(sg_type*& matrix, int32_t& num_feat, int32_t& num_vec)
 	\
 	SG_SET_LOCALE_C; \
 	\
-	matrix=SG_MALLOC(sg_type, num_lines*num_tokens); \
+	matrix=SG_MALLOC(sg_type, int64_t(num_lines)*num_tokens); \
 	skip_lines(m_num_to_skip); \
-	while (m_line_reader->has_next()) \
+	while (m_line_reader->has_next() && current_line_idx<num_lines) \
 	{ \
 		line=m_line_reader->read_line(); \
 		m_parser->set_text(line); \
 		\
 		for (int32_t i=0; i<num_tokens; i++) \
 		{ \
-			if (!m_parser->has_next()) \
-				return; \
+			/* missing tokens are zero, as in the mapped parser */ \
+			sg_type value=0; \
+			if (m_parser->has_next()) \
+				value=m_parser->read_func(); \
 			\
 			if (!is_data_transposed) \
-				matrix[i+current_line_idx*num_tokens]=m_parser->read_func(); \
+				matrix[i+int64_t(current_line_idx)*num_tokens]=value; \
 			else \
-				matrix[current_line_idx+i*num_tokens]=m_parser->read_func(); \
+				matrix[current_line_idx+int64_t(i)*num_lines]=value; \
 		} \
 		current_line_idx++; \
 	} \
@@ -80,6 +80,16 @@ void IOBuffer::set(char *p)
 	space.end = p;
 }
 
+void IOBuffer::load(const char* text, size_t len)
+{
+	if ((size_t) (space.end_array - space.begin) < len)
+		space.reserve(len);
+	sg_memcpy(space.begin, text, len);
+	space.end = space.begin;
+	endloaded = space.begin + len;
+	working_file = -1;
+}
+
 ssize_t IOBuffer::read_file(void* buf, size_t nbytes)
 {
 	return read(working_file, buf, nbytes);
@@ -86,6 +86,16 @@ namespace shogun
 	 */
 	void set(char *p);
 
+	/**
+	 * Replace the contents of the buffer with a copy of the given
+	 * text and detach it from any file, so the text is read as if
+	 * it were the whole file.
+	 *
+	 * @param text text to read
+	 * @param len length of the text
+	 */
+	void load(const char* text, size_t len);
+
 	/**
 	 * Read some bytes from the file into memory.
 	 *
@@ -9,6 +9,7 @@
 
 #include <shogun/base/progress.h>
 #include <shogun/io/LineReader.h>
+#include <shogun/io/MappedTextReader.h>
 #include <shogun/io/Parser.h>
 #include <shogun/lib/DelimiterTokenizer.h>
 #include <shogun/lib/SGSparseVector.h>
@@ -19,6 +20,153 @@
 
 using namespace shogun;
 
+namespace
+{
+	/** whether a token is a feature entry, i.e. has a value after the
+	 * feature delimiter */
+	bool is_mapped_feat_entry(const char* begin, const char* end, char delimiter)
+	{
+		const char* pos=(const char*) memchr(begin, delimiter, end-begin);
+		if (!pos)
+			return false;
+
+		for (; pos<end; pos++)
+		{
+			if (*pos!=delimiter)
+				return true;
+		}
+		return false;
+	}
+
+	/** parse a mapped LibSVM file in parallel, every chunk of lines is
+	 * parsed directly into its sparse vectors and labels */
+	template <class T>
+	void parse_mapped_sparse_matrix(const MappedTextReader& reader,
+		const bool* whitespace, char delimiter_feat, char delimiter_label,
+		bool load_labels, SGSparseVector<T>*& mat_feat, int32_t& num_feat,
+		int32_t& num_vec, SGVector<float64_t>*& multilabel,
+		int32_t& num_classes)
+	{
+		bool label_delimiters[256]={};
+		label_delimiters[(uint8_t) delimiter_label]=true;
+
+		auto chunks=reader.split();
+		const int32_t num_chunks=chunks.size()-1;
+
+		// first line of every chunk
+		std::vector<index_t> offsets(num_chunks+1, 0);
+#pragma omp parallel for
+		for (int32_t c=0; c<num_chunks; c++)
+		{
+			offsets[c+1]=MappedTextReader::count_lines(chunks[c], chunks[c+1]);
+		}
+		for (int32_t c=0; c<num_chunks; c++)
+			offsets[c+1]+=offsets[c];
+
+		num_vec=offsets[num_chunks];
+		mat_feat=SG_MALLOC(SGSparseVector<T>, num_vec);
+		multilabel=SG_MALLOC(SGVector<float64_t>, num_vec);
+
+		std::vector<int32_t> chunk_num_feat(num_chunks, 0);
+		std::vector<std::vector<float64_t>> chunk_classes(num_chunks);
+		auto pb=SG_SPROGRESS(range(0, num_chunks));
+
+		SG_SET_LOCALE_C;
+#pragma omp parallel for schedule(dynamic)
+		for (int32_t c=0; c<num_chunks; c++)
+		{
+			const char* pos=chunks[c];
+			const char *line_begin, *line_end, *token_begin, *token_end;
+			for (index_t line=offsets[c]; MappedTextReader::next_line(
+					pos, chunks[c+1], line_begin, line_end); line++)
+			{
+				// the label is the first token, unless it is a feature
+				const char* feat_begin=line_begin;
+				const char* label_begin=line_begin;
+				const char* label_end=line_begin;
+				if (load_labels && MappedTextReader::next_token(feat_begin,
+						line_end, whitespace, token_begin, token_end) &&
+					!is_mapped_feat_entry(token_begin, token_end, delimiter_feat))
+				{
+					label_begin=token_begin;
+					label_end=token_end;
+				}
+				else
+					feat_begin=line_begin;
+
+				int32_t num_feat_entries=0;
+				const char* tokens=feat_begin;
+				while (MappedTextReader::next_token(tokens, line_end,
+						whitespace, token_begin, token_end))
+					num_feat_entries++;
+
+				auto& vec=mat_feat[line];
+				vec=SGSparseVector<T>(num_feat_entries);
+				tokens=feat_begin;
+				for (int32_t i=0; i<num_feat_entries; i++)
+				{
+					MappedTextReader::next_token(tokens, line_end, whitespace,
+						token_begin, token_end);
+
+					const char* value_begin=(const char*) memchr(
+						token_begin, delimiter_feat, token_end-token_begin);
+					if (!value_begin)
+						value_begin=token_end;
+					const int32_t feat_index=MappedTextReader::parse<int32_t>(
+						token_begin, value_begin);
+					while (value_begin<token_end && *value_begin==delimiter_feat)
+						value_begin++;
+
+					chunk_num_feat[c]=Math::max(chunk_num_feat[c], feat_index);
+					vec.features[i].feat_index=feat_index-1;
+					vec.features[i].entry=MappedTextReader::parse<T>(
+						value_begin, token_end);
+				}
+
+				if (load_labels)
+				{
+					int32_t num_label_entries=0;
+					const char* labels=label_begin;
+					while (MappedTextReader::next_token(labels, label_end,
+							label_delimiters, token_begin, token_end))
+						num_label_entries++;
+
+					multilabel[line]=SGVector<float64_t>(num_label_entries);
+					labels=label_begin;
+					for (int32_t j=0; j<num_label_entries; j++)
+					{
+						MappedTextReader::next_token(labels, label_end,
+							label_delimiters, token_begin, token_end);
+						float64_t label_val=MappedTextReader::parse<float64_t>(
+							token_begin, token_end);
+
+						auto& classes=chunk_classes[c];
+						if (std::find(classes.begin(), classes.end(), label_val)==classes.end())
+							classes.push_back(label_val);
+						multilabel[line][j]=label_val;
+					}
+				}
+			}
+			pb.print_progress();
+		}
+		pb.complete();
+		SG_RESET_LOCALE;
+
+		num_feat=0;
+		std::vector<float64_t> classes;
+		for (int32_t c=0; c<num_chunks; c++)
+		{
+			num_feat=Math::max(num_feat, chunk_num_feat[c]);
+			for (auto label_val : chunk_classes[c])
+			{
+				if (std::find(classes.begin(), classes.end(), label_val)==classes.end())
+					classes.push_back(label_val);
+			}
+		}
+		num_classes=classes.size();
+	}
+}
+
 LibSVMFile::LibSVMFile()
 {
 	init();
@@ -150,6 +298,17 @@ GET_LABELED_SPARSE_MATRIX(read_ulong, uint64_t)
 	    int32_t& num_vec, SGVector<float64_t>*& multilabel,                    \
 	    int32_t& num_classes, bool load_labels)                                \
 	{                                                                          \
+		MappedTextReader reader(file);                                         \
+		if (reader.is_mapped())                                                \
+		{                                                                      \
+			parse_mapped_sparse_matrix(                                        \
+			    reader, m_whitespace_tokenizer->delimiters.vector,             \
+			    m_delimiter_feat, m_delimiter_label, load_labels, mat_feat,    \
+			    num_feat, num_vec, multilabel, num_classes);                   \
+			io::info("file successfully read");                                \
+			return;                                                            \
+		}                                                                      \
+                                                                               \
 		num_feat = 0;                                                          \
                                                                                \
 		io::info("counting line numbers in file {}.", filename);               \
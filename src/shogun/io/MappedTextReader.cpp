@@ -0,0 +1,164 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <shogun/base/ShogunEnv.h>
+#include <shogun/io/MappedTextReader.h>
+#include <shogun/io/SGIO.h>
+#include <shogun/mathematics/Math.h>
+
+#include <stdlib.h>
+#include <string>
+#ifndef _MSC_VER
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace shogun;
+
+namespace
+{
+	/** number of chunks per thread split() creates */
+	const int64_t CHUNKS_PER_THREAD=8;
+	/** minimum size of a chunk split() creates in bytes */
+	const int64_t MIN_CHUNK_SIZE=1<<20;
+
+	/** tokens up to this length are converted from a stack buffer */
+	const size_t MAX_SHORT_TOKEN=127;
+
+	/** call a conversion on a null-terminated copy of a token */
+	template <class T, class F>
+	T convert(const char* begin, const char* end, F conv)
+	{
+		const size_t len=end-begin;
+		if (!len)
+			return T(0);
+
+		if (len<=MAX_SHORT_TOKEN)
+		{
+			char buffer[MAX_SHORT_TOKEN+1];
+			memcpy(buffer, begin, len);
+			buffer[len]='\0';
+			return conv(buffer);
+		}
+
+		std::string token(begin, end);
+		return conv(token.c_str());
+	}
+}
+
+MappedTextReader::MappedTextReader(FILE* stream)
+: m_address(NULL), m_length(0), m_begin(NULL), m_end(NULL)
+{
+#ifndef _MSC_VER
+	if (!stream)
+		return;
+
+	const int fd=fileno(stream);
+	struct stat sb;
+	if (fd==-1 || fstat(fd, &sb)==-1 || !S_ISREG(sb.st_mode) || !sb.st_size)
+		return;
+
+	void* address=mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (address==MAP_FAILED)
+	{
+		SG_DEBUG("Could not map file, falling back to reading it")
+		return;
+	}
+	madvise(address, sb.st_size, MADV_SEQUENTIAL);
+
+	m_address=address;
+	m_length=sb.st_size;
+	m_begin=(const char*) address;
+	m_end=m_begin+m_length;
+#endif
+}
+
+MappedTextReader::~MappedTextReader()
+{
+#ifndef _MSC_VER
+	if (m_address)
+		munmap(m_address, m_length);
+#endif
+}
+
+void MappedTextReader::skip_lines(int32_t num_lines)
+{
+	const char* line_begin;
+	const char* line_end;
+	for (int32_t i=0; i<num_lines && next_line(m_begin, m_end, line_begin, line_end); i++);
+}
+
+std::vector<const char*> MappedTextReader::split(int32_t num_chunks) const
+{
+	require(num_chunks>0, "Number of chunks ({}) must be positive", num_chunks);
+
+	const int64_t length=m_end-m_begin;
+	std::vector<const char*> bounds(1, m_begin);
+	for (int32_t i=1; i<num_chunks; i++)
+	{
+		const char* pos=m_begin+length*i/num_chunks;
+		if (pos<=bounds.back())
+			continue;
+
+		// move to the beginning of the next line
+		pos=(const char*) memchr(pos-1, '\n', m_end-pos+1);
+		if (!pos)
+			break;
+		if (pos+1>bounds.back() && pos+1<m_end)
+			bounds.push_back(pos+1);
+	}
+	bounds.push_back(m_end);
+
+	return bounds;
+}
+
+std::vector<const char*> MappedTextReader::split() const
+{
+	const int64_t num_chunks=Math::min(
+		env()->get_num_threads()*CHUNKS_PER_THREAD,
+		(m_end-m_begin)/MIN_CHUNK_SIZE+1);
+
+	return split(num_chunks);
+}
+
+index_t MappedTextReader::count_lines(const char* begin, const char* end)
+{
+	index_t num_lines=0;
+	const char* line_begin;
+	const char* line_end;
+	while (next_line(begin, end, line_begin, line_end))
+		num_lines++;
+
+	return num_lines;
+}
+
+float64_t MappedTextReader::parse_real(const char* begin, const char* end)
+{
+	return convert<float64_t>(begin, end,
+		[](const char* s) { return strtod(s, NULL); });
+}
+
+floatmax_t MappedTextReader::parse_long_real(const char* begin, const char* end)
+{
+#ifdef HAVE_STRTOLD
+	return convert<floatmax_t>(begin, end,
+		[](const char* s) { return strtold(s, NULL); });
+#else
+	return convert<floatmax_t>(begin, end,
+		[](const char* s) { return strtod(s, NULL); });
+#endif
+}
+
+int64_t MappedTextReader::parse_long(const char* begin, const char* end)
+{
+	return convert<int64_t>(begin, end,
+		[](const char* s) { return strtoll(s, NULL, 10); });
+}
+
+uint64_t MappedTextReader::parse_ulong(const char* begin, const char* end)
+{
+	return convert<uint64_t>(begin, end,
+		[](const char* s) { return strtoull(s, NULL, 10); });
+}
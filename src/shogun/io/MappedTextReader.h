@@ -0,0 +1,191 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#ifndef __MAPPEDTEXTREADER_H__
+#define __MAPPEDTEXTREADER_H__
+
+#include <shogun/lib/config.h>
+
+#include <shogun/lib/common.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+namespace shogun
+{
+/** @brief MappedTextReader memory-maps a text file for parsing it in
+ * parallel without copying.
+ *
+ * The file is split into chunks which start at the beginning of a line, so
+ * every chunk can be parsed on its own. Lines and tokens are returned as
+ * [begin, end) ranges into the mapped file and numbers are converted with
+ * the same functions Parser uses, without any allocations.
+ *
+ * Only regular files can be mapped (and not on Windows), is_mapped() tells
+ * the caller to fall back to reading the stream otherwise. Like LineReader,
+ * empty lines are skipped.
+ */
+class MappedTextReader
+{
+public:
+	/** constructor, maps the whole file behind a stream
+	 *
+	 * @param stream stream of the file, not read from or closed
+	 */
+	explicit MappedTextReader(FILE* stream);
+
+	~MappedTextReader();
+
+	/** @return whether the file could be mapped */
+	bool is_mapped() const
+	{
+		return m_begin!=NULL;
+	}
+
+	/** @return beginning of the (remaining) file */
+	const char* begin() const
+	{
+		return m_begin;
+	}
+
+	/** @return end of the file */
+	const char* end() const
+	{
+		return m_end;
+	}
+
+	/** skip lines at the beginning of the file
+	 *
+	 * @param num_lines number of lines
+	 */
+	void skip_lines(int32_t num_lines);
+
+	/** split the (remaining) file into chunks of whole lines
+	 *
+	 * @param num_chunks maximum number of chunks
+	 * @return the chunk boundaries, chunk i is [result[i], result[i+1])
+	 */
+	std::vector<const char*> split(int32_t num_chunks) const;
+
+	/** split the (remaining) file into chunks of whole lines, enough of
+	 * them to balance the load of the available threads
+	 *
+	 * @return the chunk boundaries, chunk i is [result[i], result[i+1])
+	 */
+	std::vector<const char*> split() const;
+
+	/** get the next non-empty line
+	 *
+	 * @param pos position to start from, moved to the end of the line
+	 * @param end end of the text
+	 * @param line_begin set to the beginning of the line
+	 * @param line_end set to the end of the line (without the newline)
+	 * @return false if there is no line left
+	 */
+	static bool next_line(const char*& pos, const char* end,
+		const char*& line_begin, const char*& line_end)
+	{
+		while (pos<end && *pos=='\n')
+			pos++;
+		if (pos==end)
+			return false;
+
+		line_begin=pos;
+		pos=(const char*) memchr(pos, '\n', end-pos);
+		if (!pos)
+			pos=end;
+		line_end=pos;
+		return true;
+	}
+
+	/** get the next token, consecutive delimiters are skipped
+	 *
+	 * @param pos position to start from, moved to the end of the token
+	 * @param end end of the text
+	 * @param delimiters table of the delimiting characters
+	 * @param token_begin set to the beginning of the token
+	 * @param token_end set to the end of the token
+	 * @return false if there is no token left
+	 */
+	static bool next_token(const char*& pos, const char* end,
+		const bool* delimiters, const char*& token_begin,
+		const char*& token_end)
+	{
+		while (pos<end && delimiters[(uint8_t) *pos])
+			pos++;
+		if (pos==end)
+			return false;
+
+		token_begin=pos;
+		while (pos<end && !delimiters[(uint8_t) *pos])
+			pos++;
+		token_end=pos;
+		return true;
+	}
+
+	/** count the non-empty lines of a text
+	 *
+	 * @param begin beginning of the text
+	 * @param end end of the text
+	 * @return number of lines
+	 */
+	static index_t count_lines(const char* begin, const char* end);
+
+	/** convert a token to a number like Parser does
+	 *
+	 * @param begin beginning of the token
+	 * @param end end of the token
+	 * @return number, 0 for an empty token
+	 */
+	template <class T>
+	static T parse(const char* begin, const char* end)
+	{
+		return (T) parse_real(begin, end);
+	}
+
+private:
+	/** strtod() on a token */
+	static float64_t parse_real(const char* begin, const char* end);
+	/** strtold() on a token */
+	static floatmax_t parse_long_real(const char* begin, const char* end);
+	/** strtoll() on a token */
+	static int64_t parse_long(const char* begin, const char* end);
+	/** strtoull() on a token */
+	static uint64_t parse_ulong(const char* begin, const char* end);
+
+	/** start of the mapping */
+	void* m_address;
+	/** length of the mapping */
+	size_t m_length;
+	/** beginning of the remaining text, NULL if not mapped */
+	const char* m_begin;
+	/** end of the text */
+	const char* m_end;
+};
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+template <>
+inline floatmax_t MappedTextReader::parse<floatmax_t>(
+	const char* begin, const char* end)
+{
+	return parse_long_real(begin, end);
+}
+
+template <>
+inline int64_t MappedTextReader::parse<int64_t>(
+	const char* begin, const char* end)
+{
+	return parse_long(begin, end);
+}
+
+template <>
+inline uint64_t MappedTextReader::parse<uint64_t>(
+	const char* begin, const char* end)
+{
+	return parse_ulong(begin, end);
+}
+#endif
+}
+#endif /* __MAPPEDTEXTREADER_H__ */
@@ -25,6 +25,17 @@
 
 namespace shogun
 {
+/** expected access pattern of a memory mapped file, see
+ * MemoryMappedFile::advise() */
+enum EMMapAccess
+{
+	MMAP_NORMAL,
+	MMAP_SEQUENTIAL,
+	MMAP_RANDOM,
+	MMAP_WILLNEED,
+	MMAP_DONTNEED
+};
+
 /** @brief memory mapped file
 *
 * Implements a memory mapped file for super fast file access.
@@ -48,10 +59,14 @@ template <class T> class MemoryMappedFile : public SGObject
 
 		/** constructor
 		 *
-		 * open a memory mapped file for read or read/write mode
+		 * open a memory mapped file for read, read/write or copy-on-write
+		 * mode. In copy-on-write mode the map may be modified like in
+		 * read/write mode, but changes are private to the process and
+		 * never written back to the file.
 		 *
 		 * @param fname name of file, zero terminated string
-		 * @param flag determines read or read write mode (can be 'r' or 'w')
+		 * @param flag determines read, read write or copy-on-write mode (can
+		 *   be 'r', 'w' or 'c')
 		 * @param fsize overestimate of expected file size (in bytes)
 		 *   when opened in write  mode; Underestimating the file size will
 		 *   result in an error to occur upon writing. In case the exact file
@@ -62,7 +77,8 @@ template <class T> class MemoryMappedFile : public SGObject
 		MemoryMappedFile(const char* fname, char flag='r', int64_t fsize=0)
 		: SGObject()
 		{
-			require(flag=='w' || flag=='r', "Only 'r' and 'w' flags are allowed");
+			require(flag=='w' || flag=='r' || flag=='c',
+				"Only 'r', 'w' and 'c' flags are allowed");
 
 			last_written_byte=0;
 			rw=flag;
@@ -81,6 +97,11 @@ template <class T> class MemoryMappedFile : public SGObject
 				mmap_prot = PAGE_READWRITE;
 				mmap_flags = FILE_MAP_ALL_ACCESS;
 			}
+			else if (rw=='c')
+			{
+				mmap_prot = PAGE_WRITECOPY;
+				mmap_flags = FILE_MAP_COPY;
+			}
 
 			fd = CreateFile(fname, open_flags, share_mode, 0, create_disp, FILE_ATTRIBUTE_NORMAL, NULL);
 			if (rw=='w' && fsize)
@@ -113,6 +134,8 @@ template <class T> class MemoryMappedFile : public SGObject
 				mmap_prot=PROT_READ|PROT_WRITE;
 				mmap_flags=MAP_SHARED;
 			}
+			else if (rw=='c')
+				mmap_prot=PROT_READ|PROT_WRITE;
 
 			fd = open(fname, open_flags, S_IRWXU | S_IRWXG | S_IRWXO);
 			if (fd == -1)
@@ -267,6 +290,49 @@ template <class T> class MemoryMappedFile : public SGObject
 			last_written_byte=sz;
 		}
 
+		/** hint the OS how a range of the mapping will be accessed, such that
+		 * it can read ahead (MMAP_SEQUENTIAL, MMAP_WILLNEED), avoid useless
+		 * read ahead (MMAP_RANDOM) or drop pages which are no longer needed
+		 * (MMAP_DONTNEED). This is only a hint and does nothing on systems
+		 * without madvise. MMAP_DONTNEED is not allowed for copy on write
+		 * mappings (mode 'c'), as it discards their changes.
+		 *
+		 * @param access expected access pattern
+		 * @param offs index of the first object of type T in the range
+		 * @param len number of objects of type T in the range, zero for the
+		 * rest of the file
+		 */
+		void advise(EMMapAccess access, uint64_t offs=0, uint64_t len=0)
+		{
+			require(access!=MMAP_DONTNEED || rw!='c', "MMAP_DONTNEED would "
+				"discard the changes to the copy on write mapping");
+#ifndef _MSC_VER
+			uint64_t begin=offs*sizeof(T);
+			uint64_t end=len ? begin+len*sizeof(T) : length;
+			if (end>length)
+				end=length;
+			if (begin>=end)
+				return;
+
+			// madvise requires a page aligned address
+			uint64_t page_size=sysconf(_SC_PAGESIZE);
+			begin-=begin%page_size;
+
+			int advice=MADV_NORMAL;
+			switch (access)
+			{
+				case MMAP_NORMAL: advice=MADV_NORMAL; break;
+				case MMAP_SEQUENTIAL: advice=MADV_SEQUENTIAL; break;
+				case MMAP_RANDOM: advice=MADV_RANDOM; break;
+				case MMAP_WILLNEED: advice=MADV_WILLNEED; break;
+				case MMAP_DONTNEED: advice=MADV_DONTNEED; break;
+			}
+
+			if (madvise((char*) address+begin, end-begin, advice) == -1)
+				SG_DEBUG("madvise failed on {} bytes at {}", end-begin, begin)
+#endif
+		}
+
 		/** count the number of lines in a file
 		 *
 		 * @return number of lines
@@ -8,6 +8,7 @@
 #include <shogun/io/ShogunErrc.h>
 #include <shogun/util/converters.h>
 #include <shogun/base/class_list.h>
+#include <shogun/lib/Compressor.h>
 #include <shogun/util/system.h>
 
 #include <bitsery/bitsery.h>
@@ -22,8 +23,65 @@ template<class S>
 class BitseryReaderVisitor: public detail::BitseryVisitor<S, BitseryReaderVisitor<S>>
 {
 public:
-	BitseryReaderVisitor(S& s):
-		detail::BitseryVisitor<S,BitseryReaderVisitor<S>>(s) {}
+	BitseryReaderVisitor(S& s, std::shared_ptr<InputStream> stream, int64_t lazy_threshold):
+		detail::BitseryVisitor<S,BitseryReaderVisitor<S>>(s),
+		m_stream(std::move(stream)), m_lazy_threshold(lazy_threshold) {}
+
+	const std::shared_ptr<InputStream>& stream() const
+	{
+		return m_stream;
+	}
+
+	int64_t lazy_threshold() const
+	{
+		return m_lazy_threshold;
+	}
+
+	/* whether the numeric arrays are preceded by their compression */
+	bool has_compression() const
+	{
+		return m_has_compression;
+	}
+
+	void set_has_compression(bool has_compression)
+	{
+		m_has_compression = has_compression;
+	}
+
+	/* counterpart of BitseryWriterVisitor::on_bulk */
+	bool on_bulk(S& s, void* data, int64_t bytes)
+	{
+		if (utils::is_big_endian())
+			return false;
+
+		if (m_has_compression)
+		{
+			uint8_t compression;
+			s.value1b(compression);
+			require(compression <= SNAPPY,
+				"Unknown compression type {} of array", compression);
+			if (compression != UNCOMPRESSED)
+			{
+				uint64_t compressed_size;
+				s.value8b(compressed_size);
+				std::vector<uint8_t> compressed(compressed_size);
+				read_bytes(compressed.data(), compressed_size);
+
+				uint64_t uncompressed_size = bytes;
+				auto compressor = std::make_shared<Compressor>(
+					static_cast<E_COMPRESSION_TYPE>(compression));
+				compressor->decompress(compressed.data(), compressed_size,
+					static_cast<uint8_t*>(data), uncompressed_size);
+				if (uncompressed_size != uint64_t(bytes))
+					throw io::to_system_error(
+						make_error_condition(ShogunErrc::OutOfRange));
+				return true;
+			}
+		}
+
+		read_bytes(data, bytes);
+		return true;
+	}
 
 	void on_complex(S& s, complex128_t* v)
 	{
@@ -52,7 +110,24 @@ public:
 	void on_object(S& s, std::shared_ptr<SGObject>* v)
 	{
 		SG_DEBUG("reading SGObject: ");
-		*v = object_reader(s, this);
+		// only the elements of object vectors, e.g. sub-machines, are
+		// deferred, since objects use their other members in
+		// load_serializable_post()
+		auto may_defer = m_vector_depth > 0;
+		auto vector_depth = std::exchange(m_vector_depth, 0);
+		*v = object_reader(s, this, nullptr, may_defer);
+		m_vector_depth = vector_depth;
+	}
+
+	void enter_std_vector(size_t* size) override
+	{
+		detail::BitseryVisitor<S, BitseryReaderVisitor<S>>::enter_std_vector(size);
+		++m_vector_depth;
+	}
+
+	void exit_std_vector(size_t* size) override
+	{
+		--m_vector_depth;
 	}
 
 	void on_enter_auto_value(S& s, bool* is_empty)
@@ -75,6 +150,31 @@ public:
 	std::optional<float64_t> m_auto_value;
 
 private:
+	/* reads bytes in chunks to bound the memory of the read buffer */
+	void read_bytes(void* data, int64_t bytes)
+	{
+		auto target = static_cast<char*>(data);
+		for (int64_t offset = 0; offset < bytes; offset += kBulkReadChunkSize)
+		{
+			auto chunk = std::min(bytes - offset, kBulkReadChunkSize);
+			auto ec = m_stream->read(&m_buffer, chunk);
+			// reaching the end of the stream with the last chunk is fine
+			if (int64_t(m_buffer.size()) != chunk)
+				throw io::to_system_error(
+					ec ? ec : make_error_condition(ShogunErrc::OutOfRange));
+			copy_n(m_buffer.data(), chunk, target + offset);
+		}
+		m_buffer = string();
+	}
+
+	static constexpr int64_t kBulkReadChunkSize = 16 * 1024 * 1024;
+
+	std::shared_ptr<InputStream> m_stream;
+	int64_t m_lazy_threshold;
+	bool m_has_compression = false;
+	int32_t m_vector_depth = 0;
+	string m_buffer;
+
 	SG_DELETE_COPY_AND_ASSIGN(BitseryReaderVisitor);
 };
 
@@ -114,14 +214,85 @@ struct InputStreamAdapter
 	error_condition m_status;
 };
 
+static void seek(const std::shared_ptr<InputStream>& stream, int64_t position)
+{
+	stream->reset();
+	if (position > 0)
+		stream->skip(position);
+	if (stream->tell() != position)
+		throw io::to_system_error(make_error_condition(ShogunErrc::OutOfRange));
+}
+
+template<typename Reader>
+void read_parameters(Reader& reader, BitseryReaderVisitor<Reader>* visitor, const std::shared_ptr<SGObject>& obj)
+{
+	pre_deserialize(obj);
+
+	size_t num_params;
+	reader.value8b(num_params);
+	for (size_t i = 0; i < num_params; ++i)
+	{
+		string param_name;
+		reader.text1b(param_name, 64);
+		obj->visit_parameter(BaseTag(param_name), visitor);
+	}
+
+	post_deserialize(obj);
+}
+
+/* skips the parameters of an object and reads them from the stream when
+ * they are first accessed */
 template<typename Reader>
-std::shared_ptr<SGObject> object_reader(Reader& reader, BitseryReaderVisitor<Reader>* visitor, const std::shared_ptr<SGObject>& _this = nullptr)
+void defer_parameters(BitseryReaderVisitor<Reader>* visitor, const std::shared_ptr<SGObject>& obj, int64_t end)
+{
+	auto stream = visitor->stream();
+	auto offset = stream->tell();
+	seek(stream, end);
+
+	auto lazy_threshold = visitor->lazy_threshold();
+	auto has_compression = visitor->has_compression();
+	// the loader is owned by the object, so it must not own the object
+	auto raw = obj.get();
+	obj->set_lazy_loader([stream, offset, lazy_threshold, has_compression, raw]() {
+		SG_DEBUG("reading deferred parameters of {}", raw->get_name());
+		auto position = stream->tell();
+		seek(stream, offset);
+
+		Reader reader {InputStreamAdapter { stream }};
+		BitseryReaderVisitor<Reader> reader_visitor(reader, stream, lazy_threshold);
+		reader_visitor.set_has_compression(has_compression);
+		read_parameters(reader, addressof(reader_visitor), raw->shared_from_this());
+
+		seek(stream, position);
+	});
+}
+
+template<typename Reader>
+std::shared_ptr<SGObject> object_reader(Reader& reader, BitseryReaderVisitor<Reader>* visitor,
+	const std::shared_ptr<SGObject>& _this = nullptr, bool may_defer = false)
 {
 	size_t obj_magic;
 	reader.value8b(obj_magic);
+	// only written before the root object
+	if (obj_magic == detail::kCompressedArraysMagic)
+	{
+		uint8_t compression;
+		reader.value1b(compression);
+		visitor->set_has_compression(true);
+		reader.value8b(obj_magic);
+	}
 	if (obj_magic == detail::kNullObjectMagic)
 		return nullptr;
 
+	// objects written by older versions have no size and cannot be skipped
+	uint64_t obj_size = 0;
+	int64_t obj_end = -1;
+	if (obj_magic == detail::kIndexedObjectMagic)
+	{
+		reader.value8b(obj_size);
+		obj_end = visitor->stream()->tell() + obj_size;
+	}
+
 	string obj_name;
 	reader.text1b(obj_name, 64);
 	uint16_t primitive_type;
@@ -140,20 +311,16 @@ std::shared_ptr<SGObject> object_reader(Reader& reader, BitseryReaderVisitor<Rea
 	if (obj == nullptr)
 		throw runtime_error("Trying to deserializer and unknown object!");
 
-	try
+	if (may_defer && obj_end >= 0 && visitor->lazy_threshold() > 0 &&
+		obj_size >= uint64_t(visitor->lazy_threshold()))
 	{
-		pre_deserialize(obj);
-
-		size_t num_params;
-		reader.value8b(num_params);
-		for (size_t i = 0; i < num_params; ++i)
-		{
-			string param_name;
-			reader.text1b(param_name, 64);
-			obj->visit_parameter(BaseTag(param_name), visitor);
-		}
+		defer_parameters(visitor, obj, obj_end);
+		return obj;
+	}
 
-		post_deserialize(obj);
+	try
+	{
+		read_parameters(reader, visitor, obj);
 	}
 	catch(ShogunException& e)
 	{
@@ -176,11 +343,22 @@ BitseryDeserializer::~BitseryDeserializer()
 {
 }
 
+void BitseryDeserializer::set_lazy_threshold(int64_t bytes)
+{
+	require(bytes >= 0, "Lazy threshold ({}) must not be negative", bytes);
+	m_lazy_threshold = bytes;
+}
+
+int64_t BitseryDeserializer::get_lazy_threshold() const
+{
+	return m_lazy_threshold;
+}
+
 std::shared_ptr<SGObject> BitseryDeserializer::read_object()
 {
 	InputStreamAdapter adapter { stream() };
 	BitseryDeser deser {std::move(adapter)};
-	BitseryReaderVisitor<BitseryDeser> reader_visitor(deser);
+	BitseryReaderVisitor<BitseryDeser> reader_visitor(deser, stream(), m_lazy_threshold);
 	return object_reader(deser, addressof(reader_visitor));
 }
 
@@ -188,6 +366,6 @@ void BitseryDeserializer::read(std::shared_ptr<SGObject> _this)
 {
 	InputStreamAdapter adapter { stream() };
 	BitseryDeser deser {std::move(adapter)};
-	BitseryReaderVisitor<BitseryDeser> reader_visitor(deser);
+	BitseryReaderVisitor<BitseryDeser> reader_visitor(deser, stream(), m_lazy_threshold);
 	object_reader(deser, addressof(reader_visitor), _this);
 }
@@ -19,10 +19,30 @@ namespace shogun
 			std::shared_ptr<SGObject> read_object() override;
 			void read(std::shared_ptr<SGObject> _this) override;
 
+			/** Defers reading the objects in object vectors, for example
+			 * the sub-machines of an ensemble or of a multiclass machine,
+			 * whose serialized size is at least the given number of bytes.
+			 * Their parameters are read from the stream on their first
+			 * access, see SGObject::materialize(), so the stream has to
+			 * stay open and support reset() and skip() until then.
+			 * Only files written with the size of each object can be read
+			 * lazily, older files are read eagerly.
+			 *
+			 * @param bytes minimum size of deferred objects, 0 (the
+			 * default) reads all objects eagerly
+			 */
+			void set_lazy_threshold(int64_t bytes);
+
+			/** @return minimum size of deferred objects in bytes */
+			int64_t get_lazy_threshold() const;
+
 			const char* get_name() const override
 			{
 				return "BitseryDeserializer";
 			}
+
+		private:
+			int64_t m_lazy_threshold = 0;
 		};
 	}
 }
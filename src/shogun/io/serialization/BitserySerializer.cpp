@@ -6,23 +6,185 @@
 #include <shogun/io/serialization/BitserySerializer.h>
 #include <shogun/io/serialization/BitseryVisitor.h>
 #include <shogun/io/ShogunErrc.h>
+#include <shogun/lib/SGVector.h>
 #include <shogun/util/converters.h>
 #include <shogun/util/system.h>
 
 #include <bitsery/bitsery.h>
 #include <bitsery/traits/string.h>
 
+#include <unordered_set>
+
 using namespace bitsery;
 using namespace shogun;
 using namespace shogun::io;
 using namespace std;
 
+#define IGNORE_IN_CLASSLIST
+/* stream that only counts the bytes written to it */
+IGNORE_IN_CLASSLIST class ByteCountingOutputStream : public OutputStream
+{
+public:
+	ByteCountingOutputStream() : OutputStream() {}
+
+	error_condition close() override { return {}; }
+	error_condition flush() override { return {}; }
+
+	error_condition write(const void* buffer, int64_t size) override
+	{
+		m_bytes += size;
+		return {};
+	}
+
+	void skip(uint64_t bytes)
+	{
+		m_bytes += bytes;
+	}
+
+	uint64_t bytes() const
+	{
+		return m_bytes;
+	}
+
+	const char* get_name() const override
+	{
+		return "ByteCountingOutputStream";
+	}
+
+private:
+	uint64_t m_bytes = 0;
+};
+
+struct OutputStreamAdapter
+{
+	typedef void TValue;
+
+	void write(const TValue* buffer, size_t bytes)
+	{
+		auto ec = m_stream->write(buffer, bytes);
+		if(ec)
+			throw io::to_system_error(ec);
+		written_bytes += bytes;
+	}
+
+	void flush()
+	{
+		m_stream->flush();
+	}
+
+	size_t writtenBytesCount() const
+	{
+		return written_bytes;
+	}
+
+	shared_ptr<OutputStream> m_stream;
+	size_t written_bytes = 0;
+};
+
+/* state shared by the visitors of a write: the sizes of the serialized
+ * objects, the objects whose save_serializable_pre() ran but which are not
+ * written yet, and the arrays compressed by the counting pass that the
+ * writing pass still has to write */
+struct WriteState
+{
+	unordered_map<const SGObject*, uint64_t> sizes;
+	unordered_set<const SGObject*> prepared;
+	unordered_map<const void*, pair<int64_t, SGVector<uint8_t>>> compressed;
+};
+
+template<class Writer>
+class BitseryWriterVisitor;
+
+template<typename Writer>
+void write_object_body(Writer& writer, BitseryWriterVisitor<Writer>* visitor, const shared_ptr<SGObject>& o) noexcept(false);
+
 template<class Writer>
 class BitseryWriterVisitor : public detail::BitseryVisitor<Writer, BitseryWriterVisitor<Writer>>
 {
 public:
-	BitseryWriterVisitor(Writer& w):
-		detail::BitseryVisitor<Writer,BitseryWriterVisitor<Writer>>(w) {}
+	BitseryWriterVisitor(Writer& w, shared_ptr<OutputStream> stream,
+		E_COMPRESSION_TYPE compression, int32_t level,
+		shared_ptr<WriteState> state = make_shared<WriteState>()):
+		detail::BitseryVisitor<Writer,BitseryWriterVisitor<Writer>>(w),
+		m_stream(std::move(stream)), m_state(std::move(state)),
+		m_counter(dynamic_pointer_cast<ByteCountingOutputStream>(m_stream)),
+		m_compression(compression), m_level(level)
+	{
+		if (m_compression != UNCOMPRESSED)
+			m_compressor = make_shared<Compressor>(m_compression);
+	}
+
+	/* size of the serialized object, which is written before the object so
+	 * readers can skip it. Each object is written once more to a counting
+	 * stream to measure it, where the objects it refers to are skipped with
+	 * their size */
+	uint64_t object_size(const shared_ptr<SGObject>& o)
+	{
+		auto it = m_state->sizes.find(o.get());
+		if (it != m_state->sizes.end())
+			return it->second;
+
+		auto counter = make_shared<ByteCountingOutputStream>();
+		Writer counting_writer {OutputStreamAdapter { counter }};
+		BitseryWriterVisitor<Writer> counting_visitor(
+			counting_writer, counter, m_compression, m_level, m_state);
+		write_object_body(counting_writer, addressof(counting_visitor), o);
+
+		m_state->sizes.emplace(o.get(), counter->bytes());
+		return counter->bytes();
+	}
+
+	/* runs save_serializable_pre() of the object once for the counting
+	 * and the writing pass */
+	void prepare(const shared_ptr<SGObject>& o)
+	{
+		if (m_state->prepared.insert(o.get()).second)
+			pre_serialize(o);
+	}
+
+	/* runs save_serializable_post() once the object is written */
+	void finish(const shared_ptr<SGObject>& o)
+	{
+		m_state->prepared.erase(o.get());
+		post_serialize(o);
+	}
+
+	/* whether this visitor only measures objects */
+	bool is_counting() const
+	{
+		return m_counter != nullptr;
+	}
+
+	void skip(uint64_t bytes)
+	{
+		m_counter->skip(bytes);
+	}
+
+	/* Bitsery writes numbers little endian and unbuffered to the stream,
+	 * so on little endian machines an array of numbers can be written
+	 * with a single write of its memory. With compression, each array is
+	 * preceded by its compression type and, if compressed, its size */
+	bool on_bulk(Writer& writer, void* data, int64_t bytes)
+	{
+		if (utils::is_big_endian())
+			return false;
+
+		if (m_compressor)
+		{
+			auto compressed = compress(data, bytes);
+			if (compressed.vlen > 0)
+			{
+				writer.value1b(static_cast<uint8_t>(m_compression));
+				writer.value8b(static_cast<uint64_t>(compressed.vlen));
+				write_bytes(compressed.vector, compressed.vlen);
+				return true;
+			}
+			writer.value1b(static_cast<uint8_t>(UNCOMPRESSED));
+		}
+
+		write_bytes(data, bytes);
+		return true;
+	}
 
 	void on_complex(Writer& writer, complex128_t* v)
 	{
@@ -74,40 +236,76 @@ public:
 	}
 
 	std::optional<float64_t> m_auto_value;
-};
-
-struct OutputStreamAdapter
-{
-	typedef void TValue;
 
-	void write(const TValue* buffer, size_t bytes)
+private:
+	/* compressed array, or an empty vector if the array is stored
+	 * uncompressed. The counting pass keeps the result for the writing
+	 * pass, so each array is compressed once */
+	SGVector<uint8_t> compress(void* data, int64_t bytes)
 	{
-		auto ec = m_stream->write(buffer, bytes);
-		if(ec)
-			throw io::to_system_error(ec);
-		written_bytes += bytes;
-	}
+		auto& cache = m_state->compressed;
+		auto it = cache.find(data);
+		if (it != cache.end() && it->second.first == bytes)
+		{
+			auto compressed = it->second.second;
+			if (!is_counting())
+				cache.erase(it);
+			return compressed;
+		}
 
-	void flush()
-	{
-		m_stream->flush();
+		SGVector<uint8_t> compressed;
+		if (bytes >= detail::kMinCompressedArraySize)
+		{
+			uint8_t* buffer = nullptr;
+			uint64_t size = 0;
+			m_compressor->compress(
+				static_cast<uint8_t*>(data), bytes, buffer, size, m_level);
+			if (buffer && size < uint64_t(bytes))
+				compressed = SGVector<uint8_t>(buffer, size);
+			else
+				SG_FREE(buffer);
+		}
+
+		if (is_counting())
+			cache[data] = make_pair(bytes, compressed);
+		return compressed;
 	}
 
-	size_t writtenBytesCount() const
+	void write_bytes(const void* data, int64_t bytes)
 	{
-		return written_bytes;
+		auto ec = m_stream->write(data, bytes);
+		if (ec)
+			throw io::to_system_error(ec);
 	}
 
 	shared_ptr<OutputStream> m_stream;
-	size_t written_bytes = 0;
+	shared_ptr<WriteState> m_state;
+	shared_ptr<ByteCountingOutputStream> m_counter;
+	E_COMPRESSION_TYPE m_compression;
+	int32_t m_level;
+	shared_ptr<Compressor> m_compressor;
 };
 
 // cannot use context because of circular dependency :(
 template<typename Writer>
 void write_object(Writer& writer, BitseryWriterVisitor<Writer>* visitor, const shared_ptr<SGObject>& o) noexcept(false)
 {
-	pre_serialize(o);
-	writer.value8b(sizeof(o.get()));
+	visitor->prepare(o);
+	writer.value8b(detail::kIndexedObjectMagic);
+	auto size = visitor->object_size(o);
+	writer.value8b(size);
+	if (visitor->is_counting())
+		visitor->skip(size);
+	else
+	{
+		write_object_body(writer, visitor, o);
+		visitor->finish(o);
+	}
+}
+
+template<typename Writer>
+void write_object_body(Writer& writer, BitseryWriterVisitor<Writer>* visitor, const shared_ptr<SGObject>& o) noexcept(false)
+{
 	string name(o->get_name());
 	writer.text1b(name, 64);
 	writer.value2b(static_cast<uint16_t>(o->get_generic()));
@@ -125,7 +323,6 @@ void write_object(Writer& writer, BitseryWriterVisitor<Writer>* visitor, const s
 		writer.text1b(p.first, 64);
 		p.second->get_value().visit(visitor);
 	}
-	post_serialize(o);
 }
 
 using OutputAdapter = AdapterWriter<OutputStreamAdapter, bitsery::DefaultConfig>;
@@ -143,6 +340,26 @@ void BitserySerializer::write(const shared_ptr<SGObject>& object) noexcept(false
 {
 	OutputStreamAdapter adapter { stream() };
  	BitserySer serializer {std::move(adapter)};
- 	BitseryWriterVisitor<BitserySer> writer_visitor(serializer);
+	if (m_compression != UNCOMPRESSED)
+	{
+		serializer.value8b(detail::kCompressedArraysMagic);
+		serializer.value1b(static_cast<uint8_t>(m_compression));
+	}
+ 	BitseryWriterVisitor<BitserySer> writer_visitor(
+		serializer, stream(), m_compression, m_level);
  	write_object(serializer, addressof(writer_visitor), object);
 }
+
+void BitserySerializer::set_compression(
+	E_COMPRESSION_TYPE compression, int32_t level)
+{
+	require(level >= 1 && level <= 9,
+		"Compression level ({}) must be between 1 and 9", level);
+	m_compression = compression;
+	m_level = level;
+}
+
+E_COMPRESSION_TYPE BitserySerializer::get_compression() const
+{
+	return m_compression;
+}
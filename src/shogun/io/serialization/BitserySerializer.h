@@ -6,6 +6,7 @@
 #define __BITSERY_SERIALIZER_H__
 
 #include <shogun/io/serialization/Serializer.h>
+#include <shogun/lib/Compressor.h>
 
 namespace shogun
 {
@@ -18,10 +19,30 @@ namespace shogun
 			~BitserySerializer() override;
 			void write(const std::shared_ptr<SGObject>& object) override;
 
+			/** Compresses the numeric arrays of the written objects, e.g.
+			 * feature matrices or weight vectors. Each array is stored
+			 * compressed if it is large enough and compression makes it
+			 * smaller, otherwise as is. Files written with compression
+			 * can only be read by versions that support it.
+			 *
+			 * @param compression compression type, UNCOMPRESSED (the
+			 * default) writes the arrays as is
+			 * @param level compression level between 1 and 9
+			 */
+			void set_compression(
+				E_COMPRESSION_TYPE compression, int32_t level = 1);
+
+			/** @return compression type of the numeric arrays */
+			E_COMPRESSION_TYPE get_compression() const;
+
 			const char* get_name() const override
 			{
 				return "BitserySerializer";
 			}
+
+		private:
+			E_COMPRESSION_TYPE m_compression = UNCOMPRESSED;
+			int32_t m_level = 1;
 		};
 	}
 }
@@ -15,6 +15,15 @@ namespace shogun
 		namespace detail
 		{
 			static const size_t kNullObjectMagic = std::numeric_limits<size_t>::max();
+			/** marks an object that is preceded by its size in bytes, which
+			 * lets readers skip it. Older versions wrote sizeof(SGObject*)
+			 * instead and no size */
+			static const size_t kIndexedObjectMagic = std::numeric_limits<size_t>::max() - 1;
+			/** precedes the root object of files whose numeric arrays may
+			 * be compressed, followed by the compression type */
+			static const size_t kCompressedArraysMagic = std::numeric_limits<size_t>::max() - 2;
+			/** numeric arrays smaller than this are never compressed */
+			static const int64_t kMinCompressedArraySize = 4096;
 
 			template <class S, class T>
 			class BitseryVisitor : public AnyVisitor
@@ -118,6 +127,10 @@ namespace shogun
 				void enter_map(size_t* size) override
 				{
 				}
+				bool on_contiguous(void* data, int64_t bytes) override
+				{
+					return static_cast<T*>(this)->on_bulk(m_s, data, bytes);
+				}
 
 				void on(std::shared_ptr<SGObject>* v) override
 				{
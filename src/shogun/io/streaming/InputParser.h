@@ -14,12 +14,18 @@
 #include <shogun/io/SGIO.h>
 #include <shogun/io/streaming/StreamingFile.h>
 #include <shogun/io/streaming/ParseBuffer.h>
+#include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 #define PARSER_DEFAULT_BUFFSIZE 100
+/// Number of lines a worker of the parser pool parses at once
+#define PARSER_DEFAULT_CHUNK_LINES 256
 
 namespace shogun
 {
@@ -58,7 +64,8 @@ namespace shogun
  * function which starts a new thread for continuous parsing of examples.
  *
  * Parsing is done through the ParseBuffer object, which in its
- * current implementation is a ring of a specified number of examples.
+ * current implementation is a lock-free ring of a specified number of
+ * examples, handed from the parse thread to the reader in batches.
  * It is the task of the InputParser object to ensure that this ring
  * is being updated with new parsed examples.
  *
@@ -71,6 +78,13 @@ namespace shogun
  * The parsing thread should be joined with a call to end_parser().
  * exit_parser() may be used to cancel the parse thread if needed.
  *
+ * If the StreamingFile can be split into lines (see
+ * StreamingFile::create_chunk_reader()), set_num_parse_threads() enables a
+ * pool of parse threads: the parse thread then only reads chunks of raw
+ * lines, which the workers parse concurrently. The parsed chunks are
+ * handed to the ring in the order of the input, or, if ordering is
+ * disabled, as soon as they are parsed.
+ *
  * Options are provided for automatic SG_FREEing of example objects
  * after each finalize_example() and also on InputParser destruction.
  * They are set through the set_free_vector* functions.
@@ -105,8 +119,12 @@ public:
      * @param input_file StreamingFile object
      * @param is_labelled Whether example is labelled or not (bool), optional
      * @param size Size of the buffer in number of examples
+     * @param batch_size Number of examples handed from the parse thread
+     * to the reader at once
      */
-    void init(std::shared_ptr<StreamingFile> input_file, bool is_labelled = true, int32_t size = PARSER_DEFAULT_BUFFSIZE);
+    void init(std::shared_ptr<StreamingFile> input_file, bool is_labelled = true,
+        int32_t size = PARSER_DEFAULT_BUFFSIZE,
+        int32_t batch_size = PARSE_BUFFER_DEFAULT_BATCH_SIZE);
 
     /**
      * Test if parser is running.
@@ -192,6 +210,18 @@ public:
      */
     void set_free_vectors_on_destruct(bool destroy);
 
+    /**
+     * Sets the number of threads parsing the input. With more than one
+     * thread, chunks of lines are parsed concurrently if the input
+     * supports it, otherwise the input is parsed by a single thread.
+     * Has to be called before start_parser().
+     *
+     * @param num_threads number of parse threads, 1 by default
+     * @param ordered whether examples are returned in the order of
+     * the input, true by default
+     */
+    void set_num_parse_threads(int32_t num_threads, bool ordered = true);
+
     /**
      * Starts the parser, creating a new thread.
      *
@@ -211,17 +241,17 @@ public:
 
 
     /**
-     * Copy example into the buffer.
+     * Move example into the buffer, the vector is not copied.
      *
-     * @param ex Example to be copied.
+     * @param ex Example to be moved.
      */
     void copy_example_into_buffer(Example<T>* ex);
 
     /**
-     * Retrieves the next example from the buffer.
+     * Retrieves the next example from the buffer if one is ready.
      *
      *
-     * @return The example pointer.
+     * @return The example pointer or NULL.
      */
     Example<T>* retrieve_example();
 
@@ -279,6 +309,27 @@ public:
     int32_t get_ring_size() { return ring_size; }
 
 private:
+    /// Chunk of lines parsed by a worker of the parser pool
+    struct ParseJob
+    {
+        /// Reader parsing the chunk
+        std::shared_ptr<StreamingFile> reader;
+        /// Raw lines
+        std::vector<char> text;
+        /// Parsed examples, whose vectors are swapped with the ring
+        std::vector<Example<T>> examples;
+        /// Number of lines in text
+        int32_t num_lines;
+        /// Number of parsed examples
+        int32_t num_examples;
+        /// Whether a line could not be parsed, which ends the input
+        bool stopped;
+        /// Position of the chunk in the input
+        int64_t index;
+        /// Number of examples written to the ring up to this chunk
+        int64_t last_example;
+    };
+
     /**
      * Entry point for the parse thread.
      *
@@ -288,6 +339,36 @@ private:
      */
     static void* parse_loop_entry_point(void* params);
 
+    /** Parse loop of the parser pool, reads the chunks of lines */
+    void pool_parse_loop();
+
+    /** Loop of a worker of the parser pool */
+    void pool_worker_loop();
+
+    /** Get a job for the next chunk, waiting if too many are in flight
+     *
+     * @return job or nullptr if parsing was stopped
+     */
+    std::shared_ptr<ParseJob> acquire_job();
+
+    /** Parse the lines of a job
+     *
+     * @param job job
+     */
+    void parse_job(ParseJob& job);
+
+    /** Hand a parsed job to the ring, in order if required
+     *
+     * @param job job
+     */
+    void write_parsed_job(const std::shared_ptr<ParseJob>& job);
+
+    /** Write the examples of a job to the ring, must hold pool_write_lock
+     *
+     * @param job job
+     */
+    void write_job(const std::shared_ptr<ParseJob>& job);
+
 public:
     bool parsing_done;	/**< true if all input is parsed */
     bool reading_done;	/**< true if all examples are fetched */
@@ -347,15 +428,54 @@ protected:
     /// Size of the ring of examples
     int32_t ring_size;
 
-    /// Mutex which is used when getting/setting state of examples (whether a new example is ready)
+    /// Mutex which is used when getting/setting the parsing_done and reading_done flags
 	std::mutex examples_state_lock;
 
-    /// Condition variable to indicate change of state of examples
-	std::condition_variable examples_state_changed;
-
 	/// Flag that indicate that the parsing thread should continue reading
 	alignas(CPU_CACHE_LINE_SIZE) std::atomic_bool keep_running;
 
+    /// Number of threads parsing the input
+    int32_t num_parse_threads;
+
+    /// Whether the parser pool keeps the order of the input
+    bool ordered_parsing;
+
+    /// Lock on the job queues of the parser pool
+    std::mutex pool_lock;
+
+    /// Signalled when jobs are queued, retired or parsing ends
+    std::condition_variable pool_changed;
+
+    /// Lock held while writing jobs to the ring
+    std::mutex pool_write_lock;
+
+    /// Chunks waiting to be parsed
+    std::deque<std::shared_ptr<ParseJob>> pending_jobs;
+
+    /// Parsed chunks waiting for their predecessors in ordered mode
+    std::map<int64_t, std::shared_ptr<ParseJob>> parsed_jobs;
+
+    /// Written chunks whose examples may still be in use by the reader
+    std::deque<std::shared_ptr<ParseJob>> retired_jobs;
+
+    /// Chunks which can be reused
+    std::vector<std::shared_ptr<ParseJob>> free_jobs;
+
+    /// Number of chunks read but not yet written to the ring
+    int32_t num_jobs_in_flight;
+
+    /// Index of the next chunk to write in ordered mode
+    int64_t next_job_to_write;
+
+    /// Number of examples written to the ring by the pool
+    int64_t num_examples_written;
+
+    /// Whether all chunks have been read
+    bool input_done;
+
+    /// Whether the pool stopped handing examples to the ring
+    std::atomic_bool pool_stopped;
+
 };
 
 template <class T>
@@ -379,6 +499,8 @@ template <class T>
 	parsing_done=true;
 	reading_done=true;
 	keep_running.store(false, std::memory_order_release);
+	num_parse_threads=1;
+	ordered_parsing=true;
 }
 
 template <class T>
@@ -387,11 +509,11 @@ template <class T>
 }
 
 template <class T>
-    void InputParser<T>::init(std::shared_ptr<StreamingFile> input_file, bool is_labelled, int32_t size)
+    void InputParser<T>::init(std::shared_ptr<StreamingFile> input_file, bool is_labelled, int32_t size, int32_t batch_size)
 {
     input_source = input_file;
     example_type = is_labelled ? E_LABELLED : E_UNLABELLED;
-    examples_ring = std::make_shared<ParseBuffer<T>>(size);
+    examples_ring = std::make_shared<ParseBuffer<T>>(size, batch_size);
 
     parsing_done = false;
     reading_done = false;
@@ -418,6 +540,18 @@ template <class T>
 	examples_ring->set_free_vectors_on_destruct(destroy);
 }
 
+template <class T>
+    void InputParser<T>::set_num_parse_threads(int32_t num_threads, bool ordered)
+{
+    require(num_threads>0, "Number of parse threads ({}) must be positive",
+        num_threads);
+    require(!keep_running.load(std::memory_order_acquire),
+        "Number of parse threads cannot be changed while parsing");
+
+    num_parse_threads=num_threads;
+    ordered_parsing=ordered;
+}
+
 template <class T>
     void InputParser<T>::start_parser()
 {
@@ -497,27 +631,28 @@ template <class T>
 template <class T>
     void InputParser<T>::copy_example_into_buffer(Example<T>* ex)
 {
-    examples_ring->copy_example(ex);
+    examples_ring->write_example(ex);
 }
 
 template <class T> void* InputParser<T>::main_parse_loop(void* params)
 {
-    // Read the examples into current_* objects
-    // Instead of allocating mem for new objects each time
+    // Read the examples directly into the ring, reusing the
+    // memory of the vectors that were stored there before
     InputParser* this_obj = (InputParser *) params;
     this->input_source = this_obj->input_source;
 
+    if (num_parse_threads > 1 && input_source->create_chunk_reader())
+    {
+        pool_parse_loop();
+        return NULL;
+    }
+
     while (keep_running.load(std::memory_order_acquire))
 	{
-		std::unique_lock<std::mutex> lock(examples_state_lock);
-
-		if (parsing_done)
-		{
-			return NULL;
-		}
-		lock.unlock();
-
 		current_example = examples_ring->get_free_example();
+		if (!current_example)
+			break;
+
 		current_feature_vector = current_example->fv;
 		current_len = current_example->length;
 		current_label = current_example->label;
@@ -528,93 +663,272 @@ template <class T> void* InputParser<T>::main_parse_loop(void* params)
 			get_vector_only(current_feature_vector,	current_len);
 
 		if (current_len < 0)
-		{
-			lock.lock();
-			parsing_done = true;
-			examples_state_changed.notify_one();
-			return NULL;
-		}
+			break;
 
 		current_example->label = current_label;
 		current_example->fv = current_feature_vector;
 		current_example->length = current_len;
 
-		examples_ring->copy_example(current_example);
-		lock.lock();
+		examples_ring->commit_example();
 		number_of_vectors_parsed++;
-		examples_state_changed.notify_one();
 	}
+
+	// hands over the last batch and wakes up the reader
+	examples_ring->finish();
+	std::lock_guard<std::mutex> lock(examples_state_lock);
+	parsing_done = true;
     return NULL;
 }
 
-template <class T> Example<T>* InputParser<T>::retrieve_example()
+template <class T> void InputParser<T>::pool_parse_loop()
 {
-    /* This function should be guarded by mutexes while calling  */
-    Example<T> *ex;
+    pending_jobs.clear();
+    parsed_jobs.clear();
+    retired_jobs.clear();
+    free_jobs.clear();
+    num_jobs_in_flight = 0;
+    next_job_to_write = 0;
+    num_examples_written = 0;
+    input_done = false;
+    pool_stopped.store(false, std::memory_order_release);
+
+    // the chunk readers do not touch the locale, setlocale() is not
+    // thread-safe
+    SG_SET_LOCALE_C;
+    std::vector<std::thread> workers;
+    for (int32_t i = 0; i < num_parse_threads; i++)
+        workers.emplace_back(&InputParser<T>::pool_worker_loop, this);
+
+    for (int64_t index = 0; ; index++)
+    {
+        auto job = acquire_job();
+        if (!job)
+            break;
 
-    if (parsing_done)
+        job->num_lines = input_source->read_lines(job->text,
+            PARSER_DEFAULT_CHUNK_LINES);
+        job->num_examples = 0;
+        job->stopped = false;
+        job->index = index;
+
+        std::unique_lock<std::mutex> lock(pool_lock);
+        pending_jobs.push_back(job);
+        lock.unlock();
+        pool_changed.notify_all();
+
+        if (job->num_lines < PARSER_DEFAULT_CHUNK_LINES)
+            break;
+    }
+
+    std::unique_lock<std::mutex> lock(pool_lock);
+    input_done = true;
+    lock.unlock();
+    pool_changed.notify_all();
+
+    for (auto& worker : workers)
+        worker.join();
+    SG_RESET_LOCALE;
+
+    // free the vectors which were not swapped into the ring
+    free_jobs.insert(free_jobs.end(), retired_jobs.begin(), retired_jobs.end());
+    if (examples_ring->get_free_vectors_on_destruct())
     {
-        if (number_of_vectors_read == number_of_vectors_parsed)
+        for (const auto& job : free_jobs)
         {
-            reading_done = true;
-            /* Signal to waiting threads that no more examples are left */
-			examples_state_changed.notify_one();
-            return NULL;
+            for (auto& ex : job->examples)
+                SG_FREE(ex.fv);
         }
     }
+    free_jobs.clear();
+    retired_jobs.clear();
 
-    if (number_of_vectors_parsed <= 0)
-        return NULL;
+    // hands over the last batch and wakes up the reader
+    examples_ring->finish();
+    std::lock_guard<std::mutex> state_lock(examples_state_lock);
+    parsing_done = true;
+}
 
-    if (number_of_vectors_read == number_of_vectors_parsed)
+template <class T> void InputParser<T>::pool_worker_loop()
+{
+    while (true)
     {
-        return NULL;
+        std::unique_lock<std::mutex> lock(pool_lock);
+        pool_changed.wait(lock, [this]() {
+            return !pending_jobs.empty() || input_done; });
+        if (pending_jobs.empty())
+            return;
+
+        auto job = pending_jobs.front();
+        pending_jobs.pop_front();
+        lock.unlock();
+
+        if (job->num_lines > 0 && !pool_stopped.load(std::memory_order_acquire))
+            parse_job(*job);
+        write_parsed_job(job);
     }
+}
 
-    ex = examples_ring->get_unused_example();
-    number_of_vectors_read++;
+template <class T>
+    std::shared_ptr<typename InputParser<T>::ParseJob> InputParser<T>::acquire_job()
+{
+    std::unique_lock<std::mutex> lock(pool_lock);
+    pool_changed.wait(lock, [this]() {
+        return num_jobs_in_flight < 2 * num_parse_threads ||
+            pool_stopped.load(std::memory_order_acquire); });
+    if (pool_stopped.load(std::memory_order_acquire) ||
+        !keep_running.load(std::memory_order_acquire))
+        return nullptr;
+
+    // chunks whose examples the reader has released can be reused
+    const int64_t num_released = examples_ring->get_num_released();
+    while (!retired_jobs.empty() &&
+        retired_jobs.front()->last_example <= num_released)
+    {
+        free_jobs.push_back(retired_jobs.front());
+        retired_jobs.pop_front();
+    }
 
-    return ex;
+    std::shared_ptr<ParseJob> job;
+    if (free_jobs.empty())
+    {
+        job = std::make_shared<ParseJob>();
+        job->reader = input_source->create_chunk_reader();
+    }
+    else
+    {
+        job = free_jobs.back();
+        free_jobs.pop_back();
+    }
+    num_jobs_in_flight++;
+
+    return job;
 }
 
-template <class T> int32_t InputParser<T>::get_next_example(T* &fv,
-        int32_t &length, float64_t &label)
+template <class T> void InputParser<T>::parse_job(ParseJob& job)
 {
-    /* if reading is done, no more examples can be fetched. return 0
-       else, if example can be read, get the example and return 1.
-       otherwise, wait for further parsing, get the example and
-       return 1 */
-
-    Example<T> *ex;
+    job.reader->set_chunk(job.text.data(), job.text.size());
+    if (job.examples.size() < (size_t) job.num_lines)
+        job.examples.resize(job.num_lines, Example<T>{0, NULL, 0});
 
-    while (keep_running.load(std::memory_order_acquire))
+    job.num_examples = 0;
+    job.stopped = false;
+    for (int32_t i = 0; i < job.num_lines; i++)
     {
-        if (reading_done)
-            return 0;
+        Example<T>& ex = job.examples[i];
+        T* feature_vector = ex.fv;
+        int32_t length = ex.length;
+        float64_t label = ex.label;
 
-		std::unique_lock<std::mutex> lock(examples_state_lock);
-        ex = retrieve_example();
+        if (example_type == E_LABELLED)
+            (job.reader.get()->*read_vector_and_label)(feature_vector, length, label);
+        else
+            (job.reader.get()->*read_vector)(feature_vector, length);
 
-        if (ex == NULL)
+        if (length < 0)
         {
-            if (reading_done)
-            {
-                /* No more examples left, return */
-                return 0;
-            }
-            else
-            {
-                /* Examples left, wait for one to become ready */
-				examples_state_changed.wait(lock);
-                continue;
-            }
+            job.stopped = true;
+            break;
         }
-        else
+
+        ex.fv = feature_vector;
+        ex.length = length;
+        ex.label = label;
+        job.num_examples++;
+    }
+}
+
+template <class T>
+    void InputParser<T>::write_parsed_job(const std::shared_ptr<ParseJob>& job)
+{
+    std::lock_guard<std::mutex> write_lk(pool_write_lock);
+    if (!ordered_parsing)
+    {
+        write_job(job);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(pool_lock);
+    parsed_jobs[job->index] = job;
+    // write all chunks which are next in order, the one that
+    // completes the sequence may have been parsed by another worker
+    for (auto it = parsed_jobs.find(next_job_to_write); it != parsed_jobs.end();
+        it = parsed_jobs.find(next_job_to_write))
+    {
+        auto next = it->second;
+        parsed_jobs.erase(it);
+        lock.unlock();
+        write_job(next);
+        next_job_to_write++;
+        lock.lock();
+    }
+}
+
+template <class T>
+    void InputParser<T>::write_job(const std::shared_ptr<ParseJob>& job)
+{
+    for (int32_t i = 0; i < job->num_examples &&
+        !pool_stopped.load(std::memory_order_acquire); i++)
+    {
+        Example<T>* ex = examples_ring->get_free_example();
+        if (!ex)
         {
-            /* Example ready, return the example */
+            pool_stopped.store(true, std::memory_order_release);
             break;
         }
+
+        // the parsed vector moves into the ring, the ring's old vector
+        // is reused for parsing the next chunk
+        Example<T>& parsed = job->examples[i];
+        std::swap(ex->fv, parsed.fv);
+        std::swap(ex->length, parsed.length);
+        ex->label = parsed.label;
+        if (!parsed.fv)
+            parsed.length = 0;
+
+        examples_ring->commit_example();
+        num_examples_written++;
+        number_of_vectors_parsed++;
+    }
+    if (job->stopped)
+        pool_stopped.store(true, std::memory_order_release);
+    examples_ring->flush();
+
+    std::unique_lock<std::mutex> lock(pool_lock);
+    job->last_example = num_examples_written;
+    retired_jobs.push_back(job);
+    num_jobs_in_flight--;
+    lock.unlock();
+    pool_changed.notify_all();
+}
+
+template <class T> Example<T>* InputParser<T>::retrieve_example()
+{
+    Example<T> *ex = examples_ring->get_unused_example();
+    if (ex)
+        number_of_vectors_read++;
+
+    return ex;
+}
+
+template <class T> int32_t InputParser<T>::get_next_example(T* &fv,
+        int32_t &length, float64_t &label)
+{
+    /* if reading is done, no more examples can be fetched. return 0
+       else, wait until the parser has handed over an example, get
+       the example and return 1. */
+
+    if (reading_done || !keep_running.load(std::memory_order_acquire))
+        return 0;
+
+    Example<T> *ex = examples_ring->get_next_example();
+    if (ex == NULL)
+    {
+        /* No more examples left, return */
+        std::lock_guard<std::mutex> lock(examples_state_lock);
+        reading_done = true;
+        return 0;
     }
+    number_of_vectors_read++;
 
     fv = ex->fv;
     length = ex->length;
@@ -650,7 +964,8 @@ template <class T> void InputParser<T>::exit_parser()
 {
 	SG_TRACE("cancelling parse thread");
 	keep_running.store(false, std::memory_order_release);
-	examples_state_changed.notify_one();
+	if (examples_ring)
+		examples_ring->close();
 	if (parse_thread.joinable())
 		parse_thread.join();
 }
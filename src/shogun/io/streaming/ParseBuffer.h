@@ -12,23 +12,19 @@
 #include <shogun/lib/common.h>
 #include <shogun/base/SGObject.h>
 #include <shogun/lib/DataType.h>
-#include <condition_variable>
-#include <memory>
-#include <mutex>
-#include <vector>
+#include <shogun/lib/cpu.h>
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <thread>
+
+/// Default number of examples handed from the parser to the reader at once
+#define PARSE_BUFFER_DEFAULT_BATCH_SIZE 16
 
 namespace shogun
 {
 
-/// Specifies whether location is empty,
-/// contains an unused example or a used example.
-enum E_IS_EXAMPLE_USED
-{
-	E_EMPTY = 1,
-	E_NOT_USED = 2,
-	E_USED = 3
-};
-
 /** @brief Class Example is the container type for
  * the vector+label combination.
  *
@@ -62,8 +58,21 @@ public:
  * when the example is used to make room for another
  * example to take its place.
  *
- * Writing of examples is done into whichever position
- * in the ring is free to be overwritten, or empty.
+ * The ring is a lock-free single-producer/single-consumer queue: exactly
+ * one thread may write examples (get_free_example(), commit_example(),
+ * finish()) and exactly one thread may read them (get_next_example(),
+ * finalize_example()). Examples are handed over in batches: the ring is
+ * divided into slots of batch_size examples, and a slot only becomes
+ * visible to the reader when it is full or flushed, so the two threads
+ * synchronize once per batch instead of once per example.
+ *
+ * Examples are written in place, the producer parses directly into the
+ * Example returned by get_free_example() and the vectors are never copied.
+ * The feature vector of a slot is handed back to the producer with the
+ * slot, so it may be reused for parsing the next examples.
+ *
+ * Waiting for a free or a filled slot spins shortly and then backs off to
+ * sleeping.
  */
 template <class T> class ParseBuffer: public SGObject
 {
@@ -72,8 +81,11 @@ public:
 	 * Constructor, taking buffer size as argument.
 	 *
 	 * @param size Ring size as number of examples
+	 * @param batch_size Number of examples handed over at once
 	 */
-	ParseBuffer(int32_t size = 1024);
+	ParseBuffer(
+		int32_t size = 1024,
+		int32_t batch_size = PARSE_BUFFER_DEFAULT_BATCH_SIZE);
 
 	/**
 	 * Destructor, frees up buffer.
@@ -82,65 +94,97 @@ public:
 	~ParseBuffer() override;
 
 	/**
-	 * Return the next position to write the example
-	 * into the ring.
+	 * Return the next position to write an example into, waiting
+	 * until the reader has released it if necessary. The example
+	 * still holds the vector that was last stored at this position
+	 * so the memory can be reused.
+	 *
+	 * Only to be called by the producer thread.
 	 *
-	 * @return pointer to example
+	 * @return pointer to example, NULL if the buffer was closed
 	 */
-	Example<T>* get_free_example()
-	{
-		std::unique_lock<std::mutex> write_lk(*write_mutex, std::defer_lock);
-		std::unique_lock<std::mutex> current_ex_lock(*ex_in_use_mutex[ex_write_index], std::defer_lock);
-		std::lock(write_lk, current_ex_lock);
-		while (ex_used[ex_write_index] == E_NOT_USED)
-			ex_in_use_cond[ex_write_index]->wait(current_ex_lock);
-		Example<T>* ex=&ex_ring[ex_write_index];
-		return ex;
-	}
+	Example<T>* get_free_example();
+
+	/**
+	 * Mark the example returned by get_free_example() as written,
+	 * which hands the current batch over to the reader once it is full.
+	 *
+	 * Only to be called by the producer thread.
+	 */
+	void commit_example();
 
 	/**
-	 * Writes the given example into the appropriate buffer space.
-	 * Feature vector is copied into a separate block.
+	 * Move an example into the buffer, waiting for space if
+	 * necessary. Only the vector pointer is stored, the vector
+	 * itself is not copied.
 	 *
-	 * @param ex Example to copy into buffer
+	 * Only to be called by the producer thread.
 	 *
-	 * @return 1 if successful, 0 on failure (if no space available)
+	 * @param ex Example to move into the buffer
+	 *
+	 * @return 1 on success, 0 if the buffer was closed
 	 */
 	int32_t write_example(Example<T>* ex);
 
 	/**
-	 * Returns the example that should be read next from the buffer.
+	 * Hand the examples written so far over to the reader,
+	 * even if the current batch is not full.
+	 *
+	 * Only to be called by the producer thread.
+	 */
+	void flush();
+
+	/**
+	 * Flush and signal the reader that no more examples follow.
 	 *
-	 * @return example object at next 'read' position
+	 * Only to be called by the producer thread.
 	 */
-	Example<T>* return_example_to_read();
+	void finish();
 
 	/**
-	 * Returns the next example from the buffer if unused, or NULL.
+	 * Returns the next example from the buffer if one is ready, or NULL.
+	 * Repeated calls return the same example until it is finalized.
+	 *
+	 * Only to be called by the consumer thread.
 	 *
 	 * @return unused example object at next 'read' position or NULL.
 	 */
 	Example<T>* get_unused_example();
 
 	/**
-	 * Copies an example into the buffer, waiting for the
-	 * destination example to be used if necessary.
+	 * Returns the next example from the buffer, waiting for the
+	 * producer if necessary.
 	 *
-	 * @param ex Example to copy into buffer
+	 * Only to be called by the consumer thread.
 	 *
-	 * @return 1 on success, 0 on memory errors
+	 * @return example or NULL if finish() or close() was called and
+	 * all examples were read
 	 */
-	int32_t copy_example(Example<T>* ex);
+	Example<T>* get_next_example();
 
 	/**
 	 * Mark the example in 'read' position as 'used'.
 	 *
-	 * It will then be free to be overwritten.
+	 * It will then be free to be overwritten once all
+	 * examples of its batch are used.
+	 *
+	 * Only to be called by the consumer thread.
 	 *
 	 * @param free_after_release whether to SG_FREE() the vector or not
 	 */
 	void finalize_example(bool free_after_release);
 
+	/**
+	 * Wake up and stop both threads: waiting calls return NULL and
+	 * no more examples are handed over.
+	 *
+	 * May be called from any thread.
+	 */
+	void close()
+	{
+		closed.store(true, std::memory_order_release);
+	}
+
 	/**
 	 * Set whether all vectors are to be freed
 	 * on destruction. This is true by default.
@@ -164,6 +208,29 @@ public:
 		return free_vectors_on_destruct;
 	}
 
+	/**
+	 * Return the number of examples the reader has released, all
+	 * examples written before that many are no longer accessed.
+	 *
+	 * May be called from any thread.
+	 *
+	 * @return number of released examples
+	 */
+	int64_t get_num_released() const
+	{
+		return num_released.load(std::memory_order_acquire);
+	}
+
+	/**
+	 * Return the number of examples handed over at once
+	 *
+	 * @return batch size
+	 */
+	int32_t get_batch_size() const
+	{
+		return batch_size;
+	}
+
 	/**
 	 * Return the name of the object
 	 *
@@ -177,46 +244,53 @@ public:
 	void init_vector();
 
 protected:
-	/**
-	 * Increments the 'read' position in the buffer.
-	 *
-	 */
-	virtual void inc_read_index()
-	{
-		ex_read_index=(ex_read_index + 1) % ring_size;
-	}
+	/** hand the current batch over to the reader */
+	void publish_slot();
 
-	/**
-	 * Increments the 'write' position in the buffer.
+	/** back off while waiting for the other thread
 	 *
+	 * @param spins number of times waited so far, incremented
 	 */
-	virtual void inc_write_index()
+	static void wait(int32_t& spins)
 	{
-		ex_write_index=(ex_write_index + 1) % ring_size;
+		if (spins<64)
+			CpuRelax();
+		else if (spins<128)
+			std::this_thread::yield();
+		else
+			std::this_thread::sleep_for(std::chrono::microseconds(50));
+		spins++;
 	}
 
 protected:
 
 	/// Size of ring as number of examples
 	int32_t ring_size;
-	/// Ring of examples
+	/// Number of examples per slot
+	int32_t batch_size;
+	/// Number of slots in the ring
+	int32_t num_slots;
+	/// Ring of examples, slot after slot
 	Example<T>* ex_ring;
-
-	/// Enum used for representing used/unused/empty state of example
-	E_IS_EXAMPLE_USED* ex_used;
-	/// Lock on state of example - used or unused
-	std::vector<std::shared_ptr<std::mutex> > ex_in_use_mutex;
-	/// Condition variable triggered when example is being/not being used
-	std::vector<std::shared_ptr<std::condition_variable> > ex_in_use_cond;
-	/// Lock for reading examples from the ring
-	std::shared_ptr<std::mutex> read_mutex;
-	/// Lock for writing new examples
-	std::shared_ptr<std::mutex> write_mutex;
-
-	/// Write position for next example
-	int32_t ex_write_index;
-	/// Position of next example to be read
-	int32_t ex_read_index;
+	/// Number of examples in each handed over slot
+	int32_t* slot_size;
+
+	/// Number of slots handed over to the reader, written by the producer
+	alignas(CPU_CACHE_LINE_SIZE) std::atomic<int64_t> write_slot;
+	/// Number of examples written to the current slot
+	int32_t write_pos;
+
+	/// Number of slots released to the producer, written by the consumer
+	alignas(CPU_CACHE_LINE_SIZE) std::atomic<int64_t> read_slot;
+	/// Number of examples of the current slot that have been used
+	int32_t read_pos;
+	/// Number of examples released to the producer
+	std::atomic<int64_t> num_released;
+
+	/// Whether the producer has finished
+	alignas(CPU_CACHE_LINE_SIZE) std::atomic_bool finished;
+	/// Whether the buffer was closed
+	std::atomic_bool closed;
 
 	/// Whether examples on the ring will be freed on destruction
 	bool free_vectors_on_destruct;
@@ -234,28 +308,31 @@ template <class T> void ParseBuffer<T>::init_vector()
 	}
 }
 
-template <class T> ParseBuffer<T>::ParseBuffer(int32_t size)
+template <class T> ParseBuffer<T>::ParseBuffer(int32_t size, int32_t batch)
 {
-	ring_size = size;
+	require(size>0, "Ring size ({}) must be positive", size);
+	require(batch>0, "Batch size ({}) must be positive", batch);
+
+	batch_size = std::min(batch, size);
+	num_slots = (size + batch_size - 1) / batch_size;
+	ring_size = num_slots * batch_size;
 	ex_ring = SG_CALLOC(Example<T>, ring_size);
-	ex_used = SG_MALLOC(E_IS_EXAMPLE_USED, ring_size);
-	read_mutex = std::make_shared<std::mutex>();
-	write_mutex = std::make_shared<std::mutex>();
+	slot_size = SG_CALLOC(int32_t, num_slots);
 	io::info("Initialized with ring size: {}.", ring_size);
 
-	ex_write_index = 0;
-	ex_read_index = 0;
+	write_slot.store(0, std::memory_order_relaxed);
+	read_slot.store(0, std::memory_order_relaxed);
+	num_released.store(0, std::memory_order_relaxed);
+	write_pos = 0;
+	read_pos = 0;
+	finished.store(false, std::memory_order_relaxed);
+	closed.store(false, std::memory_order_relaxed);
 
 	for (int32_t i=0; i<ring_size; i++)
 	{
-		ex_used[i] = E_EMPTY;
-
 		ex_ring[i].fv = NULL;
 		ex_ring[i].length = 1;
 		ex_ring[i].label = FLT_MAX;
-
-		ex_in_use_mutex.push_back(std::make_shared<std::mutex>());
-		ex_in_use_cond.push_back(std::make_shared<std::condition_variable>());
 	}
 	free_vectors_on_destruct = true;
 }
@@ -272,91 +349,129 @@ template <class T> ParseBuffer<T>::~ParseBuffer()
 		}
 	}
 	SG_FREE(ex_ring);
-	SG_FREE(ex_used);
+	SG_FREE(slot_size);
+}
 
-	ex_in_use_mutex.clear();
-	ex_in_use_cond.clear();
-	read_mutex.reset();
-	write_mutex.reset();
+template <class T>
+Example<T>* ParseBuffer<T>::get_free_example()
+{
+	const int64_t slot = write_slot.load(std::memory_order_relaxed);
+	if (write_pos == 0)
+	{
+		// wait until the reader has released the slot
+		int32_t spins = 0;
+		while (slot - read_slot.load(std::memory_order_acquire) >= num_slots)
+		{
+			if (closed.load(std::memory_order_acquire))
+				return NULL;
+			wait(spins);
+		}
+	}
+
+	return &ex_ring[(slot % num_slots) * batch_size + write_pos];
+}
+
+template <class T>
+void ParseBuffer<T>::commit_example()
+{
+	if (++write_pos == batch_size)
+		publish_slot();
 }
 
 template <class T>
 int32_t ParseBuffer<T>::write_example(Example<T> *ex)
 {
-	ex_ring[ex_write_index].label = ex->label;
-	ex_ring[ex_write_index].fv = ex->fv;
-	ex_ring[ex_write_index].length = ex->length;
-	ex_used[ex_write_index] = E_NOT_USED;
-	inc_write_index();
+	Example<T>* free_ex = get_free_example();
+	if (!free_ex)
+		return 0;
+
+	free_ex->label = ex->label;
+	free_ex->fv = ex->fv;
+	free_ex->length = ex->length;
+	commit_example();
 
 	return 1;
 }
 
 template <class T>
-Example<T>* ParseBuffer<T>::return_example_to_read()
+void ParseBuffer<T>::publish_slot()
 {
-	if (ex_read_index >= 0)
-		return &ex_ring[ex_read_index];
-	else
-		return NULL;
+	const int64_t slot = write_slot.load(std::memory_order_relaxed);
+	slot_size[slot % num_slots] = write_pos;
+	write_pos = 0;
+	write_slot.store(slot + 1, std::memory_order_release);
 }
 
 template <class T>
-Example<T>* ParseBuffer<T>::get_unused_example()
+void ParseBuffer<T>::flush()
 {
-	std::lock_guard<std::mutex> read_lk(*read_mutex);
-
-	Example<T> *ex;
-	int32_t current_index = ex_read_index;
-	// Because read index will change after return_example_to_read
+	if (write_pos > 0)
+		publish_slot();
+}
 
-	std::lock_guard<std::mutex> current_ex_lk(*ex_in_use_mutex[current_index]);
+template <class T>
+void ParseBuffer<T>::finish()
+{
+	flush();
+	finished.store(true, std::memory_order_release);
+}
 
-	if (ex_used[current_index] == E_NOT_USED)
-		ex = return_example_to_read();
-	else
-		ex = NULL;
+template <class T>
+Example<T>* ParseBuffer<T>::get_unused_example()
+{
+	const int64_t slot = read_slot.load(std::memory_order_relaxed);
+	if (slot == write_slot.load(std::memory_order_acquire))
+		return NULL;
 
-	return ex;
+	return &ex_ring[(slot % num_slots) * batch_size + read_pos];
 }
 
 template <class T>
-int32_t ParseBuffer<T>::copy_example(Example<T> *ex)
+Example<T>* ParseBuffer<T>::get_next_example()
 {
-	std::lock_guard<std::mutex> write_lk(*write_mutex);
-	int32_t ret;
-	int32_t current_index = ex_write_index;
-
-	std::unique_lock<std::mutex> current_ex_lock(*ex_in_use_mutex[current_index]);
-	while (ex_used[ex_write_index] == E_NOT_USED)
+	int32_t spins = 0;
+	while (!closed.load(std::memory_order_acquire))
 	{
-		ex_in_use_cond[ex_write_index]->wait(current_ex_lock);
-	}
+		Example<T>* ex = get_unused_example();
+		if (ex)
+			return ex;
 
-	ret = write_example(ex);
+		// the last batch is published before finished is set
+		if (finished.load(std::memory_order_acquire))
+			return get_unused_example();
 
-	return ret;
+		wait(spins);
+	}
+
+	return NULL;
 }
 
 template <class T>
 void ParseBuffer<T>::finalize_example(bool free_after_release)
 {
-	std::lock_guard<std::mutex> read_lk(*read_mutex);
-	std::unique_lock<std::mutex> current_ex_lock(*ex_in_use_mutex[ex_read_index]);
-	ex_used[ex_read_index] = E_USED;
+	const int64_t slot = read_slot.load(std::memory_order_relaxed);
+	if (slot == write_slot.load(std::memory_order_acquire))
+		return;
 
+	Example<T>* ex = &ex_ring[(slot % num_slots) * batch_size + read_pos];
 	if (free_after_release)
 	{
 		SG_DEBUG("Freeing object in ring at index {} and address: {}.",
-			 ex_read_index, fmt::ptr(ex_ring[ex_read_index].fv));
+			 (slot % num_slots) * batch_size + read_pos, fmt::ptr(ex->fv));
 
-		SG_FREE(ex_ring[ex_read_index].fv);
-		ex_ring[ex_read_index].fv=NULL;
+		SG_FREE(ex->fv);
+		ex->fv=NULL;
 	}
 
-	ex_in_use_cond[ex_read_index]->notify_one();
-	current_ex_lock.unlock();
-	inc_read_index();
+	if (++read_pos == slot_size[slot % num_slots])
+	{
+		read_pos = 0;
+		num_released.store(
+			num_released.load(std::memory_order_relaxed) +
+				slot_size[slot % num_slots],
+			std::memory_order_release);
+		read_slot.store(slot + 1, std::memory_order_release);
+	}
 }
 
 }
@@ -13,17 +13,30 @@
 
 using namespace shogun;
 
+/* chunk readers are run by several threads, setlocale() is not thread-safe */
+#define SET_LOCALE_C do { if (!m_chunk_reader) SG_SET_LOCALE_C; } while (0)
+#define RESET_LOCALE do { if (!m_chunk_reader) SG_RESET_LOCALE; } while (0)
+
 StreamingAsciiFile::StreamingAsciiFile()
 		: StreamingFile()
 {
 	unstable(SOURCE_LOCATION);
 	m_delimiter = ' ';
+	m_chunk_reader = false;
 }
 
 StreamingAsciiFile::StreamingAsciiFile(const char* fname, char rw)
 		: StreamingFile(fname, rw)
 {
 	m_delimiter = ' ';
+	m_chunk_reader = false;
+}
+
+StreamingAsciiFile::StreamingAsciiFile(char delimiter)
+		: StreamingFile()
+{
+	m_delimiter = delimiter;
+	m_chunk_reader = true;
 }
 
 StreamingAsciiFile::~StreamingAsciiFile()
@@ -39,14 +52,14 @@ void StreamingAsciiFile::get_vector(sg_type*& vector, int32_t& num_feat)	\
 		ssize_t bytes_read;													\
 		int32_t old_len = num_feat;											\
 																			\
-		SG_SET_LOCALE_C;													\
+		SET_LOCALE_C;													\
 		bytes_read = buf->read_line(buffer);								\
 																			\
 		if (bytes_read<=0)													\
 		{																	\
 				vector=NULL;												\
 				num_feat=-1;												\
-				SG_RESET_LOCALE;											\
+				RESET_LOCALE;											\
 				return;														\
 		}																	\
 																			\
@@ -99,7 +112,7 @@ void StreamingAsciiFile::get_vector(sg_type*& vector, int32_t& num_feat)	\
 				vector[i]=conv(item);										\
 				SG_FREE(item);												\
 		}																	\
-		SG_RESET_LOCALE;													\
+		RESET_LOCALE;													\
 }
 
 GET_VECTOR(get_bool_vector, str_to_bool, bool)
@@ -119,14 +132,14 @@ GET_VECTOR(get_longreal_vector, atoi, floatmax_t)
 		void StreamingAsciiFile::get_vector(sg_type*& vector, int32_t& len)\
 		{																	\
 				char *line=NULL;											\
-				SG_SET_LOCALE_C;											\
+				SET_LOCALE_C;											\
 				int32_t num_chars = buf->read_line(line);					\
 				int32_t old_len = len;										\
 																			\
 				if (num_chars == 0)											\
 				{															\
 						len = -1;											\
-						SG_RESET_LOCALE;									\
+						RESET_LOCALE;									\
 						return;												\
 				}															\
 																			\
@@ -145,7 +158,7 @@ GET_VECTOR(get_longreal_vector, atoi, floatmax_t)
 				{															\
 						vector[j++] = io::SGIO::float_of_substring(*i);		\
 				}															\
-				SG_RESET_LOCALE;											\
+				RESET_LOCALE;											\
 		}
 
 GET_FLOAT_VECTOR(float32_t)
@@ -160,7 +173,7 @@ GET_FLOAT_VECTOR(float64_t)
 				char* buffer = NULL;									\
 				ssize_t bytes_read;										\
 				int32_t old_len = num_feat;								\
-				SG_SET_LOCALE_C;										\
+				SET_LOCALE_C;										\
 																		\
 				bytes_read = buf->read_line(buffer);					\
 																		\
@@ -168,7 +181,7 @@ GET_FLOAT_VECTOR(float64_t)
 				{														\
 						vector=NULL;									\
 						num_feat=-1;									\
-						SG_RESET_LOCALE;								\
+						RESET_LOCALE;								\
 						return;											\
 				}														\
 																		\
@@ -223,7 +236,7 @@ GET_FLOAT_VECTOR(float64_t)
 						SG_FREE(item);									\
 				}														\
 				num_feat--;												\
-				SG_RESET_LOCALE;										\
+				RESET_LOCALE;										\
 		}
 
 GET_VECTOR_AND_LABEL(get_bool_vector_and_label, str_to_bool, bool)
@@ -243,14 +256,14 @@ GET_VECTOR_AND_LABEL(get_longreal_vector_and_label, atoi, floatmax_t)
 		void StreamingAsciiFile::get_vector_and_label(sg_type*& vector, int32_t& len, float64_t& label) \
 		{																\
 				char *line=NULL;										\
-				SG_SET_LOCALE_C;										\
+				SET_LOCALE_C;										\
 				int32_t num_chars = buf->read_line(line);				\
 				int32_t old_len = len;									\
 																		\
 				if (num_chars == 0)										\
 				{														\
 						len = -1;										\
-						SG_RESET_LOCALE;								\
+						RESET_LOCALE;								\
 						return;											\
 				}														\
 																		\
@@ -271,7 +284,7 @@ GET_VECTOR_AND_LABEL(get_longreal_vector_and_label, atoi, floatmax_t)
 				{														\
 						vector[j++] = io::SGIO::float_of_substring(*i);		\
 				}														\
-				SG_RESET_LOCALE;										\
+				RESET_LOCALE;										\
 		}
 
 GET_FLOAT_VECTOR_AND_LABEL(float32_t)
@@ -286,14 +299,14 @@ void StreamingAsciiFile::get_string(sg_type*& vector, int32_t& len)	\
 		char* buffer = NULL;											\
 		ssize_t bytes_read;												\
 																		\
-		SG_SET_LOCALE_C;												\
+		SET_LOCALE_C;												\
 		bytes_read = buf->read_line(buffer);							\
 																		\
 		if (bytes_read<=1)												\
 		{																\
 				vector=NULL;											\
 				len=-1;													\
-				SG_RESET_LOCALE;										\
+				RESET_LOCALE;										\
 				return;													\
 		}																\
 																		\
@@ -307,7 +320,7 @@ void StreamingAsciiFile::get_string(sg_type*& vector, int32_t& len)	\
 		else															\
 				len=bytes_read;											\
 		vector=(sg_type *) buffer;										\
-		SG_RESET_LOCALE;												\
+		RESET_LOCALE;												\
 }
 
 GET_STRING(get_bool_string, str_to_bool, bool)
@@ -333,14 +346,14 @@ void StreamingAsciiFile::get_string_and_label(sg_type*& vector, int32_t& len, fl
 		char* buffer = NULL;											\
 		ssize_t bytes_read;												\
 																		\
-		SG_SET_LOCALE_C;												\
+		SET_LOCALE_C;												\
 		bytes_read = buf->read_line(buffer);							\
 																		\
 		if (bytes_read<=1)												\
 		{																\
 				vector=NULL;											\
 				len=-1;													\
-				SG_RESET_LOCALE;										\
+				RESET_LOCALE;										\
 				return;													\
 		}																\
 																		\
@@ -374,7 +387,7 @@ void StreamingAsciiFile::get_string_and_label(sg_type*& vector, int32_t& len, fl
 				len=bytes_read-str_start_pos;							\
 																		\
 		vector=(sg_type*) &buffer[str_start_pos];						\
-		SG_RESET_LOCALE;												\
+		RESET_LOCALE;												\
 }
 
 GET_STRING_AND_LABEL(get_bool_string_and_label, str_to_bool, bool)
@@ -399,7 +412,7 @@ void StreamingAsciiFile::get_sparse_vector(SGSparseVectorEntry<sg_type>*& vector
 {																		\
 		char* buffer = NULL;											\
 		ssize_t bytes_read;												\
-		SG_SET_LOCALE_C;												\
+		SET_LOCALE_C;												\
 																		\
 		bytes_read = buf->read_line(buffer);							\
 																		\
@@ -407,7 +420,7 @@ void StreamingAsciiFile::get_sparse_vector(SGSparseVectorEntry<sg_type>*& vector
 		{																\
 				vector=NULL;											\
 				len=-1;													\
-				SG_RESET_LOCALE;										\
+				RESET_LOCALE;										\
 				return;													\
 		}																\
 																		\
@@ -468,7 +481,7 @@ void StreamingAsciiFile::get_sparse_vector(SGSparseVectorEntry<sg_type>*& vector
 		}																\
 																		\
 		len=current_feat;												\
-		SG_RESET_LOCALE;												\
+		RESET_LOCALE;												\
 }
 
 GET_SPARSE_VECTOR(get_bool_sparse_vector, str_to_bool, bool)
@@ -493,7 +506,7 @@ void StreamingAsciiFile::get_sparse_vector_and_label(SGSparseVectorEntry<sg_type
 {																		\
 		char* buffer = NULL;											\
 		ssize_t bytes_read;												\
-		SG_SET_LOCALE_C;												\
+		SET_LOCALE_C;												\
 																		\
 		bytes_read = buf->read_line(buffer);							\
 																		\
@@ -501,7 +514,7 @@ void StreamingAsciiFile::get_sparse_vector_and_label(SGSparseVectorEntry<sg_type
 		{																\
 				vector=NULL;											\
 				len=-1;													\
-				SG_RESET_LOCALE;										\
+				RESET_LOCALE;										\
 				return;													\
 		}																\
 																		\
@@ -584,7 +597,7 @@ void StreamingAsciiFile::get_sparse_vector_and_label(SGSparseVectorEntry<sg_type
 		}																\
 																		\
 		len=current_feat;												\
-		SG_RESET_LOCALE;												\
+		RESET_LOCALE;												\
 }
 
 GET_SPARSE_VECTOR_AND_LABEL(get_bool_sparse_vector_and_label, str_to_bool, bool)
@@ -621,6 +634,11 @@ void StreamingAsciiFile::set_delimiter(char delimiter)
 {
 	m_delimiter = delimiter;
 }
+
+std::shared_ptr<StreamingFile> StreamingAsciiFile::create_chunk_reader() const
+{
+	return std::shared_ptr<StreamingFile>(new StreamingAsciiFile(m_delimiter));
+}
 void StreamingAsciiFile::tokenize(char delim, substring s, v_array<substring>& ret)
 {
 	ret.erase();
@@ -643,3 +661,6 @@ void StreamingAsciiFile::tokenize(char delim, substring s, v_array<substring>& r
 		ret.push(final);
 	}
 }
+
+#undef SET_LOCALE_C
+#undef RESET_LOCALE
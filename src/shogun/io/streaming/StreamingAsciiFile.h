@@ -52,6 +52,15 @@ public:
 	void set_delimiter(char delimiter);
 
 #ifndef SWIG // SWIG should skip this
+	/**
+	 * Create a reader with the same delimiter which parses lines
+	 * from memory. Chunk readers leave the locale alone, the caller
+	 * has to set the C locale while they parse.
+	 *
+	 * @return chunk reader
+	 */
+	std::shared_ptr<StreamingFile> create_chunk_reader() const override;
+
 	/**
 	 * Utility function to convert a string to a boolean value
 	 *
@@ -108,6 +117,12 @@ public:
 	}
 
 private:
+	/** constructor of a chunk reader
+	 *
+	 * @param delimiter the character used as delimiter
+	 */
+	explicit StreamingAsciiFile(char delimiter);
+
 	/** helper function to read vectors / matrices
 	 *
 	 * @param items dynamic array of values
@@ -132,6 +147,9 @@ private:
 
 	/** delimiter */
 	char m_delimiter;
+
+	/** whether this is a chunk reader, which does not set the locale */
+	bool m_chunk_reader;
 };
 }
 #endif //__STREAMING_ASCIIFILE_H__
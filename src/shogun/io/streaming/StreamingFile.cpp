@@ -223,3 +223,32 @@ StreamingFile::~StreamingFile()
 {
 	SG_FREE(filename);
 }
+
+int32_t StreamingFile::read_lines(std::vector<char>& chunk, int32_t num_lines)
+{
+	chunk.clear();
+	if (!buf)
+		return 0;
+
+	int32_t i=0;
+	for (; i<num_lines; i++)
+	{
+		char* line=NULL;
+		ssize_t len=buf->read_line(line);
+		if (len<=0)
+			break;
+
+		chunk.insert(chunk.end(), line, line+len);
+		chunk.push_back('\n');
+	}
+
+	return i;
+}
+
+void StreamingFile::set_chunk(const char* text, size_t len)
+{
+	if (!buf)
+		buf=std::make_shared<IOBuffer>();
+
+	buf->load(text, len);
+}
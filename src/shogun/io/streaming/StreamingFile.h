@@ -13,6 +13,9 @@
 #include <shogun/base/SGObject.h>
 #include <shogun/io/IOBuffer.h>
 
+#include <memory>
+#include <vector>
+
 namespace shogun
 {
 template <class ST> struct SGSparseVectorEntry;
@@ -65,6 +68,42 @@ template <class ST> struct SGSparseVectorEntry;
 		 */
 		virtual void reset_stream() { error("Unable to reset the input stream!"); }
 
+		/**
+		 * Create a reader for the same format which parses text from
+		 * memory (see set_chunk()). This allows InputParser to read
+		 * raw lines with read_lines() and to parse chunks of them in
+		 * parallel.
+		 *
+		 * @return chunk reader, or nullptr if the stream cannot be
+		 * split into lines (the default)
+		 */
+		virtual std::shared_ptr<StreamingFile> create_chunk_reader() const
+		{
+			return nullptr;
+		}
+
+		/**
+		 * Read raw lines from the stream. Like the read functions,
+		 * reading stops at an empty line or the end of the stream.
+		 *
+		 * @param chunk set to the lines, each terminated by a newline
+		 * @param num_lines maximum number of lines to read
+		 *
+		 * @return number of lines read
+		 */
+		int32_t read_lines(std::vector<char>& chunk, int32_t num_lines);
+
+		/**
+		 * Make the read functions parse the given text, rather than
+		 * the file. Vectors of strings returned by the read functions
+		 * point into a copy of the text which is valid until the next
+		 * call.
+		 *
+		 * @param text lines as returned by read_lines()
+		 * @param len length of the text
+		 */
+		void set_chunk(const char* text, size_t len);
+
 		/** @name Dense Vector Access Functions
 		 *
 		 * Functions to access dense vectors of one of several
@@ -0,0 +1,257 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <shogun/features/SubsetStack.h>
+#include <shogun/io/SGIO.h>
+#include <shogun/kernel/CachedKernel.h>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using namespace shogun;
+
+KernelValueCache::KernelValueCache(index_t num_vectors, int32_t size)
+: m_num_vectors(num_vectors), m_num_rows(0)
+{
+	require(num_vectors>=0, "Number of vectors ({}) must be non-negative",
+		num_vectors);
+	require(size>=0, "Cache size ({}) must be non-negative", size);
+
+	int64_t row_size=int64_t(Math::max(num_vectors, 1))*sizeof(float64_t);
+	m_max_rows=Math::min(int64_t(num_vectors),
+		int64_t(size)*1024*1024/row_size);
+
+	m_rows=new std::atomic<std::atomic<float64_t>*>[num_vectors];
+	for (index_t i=0; i<num_vectors; i++)
+		m_rows[i].store(NULL, std::memory_order_relaxed);
+}
+
+KernelValueCache::~KernelValueCache()
+{
+	for (index_t i=0; i<m_num_vectors; i++)
+		delete[] m_rows[i].load(std::memory_order_relaxed);
+	delete[] m_rows;
+}
+
+std::atomic<float64_t>* KernelValueCache::get_row(index_t idx)
+{
+	ASSERT(idx>=0 && idx<m_num_vectors)
+
+	auto row=m_rows[idx].load(std::memory_order_acquire);
+	if (row || m_num_rows>=m_max_rows)
+		return row;
+
+	m_lock.lock();
+	row=m_rows[idx].load(std::memory_order_relaxed);
+	if (!row && m_num_rows<m_max_rows)
+	{
+		row=new std::atomic<float64_t>[m_num_vectors];
+		for (index_t j=0; j<m_num_vectors; j++)
+		{
+			row[j].store(std::numeric_limits<float64_t>::quiet_NaN(),
+				std::memory_order_relaxed);
+		}
+		m_rows[idx].store(row, std::memory_order_release);
+		m_num_rows++;
+	}
+	m_lock.unlock();
+
+	return row;
+}
+
+CachedKernel::CachedKernel() : Kernel()
+{
+	init();
+}
+
+CachedKernel::CachedKernel(
+	std::shared_ptr<Kernel> kernel, std::shared_ptr<KernelValueCache> cache)
+: Kernel(kernel ? kernel->get_cache_size() : 10)
+{
+	init();
+
+	require(kernel, "Kernel required");
+	require(cache, "Kernel value cache required");
+	m_kernel=std::move(kernel);
+	m_cache=std::move(cache);
+
+	if (m_kernel->has_property(KP_LINADD))
+		set_property(KP_LINADD);
+	if (m_kernel->has_property(KP_BATCHEVALUATION))
+		set_property(KP_BATCHEVALUATION);
+	opt_type=m_kernel->get_optimization_type();
+}
+
+CachedKernel::~CachedKernel()
+{
+	cleanup();
+}
+
+void CachedKernel::init()
+{
+	SG_ADD(&m_kernel, "kernel", "Wrapped kernel.");
+}
+
+std::shared_ptr<SGObject> CachedKernel::clone(ParameterProperties pp) const
+{
+	auto clone=std::static_pointer_cast<CachedKernel>(Kernel::clone(pp));
+
+	// the cache is safe to access concurrently, so the clone shares it
+	clone->m_cache=m_cache;
+	clone->m_lhs_idx=m_lhs_idx;
+	clone->m_rhs_idx=m_rhs_idx;
+	return clone;
+}
+
+bool CachedKernel::init(std::shared_ptr<Features> l, std::shared_ptr<Features> r)
+{
+	require(m_kernel && m_cache, "{}::init(): Kernel and cache required",
+		get_name());
+
+	m_kernel->init(l, r);
+	Kernel::init(l, r);
+	m_lhs_idx=original_indices(l);
+	m_rhs_idx=original_indices(r);
+
+	return init_normalizer();
+}
+
+void CachedKernel::remove_lhs_and_rhs()
+{
+	if (m_kernel)
+		m_kernel->remove_lhs_and_rhs();
+	m_lhs_idx=SGVector<index_t>();
+	m_rhs_idx=SGVector<index_t>();
+
+	Kernel::remove_lhs_and_rhs();
+}
+
+SGVector<index_t> CachedKernel::original_indices(
+	const std::shared_ptr<Features>& features) const
+{
+	auto subset_stack=features->get_subset_stack();
+	SGVector<index_t> idx(features->get_num_vectors());
+	for (index_t i=0; i<idx.vlen; i++)
+	{
+		idx[i]=subset_stack->subset_idx_conversion(i);
+		require(idx[i]>=0 && idx[i]<m_cache->get_num_vectors(),
+			"{}::init(): Original index {} of vector {} is out of range of "
+			"the kernel value cache [0, {})", get_name(), idx[i], i,
+			m_cache->get_num_vectors());
+	}
+
+	return idx;
+}
+
+float64_t CachedKernel::compute(int32_t x, int32_t y)
+{
+	auto row=m_cache->get_row(m_lhs_idx[x]);
+	if (row)
+	{
+		float64_t value=row[m_rhs_idx[y]].load(std::memory_order_relaxed);
+		if (!std::isnan(value))
+			return value;
+	}
+
+	float64_t value=m_kernel->kernel(x, y);
+	if (row)
+		row[m_rhs_idx[y]].store(value, std::memory_order_relaxed);
+
+	return value;
+}
+
+bool CachedKernel::init_optimization(
+	int32_t count, int32_t* IDX, float64_t* weights)
+{
+	bool result=m_kernel->init_optimization(count, IDX, weights);
+	set_is_initialized(m_kernel->get_is_initialized());
+	return result;
+}
+
+bool CachedKernel::delete_optimization()
+{
+	bool result=m_kernel->delete_optimization();
+	set_is_initialized(m_kernel->get_is_initialized());
+	return result;
+}
+
+float64_t CachedKernel::compute_optimized(int32_t vector_idx)
+{
+	return m_kernel->compute_optimized(vector_idx);
+}
+
+void CachedKernel::compute_batch(int32_t num_vec, int32_t* vec_idx,
+	float64_t* target, int32_t num_suppvec, int32_t* IDX, float64_t* alphas,
+	float64_t factor)
+{
+	m_kernel->compute_batch(num_vec, vec_idx, target, num_suppvec, IDX,
+		alphas, factor);
+}
+
+void CachedKernel::clear_normal()
+{
+	m_kernel->clear_normal();
+	set_is_initialized(m_kernel->get_is_initialized());
+}
+
+void CachedKernel::add_to_normal(int32_t vector_idx, float64_t weight)
+{
+	m_kernel->add_to_normal(vector_idx, weight);
+	set_is_initialized(m_kernel->get_is_initialized());
+}
+
+void CachedKernel::set_optimization_type(EOptimizationType t)
+{
+	Kernel::set_optimization_type(t);
+	if (m_kernel)
+		m_kernel->set_optimization_type(t);
+}
+
+void CachedKernel::compute_block(SGVector<index_t> lhs_idx,
+	SGVector<index_t> rhs_idx, SGMatrix<float64_t> out)
+{
+	check_block(lhs_idx, rhs_idx, out);
+
+	// rows with a value missing from the cache are computed as a whole
+	std::vector<std::atomic<float64_t>*> rows(lhs_idx.vlen);
+	std::vector<index_t> missing;
+	for (index_t i=0; i<lhs_idx.vlen; i++)
+	{
+		rows[i]=m_cache->get_row(m_lhs_idx[lhs_idx[i]]);
+		bool complete=rows[i]!=NULL;
+		for (index_t j=0; j<rhs_idx.vlen && complete; j++)
+		{
+			out(i, j)=rows[i][m_rhs_idx[rhs_idx[j]]].load(
+				std::memory_order_relaxed);
+			complete=!std::isnan(out(i, j));
+		}
+
+		if (!complete)
+			missing.push_back(i);
+	}
+
+	if (missing.empty())
+		return;
+
+	SGVector<index_t> missing_idx(missing.size());
+	for (index_t m=0; m<missing_idx.vlen; m++)
+		missing_idx[m]=lhs_idx[missing[m]];
+	SGMatrix<float64_t> block(missing_idx.vlen, rhs_idx.vlen);
+	m_kernel->compute_block(missing_idx, rhs_idx, block);
+
+	for (index_t j=0; j<rhs_idx.vlen; j++)
+	{
+		for (index_t m=0; m<missing_idx.vlen; m++)
+		{
+			const index_t i=missing[m];
+			out(i, j)=block(m, j);
+			if (rows[i])
+			{
+				rows[i][m_rhs_idx[rhs_idx[j]]].store(
+					block(m, j), std::memory_order_relaxed);
+			}
+		}
+	}
+}
@@ -0,0 +1,254 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#ifndef _CACHEDKERNEL_H___
+#define _CACHEDKERNEL_H___
+
+#include <shogun/lib/config.h>
+
+#include <shogun/features/Features.h>
+#include <shogun/kernel/Kernel.h>
+#include <shogun/lib/Lock.h>
+#include <shogun/lib/common.h>
+
+#include <atomic>
+
+namespace shogun
+{
+/** @brief Kernel values between the vectors of a set of features, addressed
+ * by their original indices, i.e. with all subsets of the features removed.
+ *
+ * The cache is filled lazily row by row until its size is exhausted and can
+ * be shared between CachedKernel instances on different subsets of the same
+ * features, e.g. the training and test sets of the folds of a
+ * cross-validation. It is safe to access the cache concurrently.
+ */
+class KernelValueCache
+{
+public:
+	/** constructor
+	 *
+	 * @param num_vectors number of original vectors
+	 * @param size cache size in MB
+	 */
+	KernelValueCache(index_t num_vectors, int32_t size);
+
+	~KernelValueCache();
+
+	/** get the row of an original vector, allocating it if the cache has
+	 * room left. Entries which were not computed yet are NaN.
+	 *
+	 * @param idx original index of the vector
+	 * @return the row or NULL if it is not cached
+	 */
+	std::atomic<float64_t>* get_row(index_t idx);
+
+	/** @return number of original vectors */
+	index_t get_num_vectors() const
+	{
+		return m_num_vectors;
+	}
+
+	/** @return number of rows held by the cache */
+	index_t get_num_rows() const
+	{
+		return m_num_rows;
+	}
+
+private:
+	/** number of original vectors */
+	index_t m_num_vectors;
+	/** maximum number of rows */
+	index_t m_max_rows;
+	/** number of rows held */
+	index_t m_num_rows;
+	/** rows, NULL if not cached */
+	std::atomic<std::atomic<float64_t>*>* m_rows;
+	/** guards the allocation of rows */
+	Lock m_lock;
+};
+
+/** @brief CachedKernel computes another kernel through a KernelValueCache.
+ *
+ * The features the kernel is initialized with have to be subsets of the
+ * features whose kernel values the cache holds, which are mapped to their
+ * original indices through the SubsetStack of the features. Kernel values
+ * computed on one subset are thus reused on every other subset, e.g.
+ * CrossValidation uses it to compute every kernel value at most once over
+ * all folds. The values are cached as normalized by the wrapped kernel, so
+ * its normalizer must not depend on the subsets (e.g. AvgDiag does).
+ *
+ * Linadd and batch evaluation are forwarded to the wrapped kernel, bypassing
+ * the cache.
+ *
+ * Clones share the cache. The cache is not serialized, so a deserialized
+ * kernel needs a new one through set_cache() before it is initialized.
+ */
+class CachedKernel : public Kernel
+{
+	public:
+		/** default constructor */
+		CachedKernel();
+
+		/** constructor
+		 *
+		 * @param kernel kernel to compute
+		 * @param cache cache of the values of kernel
+		 */
+		CachedKernel(
+			std::shared_ptr<Kernel> kernel,
+			std::shared_ptr<KernelValueCache> cache);
+
+		~CachedKernel() override;
+
+		/** initialize kernel and the wrapped kernel
+		 *
+		 * @param l features of left-hand side
+		 * @param r features of right-hand side
+		 * @return if initializing was successful
+		 */
+		bool init(std::shared_ptr<Features> l, std::shared_ptr<Features> r) override;
+
+		/** remove lhs and rhs from kernel and the wrapped kernel */
+		void remove_lhs_and_rhs() override;
+
+		/** compute the kernel values between lhs vectors lhs_idx and rhs
+		 * vectors rhs_idx. Rows with missing values are computed with the
+		 * compute_block() of the wrapped kernel and stored in the cache.
+		 *
+		 * @param lhs_idx indices of lhs vectors
+		 * @param rhs_idx indices of rhs vectors
+		 * @param out preallocated lhs_idx.vlen x rhs_idx.vlen matrix
+		 */
+		void compute_block(
+			SGVector<index_t> lhs_idx, SGVector<index_t> rhs_idx,
+			SGMatrix<float64_t> out) override;
+
+		/** @return wrapped kernel */
+		std::shared_ptr<Kernel> get_kernel() const
+		{
+			return m_kernel;
+		}
+
+		/** @return cache of the values of the wrapped kernel */
+		std::shared_ptr<KernelValueCache> get_cache() const
+		{
+			return m_cache;
+		}
+
+		/** set the cache of the values of the wrapped kernel
+		 *
+		 * @param cache cache
+		 */
+		void set_cache(std::shared_ptr<KernelValueCache> cache)
+		{
+			require(cache, "Kernel value cache required");
+			m_cache=std::move(cache);
+		}
+
+		/** clone the kernel, the clone shares the cache
+		 *
+		 * @param pp properties of the parameters to clone
+		 * @return clone
+		 */
+		std::shared_ptr<SGObject> clone(
+			ParameterProperties pp=ParameterProperties::ALL) const override;
+
+		/** @return kernel type UNKNOWN, as the wrapped kernel is hidden */
+		EKernelType get_kernel_type() override { return K_UNKNOWN; }
+
+		/** @return feature type of the wrapped kernel */
+		EFeatureType get_feature_type() override
+		{
+			return m_kernel->get_feature_type();
+		}
+
+		/** @return feature class of the wrapped kernel */
+		EFeatureClass get_feature_class() override
+		{
+			return m_kernel->get_feature_class();
+		}
+
+		/** @return name */
+		const char* get_name() const override { return "CachedKernel"; }
+
+		/** initialize optimization of the wrapped kernel
+		 *
+		 * @param count count
+		 * @param IDX index
+		 * @param weights weights
+		 * @return if initializing was successful
+		 */
+		bool init_optimization(
+			int32_t count, int32_t *IDX, float64_t *weights) override;
+
+		/** delete optimization of the wrapped kernel
+		 *
+		 * @return if deleting was successful
+		 */
+		bool delete_optimization() override;
+
+		/** compute optimized with the wrapped kernel
+		 *
+		 * @param vector_idx index to compute
+		 * @return optimized value at given index
+		 */
+		float64_t compute_optimized(int32_t vector_idx) override;
+
+		/** compute a batch of outputs with the wrapped kernel, see
+		 * Kernel::compute_batch()
+		 */
+		void compute_batch(
+			int32_t num_vec, int32_t* vec_idx, float64_t* target,
+			int32_t num_suppvec, int32_t* IDX, float64_t* alphas,
+			float64_t factor=1.0) override;
+
+		/** clear the normal of the wrapped kernel */
+		void clear_normal() override;
+
+		/** add vector*factor to the normal of the wrapped kernel
+		 *
+		 * @param vector_idx index
+		 * @param weight weight
+		 */
+		void add_to_normal(int32_t vector_idx, float64_t weight) override;
+
+		/** set optimization type of the wrapped kernel
+		 *
+		 * @param t optimization type to set
+		 */
+		void set_optimization_type(EOptimizationType t) override;
+
+	protected:
+		/** compute kernel function
+		 *
+		 * @param x x
+		 * @param y y
+		 * @return value of the wrapped kernel
+		 */
+		float64_t compute(int32_t x, int32_t y) override;
+
+	private:
+		void init();
+
+		/** original indices of the vectors of some features
+		 *
+		 * @param features features
+		 * @return original index of every vector
+		 */
+		SGVector<index_t> original_indices(
+			const std::shared_ptr<Features>& features) const;
+
+	protected:
+		/** wrapped kernel */
+		std::shared_ptr<Kernel> m_kernel;
+		/** cache of the values of the wrapped kernel */
+		std::shared_ptr<KernelValueCache> m_cache;
+		/** original indices of the lhs vectors */
+		SGVector<index_t> m_lhs_idx;
+		/** original indices of the rhs vectors */
+		SGVector<index_t> m_rhs_idx;
+};
+}
+#endif /* _CACHEDKERNEL_H___ */
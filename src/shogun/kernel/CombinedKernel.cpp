@@ -7,6 +7,7 @@
  */
 
 #include <shogun/lib/common.h>
+#include <shogun/base/ShogunEnv.h>
 #include <shogun/io/SGIO.h>
 #include <shogun/lib/Signal.h>
 #include <shogun/base/Parallel.h>
@@ -21,6 +22,12 @@
 using namespace shogun;
 using namespace Eigen;
 
+namespace
+{
+	/** number of rows per task of compute_subkernel_quadratic_forms() */
+	const index_t QUADRATIC_FORM_TILE_SIZE=256;
+}
+
 CombinedKernel::CombinedKernel() : Kernel()
 {
 	init();
@@ -248,12 +255,15 @@ bool CombinedKernel::init(std::shared_ptr<Features> l, std::shared_ptr<Features>
 		combined_r = std::static_pointer_cast<CombinedFeatures>(r);
 	}
 
+	clear_subkernel_cache();
+
 	return init_with_extracted_subsets(
 	    combined_l, combined_r, lhs_subset, rhs_subset);
 }
 
 void CombinedKernel::remove_lhs()
 {
+	clear_subkernel_cache();
 	delete_optimization();
 
 	for (index_t k_idx=0; k_idx<get_num_kernels(); k_idx++)
@@ -271,6 +281,7 @@ void CombinedKernel::remove_lhs()
 
 void CombinedKernel::remove_rhs()
 {
+	clear_subkernel_cache();
 	delete_optimization();
 
 	for (index_t k_idx=0; k_idx<get_num_kernels(); k_idx++)
@@ -288,6 +299,7 @@ void CombinedKernel::remove_rhs()
 
 void CombinedKernel::remove_lhs_and_rhs()
 {
+	clear_subkernel_cache();
 	delete_optimization();
 
 	for (index_t k_idx=0; k_idx<get_num_kernels(); k_idx++)
@@ -307,6 +319,7 @@ void CombinedKernel::remove_lhs_and_rhs()
 
 void CombinedKernel::cleanup()
 {
+	clear_subkernel_cache();
 	for (index_t k_idx=0; k_idx<get_num_kernels(); k_idx++)
 	{
 		auto k = get_kernel(k_idx);
@@ -350,6 +363,229 @@ float64_t CombinedKernel::compute(int32_t x, int32_t y)
 	return result;
 }
 
+void CombinedKernel::compute_block(SGVector<index_t> lhs_idx,
+	SGVector<index_t> rhs_idx, SGMatrix<float64_t> out)
+{
+	check_block(lhs_idx, rhs_idx, out);
+
+	std::vector<index_t> active;
+	for (index_t k_idx=0; k_idx<get_num_kernels(); k_idx++)
+	{
+		if (get_kernel(k_idx)->get_combined_kernel_weight()!=0)
+			active.push_back(k_idx);
+	}
+
+	out.zero();
+	const int64_t num_active=active.size();
+	const int64_t size=int64_t(out.num_rows)*out.num_cols;
+
+	// with fewer subkernels than threads, the subkernels themselves
+	// parallelize their blocks better than we can across them
+	if (num_active<env()->get_num_threads())
+	{
+		SGMatrix<float64_t> block(out.num_rows, out.num_cols);
+		for (auto k_idx : active)
+		{
+			compute_subkernel_block(k_idx, lhs_idx, rhs_idx, block);
+			float64_t w=get_kernel(k_idx)->get_combined_kernel_weight();
+			for (int64_t e=0; e<size; e++)
+				out.matrix[e]+=w*block.matrix[e];
+		}
+	}
+	else
+	{
+#pragma omp parallel
+		{
+			SGMatrix<float64_t> block(out.num_rows, out.num_cols);
+			SGMatrix<float64_t> sum(out.num_rows, out.num_cols);
+			sum.zero();
+
+#pragma omp for schedule(dynamic) nowait
+			for (int64_t a=0; a<num_active; a++)
+			{
+				compute_subkernel_block(active[a], lhs_idx, rhs_idx, block);
+				float64_t w=get_kernel(active[a])->get_combined_kernel_weight();
+				for (int64_t e=0; e<size; e++)
+					sum.matrix[e]+=w*block.matrix[e];
+			}
+
+#pragma omp critical
+			for (int64_t e=0; e<size; e++)
+				out.matrix[e]+=sum.matrix[e];
+		}
+	}
+
+	normalize_block(lhs_idx, rhs_idx, out);
+}
+
+void CombinedKernel::compute_subkernel_block(index_t k_idx,
+	const SGVector<index_t>& lhs_idx, const SGVector<index_t>& rhs_idx,
+	SGMatrix<float64_t>& out)
+{
+	auto k=get_kernel(k_idx);
+	const index_t row_len=k->get_num_vec_rhs();
+	const int64_t capacity=
+		int64_t(subkernel_cache_size)*1024*1024/sizeof(float64_t);
+
+	if (row_len==0 || capacity<row_len)
+	{
+		k->compute_block(lhs_idx, rhs_idx, out);
+		return;
+	}
+
+	// cache slot of the subkernel, reset if the kernel array changed, must
+	// be called with the lock held
+	auto get_slot=[&]() -> SUBKERNEL_ROWS& {
+		if (subkernel_rows.size()!=kernel_array.size())
+			subkernel_rows.resize(kernel_array.size());
+		auto& slot=subkernel_rows[k_idx];
+		if (slot.kernel!=k.get())
+		{
+			for (const auto& row : slot.rows)
+				subkernel_cache_entries-=row.second.vlen;
+			slot.rows.clear();
+			slot.kernel=k.get();
+		}
+		return slot;
+	};
+
+	std::vector<SGVector<float64_t>> rows(lhs_idx.vlen);
+	std::vector<index_t> missing;
+	subkernel_cache_lock.lock();
+	auto& cached=get_slot();
+	for (index_t i=0; i<lhs_idx.vlen; i++)
+	{
+		auto it=cached.rows.find(lhs_idx[i]);
+		if (it!=cached.rows.end())
+			rows[i]=it->second;
+		else
+			missing.push_back(i);
+	}
+	index_t num_new=Math::min(int64_t(missing.size()),
+		Math::max(capacity-subkernel_cache_entries, int64_t(0))/row_len);
+	subkernel_cache_lock.unlock();
+
+	// missing rows that fit into the cache are computed in full
+	if (num_new>0)
+	{
+		SGVector<index_t> new_idx(num_new);
+		for (index_t n=0; n<num_new; n++)
+			new_idx[n]=lhs_idx[missing[n]];
+		SGVector<index_t> all_rhs(row_len);
+		all_rhs.range_fill();
+		SGMatrix<float64_t> new_rows(num_new, row_len);
+		k->compute_block(new_idx, all_rhs, new_rows);
+
+		subkernel_cache_lock.lock();
+		auto& slot=get_slot();
+		for (index_t n=0; n<num_new; n++)
+		{
+			SGVector<float64_t> row(row_len);
+			for (index_t j=0; j<row_len; j++)
+				row[j]=new_rows(n, j);
+			rows[missing[n]]=row;
+
+			// the cache might have been filled or cleared meanwhile
+			if (subkernel_cache_entries+row_len<=capacity &&
+				slot.rows.emplace(new_idx[n], row).second)
+			{
+				subkernel_cache_entries+=row_len;
+			}
+		}
+		subkernel_cache_lock.unlock();
+	}
+
+	for (index_t i=0; i<lhs_idx.vlen; i++)
+	{
+		if (!rows[i].vlen)
+			continue;
+		for (index_t j=0; j<rhs_idx.vlen; j++)
+			out(i, j)=rows[i][rhs_idx[j]];
+	}
+
+	// the remaining ones only on the requested rhs vectors
+	index_t num_rest=missing.size()-num_new;
+	if (num_rest>0)
+	{
+		SGVector<index_t> rest_idx(num_rest);
+		for (index_t n=0; n<num_rest; n++)
+			rest_idx[n]=lhs_idx[missing[num_new+n]];
+		SGMatrix<float64_t> rest(num_rest, rhs_idx.vlen);
+		k->compute_block(rest_idx, rhs_idx, rest);
+
+		for (index_t j=0; j<rhs_idx.vlen; j++)
+		{
+			for (index_t n=0; n<num_rest; n++)
+				out(missing[num_new+n], j)=rest(n, j);
+		}
+	}
+}
+
+SGVector<float64_t> CombinedKernel::compute_subkernel_quadratic_forms(
+	SGVector<index_t> idx, SGVector<float64_t> alpha)
+{
+	require(idx.vlen==alpha.vlen, "Number of indices ({}) and coefficients "
+		"({}) must match", idx.vlen, alpha.vlen);
+	for (auto i : idx)
+	{
+		require(i>=0 && i<num_lhs && i<num_rhs, "Index {} out of range "
+			"[0, {})", i, Math::min(num_lhs, num_rhs));
+	}
+
+	const index_t num_kernels=get_num_kernels();
+	SGVector<float64_t> result(num_kernels);
+	result.zero();
+	if (!idx.vlen)
+		return result;
+
+	// one task per subkernel and tile of rows, so that this scales with
+	// the number of threads independent of the number of subkernels
+	const index_t num_tiles=
+		(idx.vlen+QUADRATIC_FORM_TILE_SIZE-1)/QUADRATIC_FORM_TILE_SIZE;
+	const int64_t num_tasks=int64_t(num_kernels)*num_tiles;
+
+#pragma omp parallel for schedule(dynamic)
+	for (int64_t t=0; t<num_tasks; t++)
+	{
+		index_t k_idx=t/num_tiles;
+		index_t begin=(t%num_tiles)*QUADRATIC_FORM_TILE_SIZE;
+		index_t len=Math::min(QUADRATIC_FORM_TILE_SIZE, idx.vlen-begin);
+
+		SGVector<index_t> rows(idx.vector+begin, len, false);
+		SGMatrix<float64_t> block(len, idx.vlen);
+		compute_subkernel_block(k_idx, rows, idx, block);
+
+		float64_t sum=0;
+		for (index_t j=0; j<idx.vlen; j++)
+		{
+			float64_t col=0;
+			for (index_t i=0; i<len; i++)
+				col+=alpha[begin+i]*block(i, j);
+			sum+=col*alpha[j];
+		}
+
+#pragma omp atomic
+		result.vector[k_idx]+=sum;
+	}
+
+	return result;
+}
+
+void CombinedKernel::set_subkernel_cache_size(int32_t size)
+{
+	require(size>=0, "Subkernel cache size ({}) must be non-negative", size);
+	clear_subkernel_cache();
+	subkernel_cache_size=size;
+}
+
+void CombinedKernel::clear_subkernel_cache()
+{
+	subkernel_cache_lock.lock();
+	subkernel_rows.clear();
+	subkernel_cache_entries=0;
+	subkernel_cache_lock.unlock();
+}
+
 bool CombinedKernel::init_optimization(
 	int32_t count, int32_t *IDX, float64_t *weights)
 {
@@ -758,6 +994,11 @@ void CombinedKernel::init()
 	weight_update = false;
 	SG_ADD(&weight_update, "weight_update",
 	    "weight update");
+
+	subkernel_cache_size=0;
+	subkernel_cache_entries=0;
+	SG_ADD(&subkernel_cache_size, "subkernel_cache_size",
+	    "Size of the subkernel row cache in MB.");
 }
 
 void CombinedKernel::enable_subkernel_weight_learning()
@@ -17,6 +17,9 @@
 #include <shogun/features/Features.h>
 #include <shogun/features/CombinedFeatures.h>
 
+#include <unordered_map>
+#include <vector>
+
 namespace shogun
 {
 class Features;
@@ -367,6 +370,59 @@ class CombinedKernel : public Kernel
 		void compute_by_subkernel(
 			int32_t idx, float64_t * subkernel_contrib) override;
 
+		/** compute the combined kernel values between the lhs vectors lhs_idx
+		 * and the rhs vectors rhs_idx
+		 *
+		 * The block of every subkernel with non-zero weight is computed with
+		 * one call to its compute_block(), in parallel across the subkernels,
+		 * and the blocks are then summed up with the subkernel weights. Rows
+		 * of the subkernels are served from the subkernel row cache if it is
+		 * enabled (see set_subkernel_cache_size()).
+		 *
+		 * @param lhs_idx indices of lhs vectors
+		 * @param rhs_idx indices of rhs vectors
+		 * @param out preallocated lhs_idx.vlen x rhs_idx.vlen matrix
+		 */
+		void compute_block(
+			SGVector<index_t> lhs_idx, SGVector<index_t> rhs_idx,
+			SGMatrix<float64_t> out) override;
+
+		/** compute the quadratic forms
+		 * \f$\sum_{i,j}\alpha_i\alpha_j k_m({\bf x}_{idx_i}, {\bf x}_{idx_j})\f$
+		 * of all subkernels \f$k_m\f$ in a single pass, in parallel across
+		 * the subkernels. Subkernel weights are not applied. This is what MKL
+		 * needs to compute the subkernel norms in every iteration.
+		 *
+		 * @param idx indices of the vectors (e.g. support vectors)
+		 * @param alpha coefficients of the vectors
+		 * @return one quadratic form per kernel in the kernel array
+		 */
+		SGVector<float64_t> compute_subkernel_quadratic_forms(
+			SGVector<index_t> idx, SGVector<float64_t> alpha);
+
+		/** set the size of the subkernel row cache, which is shared by all
+		 * subkernels
+		 *
+		 * If enabled, compute_block() keeps whole rows of the (unweighted)
+		 * subkernels, so that repeated evaluations on the same vectors, e.g.
+		 * on the support vectors across MKL iterations, only cost a lookup.
+		 * Rows are kept until the cache is full, the features change, or
+		 * clear_subkernel_cache() is called. The cache has to be cleared
+		 * manually after parameters of a subkernel were changed.
+		 *
+		 * @param size cache size in MB (0 disables the cache)
+		 */
+		void set_subkernel_cache_size(int32_t size);
+
+		/** @return size of the subkernel row cache in MB */
+		int32_t get_subkernel_cache_size() const
+		{
+			return subkernel_cache_size;
+		}
+
+		/** drop all rows from the subkernel row cache */
+		void clear_subkernel_cache();
+
 		/** get subkernel weights
 		 *
 		 * @param num_weights where number of weights is stored
@@ -495,6 +551,18 @@ class CombinedKernel : public Kernel
 				initialized=false;
 		}
 
+		/** compute the block of a single subkernel, using the subkernel row
+		 * cache if it is enabled
+		 *
+		 * @param k_idx index of the subkernel in the kernel array
+		 * @param lhs_idx indices of lhs vectors
+		 * @param rhs_idx indices of rhs vectors
+		 * @param out preallocated lhs_idx.vlen x rhs_idx.vlen matrix
+		 */
+		void compute_subkernel_block(
+			index_t k_idx, const SGVector<index_t>& lhs_idx,
+			const SGVector<index_t>& rhs_idx, SGMatrix<float64_t>& out);
+
 	private:
 		void init();
 		/**
@@ -536,6 +604,27 @@ class CombinedKernel : public Kernel
 		bool enable_subkernel_weight_opt;
 		/** update the weight for subkernels */
 		bool weight_update;
+
+		/** size of the subkernel row cache in MB */
+		int32_t subkernel_cache_size;
+
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+		/** cached rows of one subkernel */
+		struct SUBKERNEL_ROWS
+		{
+			/** subkernel the rows belong to */
+			const Kernel* kernel = nullptr;
+			/** rows over all rhs vectors, by lhs index */
+			std::unordered_map<index_t, SGVector<float64_t>> rows;
+		};
+#endif
+
+		/** subkernel row cache, one entry per kernel in the kernel array */
+		std::vector<SUBKERNEL_ROWS> subkernel_rows;
+		/** number of entries held by the subkernel row cache */
+		int64_t subkernel_cache_entries;
+		/** guards the subkernel row cache */
+		Lock subkernel_cache_lock;
 };
 }
 #endif /* _COMBINEDKERNEL_H__ */
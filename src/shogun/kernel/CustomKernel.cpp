@@ -7,16 +7,32 @@
  */
 
 #include <shogun/lib/common.h>
+#include <shogun/base/progress.h>
 #include <shogun/kernel/CustomKernel.h>
 #include <shogun/features/Features.h>
 #include <shogun/features/DummyFeatures.h>
 #include <shogun/features/IndexFeatures.h>
+#include <shogun/io/MemoryMappedFile.h>
 #include <shogun/io/SGIO.h>
 #include <shogun/mathematics/linalg/LinalgNamespace.h>
 
 using namespace shogun;
 using namespace linalg;
 
+namespace
+{
+	/** number of kernel values computed at once when writing a kernel
+	 * matrix to a file */
+	const int64_t KM_FILE_BLOCK_SIZE=int64_t(1)<<24;
+
+	/** offset of element (row, col), row<=col, in the concatenated rows of
+	 * the upper triangle of a n x n matrix */
+	inline int64_t triangle_offset(int64_t row, int64_t col, int64_t n)
+	{
+		return row*n - row*(row+1)/2 + col;
+	}
+}
+
 void CustomKernel::init()
 {
 	m_row_subset_stack=std::make_shared<SubsetStack>();
@@ -355,6 +371,124 @@ SGVector<float64_t> CustomKernel::row_col_wise_sum_block(index_t
 	return sum;
 }
 
+bool CustomKernel::set_triangle_kernel_matrix_from_kernel(
+	const std::shared_ptr<Kernel>& k, const char* fname)
+{
+	if (m_row_subset_stack->has_subsets() || m_col_subset_stack->has_subsets())
+	{
+		error("{}::set_triangle_kernel_matrix_from_kernel not possible with "
+				"subset. Remove first", get_name());
+	}
+	require(k, "{}::set_triangle_kernel_matrix_from_kernel(): No kernel "
+			"given", get_name());
+	require(k->has_features(), "{}::set_triangle_kernel_matrix_from_kernel(): "
+			"{} has no features assigned", get_name(), k->get_name());
+
+	int64_t n=k->get_num_vec_lhs();
+	require(n==k->get_num_vec_rhs(), "{}::set_triangle_kernel_matrix_from_kernel(): "
+			"Kernel matrix must be square, but is {}x{}", get_name(), n,
+			k->get_num_vec_rhs());
+
+	cleanup_custom();
+	SG_DEBUG("writing custom kernel of size {}x{} to {}", n, n, fname)
+
+	{
+		int64_t size=n*(n+1)/2*sizeof(float32_t);
+		MemoryMappedFile<float32_t> file(fname, 'w', size);
+		file.set_truncate_size(size);
+		file.advise(MMAP_SEQUENTIAL);
+		float32_t* tri=file.get_map();
+
+		/* rows are computed in blocks from the diagonal on, so the file is
+		 * written front to back */
+		int64_t rows_per_block=Math::max(int64_t(1), KM_FILE_BLOCK_SIZE/n);
+		int64_t num_blocks=(n+rows_per_block-1)/rows_per_block;
+		auto pb=SG_PROGRESS(range(num_blocks));
+		for (int64_t b=0; b<num_blocks; b++)
+		{
+			index_t row_begin=b*rows_per_block;
+			SGVector<index_t> rows(Math::min(rows_per_block, n-row_begin));
+			SGVector<index_t> cols(n-row_begin);
+			rows.range_fill(row_begin);
+			cols.range_fill(row_begin);
+
+			SGMatrix<float64_t> block(rows.vlen, cols.vlen);
+			k->compute_block(rows, cols, block);
+
+			for (index_t i=0; i<rows.vlen; i++)
+			{
+				float32_t* row=tri+triangle_offset(rows[i], rows[i], n);
+				for (index_t j=i; j<cols.vlen; j++)
+					row[j-i]=block(i, j);
+			}
+			pb.print_progress();
+		}
+		pb.complete();
+	}
+
+	return set_triangle_kernel_matrix_from_file(fname);
+}
+
+bool CustomKernel::set_triangle_kernel_matrix_from_file(const char* fname)
+{
+	if (m_row_subset_stack->has_subsets() || m_col_subset_stack->has_subsets())
+	{
+		error("{}::set_triangle_kernel_matrix_from_file not possible with "
+				"subset. Remove first", get_name());
+	}
+
+	auto file=std::make_shared<MemoryMappedFile<float32_t>>(fname);
+	int64_t len=file->get_length();
+	int64_t cols=(int64_t)floor(-0.5 + std::sqrt(0.25 + 2 * len));
+	require(cols*(cols+1)/2==len && len*sizeof(float32_t)==file->get_size(),
+			"{}::set_triangle_kernel_matrix_from_file(): {} should contain "
+			"the upper triangle of a square matrix, with cols*(cols+1)/2 "
+			"elements", get_name(), fname);
+
+	cleanup_custom();
+	SG_DEBUG("using memory mapped custom kernel of size {}x{}", cols, cols)
+
+	m_kmatrix_file=file;
+	kmatrix=SGMatrix<float32_t>(file->get_map(), cols, cols, false);
+	upper_diagonal=true;
+
+	m_is_symmetric=true;
+	dummy_init(cols, cols);
+	return true;
+}
+
+void CustomKernel::compute_block(SGVector<index_t> lhs_idx,
+	SGVector<index_t> rhs_idx, SGMatrix<float64_t> out)
+{
+	if (m_kmatrix_file && upper_diagonal && rhs_idx.vlen)
+	{
+		/* entries (row, col>=row) of a row are stored contiguously, tell the
+		 * OS to read the requested part of each row ahead */
+		int64_t n=kmatrix.num_cols;
+		int64_t col_min=n;
+		int64_t col_max=-1;
+		for (auto j : rhs_idx)
+		{
+			int64_t col=m_col_subset_stack->subset_idx_conversion(j);
+			col_min=Math::min(col_min, col);
+			col_max=Math::max(col_max, col);
+		}
+
+		for (auto i : lhs_idx)
+		{
+			int64_t row=m_row_subset_stack->subset_idx_conversion(i);
+			int64_t first=Math::max(row, col_min);
+			if (first<=col_max)
+			{
+				m_kmatrix_file->advise(MMAP_WILLNEED,
+					triangle_offset(row, first, n), col_max-first+1);
+			}
+		}
+	}
+
+	Kernel::compute_block(lhs_idx, rhs_idx, out);
+}
+
 void CustomKernel::cleanup_custom()
 {
 	SG_TRACE("Entering");
@@ -362,6 +496,7 @@ void CustomKernel::cleanup_custom()
 	remove_all_col_subsets();
 
 	kmatrix=SGMatrix<float32_t>();
+	m_kmatrix_file=nullptr;
 	upper_diagonal=false;
 
 	SG_TRACE("Leaving");
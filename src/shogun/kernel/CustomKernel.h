@@ -17,6 +17,8 @@
 
 namespace shogun
 {
+template <class T> class MemoryMappedFile;
+
 /** @brief The Custom Kernel allows for custom user provided kernel matrices.
  *
  * For squared training matrices it allows to store only the upper triangle of
@@ -27,6 +29,11 @@ namespace shogun
  * The custom kernel supports subsets each on the rows and the columns. See
  * documentation in Features, Labels how this works. The interface is similar.
  *
+ * Kernel matrices which do not fit into memory can be precomputed into a file
+ * once with set_triangle_kernel_matrix_from_kernel() and be reused later with
+ * set_triangle_kernel_matrix_from_file(). The file is memory mapped, so only
+ * the pages that are accessed are loaded by the OS.
+ *
  *
  */
 class CustomKernel: public Kernel
@@ -316,6 +323,56 @@ class CustomKernel: public Kernel
 			return true;
 		}
 
+		/** set kernel matrix (only elements from upper triangle) by
+		 * computing it from a kernel into a file, which is memory mapped
+		 * afterwards. The file contains the concatenated rows of the upper
+		 * triangle, including the main diagonal, as 32bit floats, i.e. the
+		 * layout of set_triangle_kernel_matrix_from_triangle().
+		 *
+		 * The matrix is computed in blocks of rows via
+		 * Kernel::compute_block() and written sequentially, so neither the
+		 * matrix nor the file have to fit into memory.
+		 *
+		 * works NOT with subset
+		 *
+		 * @param k kernel with as many lhs as rhs vectors
+		 * @param fname name of the file to write
+		 * @return if setting was successful
+		 */
+		bool set_triangle_kernel_matrix_from_kernel(
+			const std::shared_ptr<Kernel>& k, const char* fname);
+
+		/** set kernel matrix (only elements from upper triangle) from a file
+		 * written by set_triangle_kernel_matrix_from_kernel(). The file is
+		 * memory mapped read-only instead of being loaded into memory.
+		 *
+		 * works NOT with subset
+		 *
+		 * @param fname name of the file to map
+		 * @return if setting was successful
+		 */
+		bool set_triangle_kernel_matrix_from_file(const char* fname);
+
+		/** @return whether the kernel matrix is memory mapped from a file */
+		bool is_memory_mapped() const
+		{
+			return m_kmatrix_file!=nullptr;
+		}
+
+		/** compute a block of the kernel matrix, see Kernel::compute_block.
+		 * For memory mapped kernel matrices, the contiguous parts of the
+		 * requested rows are prefetched before they are read.
+		 *
+		 * works with subset
+		 *
+		 * @param lhs_idx row indices
+		 * @param rhs_idx column indices
+		 * @param out preallocated lhs_idx.vlen x rhs_idx.vlen matrix
+		 */
+		void compute_block(
+			SGVector<index_t> lhs_idx, SGVector<index_t> rhs_idx,
+			SGMatrix<float64_t> out) override;
+
 		/**
 		 * Overrides the sum_symmetric_block method of Kernel to compute the
 		 * sum directly from the precomputed kernel matrix.
@@ -614,6 +671,9 @@ class CustomKernel: public Kernel
 
 		/** indicates whether kernel matrix is to be freed in destructor */
 		bool m_free_km;
+
+		/** file the kernel matrix is mapped from, if any */
+		std::shared_ptr<MemoryMappedFile<float32_t>> m_kmatrix_file;
 };
 
 }
@@ -12,6 +12,7 @@
 #include <shogun/lib/auto_initialiser.h>
 #include <shogun/lib/common.h>
 #include <shogun/mathematics/Math.h>
+#include <shogun/mathematics/eigen3.h>
 
 using namespace shogun;
 
@@ -112,6 +113,34 @@ float64_t GaussianKernel::compute(int32_t idx_a, int32_t idx_b)
 	return std::exp(-result);
 }
 
+void GaussianKernel::compute_block(SGVector<index_t> lhs_idx,
+	SGVector<index_t> rhs_idx, SGMatrix<float64_t> out)
+{
+	check_block(lhs_idx, rhs_idx, out);
+
+	// subclasses override compute() with a different function
+	SGVector<float64_t> lhs_sq_norms(lhs_idx.vlen);
+	SGVector<float64_t> rhs_sq_norms(rhs_idx.vlen);
+	if (get_kernel_type()!=K_GAUSSIAN || has_precomputed_distance() ||
+		!compute_dot_block(lhs_idx, rhs_idx, out, lhs_sq_norms, rhs_sq_norms))
+	{
+		ShiftInvariantKernel::compute_block(lhs_idx, rhs_idx, out);
+		return;
+	}
+
+	// same order of operations as EuclideanDistance::compute
+	for (index_t j=0; j<out.num_cols; j++)
+	{
+		float64_t* col=out.get_column_vector(j);
+		for (index_t i=0; i<out.num_rows; i++)
+			col[i]=lhs_sq_norms[i]+rhs_sq_norms[j]-2*col[i];
+	}
+
+	Eigen::Map<Eigen::ArrayXXd> eigen_out(out.matrix, out.num_rows, out.num_cols);
+	eigen_out=(eigen_out/(-get_width())).exp();
+	normalize_block(lhs_idx, rhs_idx, out);
+}
+
 void GaussianKernel::load_serializable_post() noexcept(false)
 {
 	Kernel::load_serializable_post();
@@ -136,6 +136,19 @@ public:
 	 */
 	SGMatrix<float64_t> get_parameter_gradient(Parameters::const_reference param, index_t index=-1) override;
 
+	/** compute a block of kernel values from the dot products and squared
+	 * norms of the features, computed with a single matrix product, using
+	 * \f$||{\bf x}-{\bf y}||^2 = {\bf x}\cdot{\bf x} - 2{\bf x}\cdot{\bf y}
+	 * + {\bf y}\cdot{\bf y}\f$, see Kernel::compute_block
+	 *
+	 * @param lhs_idx indices of lhs vectors
+	 * @param rhs_idx indices of rhs vectors
+	 * @param out preallocated lhs_idx.vlen x rhs_idx.vlen matrix
+	 */
+	void compute_block(
+		SGVector<index_t> lhs_idx, SGVector<index_t> rhs_idx,
+		SGMatrix<float64_t> out) override;
+
 	/** Can (optionally) be overridden to post-initialize some member
 	 * variables which are not PARAMETER::ADD'ed. Make sure that at first
 	 * the overridden method BASE_CLASS::LOAD_SERIALIZABLE_POST is called.
@@ -22,6 +22,10 @@
 #include <shogun/kernel/normalizer/KernelNormalizer.h>
 #include <shogun/kernel/normalizer/IdentityKernelNormalizer.h>
 #include <shogun/features/Features.h>
+#include <shogun/features/DenseFeatures.h>
+#include <shogun/features/SparseFeatures.h>
+#include <shogun/mathematics/eigen3.h>
+#include <shogun/mathematics/linalg/LinalgNamespace.h>
 
 #include <shogun/classifier/svm/SVM.h>
 
@@ -31,7 +35,9 @@
 #endif
 #include <shogun/mathematics/Math.h>
 
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 using namespace shogun;
 
@@ -207,8 +213,16 @@ void Kernel::kernel_cache_init(int32_t buffsize, bool regression_hack)
 		kernel_cache.max_elems=totdoc;
 	}
 
-	kernel_cache.elems=0;   // initialize cache
-	for(i=0;i<totdoc;i++) {
+	kernel_cache.num_shards=cache_num_shards;
+	if (kernel_cache.num_shards<=0)
+		kernel_cache.num_shards=env()->get_num_threads();
+	kernel_cache.num_shards=Math::clamp(kernel_cache.num_shards, 1,
+			Math::max(kernel_cache.max_elems, 1));
+	kernel_cache.shards=new KERNEL_CACHE_SHARD[kernel_cache.num_shards];
+	for (int32_t s=0; s<kernel_cache.num_shards; s++)
+		kernel_cache.shards[s].version=0;
+
+	for(i=0;i<totdoc;i++) {   // initialize cache
 		kernel_cache.index[i]=-1;
 		kernel_cache.lru[i]=0;
 	}
@@ -224,6 +238,106 @@ void Kernel::kernel_cache_init(int32_t buffsize, bool regression_hack)
 	}
 
 	kernel_cache.time=0;
+
+	kernel_cache_partition_shards(kernel_cache.max_elems);
+	reset_cache_statistics();
+}
+
+void Kernel::kernel_cache_partition_shards(int32_t num_lines)
+{
+	int32_t num_shards=kernel_cache.num_shards;
+	for (int32_t s=0; s<num_shards; s++)
+	{
+		KERNEL_CACHE_SHARD& shard=kernel_cache.shards[s];
+		shard.first_elem=(int32_t) (((int64_t) kernel_cache.max_elems)*s/num_shards);
+		shard.last_elem=(int32_t) (((int64_t) kernel_cache.max_elems)*(s+1)/num_shards);
+	}
+
+	/* cached rows keep their lines when the ranges change, so rows whose
+	 * line now belongs to another shard are moved into a free line of their
+	 * own shard, or dropped if it is full. A shard must only evict rows
+	 * whose lock it holds */
+	for (int32_t k=0; k<num_lines; k++)
+	{
+		int32_t row=kernel_cache.invindex[k];
+		if (row==-1)
+			continue;
+
+		KERNEL_CACHE_SHARD* owner=kernel_cache_shard(row);
+		if (k>=owner->first_elem && k<owner->last_elem)
+			continue;
+
+		int32_t line=-1;
+		for (int32_t i=owner->first_elem; i<owner->last_elem && line==-1; i++)
+		{
+			if (!kernel_cache.occu[i])
+				line=i;
+		}
+
+		if (line!=-1)
+		{
+			sg_memcpy(&kernel_cache.buffer[((KERNELCACHE_IDX) kernel_cache.activenum)*line],
+				&kernel_cache.buffer[((KERNELCACHE_IDX) kernel_cache.activenum)*k],
+				sizeof(KERNELCACHE_ELEM)*kernel_cache.activenum);
+			kernel_cache.occu[line]=1;
+			kernel_cache.invindex[line]=row;
+			kernel_cache.lru[line]=kernel_cache.lru[k];
+			kernel_cache.index[row]=line;
+		}
+		else
+			kernel_cache.index[row]=-1;
+
+		kernel_cache.occu[k]=0;
+		kernel_cache.invindex[k]=-1;
+	}
+
+	for (int32_t s=0; s<num_shards; s++)
+	{
+		KERNEL_CACHE_SHARD& shard=kernel_cache.shards[s];
+		shard.elems=0;
+		for (int32_t k=shard.first_elem; k<shard.last_elem; k++)
+		{
+			if (kernel_cache.occu[k])
+				shard.elems++;
+		}
+	}
+}
+
+int64_t Kernel::get_cache_hits() const
+{
+	int64_t hits=0;
+	for (int32_t s=0; s<kernel_cache.num_shards; s++)
+		hits+=kernel_cache.shards[s].hits.load(std::memory_order_relaxed);
+
+	return hits;
+}
+
+int64_t Kernel::get_cache_misses() const
+{
+	int64_t misses=0;
+	for (int32_t s=0; s<kernel_cache.num_shards; s++)
+		misses+=kernel_cache.shards[s].misses.load(std::memory_order_relaxed);
+
+	return misses;
+}
+
+int64_t Kernel::get_cache_evictions() const
+{
+	int64_t evictions=0;
+	for (int32_t s=0; s<kernel_cache.num_shards; s++)
+		evictions+=kernel_cache.shards[s].evictions.load(std::memory_order_relaxed);
+
+	return evictions;
+}
+
+void Kernel::reset_cache_statistics()
+{
+	for (int32_t s=0; s<kernel_cache.num_shards; s++)
+	{
+		kernel_cache.shards[s].hits=0;
+		kernel_cache.shards[s].misses=0;
+		kernel_cache.shards[s].evictions=0;
+	}
 }
 
 void Kernel::get_kernel_row(
@@ -236,11 +350,17 @@ void Kernel::get_kernel_row(
 	if (docnum>=num_vectors)
 		docnum=2*num_vectors-1-docnum;
 
-	/* is cached? */
-	if(kernel_cache.index[docnum] != -1)
+	KERNEL_CACHE_SHARD* shard=kernel_cache_shard(docnum);
+
+	/* is cached? the cached entries are copied without the shard lock, and
+	 * are only used if no row of the shard was changed meanwhile. The
+	 * others are computed after */
+	bool cached=false;
+	const uint64_t version=shard->version.load(std::memory_order_acquire);
+	const int32_t line=kernel_cache.index[docnum];
+	if (!(version & 1) && line != -1)
 	{
-		kernel_cache.lru[kernel_cache.index[docnum]]=kernel_cache.time; /* lru */
-		start=((KERNELCACHE_IDX) kernel_cache.activenum)*kernel_cache.index[docnum];
+		start=((KERNELCACHE_IDX) kernel_cache.activenum)*line;
 
 		if (full_line)
 		{
@@ -248,8 +368,6 @@ void Kernel::get_kernel_row(
 			{
 				if(kernel_cache.totdoc2active[j] >= 0)
 					buffer[j]=kernel_cache.buffer[start+kernel_cache.totdoc2active[j]];
-				else
-					buffer[j]=(float64_t) kernel(docnum, j);
 			}
 		}
 		else
@@ -258,26 +376,34 @@ void Kernel::get_kernel_row(
 			{
 				if(kernel_cache.totdoc2active[j] >= 0)
 					buffer[j]=kernel_cache.buffer[start+kernel_cache.totdoc2active[j]];
-				else
-				{
-					int32_t k=j;
-					if (k>=num_vectors)
-						k=2*num_vectors-1-k;
-					buffer[j]=(float64_t) kernel(docnum, k);
-				}
 			}
 		}
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+		cached=shard->version.load(std::memory_order_relaxed)==version;
+	}
+
+	if (cached)
+	{
+		shard->hits.fetch_add(1, std::memory_order_relaxed);
+		kernel_cache.lru[line]=kernel_cache.time; /* lru */
 	}
 	else
+		shard->misses.fetch_add(1, std::memory_order_relaxed);
+
+	if (full_line)
 	{
-		if (full_line)
+		for(j=0;j<get_num_vec_lhs();j++)
 		{
-			for(j=0;j<get_num_vec_lhs();j++)
+			if(!cached || kernel_cache.totdoc2active[j] < 0)
 				buffer[j]=(KERNELCACHE_ELEM) kernel(docnum, j);
 		}
-		else
+	}
+	else
+	{
+		for(i=0;(j=active2dnum[i])>=0;i++)
 		{
-			for(i=0;(j=active2dnum[i])>=0;i++)
+			if(!cached || kernel_cache.totdoc2active[j] < 0)
 			{
 				int32_t k=j;
 				if (k>=num_vectors)
@@ -290,6 +416,13 @@ void Kernel::get_kernel_row(
 
 
 // Fills cache for the row m
+// Safe to call concurrently: the row's shard is locked while the row is
+// allocated and filled, and its version tells readers of cached rows that
+// they may have read a changed row. Symmetric entries are copied from cached rows of
+// any shard while holding that shard's lock, so the rows can't be evicted
+// meanwhile. Other shards are only try-locked, as two threads filling rows
+// of each other's shards would deadlock otherwise, and the entries of a
+// busy shard are computed instead.
 void Kernel::cache_kernel_row(int32_t m)
 {
 	int32_t j,k,l;
@@ -300,32 +433,53 @@ void Kernel::cache_kernel_row(int32_t m)
 	if (m>=num_vectors)
 		m=2*num_vectors-1-m;
 
+	KERNEL_CACHE_SHARD* shard=kernel_cache_shard(m);
+	shard->lock.lock();
+
 	if(!kernel_cache_check(m))   // not cached yet
 	{
+		kernel_cache_begin_write(shard);
 		cache = kernel_cache_clean_and_malloc(m);
 		if(cache) {
 			l=kernel_cache.totdoc2active[m];
 
-			for(j=0;j<kernel_cache.activenum;j++)  // fill cache
+			// fill cache, the entries of each shard's rows in turn
+			for (int32_t s=0; s<kernel_cache.num_shards; s++)
 			{
-				k=kernel_cache.active2totdoc[j];
+				KERNEL_CACHE_SHARD* owner=&kernel_cache.shards[s];
+				bool locked=(owner==shard) || owner->lock.try_lock();
 
-				if((kernel_cache.index[k] != -1) && (l != -1) && (k != m)) {
-					cache[j]=kernel_cache.buffer[((KERNELCACHE_IDX) kernel_cache.activenum)
-						*kernel_cache.index[k]+l];
-				}
-				else
+				for(j=0;j<kernel_cache.activenum;j++)
 				{
-					if (k>=num_vectors)
-						k=2*num_vectors-1-k;
-
-					cache[j]=kernel(m, k);
+					k=kernel_cache.active2totdoc[j];
+					if (kernel_cache_shard(k)!=owner)
+						continue;
+
+					if(locked && (kernel_cache.index[k] != -1) && (l != -1) && (k != m)) {
+						cache[j]=kernel_cache.buffer[((KERNELCACHE_IDX) kernel_cache.activenum)
+							*kernel_cache.index[k]+l];
+					}
+					else
+					{
+						if (k>=num_vectors)
+							k=2*num_vectors-1-k;
+
+						cache[j]=kernel(m, k);
+					}
 				}
+
+				if (locked && owner!=shard)
+					owner->lock.unlock();
 			}
 		}
 		else
 			perror("Error: Kernel cache full! => increase cache size");
+		kernel_cache_end_write(shard);
 	}
+	else
+		shard->hits.fetch_add(1, std::memory_order_relaxed);
+
+	shard->lock.unlock();
 }
 
 
@@ -344,7 +498,8 @@ void* Kernel::cache_multiple_kernel_row_helper(void* p)
 		{
 			k=params->kernel_cache->active2totdoc[j];
 
-			if((params->kernel_cache->index[k] != -1) && (l != -1) && (!params->needs_computation[k])) {
+			if((params->kernel_cache->index[k] != -1) && (l != -1) && (!params->needs_computation[k])
+					&& params->locked_shards[k % params->kernel_cache->num_shards]) {
 				cache[j]=params->kernel_cache->buffer[((KERNELCACHE_IDX) params->kernel_cache->activenum)
 					*params->kernel_cache->index[k]+l];
 			}
@@ -356,9 +511,6 @@ void* Kernel::cache_multiple_kernel_row_helper(void* p)
 					cache[j]=params->kernel->kernel(m, k);
 				}
 		}
-
-		//now line m is cached
-		params->needs_computation[m]=0;
 	}
 	return NULL;
 }
@@ -378,15 +530,30 @@ void Kernel::cache_multiple_kernel_rows(int32_t* rows, int32_t num_rows)
 		// fill up kernel cache
 		int32_t* uncached_rows = SG_MALLOC(int32_t, num_rows);
 		KERNELCACHE_ELEM** cache = SG_MALLOC(KERNELCACHE_ELEM*, num_rows);
-		S_KTHREAD_PARAM params;
-		int32_t num_threads=nthreads-1;
 		int32_t num_vec=get_num_vec_lhs();
 		ASSERT(num_vec>0)
 		uint8_t* needs_computation=SG_CALLOC(uint8_t, num_vec);
 
-		int32_t step=0;
 		int32_t num=0;
-		int32_t end=0;
+
+		// the shards of the rows stay locked until the rows are filled, so
+		// that no line of them is recycled while it is read below. They are
+		// locked in order, as other calls may lock several shards too
+		int32_t num_shards=kernel_cache.num_shards;
+		uint8_t* locked_shards=SG_CALLOC(uint8_t, num_shards);
+		uint8_t* changed_shards=SG_CALLOC(uint8_t, num_shards);
+		for (int32_t i=0; i<num_rows; i++)
+		{
+			int32_t idx=rows[i];
+			if (idx>=num_vec)
+				idx=2*num_vec-1-idx;
+			locked_shards[idx % num_shards]=1;
+		}
+		for (int32_t s=0; s<num_shards; s++)
+		{
+			if (locked_shards[s])
+				kernel_cache.shards[s].lock.lock();
+		}
 
 		// allocate cachelines if necessary
 		for (int32_t i=0; i<num_rows; i++)
@@ -395,63 +562,69 @@ void Kernel::cache_multiple_kernel_rows(int32_t* rows, int32_t num_rows)
 			if (idx>=num_vec)
 				idx=2*num_vec-1-idx;
 
+			KERNEL_CACHE_SHARD* shard=kernel_cache_shard(idx);
 			if (kernel_cache_check(idx))
+			{
+				shard->hits.fetch_add(1, std::memory_order_relaxed);
 				continue;
+			}
+
+			if (!changed_shards[idx % num_shards])
+			{
+				kernel_cache_begin_write(shard);
+				changed_shards[idx % num_shards]=1;
+			}
 
 			needs_computation[idx]=1;
 			uncached_rows[num]=idx;
 			cache[num]= kernel_cache_clean_and_malloc(idx);
 
 			if (!cache[num])
+			{
+				for (int32_t s=0; s<num_shards; s++)
+				{
+					if (changed_shards[s])
+						kernel_cache_end_write(&kernel_cache.shards[s]);
+					if (locked_shards[s])
+						kernel_cache.shards[s].lock.unlock();
+				}
 				error("Kernel cache full! => increase cache size");
+			}
 
 			num++;
 		}
 
-		if (num>0)
+		// rows that are filled in this call are not copied from, and their
+		// shards' versions are odd until all of them are done, so none is
+		// read while it is being written
+		#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+		for (int32_t i=0; i<num; i++)
 		{
-			step = num/nthreads;
-
-			if (step<1)
-			{
-				num_threads=num-1;
-				step=1;
-			}
-
-			#pragma omp parallel for private(params)
-			for (int32_t t=0; t<num_threads; t++)
-			{
-				params.kernel = this;
-				params.kernel_cache = &kernel_cache;
-				params.cache = cache;
-				params.uncached_rows = uncached_rows;
-				params.needs_computation = needs_computation;
-				params.num_uncached = num;
-				params.start = t*step;
-				params.end = (t+1)*step;
-				params.num_vectors = get_num_vec_lhs();
-				end=params.end;
-
-				cache_multiple_kernel_row_helper(&params);
-			}
+			S_KTHREAD_PARAM params;
+			params.kernel = this;
+			params.kernel_cache = &kernel_cache;
+			params.cache = cache;
+			params.uncached_rows = uncached_rows;
+			params.needs_computation = needs_computation;
+			params.locked_shards = locked_shards;
+			params.num_uncached = num;
+			params.start = i;
+			params.end = i+1;
+			params.num_vectors = num_vec;
+
+			cache_multiple_kernel_row_helper(&params);
 		}
-		else
-			num_threads=-1;
-
 
-		S_KTHREAD_PARAM last_param;
-		last_param.kernel = this;
-		last_param.kernel_cache = &kernel_cache;
-		last_param.cache = cache;
-		last_param.uncached_rows = uncached_rows;
-		last_param.needs_computation = needs_computation;
-		last_param.start = end;
-		last_param.num_uncached = num;
-		last_param.end = num;
-		last_param.num_vectors = get_num_vec_lhs();
-
-		cache_multiple_kernel_row_helper(&last_param);
+		for (int32_t s=0; s<num_shards; s++)
+		{
+			if (changed_shards[s])
+				kernel_cache_end_write(&kernel_cache.shards[s]);
+			if (locked_shards[s])
+				kernel_cache.shards[s].lock.unlock();
+		}
 
+		SG_FREE(changed_shards);
+		SG_FREE(locked_shards);
 		SG_FREE(needs_computation);
 		SG_FREE(cache);
 		SG_FREE(uncached_rows);
@@ -468,6 +641,9 @@ void Kernel::kernel_cache_shrink(
 	KERNELCACHE_IDX from=0,to=0;
 	int32_t *keep;
 
+	// lines in use before the shrink, the number of lines changes below
+	int32_t num_lines=kernel_cache.max_elems;
+
 	keep=SG_MALLOC(int32_t, totdoc);
 	for(j=0;j<totdoc;j++) {
 		keep[j]=1;
@@ -515,6 +691,8 @@ void Kernel::kernel_cache_shrink(
 	if(kernel_cache.max_elems>totdoc)
 		kernel_cache.max_elems=totdoc;
 
+	kernel_cache_partition_shards(Math::max(num_lines, kernel_cache.max_elems));
+
 	SG_FREE(keep);
 
 }
@@ -541,39 +719,38 @@ void Kernel::kernel_cache_cleanup()
 	SG_FREE(kernel_cache.active2totdoc);
 	SG_FREE(kernel_cache.totdoc2active);
 	SG_FREE(kernel_cache.buffer);
+	delete[] kernel_cache.shards;
 	memset(&kernel_cache, 0x0, sizeof(KERNEL_CACHE));
 }
 
-int32_t Kernel::kernel_cache_malloc()
+int32_t Kernel::kernel_cache_malloc(KERNEL_CACHE_SHARD* shard)
 {
-  int32_t i;
-
-  if(kernel_cache_space_available()) {
-    for(i=0;i<kernel_cache.max_elems;i++) {
-      if(!kernel_cache.occu[i]) {
-	kernel_cache.occu[i]=1;
-	kernel_cache.elems++;
-	return(i);
-      }
-    }
-  }
-  return(-1);
+	for (int32_t i=shard->first_elem; i<shard->last_elem; i++)
+	{
+		if (!kernel_cache.occu[i])
+		{
+			kernel_cache.occu[i]=1;
+			shard->elems++;
+			return(i);
+		}
+	}
+	return(-1);
 }
 
-void Kernel::kernel_cache_free(int32_t cacheidx)
+void Kernel::kernel_cache_free(KERNEL_CACHE_SHARD* shard, int32_t cacheidx)
 {
 	kernel_cache.occu[cacheidx]=0;
-	kernel_cache.elems--;
+	shard->elems--;
 }
 
 // remove least recently used cache
-// element
-int32_t Kernel::kernel_cache_free_lru()
+// element of a shard
+int32_t Kernel::kernel_cache_free_lru(KERNEL_CACHE_SHARD* shard)
 {
   int32_t k,least_elem=-1,least_time;
 
   least_time=kernel_cache.time+1;
-  for(k=0;k<kernel_cache.max_elems;k++) {
+  for(k=shard->first_elem;k<shard->last_elem;k++) {
     if(kernel_cache.invindex[k] != -1) {
       if(kernel_cache.lru[k]<least_time) {
 	least_time=kernel_cache.lru[k];
@@ -583,31 +760,35 @@ int32_t Kernel::kernel_cache_free_lru()
   }
 
   if(least_elem != -1) {
-    kernel_cache_free(least_elem);
+    kernel_cache_free(shard, least_elem);
     kernel_cache.index[kernel_cache.invindex[least_elem]]=-1;
     kernel_cache.invindex[least_elem]=-1;
+    shard->evictions.fetch_add(1, std::memory_order_relaxed);
     return(1);
   }
   return(0);
 }
 
-// Get a free cache entry. In case cache is full, the lru
-// element is removed.
+// Get a free cache entry. In case the shard of cacheidx is full, its lru
+// element is removed. The caller must hold the shard's lock.
 KERNELCACHE_ELEM* Kernel::kernel_cache_clean_and_malloc(int32_t cacheidx)
 {
 	int32_t result;
-	if((result = kernel_cache_malloc()) == -1) {
-		if(kernel_cache_free_lru()) {
-			result = kernel_cache_malloc();
+	KERNEL_CACHE_SHARD* shard=kernel_cache_shard(cacheidx);
+	shard->misses.fetch_add(1, std::memory_order_relaxed);
+
+	if((result = kernel_cache_malloc(shard)) == -1) {
+		if(kernel_cache_free_lru(shard)) {
+			result = kernel_cache_malloc(shard);
 		}
 	}
-	kernel_cache.index[cacheidx]=result;
 	if(result == -1) {
 		return(0);
 	}
 	kernel_cache.invindex[result]=cacheidx;
-	kernel_cache.lru[kernel_cache.index[cacheidx]]=kernel_cache.time; // lru
-	return &kernel_cache.buffer[((KERNELCACHE_IDX) kernel_cache.activenum)*kernel_cache.index[cacheidx]];
+	kernel_cache.lru[result]=kernel_cache.time; // lru
+	kernel_cache.index[cacheidx]=result;
+	return &kernel_cache.buffer[((KERNELCACHE_IDX) kernel_cache.activenum)*result];
 }
 #endif //USE_SVMLIGHT
 
@@ -919,6 +1100,8 @@ void Kernel::save_serializable_post() noexcept(false)
 void Kernel::register_params()
 {
 	SG_ADD(&cache_size, "cache_size", "Cache size in MB.");
+	SG_ADD(&cache_num_shards, "cache_num_shards",
+		"Number of kernel cache shards, 0 for one per thread.");
 	SG_ADD(
 		&lhs, "lhs", "Feature vectors to occur on left hand side.",
 		ParameterProperties::READONLY);
@@ -962,6 +1145,7 @@ void Kernel::init()
 	opt_type=FASTBUTMEMHUNGRY;
 	properties=KP_NONE;
 	normalizer=NULL;
+	cache_num_shards=0;
 
 #ifdef USE_SVMLIGHT
 	memset(&kernel_cache, 0x0, sizeof(KERNEL_CACHE));
@@ -970,34 +1154,6 @@ void Kernel::init()
 	set_normalizer(std::make_shared<IdentityKernelNormalizer>());
 }
 
-namespace shogun
-{
-/** kernel thread parameters */
-template <class T> struct K_THREAD_PARAM
-{
-	/** kernel */
-	Kernel* kernel;
-	/** start (unit row) */
-	int32_t start;
-	/** end (unit row) */
-	int32_t end;
-	/** start (unit number of elements) */
-	int64_t total_start;
-	/** m */
-	int32_t m;
-	/** n */
-	int32_t n;
-	/** result */
-	T* result;
-	/** kernel matrix k(i,j)=k(j,i) */
-	bool symmetric;
-	/** output progress */
-	bool verbose;
-	/* Progress bar*/
-	PRange<int64_t>* pb;
-};
-}
-
 float64_t Kernel::sum_symmetric_block(index_t block_begin, index_t block_size,
 		bool no_diag)
 {
@@ -1261,119 +1417,273 @@ SGVector<float64_t> Kernel::row_col_wise_sum_block(index_t block_begin_row,
 	return sum;
 }
 
-template <class T> void* Kernel::get_kernel_matrix_helper(void* p)
+namespace
 {
-	K_THREAD_PARAM<T>* params= (K_THREAD_PARAM<T>*) p;
-	int32_t i_start=params->start;
-	int32_t i_end=params->end;
-	Kernel* k=params->kernel;
-	T* result=params->result;
-	bool symmetric=params->symmetric;
-	int32_t n=params->n;
-	int32_t m=params->m;
-	bool verbose=params->verbose;
-	int64_t total_start=params->total_start;
-	int64_t total=total_start;
-	PRange<int64_t>* pb = params->pb;
-
-	for (int32_t i=i_start; i<i_end; i++)
+	/** number of rows and columns of a tile in get_kernel_matrix */
+	const index_t KERNEL_TILE_SIZE=256;
+
+	/** whether idx is begin, begin+1, ... */
+	bool is_range(const SGVector<index_t>& idx)
 	{
-		int32_t j_start=0;
+		for (index_t i=1; i<idx.vlen; i++)
+		{
+			if (idx[i]!=idx[0]+i)
+				return false;
+		}
+		return true;
+	}
 
-		if (symmetric)
-			j_start=i;
+	/** get the feature vectors idx as a matrix, without a copy if they are
+	 * stored contiguously */
+	SGMatrix<float64_t> gather_dense(
+		const std::shared_ptr<DenseFeatures<float64_t>>& feats,
+		const SGVector<index_t>& idx)
+	{
+		int32_t num_feat;
+		int32_t num_vec;
+		float64_t* matrix=feats->get_feature_matrix(num_feat, num_vec);
+		if (matrix && idx.vlen && is_range(idx)
+			&& !feats->get_subset_stack()->has_subsets()
+			&& !feats->get_num_preprocessors())
+		{
+			return SGMatrix<float64_t>(
+				matrix+int64_t(num_feat)*idx[0], num_feat, idx.vlen, false);
+		}
 
-		for (int32_t j=j_start; j<n; j++)
+		SGMatrix<float64_t> gathered(feats->get_num_features(), idx.vlen);
+		for (index_t i=0; i<idx.vlen; i++)
 		{
-			float64_t v=k->kernel(i,j);
-			result[i+j*m]=v;
+			int32_t len;
+			bool do_free;
+			float64_t* vec=feats->get_feature_vector(idx[i], len, do_free);
+			ASSERT(len==gathered.num_rows)
+			sg_memcpy(gathered.get_column_vector(i), vec,
+				len*sizeof(float64_t));
+			feats->free_feature_vector(vec, idx[i], do_free);
+		}
+		return gathered;
+	}
 
-			if (symmetric && i!=j)
-				result[j+i*m]=v;
+	/** dense buffer of a thread to scatter sparse vectors into, all
+	 * entries are zero between uses */
+	std::vector<float64_t>& scatter_buffer(int32_t dim)
+	{
+		thread_local std::vector<float64_t> buffer;
+		if (buffer.size()<size_t(dim))
+			buffer.resize(dim, 0.0);
+		return buffer;
+	}
+
+	/** dot products between sparse vectors. Every lhs vector is scattered
+	 * into a dense buffer once, against which the rhs vectors are gathered,
+	 * so each dot product costs only the number of rhs entries. */
+	void sparse_dot_block(
+		const std::shared_ptr<SparseFeatures<float64_t>>& l,
+		const SGVector<index_t>& lhs_idx,
+		const std::shared_ptr<SparseFeatures<float64_t>>& r,
+		const SGVector<index_t>& rhs_idx, SGMatrix<float64_t>& block)
+	{
+		// rhs indices are looked up in the buffer as well
+		const int32_t dim=std::max(l->get_num_features(), r->get_num_features());
+		// few lhs vectors (a kernel row) are spread over the rhs instead
+		const bool parallel_lhs=lhs_idx.vlen>=env()->get_num_threads();
+
+#pragma omp parallel for if(parallel_lhs)
+		for (index_t i=0; i<lhs_idx.vlen; i++)
+		{
+			auto& buffer=scatter_buffer(dim);
+			auto lvec=l->get_sparse_feature_vector(lhs_idx[i]);
+			lvec.add_to_dense(1.0, buffer.data(), dim);
 
-			if (verbose)
+#pragma omp parallel for if(!parallel_lhs)
+			for (index_t j=0; j<rhs_idx.vlen; j++)
 			{
-				total++;
+				auto rvec=r->get_sparse_feature_vector(rhs_idx[j]);
+				block(i, j)=rvec.dense_dot(1.0, buffer.data(), dim, 0.0);
+				r->free_sparse_feature_vector(rhs_idx[j]);
+			}
 
-				if (symmetric && i!=j)
-					total++;
+			for (index_t k=0; k<lvec.num_feat_entries; k++)
+				buffer[lvec.features[k].feat_index]=0.0;
+			l->free_sparse_feature_vector(lhs_idx[i]);
+		}
+	}
 
-				pb->print_progress();
+	/** squared norms of sparse feature vectors */
+	void sparse_sq_norms(
+		const std::shared_ptr<SparseFeatures<float64_t>>& feats,
+		const SGVector<index_t>& idx, SGVector<float64_t>& sq_norms)
+	{
+		for (index_t i=0; i<idx.vlen; i++)
+		{
+			auto vec=feats->get_sparse_feature_vector(idx[i]);
+			float64_t sq_norm=0;
+			for (index_t k=0; k<vec.num_feat_entries; k++)
+				sq_norm+=vec.features[k].entry*vec.features[k].entry;
+			sq_norms[i]=sq_norm;
+			feats->free_sparse_feature_vector(idx[i]);
+		}
+	}
+}
 
-				// TODO: replace with the new signal
-				// if (Signal::cancel_computations())
-				//	break;
-			}
+void Kernel::check_block(const SGVector<index_t>& lhs_idx,
+	const SGVector<index_t>& rhs_idx, const SGMatrix<float64_t>& out) const
+{
+	require(out.num_rows==lhs_idx.vlen && out.num_cols==rhs_idx.vlen,
+		"Output matrix ({}x{}) must be of size {}x{}", out.num_rows,
+		out.num_cols, lhs_idx.vlen, rhs_idx.vlen);
+
+	for (auto i : lhs_idx)
+	{
+		require(i>=0 && i<num_lhs, "{}::compute_block(): lhs index {} out "
+			"of range [0, {})", get_name(), i, num_lhs);
+	}
+	for (auto j : rhs_idx)
+	{
+		require(j>=0 && j<num_rhs, "{}::compute_block(): rhs index {} out "
+			"of range [0, {})", get_name(), j, num_rhs);
+	}
+}
+
+void Kernel::compute_block(SGVector<index_t> lhs_idx,
+	SGVector<index_t> rhs_idx, SGMatrix<float64_t> out)
+{
+	check_block(lhs_idx, rhs_idx, out);
+
+#pragma omp parallel for
+	for (index_t j=0; j<rhs_idx.vlen; j++)
+	{
+		for (index_t i=0; i<lhs_idx.vlen; i++)
+		{
+			out(i, j)=normalizer->normalize(
+				compute(lhs_idx[i], rhs_idx[j]), lhs_idx[i], rhs_idx[j]);
 		}
+	}
+}
+
+void Kernel::normalize_block(const SGVector<index_t>& lhs_idx,
+	const SGVector<index_t>& rhs_idx, SGMatrix<float64_t>& block)
+{
+	if (std::dynamic_pointer_cast<IdentityKernelNormalizer>(normalizer))
+		return;
 
+	for (index_t j=0; j<rhs_idx.vlen; j++)
+	{
+		for (index_t i=0; i<lhs_idx.vlen; i++)
+		{
+			block(i, j)=normalizer->normalize(
+				block(i, j), lhs_idx[i], rhs_idx[j]);
+		}
 	}
+}
 
-	return NULL;
+bool Kernel::compute_dot_block(const SGVector<index_t>& lhs_idx,
+	const SGVector<index_t>& rhs_idx, SGMatrix<float64_t>& block,
+	SGVector<float64_t> lhs_sq_norms, SGVector<float64_t> rhs_sq_norms)
+{
+	auto l_sparse=std::dynamic_pointer_cast<SparseFeatures<float64_t>>(lhs);
+	auto r_sparse=std::dynamic_pointer_cast<SparseFeatures<float64_t>>(rhs);
+	if (l_sparse && r_sparse)
+	{
+		sparse_dot_block(l_sparse, lhs_idx, r_sparse, rhs_idx, block);
+		if (lhs_sq_norms.vlen)
+			sparse_sq_norms(l_sparse, lhs_idx, lhs_sq_norms);
+		if (rhs_sq_norms.vlen)
+			sparse_sq_norms(r_sparse, rhs_idx, rhs_sq_norms);
+		return true;
+	}
+
+	auto l=std::dynamic_pointer_cast<DenseFeatures<float64_t>>(lhs);
+	auto r=std::dynamic_pointer_cast<DenseFeatures<float64_t>>(rhs);
+	if (!l || !r)
+		return false;
+
+	SGMatrix<float64_t> l_block=gather_dense(l, lhs_idx);
+	SGMatrix<float64_t> r_block;
+	if (l==r && lhs_idx.equals(rhs_idx))
+		r_block=l_block;
+	else
+		r_block=gather_dense(r, rhs_idx);
+
+	linalg::matrix_prod(l_block, r_block, block, true, false);
+
+	if (lhs_sq_norms.vlen)
+	{
+		Eigen::Map<Eigen::MatrixXd> eigen_l(
+			l_block.matrix, l_block.num_rows, l_block.num_cols);
+		Eigen::Map<Eigen::RowVectorXd> eigen_norms(
+			lhs_sq_norms.vector, lhs_sq_norms.vlen);
+		eigen_norms=eigen_l.colwise().squaredNorm();
+	}
+	if (rhs_sq_norms.vlen)
+	{
+		Eigen::Map<Eigen::MatrixXd> eigen_r(
+			r_block.matrix, r_block.num_rows, r_block.num_cols);
+		Eigen::Map<Eigen::RowVectorXd> eigen_norms(
+			rhs_sq_norms.vector, rhs_sq_norms.vlen);
+		eigen_norms=eigen_r.colwise().squaredNorm();
+	}
+
+	return true;
 }
 
 template <class T>
 SGMatrix<T> Kernel::get_kernel_matrix()
 {
-	T* result = NULL;
-
 	require(has_features(), "no features assigned to kernel");
 
 	int32_t m=get_num_vec_lhs();
 	int32_t n=get_num_vec_rhs();
 
-	int64_t total_num = int64_t(m)*n;
-
 	// if lhs == rhs and sizes match assume k(i,j)=k(j,i)
 	bool symmetric= (lhs && lhs==rhs && m==n);
 
 	SG_DEBUG("returning kernel matrix of size {}x{}", m, n)
 
-	result=SG_MALLOC(T, total_num);
+	SGMatrix<T> result(m, n);
 
-	int32_t num_threads=env()->get_num_threads();
-	K_THREAD_PARAM<T> params;
-	int64_t step = total_num/num_threads;
-	index_t t = 0;
-	auto pb = SG_PROGRESS(range(total_num));
-#pragma omp parallel for lastprivate(t) private(params)
-	for (t = 0; t < num_threads; ++t)
-	{
-		params.kernel = this;
-		params.result = result;
-		params.start = compute_row_start(t*step, n, symmetric);
-		params.end = compute_row_start((t+1)*step, n, symmetric);
-		params.total_start=t*step;
-		params.n=n;
-		params.m=m;
-		params.symmetric=symmetric;
-		params.verbose=false;
-		params.pb = &pb;
-		Kernel::get_kernel_matrix_helper<T>((void*)&params);
-	}
+	// the matrix is computed in tiles through compute_block, for symmetric
+	// matrices only the tiles on and above the diagonal
+	const index_t num_row_tiles=(m+KERNEL_TILE_SIZE-1)/KERNEL_TILE_SIZE;
+	const index_t num_col_tiles=(n+KERNEL_TILE_SIZE-1)/KERNEL_TILE_SIZE;
+	const int64_t num_tiles=int64_t(num_row_tiles)*num_col_tiles;
 
-	if (total_num % num_threads != 0)
+	auto pb=SG_PROGRESS(range(num_tiles));
+#pragma omp parallel for schedule(dynamic)
+	for (int64_t t=0; t<num_tiles; t++)
 	{
-		params.kernel = this;
-		params.result = result;
-		params.start = compute_row_start(t*step, n, symmetric);
-		params.end = m;
-		params.total_start=t*step;
-		params.n=n;
-		params.m=m;
-		params.symmetric=symmetric;
-		params.verbose=false;
-		params.pb = &pb;
-		Kernel::get_kernel_matrix_helper<T>((void*)&params);
+		index_t row_tile=t/num_col_tiles;
+		index_t col_tile=t%num_col_tiles;
+		if (symmetric && col_tile<row_tile)
+			continue;
+
+		index_t row_begin=row_tile*KERNEL_TILE_SIZE;
+		index_t col_begin=col_tile*KERNEL_TILE_SIZE;
+		SGVector<index_t> rows(Math::min(KERNEL_TILE_SIZE, m-row_begin));
+		SGVector<index_t> cols(Math::min(KERNEL_TILE_SIZE, n-col_begin));
+		rows.range_fill(row_begin);
+		cols.range_fill(col_begin);
+
+		SGMatrix<float64_t> block(rows.vlen, cols.vlen);
+		compute_block(rows, cols, block);
+
+		bool mirror=symmetric && col_tile!=row_tile;
+		for (index_t j=0; j<cols.vlen; j++)
+		{
+			for (index_t i=0; i<rows.vlen; i++)
+			{
+				result(row_begin+i, col_begin+j)=block(i, j);
+				if (mirror)
+					result(col_begin+j, row_begin+i)=block(i, j);
+			}
+		}
+		pb.print_progress();
 	}
-
 	pb.complete();
 
-	return SGMatrix<T>(result,m,n,true);
+	return result;
 }
 
 
 template SGMatrix<float64_t> Kernel::get_kernel_matrix<float64_t>();
 template SGMatrix<float32_t> Kernel::get_kernel_matrix<float32_t>();
-
-template void* Kernel::get_kernel_matrix_helper<float64_t>(void* p);
-template void* Kernel::get_kernel_matrix_helper<float32_t>(void* p);
@@ -20,8 +20,11 @@
 #include <shogun/features/FeatureTypes.h>
 #include <shogun/base/SGObject.h>
 #include <shogun/lib/SGMatrix.h>
+#include <shogun/lib/Lock.h>
 #include <shogun/features/Features.h>
 
+#include <atomic>
+
 namespace shogun
 {
 	class File;
@@ -435,6 +438,21 @@ class Kernel : public SGObject
 		 */
 		template <class T> SGMatrix<T> get_kernel_matrix();
 
+		/** compute the kernel values between the lhs vectors lhs_idx and the
+		 * rhs vectors rhs_idx, i.e. out(i, j)=kernel(lhs_idx[i], rhs_idx[j])
+		 *
+		 * The base implementation evaluates the entries one by one in
+		 * parallel. Kernels which can compute many entries at once (e.g.
+		 * with a matrix product) override it.
+		 *
+		 * @param lhs_idx indices of lhs vectors
+		 * @param rhs_idx indices of rhs vectors
+		 * @param out preallocated lhs_idx.vlen x rhs_idx.vlen matrix
+		 */
+		virtual void compute_block(
+			SGVector<index_t> lhs_idx, SGVector<index_t> rhs_idx,
+			SGMatrix<float64_t> out);
+
 		/** initialize kernel
 		 *  e.g. setup lhs/rhs of kernel, precompute normalization
 		 *  constants etc.
@@ -584,6 +602,30 @@ class Kernel : public SGObject
 		 */
 		inline int32_t get_cache_size() { return cache_size; }
 
+		/** set the number of shards the kernel cache is split into
+		 *
+		 * Each shard owns a contiguous range of cache lines and has its own
+		 * lock and LRU eviction, so rows that map to different shards can be
+		 * filled concurrently. 0 chooses one shard per thread.
+		 *
+		 * @param num_shards number of shards (0 for auto)
+		 */
+		inline void set_cache_num_shards(int32_t num_shards)
+		{
+			require(num_shards >= 0, "Number of cache shards ({}) must be "
+				"non-negative", num_shards);
+			cache_num_shards = num_shards;
+#ifdef USE_SVMLIGHT
+			cache_reset();
+#endif //USE_SVMLIGHT
+		}
+
+		/** get the number of shards of the kernel cache
+		 *
+		 * @return number of shards (0 for auto)
+		 */
+		inline int32_t get_cache_num_shards() const { return cache_num_shards; }
+
 #ifdef USE_SVMLIGHT
 		/** cache reset */
 		inline void cache_reset() { resize_kernel_cache(cache_size); }
@@ -600,6 +642,27 @@ class Kernel : public SGObject
 		 */
 		inline int32_t get_activenum_cache() { return kernel_cache.activenum; }
 
+		/** get number of kernel rows that were served from the cache
+		 *
+		 * @return number of cache hits
+		 */
+		int64_t get_cache_hits() const;
+
+		/** get number of kernel rows that had to be computed
+		 *
+		 * @return number of cache misses
+		 */
+		int64_t get_cache_misses() const;
+
+		/** get number of kernel rows that were evicted from the cache
+		 *
+		 * @return number of cache evictions
+		 */
+		int64_t get_cache_evictions() const;
+
+		/** reset hit/miss/eviction counters of the kernel cache */
+		void reset_cache_statistics();
+
 		/** get kernel row
 		 *
 		 * @param docnum docnum
@@ -684,7 +747,11 @@ class Kernel : public SGObject
 		 */
 		inline int32_t kernel_cache_space_available()
 		{
-			return(kernel_cache.elems < kernel_cache.max_elems);
+			int32_t elems=0;
+			for (int32_t s=0; s<kernel_cache.num_shards; s++)
+				elems+=kernel_cache.shards[s].elems;
+
+			return(elems < kernel_cache.max_elems);
 		}
 
 		/** initialize kernel cache
@@ -903,30 +970,48 @@ class Kernel : public SGObject
 		 */
 		virtual float64_t compute(int32_t x, int32_t y)=0;
 
-		/** compute row start offset for parallel kernel matrix computation
+		/** compute the dot products between the lhs vectors lhs_idx and the
+		 * rhs vectors rhs_idx with a single matrix product
 		 *
-		 * @param offs offset
-		 * @param n number of columns
-		 * @param symmetric whether matrix is symmetric
+		 * Supported are DenseFeatures<float64_t> and
+		 * SparseFeatures<float64_t> on both sides.
+		 *
+		 * @param lhs_idx indices of lhs vectors
+		 * @param rhs_idx indices of rhs vectors
+		 * @param block lhs_idx.vlen x rhs_idx.vlen matrix to fill with the
+		 * dot products
+		 * @param lhs_sq_norms if not empty, filled with the squared norms of
+		 * the lhs vectors
+		 * @param rhs_sq_norms if not empty, filled with the squared norms of
+		 * the rhs vectors
+		 * @return false if the features are not supported
 		 */
-		int32_t compute_row_start(int64_t offs, int32_t n, bool symmetric)
-		{
-			int32_t i_start;
+		bool compute_dot_block(
+			const SGVector<index_t>& lhs_idx, const SGVector<index_t>& rhs_idx,
+			SGMatrix<float64_t>& block,
+			SGVector<float64_t> lhs_sq_norms=SGVector<float64_t>(),
+			SGVector<float64_t> rhs_sq_norms=SGVector<float64_t>());
 
-			if (symmetric)
-				i_start = (int32_t)Math::floor(
-				    n - std::sqrt(Math::sq((float64_t)n) - offs));
-			else
-				i_start=(int32_t) (offs/int64_t(n));
-
-			return i_start;
-		}
+		/** apply the kernel normalizer to a block of kernel values computed
+		 * with compute() semantics, does nothing for the identity normalizer
+		 *
+		 * @param lhs_idx indices of lhs vectors
+		 * @param rhs_idx indices of rhs vectors
+		 * @param block block of kernel values
+		 */
+		void normalize_block(
+			const SGVector<index_t>& lhs_idx, const SGVector<index_t>& rhs_idx,
+			SGMatrix<float64_t>& block);
 
-		/** helper for computing the kernel matrix in a parallel way
+		/** check that the indices and output of compute_block() are valid
 		 *
-		 * @param p thread parameters
+		 * @param lhs_idx indices of lhs vectors
+		 * @param rhs_idx indices of rhs vectors
+		 * @param out output matrix
 		 */
-		template <class T> static void* get_kernel_matrix_helper(void* p);
+		void check_block(
+			const SGVector<index_t>& lhs_idx, const SGVector<index_t>& rhs_idx,
+			const SGMatrix<float64_t>& out) const;
 
 		/** Can (optionally) be overridden to post-initialize some member
 		 *  variables which are not PARAMETER::ADD'ed.  Make sure that at
@@ -972,6 +1057,28 @@ class Kernel : public SGObject
 
 #ifdef USE_SVMLIGHT
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
+		/** part of the kernel cache with its own lock and LRU eviction */
+		struct KERNEL_CACHE_SHARD {
+			/** guards allocation and eviction of the shard's cache lines */
+			Lock lock;
+			/** first cache line owned by this shard */
+			int32_t first_elem;
+			/** one past the last cache line owned by this shard */
+			int32_t last_elem;
+			/** occupied cache lines */
+			int32_t elems;
+			/** odd while the shard's rows are changed under the lock.
+			 * Cached rows are read without the lock, and the read is
+			 * only used if the version was even and did not change */
+			std::atomic<uint64_t> version;
+			/** hits, counted without holding the lock */
+			std::atomic<int64_t> hits;
+			/** misses */
+			std::atomic<int64_t> misses;
+			/** evictions */
+			std::atomic<int64_t> evictions;
+		};
+
 		/**@ cache kernel evalutations to improve speed */
 		struct KERNEL_CACHE {
 			/** index */
@@ -986,8 +1093,6 @@ class Kernel : public SGObject
 			int32_t   *lru;
 			/** occu */
 			int32_t   *occu;
-			/** elements */
-			int32_t   elems;
 			/** max elements */
 			int32_t   max_elems;
 			/** time */
@@ -999,6 +1104,11 @@ class Kernel : public SGObject
 			KERNELCACHE_ELEM  *buffer;
 			/** buffer size */
 			KERNELCACHE_IDX   buffsize;
+
+			/** number of shards */
+			int32_t   num_shards;
+			/** shards, row i lives in shard i % num_shards */
+			KERNEL_CACHE_SHARD *shards;
 		};
 
 		/** kernel thread parameters */
@@ -1016,6 +1126,8 @@ class Kernel : public SGObject
 			int32_t num_uncached;
 			/** needs computation */
 			uint8_t* needs_computation;
+			/** shards whose lock is held, only their rows are read */
+			uint8_t* locked_shards;
 			/** start */
 			int32_t start;
 			/** end */
@@ -1029,10 +1141,40 @@ class Kernel : public SGObject
 		static void* cache_multiple_kernel_row_helper(void* p);
 
 		/// init kernel cache of size megabytes
-		void   kernel_cache_free(int32_t cacheidx);
-		int32_t   kernel_cache_malloc();
-		int32_t   kernel_cache_free_lru();
+		void   kernel_cache_free(KERNEL_CACHE_SHARD* shard, int32_t cacheidx);
+		int32_t   kernel_cache_malloc(KERNEL_CACHE_SHARD* shard);
+		int32_t   kernel_cache_free_lru(KERNEL_CACHE_SHARD* shard);
 		KERNELCACHE_ELEM *kernel_cache_clean_and_malloc(int32_t cacheidx);
+
+		/// shard that row cacheidx belongs to
+		inline KERNEL_CACHE_SHARD* kernel_cache_shard(int32_t cacheidx)
+		{
+			return &kernel_cache.shards[cacheidx % kernel_cache.num_shards];
+		}
+
+		/// mark the rows of a shard whose lock is held as being changed
+		inline void kernel_cache_begin_write(KERNEL_CACHE_SHARD* shard)
+		{
+			shard->version.store(
+				shard->version.load(std::memory_order_relaxed)+1,
+				std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+		}
+
+		/// mark the changed rows of a shard as readable again
+		inline void kernel_cache_end_write(KERNEL_CACHE_SHARD* shard)
+		{
+			shard->version.store(
+				shard->version.load(std::memory_order_relaxed)+1,
+				std::memory_order_release);
+		}
+
+		/** distribute the cache lines evenly among the shards, and move
+		 * cached rows into lines of their own shard
+		 *
+		 * @param num_lines number of lines that may hold cached rows
+		 */
+		void kernel_cache_partition_shards(int32_t num_lines);
 #endif //USE_SVMLIGHT
 		//@}
 
@@ -1045,6 +1187,9 @@ class Kernel : public SGObject
 		KERNEL_CACHE kernel_cache;
 #endif //USE_SVMLIGHT
 
+		/// number of kernel cache shards, 0 for one per thread
+		int32_t cache_num_shards;
+
 		/// this *COULD* store the whole kernel matrix
 		/// usually not applicable / necessary to compute the whole matrix
 		KERNELCACHE_ELEM* kernel_matrix;
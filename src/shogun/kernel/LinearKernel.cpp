@@ -85,6 +85,19 @@ bool LinearKernel::delete_optimization()
 	return true;
 }
 
+void LinearKernel::compute_block(SGVector<index_t> lhs_idx,
+	SGVector<index_t> rhs_idx, SGMatrix<float64_t> out)
+{
+	check_block(lhs_idx, rhs_idx, out);
+	if (!compute_dot_block(lhs_idx, rhs_idx, out))
+	{
+		DotKernel::compute_block(lhs_idx, rhs_idx, out);
+		return;
+	}
+
+	normalize_block(lhs_idx, rhs_idx, out);
+}
+
 float64_t LinearKernel::compute_optimized(int32_t idx)
 {
 	ASSERT(get_is_initialized())
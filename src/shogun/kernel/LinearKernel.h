@@ -66,6 +66,17 @@ class LinearKernel: public DotKernel
 		 */
 		const char* get_name() const override { return "LinearKernel"; }
 
+		/** compute a block of kernel values from the dot products computed
+		 * with a single matrix product, see Kernel::compute_block
+		 *
+		 * @param lhs_idx indices of lhs vectors
+		 * @param rhs_idx indices of rhs vectors
+		 * @param out preallocated lhs_idx.vlen x rhs_idx.vlen matrix
+		 */
+		void compute_block(
+			SGVector<index_t> lhs_idx, SGVector<index_t> rhs_idx,
+			SGMatrix<float64_t> out) override;
+
 		/** optimizable kernel, i.e. precompute normal vector and as
 		 * phi(x) = x do scalar product in input space
 		 *
@@ -12,6 +12,7 @@
 #include <shogun/lib/auto_initialiser.h>
 #include <shogun/lib/common.h>
 #include <shogun/lib/config.h>
+#include <shogun/mathematics/eigen3.h>
 
 using namespace shogun;
 
@@ -66,6 +67,21 @@ float64_t PolyKernel::compute(int32_t idx_a, int32_t idx_b)
 	return Math::pow(result, degree);
 }
 
+void PolyKernel::compute_block(SGVector<index_t> lhs_idx,
+	SGVector<index_t> rhs_idx, SGMatrix<float64_t> out)
+{
+	check_block(lhs_idx, rhs_idx, out);
+	if (!compute_dot_block(lhs_idx, rhs_idx, out))
+	{
+		DotKernel::compute_block(lhs_idx, rhs_idx, out);
+		return;
+	}
+
+	Eigen::Map<Eigen::ArrayXXd> eigen_out(out.matrix, out.num_rows, out.num_cols);
+	eigen_out=(std::get<float64_t>(m_gamma)*eigen_out+m_c).pow(degree);
+	normalize_block(lhs_idx, rhs_idx, out);
+}
+
 void PolyKernel::init()
 {
 	degree = 0;
@@ -89,6 +89,17 @@ class PolyKernel: public DotKernel
 		/** @return degree of kernel */
 		virtual int32_t get_degree() { return degree; }
 
+		/** compute a block of kernel values from the dot products computed
+		 * with a single matrix product, see Kernel::compute_block
+		 *
+		 * @param lhs_idx indices of lhs vectors
+		 * @param rhs_idx indices of rhs vectors
+		 * @param out preallocated lhs_idx.vlen x rhs_idx.vlen matrix
+		 */
+		void compute_block(
+			SGVector<index_t> lhs_idx, SGVector<index_t> rhs_idx,
+			SGMatrix<float64_t> out) override;
+
 	protected:
 		/** compute kernel function for features a and b
 		 * idx_{a,b} denote the index of the feature vectors
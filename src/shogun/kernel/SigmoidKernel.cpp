@@ -8,6 +8,7 @@
 #include <shogun/kernel/SigmoidKernel.h>
 #include <shogun/lib/auto_initialiser.h>
 #include <shogun/lib/common.h>
+#include <shogun/mathematics/eigen3.h>
 
 using namespace shogun;
 
@@ -49,3 +50,18 @@ bool SigmoidKernel::init(std::shared_ptr<Features> l, std::shared_ptr<Features>
 	DotKernel::init(l, r);
 	return init_normalizer();
 }
+
+void SigmoidKernel::compute_block(SGVector<index_t> lhs_idx,
+	SGVector<index_t> rhs_idx, SGMatrix<float64_t> out)
+{
+	check_block(lhs_idx, rhs_idx, out);
+	if (!compute_dot_block(lhs_idx, rhs_idx, out))
+	{
+		DotKernel::compute_block(lhs_idx, rhs_idx, out);
+		return;
+	}
+
+	Eigen::Map<Eigen::ArrayXXd> eigen_out(out.matrix, out.num_rows, out.num_cols);
+	eigen_out=(std::get<float64_t>(m_gamma)*eigen_out+coef0).tanh();
+	normalize_block(lhs_idx, rhs_idx, out);
+}
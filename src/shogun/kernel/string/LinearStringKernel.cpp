@@ -11,8 +11,34 @@
 #include <shogun/features/StringFeatures.h>
 #include <shogun/kernel/normalizer/KernelNormalizer.h>
 
+#include <algorithm>
+
 using namespace shogun;
 
+namespace
+{
+	/* copies the strings idx of features, which are all of length len, into
+	 * the columns of a matrix */
+	SGMatrix<float64_t> gather_strings(
+		const std::shared_ptr<StringFeatures<char>>& features,
+		const SGVector<index_t>& idx, int32_t len)
+	{
+		SGMatrix<float64_t> strings(len, idx.vlen);
+		for (index_t j=0; j<idx.vlen; j++)
+		{
+			int32_t vlen;
+			bool vfree;
+			char* vec=features->get_feature_vector(idx[j], vlen, vfree);
+			if (vlen==len)
+				std::copy(vec, vec+vlen, strings.get_column_vector(j));
+			features->free_feature_vector(vec, idx[j], vfree);
+			require(vlen==len, "String {} has length {}, expected {}",
+				idx[j], vlen, len);
+		}
+		return strings;
+	}
+}
+
 LinearStringKernel::LinearStringKernel()
 : StringKernel<char>(0)
 {
@@ -76,6 +102,23 @@ float64_t LinearStringKernel::compute(int32_t idx_a, int32_t idx_b)
 	return result;
 }
 
+void LinearStringKernel::compute_block(SGVector<index_t> lhs_idx,
+	SGVector<index_t> rhs_idx, SGMatrix<float64_t> out)
+{
+	check_block(lhs_idx, rhs_idx, out);
+	if (!lhs_idx.vlen || !rhs_idx.vlen)
+		return;
+
+	auto l_feats=lhs->as<StringFeatures<char>>();
+	auto r_feats=rhs->as<StringFeatures<char>>();
+	auto len=l_feats->get_vector_length(lhs_idx[0]);
+	auto l_strings=gather_strings(l_feats, lhs_idx, len);
+	auto r_strings=gather_strings(r_feats, rhs_idx, len);
+	linalg::matrix_prod(l_strings, r_strings, out, true, false);
+
+	normalize_block(lhs_idx, rhs_idx, out);
+}
+
 bool LinearStringKernel::init_optimization(
 	int32_t num_suppvec, int32_t *sv_idx, float64_t *alphas)
 {
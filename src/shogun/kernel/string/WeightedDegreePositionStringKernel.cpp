@@ -8,6 +8,7 @@
 #include <shogun/base/Parallel.h>
 #include <shogun/base/progress.h>
 #include <shogun/io/SGIO.h>
+#include <shogun/lib/FlatTrie.h>
 #include <shogun/lib/Signal.h>
 #include <shogun/lib/Trie.h>
 #include <shogun/lib/common.h>
@@ -30,25 +31,6 @@ using namespace shogun;
 
 #define TRIES(X) ((use_poim_tries) ? (poim_tries->X) : (tries->X))
 
-#ifndef DOXYGEN_SHOULD_SKIP_THIS
-template <class Trie> struct S_THREAD_PARAM_WDS
-{
-	int32_t* vec;
-	float64_t* result;
-	float64_t* weights;
-	WeightedDegreePositionStringKernel* kernel;
-	CTrie<Trie>* tries;
-	float64_t factor;
-	int32_t j;
-	int32_t start;
-	int32_t end;
-	int32_t length;
-	int32_t max_shift;
-	int32_t* shift;
-	int32_t* vec_idx;
-};
-#endif // DOXYGEN_SHOULD_SKIP_THIS
-
 WeightedDegreePositionStringKernel::WeightedDegreePositionStringKernel(
 	void)
 : StringKernel<char>()
@@ -120,6 +102,7 @@ void WeightedDegreePositionStringKernel::remove_lhs()
 {
 	SG_DEBUG("deleting CWeightedDegreePositionStringKernel optimization")
 	delete_optimization();
+	flat_tries=nullptr;
 
 	Kernel::remove_lhs();
 }
@@ -128,6 +111,7 @@ void WeightedDegreePositionStringKernel::create_empty_tries()
 {
 	ASSERT(lhs)
 	seq_length = std::static_pointer_cast<StringFeatures<char>>(lhs)->get_max_vector_length();
+	flat_tries=nullptr;
 
 	if (opt_type==SLOWBUTMEMEFFICIENT)
 	{
@@ -193,6 +177,7 @@ void WeightedDegreePositionStringKernel::cleanup()
 {
 	SG_DEBUG("deleting CWeightedDegreePositionStringKernel optimization")
 	delete_optimization();
+	flat_tries=nullptr;
 
 	seq_length = 0;
 	tree_initialized = false;
@@ -1053,169 +1038,175 @@ bool WeightedDegreePositionStringKernel::init_block_weights()
 	return false;
 }
 
-void* WeightedDegreePositionStringKernel::compute_batch_helper(void* p)
-{
-	auto* params = (S_THREAD_PARAM_WDS<DNATrie>*) p;
-	int32_t j=params->j;
-	WeightedDegreePositionStringKernel* wd=params->kernel;
-	CTrie<DNATrie>* tries=params->tries;
-	float64_t* weights=params->weights;
-	int32_t length=params->length;
-	int32_t max_shift=params->max_shift;
-	int32_t* vec=params->vec;
-	float64_t* result=params->result;
-	float64_t factor=params->factor;
-	int32_t* shift=params->shift;
-	int32_t* vec_idx=params->vec_idx;
-
-	for (int32_t i=params->start; i<params->end; i++)
-	{
-		int32_t len=0;
-		auto rhs_feat=(StringFeatures<char>*)(wd->get_rhs().get());
-		auto alpha=rhs_feat->get_alphabet();
-
-		bool free_vec;
-		char* char_vec=rhs_feat->get_feature_vector(vec_idx[i], len, free_vec);
-		for (int32_t k=Math::max(0,j-max_shift); k<Math::min(len,j+wd->get_degree()+max_shift); k++)
-			vec[k]=alpha->remap_to_bin(char_vec[k]);
-		rhs_feat->free_feature_vector(char_vec, vec_idx[i], free_vec);
-
-		result[i] += factor*wd->normalizer->normalize_rhs(tries->compute_by_tree_helper(vec, len, j, j, j, weights, (length!=0)), vec_idx[i]);
-
-		if (wd->get_optimization_type()==SLOWBUTMEMEFFICIENT)
-		{
-			for (int32_t q=Math::max(0,j-max_shift); q<Math::min(len,j+max_shift+1); q++)
-			{
-				int32_t s=j-q ;
-				if ((s>=1) && (s<=shift[q]) && (q+s<len))
-				{
-					result[i] +=
-						wd->normalizer->normalize_rhs(tries->compute_by_tree_helper(vec,
-								len, q, q+s, q, weights, (length!=0)),
-								vec_idx[i])/(2.0*s);
-				}
-			}
-
-			for (int32_t s=1; (s<=shift[j]) && (j+s<len); s++)
-			{
-				result[i] +=
-					wd->normalizer->normalize_rhs(tries->compute_by_tree_helper(vec,
-								len, j+s, j, j+s, weights, (length!=0)),
-								vec_idx[i])/(2.0*s);
-			}
-		}
-	}
-
-	return NULL;
-}
-
 void WeightedDegreePositionStringKernel::compute_batch(
 	int32_t num_vec, int32_t* vec_idx, float64_t* result, int32_t num_suppvec,
 	int32_t* IDX, float64_t* alphas, float64_t factor)
 {
-	auto alphabet = std::static_pointer_cast<StringFeatures<char>>(rhs)->get_alphabet();
+	auto lhs_str=std::static_pointer_cast<StringFeatures<char>>(lhs);
+	auto rhs_str=std::static_pointer_cast<StringFeatures<char>>(rhs);
+	auto alphabet = rhs_str->get_alphabet();
 	ASSERT(alphabet->get_alphabet()==DNA || alphabet->get_alphabet()==RNA)
 	ASSERT(rhs)
 	ASSERT(num_vec<=rhs->get_num_vectors())
 	ASSERT(num_vec>0)
 	ASSERT(vec_idx)
 	ASSERT(result)
-	create_empty_tries();
+	if (opt_type!=SLOWBUTMEMEFFICIENT && opt_type!=FASTBUTMEMHUNGRY)
+		error("unknown optimization type");
 
-	int32_t num_feat=std::static_pointer_cast<StringFeatures<char>>(rhs)->get_max_vector_length();
+	int32_t num_feat=rhs_str->get_max_vector_length();
 	ASSERT(num_feat>0)
-	// TODO: port to use OpenMP backend instead of pthread
-#ifdef HAVE_PTHREAD
-	int32_t num_threads=env()->get_num_threads();
-#else
-	int32_t num_threads=1;
-#endif
-	ASSERT(num_threads>0)
-	int32_t* vec=SG_MALLOC(int32_t, num_threads*num_feat);
-
-	if (num_threads < 2)
+	const bool fast=(opt_type==FASTBUTMEMHUNGRY);
+
+	// with FASTBUTMEMHUNGRY, the trie of position j also holds the shifted
+	// k-mers of the support vectors, otherwise the test vectors are shifted
+	int64_t items_per_sv=1;
+	if (fast)
+		items_per_sv+=2*max_shift;
+	const int64_t trie_nodes=int64_t(num_suppvec)*items_per_sv*degree+1;
+	const int32_t block_size=Math::min(num_feat, Math::max(
+		env()->get_num_threads(), int32_t(FLAT_TRIE_BLOCK_NODES/trie_nodes)));
+	const int32_t num_blocks=(num_feat+block_size-1)/block_size;
+
+	// if all tries fit at once they are kept for the next call
+	std::vector<float64_t> trie_params(weights.begin(), weights.end());
+	trie_params.insert(trie_params.end(), shift.begin(), shift.end());
+	trie_params.push_back(fast);
+	const bool built=num_blocks==1 && flat_tries &&
+		flat_tries->get_num_tries()==num_feat &&
+		flat_tries->has_input(num_suppvec, IDX, alphas, trie_params);
+	if (!built)
+		flat_tries=std::make_shared<FlatTrie>(degree, num_feat);
+
+	// support vectors are mapped to symbols only once
+	std::vector<SGVector<int32_t>> sv_vecs(built ? 0 : num_suppvec);
+#pragma omp parallel for
+	for (int32_t i=0; i<(int32_t) sv_vecs.size(); i++)
 	{
-		// TODO: replace with the new signal
-		// for (int32_t j=0; j<num_feat && !Signal::cancel_computations(); j++)
-		for (auto j : SG_PROGRESS(range(num_feat)))
-		{
-			init_optimization(num_suppvec, IDX, alphas, j);
-			S_THREAD_PARAM_WDS<DNATrie> params;
-			params.vec = vec;
-			params.result = result;
-			params.weights = weights.vector;
-			params.kernel = this;
-			params.tries = tries.get();
-			params.factor = factor;
-			params.j = j;
-			params.start = 0;
-			params.end = num_vec;
-			params.length = length;
-			params.max_shift = max_shift;
-			params.shift = shift;
-			params.vec_idx = vec_idx;
-			compute_batch_helper((void*)&params);
-		    }
+		int32_t len=0;
+		bool free_vec;
+		char* char_vec=lhs_str->get_feature_vector(IDX[i], len, free_vec);
+		sv_vecs[i]=SGVector<int32_t>(len);
+		for (int32_t k=0; k<len; k++)
+			sv_vecs[i][k]=alphabet->remap_to_bin(char_vec[k]);
+		lhs_str->free_feature_vector(char_vec, IDX[i], free_vec);
 	}
-#ifdef HAVE_PTHREAD
-	else
+
+	// as in compute(), the matches starting at position i of the support
+	// vector are weighted by the position weight of i
+	auto pos_weight=[&](int32_t i)
+	{
+		return (position_weights.size() > 0) ? position_weights[i] : 1.0;
+	};
+
+	auto pb=SG_PROGRESS(range(num_blocks));
+	for (int32_t block_begin=0; block_begin<num_feat; block_begin+=block_size)
 	{
-		// TODO: replace with the new signal
-		// for (int32_t j=0; j<num_feat && !Signal::cancel_computations(); j++)
-		for (auto j : SG_PROGRESS(range(num_feat)))
+		const int32_t block_end=Math::min(num_feat, block_begin+block_size);
+
+#pragma omp parallel for schedule(dynamic)
+		for (int32_t j=block_begin; j<block_end; j++)
+		{
+			if (built)
+				continue;
+
+			std::vector<FlatTrie::Item> items;
+			items.reserve(num_suppvec*items_per_sv);
+			for (int32_t i=0; i<num_suppvec; i++)
+			{
+				const int32_t len=Math::min(sv_vecs[i].vlen, seq_length);
+				if (alphas[i]==0.0 || j>=len)
+					continue;
+
+				// the k-mer at j+offset, weighted by 1/(2|offset|) if shifted
+				auto add_item=[&](int32_t offset)
+				{
+					const int32_t s=Math::abs(offset);
+					float64_t alpha=(s==0) ? alphas[i] : alphas[i]/(2.0*s);
+					items.push_back({sv_vecs[i].vector+j+offset,
+						Math::min(degree, Math::min(len-j, len-j-offset)),
+						normalizer->normalize_lhs(alpha, IDX[i]),
+						(length!=0) ? &weights[(j+offset)*degree] : weights.vector});
+				};
+
+				add_item(0);
+				if (!fast)
+					continue;
+
+				for (int32_t s=1; s<=shift[j] && j+s<len; s++)
+					add_item(s);
+				for (int32_t s=1; s<=Math::min(j, max_shift); s++)
+				{
+					if (s<=shift[j-s])
+						add_item(-s);
+				}
+			}
+			flat_tries->build(j, items);
+		}
+
+#pragma omp parallel
 		{
-			init_optimization(num_suppvec, IDX, alphas, j);
-			pthread_t* threads = SG_MALLOC(pthread_t, num_threads-1);
-			std::vector<S_THREAD_PARAM_WDS<DNATrie>> params(num_threads);
-			int32_t step= num_vec/num_threads;
-			int32_t t;
+			SGVector<int32_t> vec(num_feat);
 
-			for (t=0; t<num_threads-1; t++)
+#pragma omp for schedule(dynamic, 64)
+			for (int32_t i=0; i<num_vec; i++)
 			{
-				params[t].vec=&vec[num_feat*t];
-				params[t].result=result;
-				params[t].weights=weights.vector;
-				params[t].kernel=this;
-				params[t].tries=tries.get();
-				params[t].factor=factor;
-				params[t].j=j;
-				params[t].start = t*step;
-				params[t].end = (t+1)*step;
-				params[t].length=length;
-				params[t].max_shift=max_shift;
-				params[t].shift=shift;
-				params[t].vec_idx=vec_idx;
-				pthread_create(&threads[t], NULL, WeightedDegreePositionStringKernel::compute_batch_helper, (void*)&params[t]);
+				int32_t len=0;
+				bool free_vec;
+				char* char_vec=rhs_str->get_feature_vector(vec_idx[i], len, free_vec);
+				for (int32_t k=Math::max(0, block_begin-max_shift);
+					k<Math::min(len, block_end+degree+max_shift); k++)
+				{
+					vec[k]=alphabet->remap_to_bin(char_vec[k]);
+				}
+				rhs_str->free_feature_vector(char_vec, vec_idx[i], free_vec);
+
+				float64_t sum=0;
+				for (int32_t j=block_begin; j<Math::min(len, block_end); j++)
+				{
+					// with FASTBUTMEMHUNGRY, the shifted support vectors in
+					// the trie of position j are weighted by position j too
+					if (pos_weight(j)!=0.0)
+						sum+=pos_weight(j)*flat_tries->compute(j, &vec[j], len-j);
+
+					if (fast)
+						continue;
+
+					// the test vector shifted against the trie of position j
+					for (int32_t s=1; s<=Math::min(j, max_shift); s++)
+					{
+						if (s<=shift[j-s] && pos_weight(j-s)!=0.0)
+						{
+							sum+=pos_weight(j-s)*
+								flat_tries->compute(j, &vec[j-s], len-j+s)/(2.0*s);
+						}
+					}
+					for (int32_t s=1; s<=shift[j] && j+s<len; s++)
+					{
+						if (pos_weight(j+s)!=0.0)
+						{
+							sum+=pos_weight(j+s)*
+								flat_tries->compute(j, &vec[j+s], len-j-s)/(2.0*s);
+						}
+					}
+				}
+				result[i]+=factor*normalizer->normalize_rhs(sum, vec_idx[i]);
 			}
+		}
 
-			params[t].vec=&vec[num_feat*t];
-			params[t].result=result;
-			params[t].weights=weights.vector;
-			params[t].kernel=this;
-			params[t].tries=tries.get();
-			params[t].factor=factor;
-			params[t].j=j;
-			params[t].start=t*step;
-			params[t].end=num_vec;
-			params[t].length=length;
-			params[t].max_shift=max_shift;
-			params[t].shift=shift;
-			params[t].vec_idx=vec_idx;
-			compute_batch_helper((void*) &params[t]);
-
-			for (t=0; t<num_threads-1; t++)
-				pthread_join(threads[t], NULL);
-
-			SG_FREE(threads);
+		if (num_blocks>1)
+		{
+			for (int32_t j=block_begin; j<block_end; j++)
+				flat_tries->clear(j);
 		}
+		pb.print_progress();
 	}
-#endif
-
-	SG_FREE(vec);
+	pb.complete();
 
-	//really also free memory as this can be huge on testing especially when
-	//using the combined kernel
-	create_empty_tries();
+	if (num_blocks>1)
+		flat_tries=nullptr;
+	else if (!built)
+		flat_tries->set_input(num_suppvec, IDX, alphas, std::move(trie_params));
 }
 
 float64_t* WeightedDegreePositionStringKernel::compute_scoring(
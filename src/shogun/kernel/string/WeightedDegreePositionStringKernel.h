@@ -19,6 +19,7 @@ namespace shogun
 {
 
 class SVM;
+class FlatTrie;
 
 /** @brief The Weighted Degree Position String kernel (Weighted Degree kernel
  * with shifts).
@@ -108,6 +109,17 @@ class WeightedDegreePositionStringKernel: public StringKernel<char>
 		 */
 		const char* get_name() const override { return "WeightedDegreePositionStringKernel"; }
 
+		/** set the current kernel normalizer
+		 *
+		 * @return if successful
+		 */
+		bool set_normalizer(std::shared_ptr<KernelNormalizer> normalizer_) override
+		{
+			// the flat tries hold alphas normalized by the old normalizer
+			flat_tries=nullptr;
+			return StringKernel<char>::set_normalizer(normalizer_);
+		}
+
 		/** initialize optimization
 		 *
 		 * @param p_count count
@@ -155,13 +167,11 @@ class WeightedDegreePositionStringKernel: public StringKernel<char>
 			return compute_by_tree(idx);
 		}
 
-		/** helper for compute batch
-		 *
-		 * @param p thread parameter
-		 */
-		static void* compute_batch_helper(void* p);
-
-		/** compute batch
+		/** compute batch with flattened tries (see FlatTrie) for blocks of
+		 * positions, which are built in parallel. The test vectors are then
+		 * evaluated on all tries of a block in parallel. If all tries fit
+		 * at once, they are kept and reused by the next call with the same
+		 * support vectors.
 		 *
 		 * @param num_vec number of vectors
 		 * @param vec_idx vector index
@@ -712,6 +722,8 @@ s		 * @return if setting was successful
 
 		/** tries */
 		std::unique_ptr<CTrie<DNATrie>> tries;
+		/** flattened tries of the last compute_batch(), if they all fit */
+		std::shared_ptr<FlatTrie> flat_tries;
 		/** POIM tries */
 		std::unique_ptr<CTrie<POIMTrie>> poim_tries;
 
@@ -8,6 +8,7 @@
 #include <shogun/base/Parallel.h>
 #include <shogun/base/progress.h>
 #include <shogun/io/SGIO.h>
+#include <shogun/lib/FlatTrie.h>
 #include <shogun/lib/Signal.h>
 #include <shogun/lib/Trie.h>
 #include <shogun/lib/common.h>
@@ -18,6 +19,7 @@
 #include <shogun/features/StringFeatures.h>
 
 #include <thread>
+#include <vector>
 
 using namespace shogun;
 
@@ -101,6 +103,7 @@ void WeightedDegreeStringKernel::remove_lhs()
 
 	if (tries!=NULL)
 		tries->destroy();
+	flat_tries=nullptr;
 
 	Kernel::remove_lhs();
 }
@@ -110,6 +113,7 @@ void WeightedDegreeStringKernel::create_empty_tries()
 	ASSERT(lhs)
 
 	seq_length=lhs->as<StringFeatures<char>>()->get_max_vector_length();
+	flat_tries=nullptr;
 
 	if (tries!=NULL)
 	{
@@ -167,6 +171,7 @@ void WeightedDegreeStringKernel::cleanup()
 {
 	SG_DEBUG("deleting WeightedDegreeStringKernel optimization")
 	delete_optimization();
+	flat_tries=nullptr;
 
 	Kernel::cleanup();
 }
@@ -329,25 +334,52 @@ float64_t WeightedDegreeStringKernel::compute(int32_t idx_a, int32_t idx_b)
 	bool free_avec, free_bvec;
 	char* avec=lhs->as<StringFeatures<char>>()->get_feature_vector(idx_a, alen, free_avec);
 	char* bvec=rhs->as<StringFeatures<char>>()->get_feature_vector(idx_b, blen, free_bvec);
-	float64_t result=0;
-
-	if (max_mismatch==0 && length==0 && block_computation)
-		result=compute_using_block(avec, alen, bvec, blen);
-	else
-	{
-		if (max_mismatch>0)
-			result=compute_with_mismatch(avec, alen, bvec, blen);
-		else if (length==0)
-			result=compute_without_mismatch(avec, alen, bvec, blen);
-		else
-			result=compute_without_mismatch_matrix(avec, alen, bvec, blen);
-	}
+	float64_t result=compute_strings(avec, alen, bvec, blen);
 	lhs->as<StringFeatures<char>>()->free_feature_vector(avec, idx_a, free_avec);
 	rhs->as<StringFeatures<char>>()->free_feature_vector(bvec, idx_b, free_bvec);
 
 	return result;
 }
 
+float64_t WeightedDegreeStringKernel::compute_strings(
+	char* avec, int32_t alen, char* bvec, int32_t blen)
+{
+	if (max_mismatch==0 && length==0 && block_computation)
+		return compute_using_block(avec, alen, bvec, blen);
+	if (max_mismatch>0)
+		return compute_with_mismatch(avec, alen, bvec, blen);
+	if (length==0)
+		return compute_without_mismatch(avec, alen, bvec, blen);
+	return compute_without_mismatch_matrix(avec, alen, bvec, blen);
+}
+
+void WeightedDegreeStringKernel::compute_block(SGVector<index_t> lhs_idx,
+	SGVector<index_t> rhs_idx, SGMatrix<float64_t> out)
+{
+	check_block(lhs_idx, rhs_idx, out);
+
+	auto l_feats=lhs->as<StringFeatures<char>>();
+	auto r_feats=rhs->as<StringFeatures<char>>();
+	std::vector<SGVector<char>> l_strings(lhs_idx.vlen);
+	std::vector<SGVector<char>> r_strings(rhs_idx.vlen);
+	for (index_t i=0; i<lhs_idx.vlen; i++)
+		l_strings[i]=l_feats->get_feature_vector(lhs_idx[i]);
+	for (index_t j=0; j<rhs_idx.vlen; j++)
+		r_strings[j]=r_feats->get_feature_vector(rhs_idx[j]);
+
+#pragma omp parallel for
+	for (index_t j=0; j<rhs_idx.vlen; j++)
+	{
+		auto& b=r_strings[j];
+		for (index_t i=0; i<lhs_idx.vlen; i++)
+		{
+			auto& a=l_strings[i];
+			out(i, j)=normalizer->normalize(
+				compute_strings(a.vector, a.vlen, b.vector, b.vlen),
+				lhs_idx[i], rhs_idx[j]);
+		}
+	}
+}
 
 void WeightedDegreeStringKernel::add_example_to_tree(
 	int32_t idx, float64_t alpha)
@@ -617,6 +649,7 @@ bool WeightedDegreeStringKernel::set_position_weights(
 	position_weights = pws.clone();
 	position_weights_len=pws.size();
 	tries->set_position_weights(position_weights.vector);
+	flat_tries=nullptr;
 
 	if (position_weights.size() > 0)
 		return true;
@@ -793,6 +826,14 @@ void WeightedDegreeStringKernel::compute_batch(
 	ASSERT(num_vec>0)
 	ASSERT(vec_idx)
 	ASSERT(result)
+
+	if (max_mismatch==0)
+	{
+		compute_batch_flat_trie(
+			num_vec, vec_idx, result, num_suppvec, IDX, alphas, factor);
+		return;
+	}
+
 	create_empty_tries();
 
 	const auto& num_feat=rhs->as<StringFeatures<char>>()->get_max_vector_length();
@@ -846,6 +887,117 @@ void WeightedDegreeStringKernel::compute_batch(
 	create_empty_tries();
 }
 
+void WeightedDegreeStringKernel::compute_batch_flat_trie(
+	int32_t num_vec, int32_t* vec_idx, float64_t* result, int32_t num_suppvec,
+	int32_t* IDX, float64_t* alphas, float64_t factor)
+{
+	auto lhs_str=lhs->as<StringFeatures<char>>();
+	auto rhs_str=rhs->as<StringFeatures<char>>();
+	const auto& alphabet=lhs_str->get_alphabet();
+	const int32_t num_feat=rhs_str->get_max_vector_length();
+	ASSERT(num_feat>0)
+
+	const float64_t* pos_weights=
+		(position_weights.size() > 0) ? position_weights.vector : NULL;
+	const int64_t trie_nodes=int64_t(num_suppvec)*degree+1;
+	const int32_t block_size=Math::min(num_feat, Math::max(
+		env()->get_num_threads(), int32_t(FLAT_TRIE_BLOCK_NODES/trie_nodes)));
+	const int32_t num_blocks=(num_feat+block_size-1)/block_size;
+
+	// if all tries fit at once they are kept for the next call
+	std::vector<float64_t> trie_params(weights.begin(), weights.end());
+	const bool built=num_blocks==1 && flat_tries &&
+		flat_tries->get_num_tries()==num_feat &&
+		flat_tries->has_input(num_suppvec, IDX, alphas, trie_params);
+	if (!built)
+		flat_tries=std::make_shared<FlatTrie>(degree, num_feat);
+
+	// support vectors are mapped to symbols only once
+	std::vector<SGVector<int32_t>> sv_vecs(built ? 0 : num_suppvec);
+	SGVector<float64_t> sv_alphas(sv_vecs.size());
+#pragma omp parallel for
+	for (int32_t i=0; i<(int32_t) sv_vecs.size(); i++)
+	{
+		int32_t len=0;
+		bool free_vec;
+		char* char_vec=lhs_str->get_feature_vector(IDX[i], len, free_vec);
+		sv_vecs[i]=SGVector<int32_t>(len);
+		for (int32_t k=0; k<len; k++)
+			sv_vecs[i][k]=alphabet->remap_to_bin(char_vec[k]);
+		lhs_str->free_feature_vector(char_vec, IDX[i], free_vec);
+		sv_alphas[i]=normalizer->normalize_lhs(alphas[i], IDX[i]);
+	}
+
+	auto pb=SG_PROGRESS(range(num_blocks));
+	for (int32_t block_begin=0; block_begin<num_feat; block_begin+=block_size)
+	{
+		const int32_t block_end=Math::min(num_feat, block_begin+block_size);
+
+#pragma omp parallel for schedule(dynamic)
+		for (int32_t j=block_begin; j<block_end; j++)
+		{
+			if (built)
+				continue;
+
+			const float64_t* weights_column=
+				(length!=0) ? &weights.matrix[j*degree] : weights.matrix;
+			std::vector<FlatTrie::Item> items;
+			items.reserve(num_suppvec);
+			for (int32_t i=0; i<num_suppvec; i++)
+			{
+				const int32_t len=Math::min(sv_vecs[i].vlen, seq_length);
+				if (sv_alphas[i]==0.0 || j>=len)
+					continue;
+				items.push_back({sv_vecs[i].vector+j,
+					Math::min(degree, len-j), sv_alphas[i], weights_column});
+			}
+			flat_tries->build(j, items);
+		}
+
+#pragma omp parallel
+		{
+			SGVector<int32_t> vec(num_feat);
+
+#pragma omp for schedule(dynamic, 64)
+			for (int32_t i=0; i<num_vec; i++)
+			{
+				int32_t len=0;
+				bool free_vec;
+				char* char_vec=rhs_str->get_feature_vector(vec_idx[i], len, free_vec);
+				for (int32_t k=block_begin; k<Math::min(len, block_end+degree); k++)
+					vec[k]=alphabet->remap_to_bin(char_vec[k]);
+				rhs_str->free_feature_vector(char_vec, vec_idx[i], free_vec);
+
+				// the position weights scale the output of each position,
+				// as in compute() and CTrie::compute_by_tree_helper()
+				for (int32_t j=block_begin; j<Math::min(len, block_end); j++)
+				{
+					if (pos_weights && pos_weights[j]==0.0)
+						continue;
+
+					float64_t sum=flat_tries->compute(j, &vec[j], len-j);
+					if (pos_weights)
+						sum*=pos_weights[j];
+					result[i]+=factor*normalizer->normalize_rhs(sum, vec_idx[i]);
+				}
+			}
+		}
+
+		if (num_blocks>1)
+		{
+			for (int32_t j=block_begin; j<block_end; j++)
+				flat_tries->clear(j);
+		}
+		pb.print_progress();
+	}
+	pb.complete();
+
+	if (num_blocks>1)
+		flat_tries=nullptr;
+	else if (!built)
+		flat_tries->set_input(num_suppvec, IDX, alphas, std::move(trie_params));
+}
+
 bool WeightedDegreeStringKernel::set_max_mismatch(int32_t max)
 {
 	if (type==E_EXTERNAL && max!=0)
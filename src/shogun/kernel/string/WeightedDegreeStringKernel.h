@@ -18,6 +18,8 @@
 namespace shogun
 {
 
+class FlatTrie;
+
 /** WD kernel type */
 enum EWDKernType
 {
@@ -179,6 +181,18 @@ class WeightedDegreeStringKernel: public StringKernel<char>
 			int32_t num_suppvec, int32_t* IDX, float64_t* alphas,
 			float64_t factor=1.0) override;
 
+		/** compute a block of kernel values, see Kernel::compute_block.
+		 * Each string of the block is fetched only once and the entries are
+		 * then computed in parallel.
+		 *
+		 * @param lhs_idx indices of lhs vectors
+		 * @param rhs_idx indices of rhs vectors
+		 * @param out preallocated lhs_idx.vlen x rhs_idx.vlen matrix
+		 */
+		void compute_block(
+			SGVector<index_t> lhs_idx, SGVector<index_t> rhs_idx,
+			SGMatrix<float64_t> out) override;
+
 		/** clear normal
 		 * subkernel functionality
 		 */
@@ -340,6 +354,8 @@ class WeightedDegreeStringKernel: public StringKernel<char>
 				set_property(KP_BATCHEVALUATION);
 			}
 
+			// the flat tries hold alphas normalized by the old normalizer
+			flat_tries=nullptr;
 			return StringKernel<char>::set_normalizer(normalizer_);
 		}
 
@@ -575,6 +591,25 @@ class WeightedDegreeStringKernel: public StringKernel<char>
 		/** create emtpy tries */
 		void create_empty_tries();
 
+		/** compute batch with flattened tries (see FlatTrie) for blocks of
+		 * positions, which are built in parallel. The test vectors are then
+		 * evaluated on all tries of a block in parallel. Only for
+		 * max_mismatch==0. If all tries fit at once, they are kept and
+		 * reused by the next call with the same support vectors.
+		 *
+		 * @param num_vec number of vectors
+		 * @param vec_idx vector index
+		 * @param target target
+		 * @param num_suppvec number of support vectors
+		 * @param IDX IDX
+		 * @param alphas alphas
+		 * @param factor factor
+		 */
+		void compute_batch_flat_trie(
+			int32_t num_vec, int32_t* vec_idx, float64_t* target,
+			int32_t num_suppvec, int32_t* IDX, float64_t* alphas,
+			float64_t factor);
+
 		/** add example to tree
 		 *
 		 * @param idx index
@@ -624,6 +659,18 @@ class WeightedDegreeStringKernel: public StringKernel<char>
 		 */
 		float64_t compute(int32_t idx_a, int32_t idx_b) override;
 
+		/** compute kernel function for two strings with the method that
+		 * matches the kernel's settings
+		 *
+		 * @param avec vector a
+		 * @param alen length of vector a
+		 * @param bvec vector b
+		 * @param blen length of vector b
+		 * @return computed value
+		 */
+		float64_t compute_strings(
+			char* avec, int32_t alen, char* bvec, int32_t blen);
+
 		/** compute with mismatch
 		 *
 		 * @param avec vector a
@@ -715,6 +762,8 @@ class WeightedDegreeStringKernel: public StringKernel<char>
 
 		/** tries */
 		std::shared_ptr<CTrie<DNATrie>> tries;
+		/** flattened tries of the last compute_batch(), if they all fit */
+		std::shared_ptr<FlatTrie> flat_tries;
 
 		/** if tree is initialized */
 		bool tree_initialized = false;
@@ -0,0 +1,137 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <shogun/io/SGIO.h>
+#include <shogun/lib/CompressedVectorStore.h>
+#include <shogun/mathematics/Math.h>
+
+#include <atomic>
+#include <list>
+#include <string.h>
+
+using namespace shogun;
+
+namespace
+{
+	/** a decompressed block in the cache of a thread */
+	struct CachedBlock
+	{
+		/** id of the store */
+		uint64_t store_id;
+		/** index of the block in the store */
+		index_t block;
+		/** uncompressed data */
+		std::vector<uint8_t> data;
+	};
+
+	/** source of the store ids, 0 marks an empty cache entry */
+	std::atomic<uint64_t> next_store_id(1);
+
+	/** blocks the thread decompressed, most recently used first */
+	thread_local std::list<CachedBlock> block_cache;
+}
+
+CompressedVectorStore::CompressedVectorStore(E_COMPRESSION_TYPE compression,
+	int32_t vectors_per_block, int32_t level)
+: m_compressor(std::make_shared<Compressor>(compression)),
+	m_vectors_per_block(vectors_per_block), m_level(level),
+	m_id(next_store_id++), m_finalized(false), m_offsets(1, 0)
+{
+	require(vectors_per_block>0, "Number of vectors per block ({}) must be "
+		"positive", vectors_per_block);
+}
+
+void CompressedVectorStore::append(const void* data, uint64_t size)
+{
+	require(!m_finalized, "Cannot append to a finalized store");
+
+	const uint8_t* bytes=(const uint8_t*) data;
+	m_pending.insert(m_pending.end(), bytes, bytes+size);
+	m_offsets.push_back(m_offsets.back()+size);
+
+	if (get_num_vectors()%m_vectors_per_block==0)
+		compress_pending();
+}
+
+void CompressedVectorStore::finalize()
+{
+	if (m_finalized)
+		return;
+
+	if (get_num_vectors()%m_vectors_per_block)
+		compress_pending();
+	m_pending=std::vector<uint8_t>();
+	m_finalized=true;
+}
+
+void CompressedVectorStore::compress_pending()
+{
+	uint8_t* compressed=NULL;
+	uint64_t compressed_size=0;
+	m_compressor->compress(m_pending.data(), m_pending.size(), compressed,
+		compressed_size, m_level);
+
+	m_blocks.push_back(SGVector<uint8_t>(compressed, compressed_size));
+	m_pending.clear();
+}
+
+void CompressedVectorStore::get(index_t num, void* target) const
+{
+	require(m_finalized, "Store has to be finalized before accessing it");
+	require(num>=0 && num<get_num_vectors(), "Index {} out of bounds for "
+		"{} vectors", num, get_num_vectors());
+
+	const uint64_t size=get_size(num);
+	if (!size)
+		return;
+
+	const index_t block=num/m_vectors_per_block;
+	const uint64_t block_offset=m_offsets[block*m_vectors_per_block];
+	memcpy(target, get_block(block)+m_offsets[num]-block_offset, size);
+}
+
+uint64_t CompressedVectorStore::get_compressed_size() const
+{
+	uint64_t size=0;
+	for (const auto& block : m_blocks)
+		size+=block.vlen;
+
+	return size;
+}
+
+const uint8_t* CompressedVectorStore::get_block(index_t block) const
+{
+	for (auto it=block_cache.begin(); it!=block_cache.end(); ++it)
+	{
+		if (it->store_id==m_id && it->block==block)
+		{
+			block_cache.splice(block_cache.begin(), block_cache, it);
+			return block_cache.front().data.data();
+		}
+	}
+
+	/* reuse the least recently used entry once the cache is full */
+	if (block_cache.size()<COMPRESSED_STORE_CACHE_BLOCKS)
+		block_cache.emplace_front();
+	else
+		block_cache.splice(block_cache.begin(), block_cache, --block_cache.end());
+
+	auto& entry=block_cache.front();
+	const index_t first=block*m_vectors_per_block;
+	const index_t last=Math::min(first+m_vectors_per_block, get_num_vectors());
+	uint64_t size=m_offsets[last]-m_offsets[first];
+
+	/* only tag the entry once it holds the block */
+	entry.store_id=0;
+	entry.data.resize(size);
+	m_compressor->decompress(m_blocks[block].vector, m_blocks[block].vlen,
+		entry.data.data(), size);
+
+	require(size==entry.data.size(), "Block {} decompressed to {} bytes, "
+		"expected {}", block, size, entry.data.size());
+	entry.store_id=m_id;
+	entry.block=block;
+
+	return entry.data.data();
+}
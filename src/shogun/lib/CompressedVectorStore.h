@@ -0,0 +1,116 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#ifndef __COMPRESSEDVECTORSTORE_H__
+#define __COMPRESSEDVECTORSTORE_H__
+
+#include <shogun/lib/config.h>
+
+#include <shogun/lib/Compressor.h>
+#include <shogun/lib/SGVector.h>
+#include <shogun/lib/common.h>
+
+#include <memory>
+#include <vector>
+
+/** default number of vectors compressed together in one block */
+#define COMPRESSED_STORE_DEFAULT_BLOCK_SIZE 256
+/** number of decompressed blocks each thread keeps */
+#define COMPRESSED_STORE_CACHE_BLOCKS 4
+
+namespace shogun
+{
+/** @brief CompressedVectorStore keeps a list of vectors of bytes compressed
+ * in memory, and decompresses single vectors on demand.
+ *
+ * Vectors are appended one after another and compressed in blocks of a
+ * fixed number of vectors with Compressor, so a vector can be accessed
+ * without decompressing the whole store. Each thread keeps the last
+ * COMPRESSED_STORE_CACHE_BLOCKS blocks it decompressed (shared by all
+ * stores) in a least recently used cache, so accessing vectors of the same
+ * block one after another decompresses the block only once.
+ *
+ * Once finalize() was called the store is read-only, and get() can be called
+ * from any number of threads.
+ */
+class CompressedVectorStore
+{
+public:
+	/** constructor
+	 *
+	 * @param compression compression algorithm
+	 * @param vectors_per_block number of vectors compressed together
+	 * @param level compression level between 1 and 9
+	 */
+	CompressedVectorStore(E_COMPRESSION_TYPE compression,
+		int32_t vectors_per_block=COMPRESSED_STORE_DEFAULT_BLOCK_SIZE,
+		int32_t level=1);
+
+	/** append a vector, compressing its block when the block is full
+	 *
+	 * @param data bytes of the vector
+	 * @param size number of bytes
+	 */
+	void append(const void* data, uint64_t size);
+
+	/** compress the last (partial) block, no vectors can be appended
+	 * afterwards */
+	void finalize();
+
+	/** @return number of vectors */
+	index_t get_num_vectors() const
+	{
+		return m_offsets.size()-1;
+	}
+
+	/** @param num index of the vector
+	 * @return size of the vector in bytes */
+	uint64_t get_size(index_t num) const
+	{
+		return m_offsets[num+1]-m_offsets[num];
+	}
+
+	/** decompress a vector
+	 *
+	 * @param num index of the vector
+	 * @param target buffer of at least get_size(num) bytes
+	 */
+	void get(index_t num, void* target) const;
+
+	/** @return size of the compressed blocks in bytes */
+	uint64_t get_compressed_size() const;
+
+	/** @return size of all vectors in bytes */
+	uint64_t get_uncompressed_size() const
+	{
+		return m_offsets.back();
+	}
+
+private:
+	/** @return the decompressed block from the cache of the calling
+	 * thread, valid until the thread decompresses another block */
+	const uint8_t* get_block(index_t block) const;
+
+	/** compress the pending vectors into a new block */
+	void compress_pending();
+
+	/** compressor */
+	std::shared_ptr<Compressor> m_compressor;
+	/** number of vectors per block */
+	int32_t m_vectors_per_block;
+	/** compression level */
+	int32_t m_level;
+	/** unique id of the store, which identifies its cached blocks */
+	uint64_t m_id;
+	/** whether finalize() was called */
+	bool m_finalized;
+	/** offsets of the vectors in bytes, get_num_vectors()+1 of them */
+	std::vector<uint64_t> m_offsets;
+	/** compressed blocks */
+	std::vector<SGVector<uint8_t>> m_blocks;
+	/** vectors appended since the last block was compressed */
+	std::vector<uint8_t> m_pending;
+};
+}
+#endif /* __COMPRESSEDVECTORSTORE_H__ */
@@ -0,0 +1,154 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <shogun/lib/common.h>
+#include <shogun/io/SGIO.h>
+#include <shogun/lib/FlatTrie.h>
+
+#include <algorithm>
+
+using namespace shogun;
+
+namespace
+{
+	/** number of symbols of the alphabet */
+	const int32_t NUM_SYMS=4;
+	/** number of set bits of a child mask */
+	const uint8_t NUM_CHILDREN[1<<NUM_SYMS]=
+		{0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4};
+}
+
+FlatTrie::FlatTrie(int32_t d, int32_t num_tries)
+: degree(d), tries(num_tries)
+{
+	require(degree>0, "Degree ({}) must be positive", degree);
+	require(num_tries>=0, "Number of tries ({}) must be non-negative",
+		num_tries);
+}
+
+void FlatTrie::build(int32_t trie, std::vector<Item>& items)
+{
+	ASSERT(trie>=0 && trie<get_num_tries())
+
+	// items[begin[n], end[n]) are the k-mers sharing the prefix of node n
+	std::vector<Node> nodes(1, Node{0.0, 0, 0});
+	std::vector<index_t> begin(1, 0);
+	std::vector<index_t> end(1, items.size());
+	std::vector<int32_t> depth(1, 0);
+	std::vector<Item> buffer(items.size());
+
+	// nodes are appended while they are processed, which yields breadth
+	// first order with contiguous children
+	for (size_t n=0; n<nodes.size(); n++)
+	{
+		const int32_t d=depth[n];
+		if (d==degree)
+			continue;
+
+		// counting sort by the symbol at depth d, k-mers ending here drop out
+		index_t counts[NUM_SYMS]={0, 0, 0, 0};
+		for (index_t i=begin[n]; i<end[n]; i++)
+		{
+			if (items[i].len>d)
+			{
+				ASSERT(items[i].seq[d]>=0 && items[i].seq[d]<NUM_SYMS)
+				counts[items[i].seq[d]]++;
+			}
+		}
+
+		index_t offsets[NUM_SYMS];
+		index_t offset=begin[n];
+		for (int32_t s=0; s<NUM_SYMS; s++)
+		{
+			offsets[s]=offset;
+			offset+=counts[s];
+		}
+		for (index_t i=begin[n]; i<end[n]; i++)
+		{
+			if (items[i].len>d)
+				buffer[offsets[items[i].seq[d]]++]=items[i];
+		}
+
+		nodes[n].first_child=nodes.size();
+		offset=begin[n];
+		for (int32_t s=0; s<NUM_SYMS; s++)
+		{
+			if (!counts[s])
+				continue;
+
+			float64_t weight=0;
+			for (index_t i=offset; i<offset+counts[s]; i++)
+			{
+				items[i]=buffer[i];
+				weight+=items[i].alpha*items[i].weights[d];
+			}
+
+			nodes[n].children|=1<<s;
+			nodes.push_back(Node{weight, 0, 0});
+			begin.push_back(offset);
+			end.push_back(offset+counts[s]);
+			depth.push_back(d+1);
+			offset+=counts[s];
+		}
+	}
+
+	nodes.shrink_to_fit();
+	tries[trie]=std::move(nodes);
+}
+
+float64_t FlatTrie::compute(int32_t trie, const int32_t* vec, int32_t len) const
+{
+	const auto& nodes=tries[trie];
+	if (nodes.empty())
+		return 0.0;
+
+	float64_t sum=0;
+	const Node* node=&nodes[0];
+	for (int32_t j=0; j<degree && j<len; j++)
+	{
+		const int32_t sym=vec[j];
+		ASSERT(sym>=0 && sym<NUM_SYMS)
+		if (!(node->children & (1<<sym)))
+			break;
+
+		// children are ordered by symbol, skip the ones before sym
+		const uint8_t before=node->children & ((1<<sym)-1);
+		node=&nodes[node->first_child+NUM_CHILDREN[before]];
+		sum+=node->weight;
+	}
+
+	return sum;
+}
+
+void FlatTrie::clear(int32_t trie)
+{
+	ASSERT(trie>=0 && trie<get_num_tries())
+	std::vector<Node>().swap(tries[trie]);
+}
+
+int64_t FlatTrie::get_num_nodes() const
+{
+	int64_t num_nodes=0;
+	for (const auto& nodes : tries)
+		num_nodes+=nodes.size();
+
+	return num_nodes;
+}
+
+void FlatTrie::set_input(int32_t num_suppvec, const int32_t* IDX,
+	const float64_t* alphas, std::vector<float64_t> params)
+{
+	input_idx.assign(IDX, IDX+num_suppvec);
+	input_alphas.assign(alphas, alphas+num_suppvec);
+	input_params=std::move(params);
+}
+
+bool FlatTrie::has_input(int32_t num_suppvec, const int32_t* IDX,
+	const float64_t* alphas, const std::vector<float64_t>& params) const
+{
+	return input_idx.size()==size_t(num_suppvec) &&
+		std::equal(input_idx.begin(), input_idx.end(), IDX) &&
+		std::equal(input_alphas.begin(), input_alphas.end(), alphas) &&
+		input_params==params;
+}
@@ -0,0 +1,141 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#ifndef _FLATTRIE_H___
+#define _FLATTRIE_H___
+
+#include <shogun/lib/config.h>
+
+#include <shogun/lib/common.h>
+
+#include <vector>
+
+/** number of trie nodes (16 bytes each) that batch computations with flat
+ * tries may allocate at once */
+#define FLAT_TRIE_BLOCK_NODES (1<<22)
+
+namespace shogun
+{
+/** @brief FlatTrie stores a number of tries over the DNA alphabet (one per
+ * sequence position) in flat arrays of nodes, for the fast evaluation of
+ * weighted degree kernel based SVM outputs.
+ *
+ * Contrary to CTrie, the tries are built once from all weighted k-mers that
+ * belong to a position and are immutable afterwards. The nodes of a trie are
+ * stored in breadth-first order, the children of a node are contiguous and
+ * addressed by the index of the first child and a bit mask of the present
+ * symbols, so a node takes 16 bytes and a lookup touches few cache lines.
+ * As the tries do not share any state, they can be built and evaluated
+ * concurrently.
+ *
+ * Like CTrie with weights in the tree, a node at depth d holds the sum of
+ * \f$\alpha w_{d-1}\f$ over all k-mers sharing its prefix, such that the
+ * output for a sequence is the sum of the node weights along the path it
+ * matches.
+ */
+class FlatTrie
+{
+public:
+	/** a weighted k-mer to be added to a trie */
+	struct Item
+	{
+		/** symbols (in [0, 3]) of the k-mer */
+		const int32_t* seq;
+		/** number of symbols of the k-mer (at most the degree) */
+		int32_t len;
+		/** weight of the k-mer */
+		float64_t alpha;
+		/** weights of the k-mer per depth */
+		const float64_t* weights;
+	};
+
+	/** constructor
+	 *
+	 * @param degree degree (maximum depth) of the tries
+	 * @param num_tries number of tries
+	 */
+	FlatTrie(int32_t degree, int32_t num_tries);
+
+	/** build a trie from a set of k-mers, replacing the previous one
+	 *
+	 * @param trie index of the trie
+	 * @param items k-mers, reordered during construction
+	 */
+	void build(int32_t trie, std::vector<Item>& items);
+
+	/** sum of the node weights along the path matched by a sequence
+	 *
+	 * @param trie index of the trie
+	 * @param vec symbols (in [0, 3]) of the sequence starting at the
+	 *        position of the trie
+	 * @param len number of symbols available in vec
+	 * @return output
+	 */
+	float64_t compute(int32_t trie, const int32_t* vec, int32_t len) const;
+
+	/** release the nodes of a trie
+	 *
+	 * @param trie index of the trie
+	 */
+	void clear(int32_t trie);
+
+	/** @return number of tries */
+	int32_t get_num_tries() const
+	{
+		return tries.size();
+	}
+
+	/** @return total number of nodes of all tries */
+	int64_t get_num_nodes() const;
+
+	/** remember the input all tries were built from, so that they can be
+	 * reused by later batch computations on the same input
+	 *
+	 * @param num_suppvec number of support vectors
+	 * @param IDX indices of the support vectors
+	 * @param alphas weights of the support vectors
+	 * @param params any other parameters the tries depend on
+	 */
+	void set_input(int32_t num_suppvec, const int32_t* IDX,
+		const float64_t* alphas, std::vector<float64_t> params);
+
+	/** @return whether all tries were built from the given input, see
+	 * set_input()
+	 *
+	 * @param num_suppvec number of support vectors
+	 * @param IDX indices of the support vectors
+	 * @param alphas weights of the support vectors
+	 * @param params any other parameters the tries depend on
+	 */
+	bool has_input(int32_t num_suppvec, const int32_t* IDX,
+		const float64_t* alphas, const std::vector<float64_t>& params) const;
+
+private:
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+	/** trie node */
+	struct Node
+	{
+		/** weight */
+		float64_t weight;
+		/** index of the first child */
+		int32_t first_child;
+		/** bit i is set if there is a child for symbol i */
+		uint8_t children;
+	};
+#endif
+
+	/** degree */
+	int32_t degree;
+	/** nodes of the tries, the root is the first node */
+	std::vector<std::vector<Node>> tries;
+
+	/** indices of the support vectors, see set_input() */
+	std::vector<int32_t> input_idx;
+	/** weights of the support vectors, see set_input() */
+	std::vector<float64_t> input_alphas;
+	/** other parameters, see set_input() */
+	std::vector<float64_t> input_params;
+};
+}
+#endif /* _FLATTRIE_H___ */
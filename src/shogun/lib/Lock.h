@@ -27,6 +27,16 @@ public:
 		while (m_locked.exchange(true, std::memory_order_acquire));
 	}
 
+	/** lock the object if it is not locked, without waiting
+	 *
+	 * @return whether the object was locked by this call
+	 */
+	SG_FORCED_INLINE bool try_lock()
+	{
+		return !m_locked.load(std::memory_order_relaxed) &&
+			!m_locked.exchange(true, std::memory_order_acquire);
+	}
+
 	/** unlock the object (must be called as often as lock) */
 	SG_FORCED_INLINE void unlock()
 	{
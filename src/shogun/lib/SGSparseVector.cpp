@@ -10,9 +10,18 @@
 #include <shogun/mathematics/Math.h>
 #include <shogun/io/File.h>
 
+#include <type_traits>
+
 namespace shogun
 {
 
+namespace
+{
+	/** sparse_dot() searches the entries of the shorter vector in the longer
+	 * one if it is this many times longer */
+	const int64_t SPARSE_DOT_GALLOP_RATIO=16;
+}
+
 template <class T>
 SGSparseVector<T>::SGSparseVector() : SGReferencedData()
 {
@@ -132,26 +141,70 @@ T SGSparseVector<T>::sparse_dot(const SGSparseVector<T> &a, const SGSparseVector
 		return dot_prod_expensive_unsorted(a, b);
 	}
 
+	// the shorter vector is looked up in the longer one if that is cheaper
+	// than merging both
+	const SGSparseVector<T>& s = a.num_feat_entries <= b.num_feat_entries ? a : b;
+	const SGSparseVector<T>& l = a.num_feat_entries <= b.num_feat_entries ? b : a;
+
+	if (int64_t(s.num_feat_entries) * SPARSE_DOT_GALLOP_RATIO < l.num_feat_entries)
+		return dot_prod_gallop(s, l);
+
 	T dot_prod = 0;
 	size_type a_idx = 0, b_idx = 0;
+	const SGSparseVectorEntry<T>* a_feats = a.features;
+	const SGSparseVectorEntry<T>* b_feats = b.features;
 
+	// merge without unpredictable branches: both cursors advance by the
+	// outcome of the index comparison
 	while (a_idx < a.num_feat_entries && b_idx < b.num_feat_entries)
 	{
-		if (a.features[a_idx].feat_index < b.features[b_idx].feat_index)
-		{
-			a_idx++;
-		}
-		else if (a.features[a_idx].feat_index > b.features[b_idx].feat_index)
+		const int32_t a_feat = a_feats[a_idx].feat_index;
+		const int32_t b_feat = b_feats[b_idx].feat_index;
+		T prod;
+		if constexpr (std::is_same_v<T, bool>)
+			prod = a_feats[a_idx].entry && b_feats[b_idx].entry;
+		else
+			prod = a_feats[a_idx].entry * b_feats[b_idx].entry;
+
+		dot_prod += a_feat == b_feat ? prod : T(0);
+		a_idx += a_feat <= b_feat;
+		b_idx += b_feat <= a_feat;
+	}
+
+	return dot_prod;
+}
+
+template <class T>
+T SGSparseVector<T>::dot_prod_gallop(const SGSparseVector<T>& s, const SGSparseVector<T>& l)
+{
+	T dot_prod = 0;
+	size_type lo = 0;
+
+	for (size_type i = 0; i < s.num_feat_entries && lo < l.num_feat_entries; ++i)
+	{
+		const int32_t feat = s.features[i].feat_index;
+
+		// exponential search for an upper bound, then binary search
+		size_type step = 1, hi = lo;
+		while (hi < l.num_feat_entries && l.features[hi].feat_index < feat)
 		{
-			b_idx++;
+			lo = hi + 1;
+			hi += step;
+			step *= 2;
 		}
-		else
+		hi = Math::min(hi, l.num_feat_entries);
+
+		while (lo < hi)
 		{
-			// a.features[a_idx].feat_index == b.features[b_idx].feat_index
-			dot_prod += a.features[a_idx].entry * b.features[b_idx].entry;
-			a_idx++;
-			b_idx++;
+			const size_type mid = lo + (hi - lo) / 2;
+			if (l.features[mid].feat_index < feat)
+				lo = mid + 1;
+			else
+				hi = mid;
 		}
+
+		if (lo < l.num_feat_entries && l.features[lo].feat_index == feat)
+			dot_prod += s.features[i].entry * l.features[lo].entry;
 	}
 
 	return dot_prod;
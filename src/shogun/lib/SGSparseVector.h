@@ -225,6 +225,17 @@ protected:
 	 */
 	static T dot_prod_expensive_unsorted(const SGSparseVector<T>& a, const SGSparseVector<T>& b);
 
+	/** helper function to compute the dot product of sorted sparse vectors
+	 * by searching each entry of the short vector in the long one, which is
+	 * cheaper than merging if the lengths are very different
+	 *
+	 * @param s short vector
+	 * @param l long vector
+	 *
+	 * @return dot product
+	 */
+	static T dot_prod_gallop(const SGSparseVector<T>& s, const SGSparseVector<T>& l);
+
 public:
 	/** number of feature entries */
 	size_type num_feat_entries;
@@ -0,0 +1,185 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#ifndef __SHARDEDVECTORCACHE_H__
+#define __SHARDEDVECTORCACHE_H__
+
+#include <shogun/lib/config.h>
+
+#include <shogun/base/ShogunEnv.h>
+#include <shogun/lib/SGVector.h>
+#include <shogun/lib/common.h>
+#include <shogun/mathematics/Math.h>
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace shogun
+{
+#ifndef DOXYGEN_SHOULD_SKIP_THIS
+namespace detail
+{
+	/** source of the ids of ShardedVectorCache instances */
+	inline std::atomic<uint64_t> next_sharded_cache_id{1};
+}
+#endif
+
+/** @brief ShardedVectorCache caches vectors that are expensive to compute,
+ * e.g. feature vectors computed on the fly, for concurrent readers.
+ *
+ * Every thread that uses the cache gets its own shard, a least recently
+ * used cache that only this thread reads and writes, so lookups and
+ * insertions need no locks or atomics. Only the first access of a thread
+ * registers its shard under a lock. The memory budget is split evenly among
+ * the threads of the environment.
+ *
+ * Vectors are copied out of the cache, so callers may keep them as long as
+ * they like and the cache can evict entries at any time. Threads do not see
+ * the vectors other threads cached.
+ */
+template <class T>
+class ShardedVectorCache
+{
+	/** cached vector */
+	struct Entry
+	{
+		/** index of the vector */
+		index_t num;
+		/** the vector */
+		SGVector<T> data;
+	};
+
+	/** cache of one thread */
+	struct Shard
+	{
+		/** entries, most recently used first */
+		std::list<Entry> entries;
+		/** entries by index */
+		std::unordered_map<index_t, typename std::list<Entry>::iterator> lookup;
+		/** size of the cached vectors in bytes */
+		int64_t size=0;
+	};
+
+public:
+	/** constructor
+	 *
+	 * @param cache_size memory budget in MB, shared by all threads
+	 */
+	explicit ShardedVectorCache(int64_t cache_size)
+	: m_id(detail::next_sharded_cache_id++),
+		m_shard_size(cache_size*1024*1024/Math::max(env()->get_num_threads(), 1))
+	{
+	}
+
+	/** look up a vector in the cache of the calling thread
+	 *
+	 * @param num index of the vector
+	 * @param len length of the vector (returned)
+	 * @return copy of the vector, to be SG_FREE()'d, NULL if not cached
+	 */
+	T* get(index_t num, int32_t& len) const
+	{
+		Shard& shard=get_shard();
+		auto it=shard.lookup.find(num);
+		if (it==shard.lookup.end())
+			return NULL;
+
+		shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+		const auto& data=it->second->data;
+		len=data.vlen;
+		T* vec=SG_MALLOC(T, len);
+		sg_memcpy(vec, data.vector, len*sizeof(T));
+		return vec;
+	}
+
+	/** add a vector to the cache of the calling thread, evicting the least
+	 * recently used vectors to stay within the budget
+	 *
+	 * @param num index of the vector
+	 * @param vec the vector
+	 * @param len length of the vector
+	 */
+	void put(index_t num, const T* vec, int32_t len) const
+	{
+		const int64_t size=int64_t(len)*sizeof(T);
+		if (size>m_shard_size)
+			return;
+
+		Shard& shard=get_shard();
+		auto it=shard.lookup.find(num);
+		if (it!=shard.lookup.end())
+		{
+			shard.size-=it->second->data.vlen*sizeof(T);
+			shard.entries.erase(it->second);
+			shard.lookup.erase(it);
+		}
+
+		while (shard.size+size>m_shard_size)
+		{
+			const auto& last=shard.entries.back();
+			shard.size-=last.data.vlen*sizeof(T);
+			shard.lookup.erase(last.num);
+			shard.entries.pop_back();
+		}
+
+		SGVector<T> data(len);
+		sg_memcpy(data.vector, vec, size);
+		shard.entries.push_front(Entry{num, data});
+		shard.lookup[num]=shard.entries.begin();
+		shard.size+=size;
+	}
+
+	/** @return memory budget of each thread in bytes */
+	int64_t get_shard_size() const
+	{
+		return m_shard_size;
+	}
+
+private:
+	/** @return the shard of the calling thread, registering it on its
+	 * first call */
+	Shard& get_shard() const
+	{
+		/* shards of the calling thread by cache id. The ids are unique and
+		 * this cache owns its shards, so a found shard is alive, the weak
+		 * pointers only tell which shards of destroyed caches to drop */
+		thread_local std::unordered_map<uint64_t,
+			std::pair<Shard*, std::weak_ptr<Shard>>> shards;
+
+		auto it=shards.find(m_id);
+		if (it!=shards.end())
+			return *it->second.first;
+
+		for (auto expired=shards.begin(); expired!=shards.end();)
+		{
+			if (expired->second.second.expired())
+				expired=shards.erase(expired);
+			else
+				++expired;
+		}
+
+		auto shard=std::make_shared<Shard>();
+		{
+			std::lock_guard<std::mutex> lock(m_shards_lock);
+			m_shards.push_back(shard);
+		}
+		shards[m_id]=std::make_pair(shard.get(), std::weak_ptr<Shard>(shard));
+		return *shard;
+	}
+
+	/** unique id of the cache */
+	const uint64_t m_id;
+	/** memory budget of each shard in bytes */
+	const int64_t m_shard_size;
+	/** shards of all threads, owned by the cache */
+	mutable std::vector<std::shared_ptr<Shard>> m_shards;
+	/** lock for registering shards */
+	mutable std::mutex m_shards_lock;
+};
+}
+#endif /* __SHARDEDVECTORCACHE_H__ */
@@ -200,6 +200,44 @@ namespace shogun
 		virtual void exit_std_vector(size_t* size) = 0;
 		virtual void exit_map(size_t* size) = 0;
 
+		/** Visits a contiguous array of plain numbers (see on_array) at
+		 * once, which is much faster than visiting the elements one by one
+		 * for large arrays. Called after enter_vector/enter_matrix, in place
+		 * of the visits of the elements.
+		 *
+		 * @param data first element of the array
+		 * @param bytes size of the array in bytes
+		 * @return whether the array was visited, if not its elements are
+		 * visited one by one
+		 */
+		virtual bool on_contiguous(void* data, int64_t bytes)
+		{
+			return false;
+		}
+
+		/** Visits an array with on_contiguous if its elements are plain
+		 * numbers, whose memory layout is their natural serialised form.
+		 *
+		 * @param data first element of the array
+		 * @param length number of elements
+		 * @return whether the array was visited
+		 */
+		template <typename T>
+		bool on_array(T* data, int64_t length)
+		{
+			if constexpr (
+			    (std::is_integral_v<T> && !std::is_same_v<T, bool>) ||
+			    std::is_same_v<T, float32_t> ||
+			    std::is_same_v<T, float64_t> ||
+			    std::is_same_v<T, complex128_t>)
+			{
+				return length == 0 ||
+				       on_contiguous(data, length * int64_t(sizeof(T)));
+			}
+			else
+				return false;
+		}
+
 		template <typename T>
 		void on(std::atomic<T>* val)
 		{
@@ -244,8 +282,11 @@ namespace shogun
 			enter_vector(std::addressof(size));
 			if (size != _v->vlen)
 				_v->resize_vector(size);
-			for (auto&& _value : *_v)
-				on(std::addressof(_value));
+			if (!on_array(_v->vector, size))
+			{
+				for (auto&& _value : *_v)
+					on(std::addressof(_value));
+			}
 			exit_vector(std::addressof(size));
 		}
 
@@ -289,8 +330,11 @@ namespace shogun
 					*_v->ptr() = SG_CALLOC(T, size);
 			}
 			auto ptr = *(_v->ptr());
-			for (S i = 0; i < size; ++i)
-				on(std::addressof(ptr[i]));
+			if (!on_array(ptr, size))
+			{
+				for (S i = 0; i < size; ++i)
+					on(std::addressof(ptr[i]));
+			}
 			exit_vector(std::addressof(size));
 		}
 
@@ -310,8 +354,11 @@ namespace shogun
 					*_v->ptr() = SG_MALLOC(T, length);
 			}
 			auto ptr = *(_v->ptr());
-			for (int64_t i = 0; i < length; ++i)
-				on(std::addressof(ptr[i]));
+			if (!on_array(ptr, length))
+			{
+				for (int64_t i = 0; i < length; ++i)
+					on(std::addressof(ptr[i]));
+			}
 			exit_matrix(shape.first, shape.second);
 		}
 
@@ -323,10 +370,13 @@ namespace shogun
 			enter_matrix(std::addressof(rows), std::addressof(cols));
 			if ((rows != _matrix->num_rows) || (cols != _matrix->num_cols))
 				*_matrix = SGMatrix<T>(rows, cols);
-			for (auto index = 0; index < cols; index++)
+			if (!on_array(_matrix->matrix, int64_t(rows) * cols))
 			{
-				on_matrix_row(
-				    std::addressof(rows), std::addressof(index), _matrix);
+				for (auto index = 0; index < cols; index++)
+				{
+					on_matrix_row(
+					    std::addressof(rows), std::addressof(index), _matrix);
+				}
 			}
 			exit_matrix(std::addressof(rows), std::addressof(cols));
 		}
@@ -56,4 +56,15 @@ SG_FORCED_INLINE static void CpuRelax()
 #endif
 }
 
+/** hint the CPU to load the cache line of an address, which will be read
+ * soon */
+SG_FORCED_INLINE static void CpuPrefetch(const void* address)
+{
+#ifdef _MSC_VER
+	_mm_prefetch((const char*) address, _MM_HINT_T0);
+#elif defined(__GNUC__) || defined(__clang__)
+	__builtin_prefetch(address);
+#endif
+}
+
 #endif /* __CPU_INFO_H__ */
@@ -51,6 +51,7 @@
 #include <float.h>
 #include <string.h>
 #include <stdarg.h>
+#include <vector>
 
 #include <rxcpp/rx.hpp>
 
@@ -67,6 +68,34 @@ template <class S, class T> inline void clone(T*& dst, S* src, int32_t n)
 }
 #define INF HUGE_VAL
 #define TAU 1e-12
+// minimum number of variables for which the solver loops run in parallel
+#define PARALLEL_MIN_SIZE 4096
+
+// merge the maximum of a chunk of variables into the overall maximum, ties are
+// resolved towards the larger index as in a sequential scan with >=
+inline void merge_max(
+	float64_t& max, int32_t& idx, float64_t chunk_max, int32_t chunk_idx)
+{
+	if (chunk_idx != -1 &&
+		(chunk_max > max || (chunk_max == max && chunk_idx > idx)))
+	{
+		max = chunk_max;
+		idx = chunk_idx;
+	}
+}
+
+// merge the minimum of a chunk of variables into the overall minimum, ties are
+// resolved towards the larger index as in a sequential scan with <=
+inline void merge_min(
+	float64_t& min, int32_t& idx, float64_t chunk_min, int32_t chunk_idx)
+{
+	if (chunk_idx != -1 &&
+		(chunk_min < min || (chunk_min == min && chunk_idx > idx)))
+	{
+		min = chunk_min;
+		idx = chunk_idx;
+	}
+}
 
 class QMatrix;
 class SVC_QMC;
@@ -232,17 +261,28 @@ public:
 
 	void compute_Q_parallel(Qfloat* data, float64_t* lab, int32_t i, int32_t start, int32_t len) const
 	{
+		if (start>=len)
+			return;
+
+		// fetch the whole row segment with a single batched kernel call
+		SGVector<index_t> lhs_idx(1);
+		SGVector<index_t> rhs_idx(len-start);
+		lhs_idx[0]=x[i]->index;
+		for(int32_t j=start;j<len;j++)
+			rhs_idx[j-start]=x[j]->index;
+
+		SGMatrix<float64_t> row(1, len-start);
+		kernel->compute_block(lhs_idx, rhs_idx, row);
+
 		if (lab) // two class
 		{
-			#pragma omp parallel for
 			for(int32_t j=start;j<len;j++)
-				data[j] = (Qfloat) lab[i]*lab[j]*this->kernel_function(i,j);
+				data[j] = (Qfloat) lab[i]*lab[j]*row[j-start];
 		}
 		else // one class, eps svr
 		{
-			#pragma omp parallel for
 			for(int32_t j=start;j<len;j++)
-				data[j] = (Qfloat) this->kernel_function(i,j);
+				data[j] = (Qfloat) row[j-start];
 		}
 	}
 
@@ -342,6 +382,7 @@ protected:
 	bool is_free(int32_t i) { return alpha_status[i] == FREE; }
 	void swap_index(int32_t i, int32_t j);
 	void reconstruct_gradient();
+	void shrink_active_set(const std::vector<uint8_t>& shrunk);
 	virtual int32_t select_working_set(int32_t &i, int32_t &j, float64_t &gap);
 	virtual float64_t calculate_rho();
 	virtual void do_shrinking();
@@ -408,24 +449,31 @@ void Solver::reconstruct_gradient()
 
 	if(active_size == l) return;
 
-	int32_t i,j;
+	int32_t i;
 	int32_t nr_free = 0;
 
-	for(j=active_size;j<l;j++)
+	#pragma omp parallel for if (l >= PARALLEL_MIN_SIZE)
+	for(int32_t j=active_size;j<l;j++)
 		G[j] = G_bar[j] + p[j];
 
-	for(j=0;j<active_size;j++)
+	#pragma omp parallel for reduction(+:nr_free) if (active_size >= PARALLEL_MIN_SIZE)
+	for(int32_t j=0;j<active_size;j++)
 		if(is_free(j))
 			nr_free++;
 
+	// the rows of Q are fetched one at a time as the kernel cache is not
+	// thread safe, only the products with them are parallel
 	if (nr_free*l > 2*active_size*(l-active_size))
 	{
 		for(i=active_size;i<l;i++)
 		{
 			const Qfloat *Q_i = Q->get_Q(i,active_size);
-			for(j=0;j<active_size;j++)
+			float64_t G_i = 0;
+			#pragma omp parallel for reduction(+:G_i) if (active_size >= PARALLEL_MIN_SIZE)
+			for(int32_t j=0;j<active_size;j++)
 				if(is_free(j))
-					G[i] += alpha[j] * Q_i[j];
+					G_i += alpha[j] * Q_i[j];
+			G[i] += G_i;
 		}
 	}
 	else
@@ -435,12 +483,33 @@ void Solver::reconstruct_gradient()
 			{
 				const Qfloat *Q_i = Q->get_Q(i,l);
 				float64_t alpha_i = alpha[i];
-				for(j=active_size;j<l;j++)
+				#pragma omp parallel for if (l-active_size >= PARALLEL_MIN_SIZE)
+				for(int32_t j=active_size;j<l;j++)
 					G[j] += alpha_i * Q_i[j];
 			}
 	}
 }
 
+void Solver::shrink_active_set(const std::vector<uint8_t>& shrunk)
+{
+	// move the shrunk variables behind the active set, shrunk[i] refers to
+	// the variable at position i when the active set was scanned
+	for(int32_t i=0;i<active_size;i++)
+		if (shrunk[i])
+		{
+			active_size--;
+			while (active_size > i)
+			{
+				if (!shrunk[active_size])
+				{
+					swap_index(i,active_size);
+					break;
+				}
+				active_size--;
+			}
+		}
+}
+
 void Solver::Solve(
 	int32_t p_l, const QMatrix& p_Q, const float64_t *p_p,
 	const schar *p_y, float64_t *p_alpha, float64_t p_Cp, float64_t p_Cn,
@@ -668,6 +737,7 @@ void Solver::Solve(
 		float64_t delta_alpha_i = alpha[i] - old_alpha_i;
 		float64_t delta_alpha_j = alpha[j] - old_alpha_j;
 
+		#pragma omp parallel for if (active_size >= PARALLEL_MIN_SIZE)
 		for(int32_t k=0;k<active_size;k++)
 		{
 			G[k] += Q_i[k]*delta_alpha_i + Q_j[k]*delta_alpha_j;
@@ -680,27 +750,22 @@ void Solver::Solve(
 			bool uj = is_upper_bound(j);
 			update_alpha_status(i);
 			update_alpha_status(j);
-			int32_t k;
 			if(ui != is_upper_bound(i))
 			{
 				Q_i = Q->get_Q(i,l);
-				if(ui)
-					for(k=0;k<l;k++)
-						G_bar[k] -= C_i * Q_i[k];
-				else
-					for(k=0;k<l;k++)
-						G_bar[k] += C_i * Q_i[k];
+				float64_t C_i_signed = ui ? -C_i : C_i;
+				#pragma omp parallel for if (l >= PARALLEL_MIN_SIZE)
+				for(int32_t k=0;k<l;k++)
+					G_bar[k] += C_i_signed * Q_i[k];
 			}
 
 			if(uj != is_upper_bound(j))
 			{
 				Q_j = Q->get_Q(j,l);
-				if(uj)
-					for(k=0;k<l;k++)
-						G_bar[k] -= C_j * Q_j[k];
-				else
-					for(k=0;k<l;k++)
-						G_bar[k] += C_j * Q_j[k];
+				float64_t C_j_signed = uj ? -C_j : C_j;
+				#pragma omp parallel for if (l >= PARALLEL_MIN_SIZE)
+				for(int32_t k=0;k<l;k++)
+					G_bar[k] += C_j_signed * Q_j[k];
 			}
 		}
 
@@ -777,81 +842,107 @@ int32_t Solver::select_working_set(
 	int32_t Gmin_idx = -1;
 	float64_t obj_diff_min = INF;
 
-	for(int32_t t=0;t<active_size;t++)
-		if(y[t]==+1)
-		{
-			if(!is_upper_bound(t))
-				if(-G[t] >= Gmax)
-				{
-					Gmax = -G[t];
-					Gmax_idx = t;
-				}
-		}
-		else
-		{
-			if(!is_lower_bound(t))
-				if(G[t] >= Gmax)
-				{
-					Gmax = G[t];
-					Gmax_idx = t;
-				}
-		}
+	// both scans are reductions over the active set, each thread scans a
+	// chunk and the results are merged such that they match a sequential scan
+	#pragma omp parallel if (active_size >= PARALLEL_MIN_SIZE)
+	{
+		float64_t chunk_Gmax = -INF;
+		int32_t chunk_Gmax_idx = -1;
+
+		#pragma omp for nowait
+		for(int32_t t=0;t<active_size;t++)
+			if(y[t]==+1)
+			{
+				if(!is_upper_bound(t))
+					if(-G[t] >= chunk_Gmax)
+					{
+						chunk_Gmax = -G[t];
+						chunk_Gmax_idx = t;
+					}
+			}
+			else
+			{
+				if(!is_lower_bound(t))
+					if(G[t] >= chunk_Gmax)
+					{
+						chunk_Gmax = G[t];
+						chunk_Gmax_idx = t;
+					}
+			}
+
+		#pragma omp critical
+		merge_max(Gmax, Gmax_idx, chunk_Gmax, chunk_Gmax_idx);
+	}
 
 	int32_t i = Gmax_idx;
 	const Qfloat *Q_i = NULL;
 	if(i != -1) // NULL Q_i not accessed: Gmax=-INF if i=-1
 		Q_i = Q->get_Q(i,active_size);
 
-	for(int32_t j=0;j<active_size;j++)
+	#pragma omp parallel if (active_size >= PARALLEL_MIN_SIZE)
 	{
-		if(y[j]==+1)
+		float64_t chunk_Gmax2 = -INF;
+		int32_t chunk_Gmin_idx = -1;
+		float64_t chunk_obj_diff_min = INF;
+
+		#pragma omp for nowait
+		for(int32_t j=0;j<active_size;j++)
 		{
-			if (!is_lower_bound(j))
+			if(y[j]==+1)
 			{
-				float64_t grad_diff=Gmax+G[j];
-				if (G[j] >= Gmax2)
-					Gmax2 = G[j];
-				if (grad_diff > 0)
+				if (!is_lower_bound(j))
 				{
-					float64_t obj_diff;
-					float64_t quad_coef=Q_i[i]+QD[j]-2.0*y[i]*Q_i[j];
-					if (quad_coef > 0)
-						obj_diff = -(grad_diff*grad_diff)/quad_coef;
-					else
-						obj_diff = -(grad_diff*grad_diff)/TAU;
-
-					if (obj_diff <= obj_diff_min)
+					float64_t grad_diff=Gmax+G[j];
+					if (G[j] >= chunk_Gmax2)
+						chunk_Gmax2 = G[j];
+					if (grad_diff > 0)
 					{
-						Gmin_idx=j;
-						obj_diff_min = obj_diff;
+						float64_t obj_diff;
+						float64_t quad_coef=Q_i[i]+QD[j]-2.0*y[i]*Q_i[j];
+						if (quad_coef > 0)
+							obj_diff = -(grad_diff*grad_diff)/quad_coef;
+						else
+							obj_diff = -(grad_diff*grad_diff)/TAU;
+
+						if (obj_diff <= chunk_obj_diff_min)
+						{
+							chunk_Gmin_idx=j;
+							chunk_obj_diff_min = obj_diff;
+						}
 					}
 				}
 			}
-		}
-		else
-		{
-			if (!is_upper_bound(j))
+			else
 			{
-				float64_t grad_diff= Gmax-G[j];
-				if (-G[j] >= Gmax2)
-					Gmax2 = -G[j];
-				if (grad_diff > 0)
+				if (!is_upper_bound(j))
 				{
-					float64_t obj_diff;
-					float64_t quad_coef=Q_i[i]+QD[j]+2.0*y[i]*Q_i[j];
-					if (quad_coef > 0)
-						obj_diff = -(grad_diff*grad_diff)/quad_coef;
-					else
-						obj_diff = -(grad_diff*grad_diff)/TAU;
-
-					if (obj_diff <= obj_diff_min)
+					float64_t grad_diff= Gmax-G[j];
+					if (-G[j] >= chunk_Gmax2)
+						chunk_Gmax2 = -G[j];
+					if (grad_diff > 0)
 					{
-						Gmin_idx=j;
-						obj_diff_min = obj_diff;
+						float64_t obj_diff;
+						float64_t quad_coef=Q_i[i]+QD[j]+2.0*y[i]*Q_i[j];
+						if (quad_coef > 0)
+							obj_diff = -(grad_diff*grad_diff)/quad_coef;
+						else
+							obj_diff = -(grad_diff*grad_diff)/TAU;
+
+						if (obj_diff <= chunk_obj_diff_min)
+						{
+							chunk_Gmin_idx=j;
+							chunk_obj_diff_min = obj_diff;
+						}
 					}
 				}
 			}
 		}
+
+		#pragma omp critical
+		{
+			Gmax2 = Math::max(Gmax2, chunk_Gmax2);
+			merge_min(obj_diff_min, Gmin_idx, chunk_obj_diff_min, chunk_Gmin_idx);
+		}
 	}
 
 	gap=Gmax+Gmax2;
@@ -886,38 +977,50 @@ bool Solver::be_shrunk(int32_t i, float64_t Gmax1, float64_t Gmax2)
 
 void Solver::do_shrinking()
 {
-	int32_t i;
 	float64_t Gmax1 = -INF;		// max { -y_i * grad(f)_i | i in I_up(\alpha) }
 	float64_t Gmax2 = -INF;		// max { y_i * grad(f)_i | i in I_low(\alpha) }
 
 	// find maximal violating pair first
-	for(i=0;i<active_size;i++)
+	#pragma omp parallel if (active_size >= PARALLEL_MIN_SIZE)
 	{
-		if(y[i]==+1)
+		float64_t chunk_Gmax1 = -INF;
+		float64_t chunk_Gmax2 = -INF;
+
+		#pragma omp for nowait
+		for(int32_t i=0;i<active_size;i++)
 		{
-			if(!is_upper_bound(i))
+			if(y[i]==+1)
 			{
-				if(-G[i] >= Gmax1)
-					Gmax1 = -G[i];
+				if(!is_upper_bound(i))
+				{
+					if(-G[i] >= chunk_Gmax1)
+						chunk_Gmax1 = -G[i];
+				}
+				if(!is_lower_bound(i))
+				{
+					if(G[i] >= chunk_Gmax2)
+						chunk_Gmax2 = G[i];
+				}
 			}
-			if(!is_lower_bound(i))
+			else
 			{
-				if(G[i] >= Gmax2)
-					Gmax2 = G[i];
+				if(!is_upper_bound(i))
+				{
+					if(-G[i] >= chunk_Gmax2)
+						chunk_Gmax2 = -G[i];
+				}
+				if(!is_lower_bound(i))
+				{
+					if(G[i] >= chunk_Gmax1)
+						chunk_Gmax1 = G[i];
+				}
 			}
 		}
-		else
+
+		#pragma omp critical
 		{
-			if(!is_upper_bound(i))
-			{
-				if(-G[i] >= Gmax2)
-					Gmax2 = -G[i];
-			}
-			if(!is_lower_bound(i))
-			{
-				if(G[i] >= Gmax1)
-					Gmax1 = G[i];
-			}
+			Gmax1 = Math::max(Gmax1, chunk_Gmax1);
+			Gmax2 = Math::max(Gmax2, chunk_Gmax2);
 		}
 	}
 
@@ -928,20 +1031,12 @@ void Solver::do_shrinking()
 		active_size = l;
 	}
 
-	for(i=0;i<active_size;i++)
-		if (be_shrunk(i, Gmax1, Gmax2))
-		{
-			active_size--;
-			while (active_size > i)
-			{
-				if (!be_shrunk(active_size, Gmax1, Gmax2))
-				{
-					swap_index(i,active_size);
-					break;
-				}
-				active_size--;
-			}
-		}
+	std::vector<uint8_t> shrunk(active_size);
+	#pragma omp parallel for if (active_size >= PARALLEL_MIN_SIZE)
+	for(int32_t i=0;i<active_size;i++)
+		shrunk[i] = be_shrunk(i, Gmax1, Gmax2);
+
+	shrink_active_set(shrunk);
 }
 
 float64_t Solver::calculate_rho()
@@ -1060,25 +1155,40 @@ int32_t Solver_NU::select_working_set(
 	int32_t Gmin_idx = -1;
 	float64_t obj_diff_min = INF;
 
-	for(int32_t t=0;t<active_size;t++)
-		if(y[t]==+1)
-		{
-			if(!is_upper_bound(t))
-				if(-G[t] >= Gmaxp)
-				{
-					Gmaxp = -G[t];
-					Gmaxp_idx = t;
-				}
-		}
-		else
+	#pragma omp parallel if (active_size >= PARALLEL_MIN_SIZE)
+	{
+		float64_t chunk_Gmaxp = -INF;
+		int32_t chunk_Gmaxp_idx = -1;
+		float64_t chunk_Gmaxn = -INF;
+		int32_t chunk_Gmaxn_idx = -1;
+
+		#pragma omp for nowait
+		for(int32_t t=0;t<active_size;t++)
+			if(y[t]==+1)
+			{
+				if(!is_upper_bound(t))
+					if(-G[t] >= chunk_Gmaxp)
+					{
+						chunk_Gmaxp = -G[t];
+						chunk_Gmaxp_idx = t;
+					}
+			}
+			else
+			{
+				if(!is_lower_bound(t))
+					if(G[t] >= chunk_Gmaxn)
+					{
+						chunk_Gmaxn = G[t];
+						chunk_Gmaxn_idx = t;
+					}
+			}
+
+		#pragma omp critical
 		{
-			if(!is_lower_bound(t))
-				if(G[t] >= Gmaxn)
-				{
-					Gmaxn = G[t];
-					Gmaxn_idx = t;
-				}
+			merge_max(Gmaxp, Gmaxp_idx, chunk_Gmaxp, chunk_Gmaxp_idx);
+			merge_max(Gmaxn, Gmaxn_idx, chunk_Gmaxn, chunk_Gmaxn_idx);
 		}
+	}
 
 	int32_t ip = Gmaxp_idx;
 	int32_t in = Gmaxn_idx;
@@ -1089,56 +1199,72 @@ int32_t Solver_NU::select_working_set(
 	if(in != -1)
 		Q_in = Q->get_Q(in,active_size);
 
-	for(int32_t j=0;j<active_size;j++)
+	#pragma omp parallel if (active_size >= PARALLEL_MIN_SIZE)
 	{
-		if(y[j]==+1)
+		float64_t chunk_Gmaxp2 = -INF;
+		float64_t chunk_Gmaxn2 = -INF;
+		int32_t chunk_Gmin_idx = -1;
+		float64_t chunk_obj_diff_min = INF;
+
+		#pragma omp for nowait
+		for(int32_t j=0;j<active_size;j++)
 		{
-			if (!is_lower_bound(j))
+			if(y[j]==+1)
 			{
-				float64_t grad_diff=Gmaxp+G[j];
-				if (G[j] >= Gmaxp2)
-					Gmaxp2 = G[j];
-				if (grad_diff > 0)
+				if (!is_lower_bound(j))
 				{
-					float64_t obj_diff;
-					float64_t quad_coef = Q_ip[ip]+QD[j]-2*Q_ip[j];
-					if (quad_coef > 0)
-						obj_diff = -(grad_diff*grad_diff)/quad_coef;
-					else
-						obj_diff = -(grad_diff*grad_diff)/TAU;
-
-					if (obj_diff <= obj_diff_min)
+					float64_t grad_diff=Gmaxp+G[j];
+					if (G[j] >= chunk_Gmaxp2)
+						chunk_Gmaxp2 = G[j];
+					if (grad_diff > 0)
 					{
-						Gmin_idx=j;
-						obj_diff_min = obj_diff;
+						float64_t obj_diff;
+						float64_t quad_coef = Q_ip[ip]+QD[j]-2*Q_ip[j];
+						if (quad_coef > 0)
+							obj_diff = -(grad_diff*grad_diff)/quad_coef;
+						else
+							obj_diff = -(grad_diff*grad_diff)/TAU;
+
+						if (obj_diff <= chunk_obj_diff_min)
+						{
+							chunk_Gmin_idx=j;
+							chunk_obj_diff_min = obj_diff;
+						}
 					}
 				}
 			}
-		}
-		else
-		{
-			if (!is_upper_bound(j))
+			else
 			{
-				float64_t grad_diff=Gmaxn-G[j];
-				if (-G[j] >= Gmaxn2)
-					Gmaxn2 = -G[j];
-				if (grad_diff > 0)
+				if (!is_upper_bound(j))
 				{
-					float64_t obj_diff;
-					float64_t quad_coef = Q_in[in]+QD[j]-2*Q_in[j];
-					if (quad_coef > 0)
-						obj_diff = -(grad_diff*grad_diff)/quad_coef;
-					else
-						obj_diff = -(grad_diff*grad_diff)/TAU;
-
-					if (obj_diff <= obj_diff_min)
+					float64_t grad_diff=Gmaxn-G[j];
+					if (-G[j] >= chunk_Gmaxn2)
+						chunk_Gmaxn2 = -G[j];
+					if (grad_diff > 0)
 					{
-						Gmin_idx=j;
-						obj_diff_min = obj_diff;
+						float64_t obj_diff;
+						float64_t quad_coef = Q_in[in]+QD[j]-2*Q_in[j];
+						if (quad_coef > 0)
+							obj_diff = -(grad_diff*grad_diff)/quad_coef;
+						else
+							obj_diff = -(grad_diff*grad_diff)/TAU;
+
+						if (obj_diff <= chunk_obj_diff_min)
+						{
+							chunk_Gmin_idx=j;
+							chunk_obj_diff_min = obj_diff;
+						}
 					}
 				}
 			}
 		}
+
+		#pragma omp critical
+		{
+			Gmaxp2 = Math::max(Gmaxp2, chunk_Gmaxp2);
+			Gmaxn2 = Math::max(Gmaxn2, chunk_Gmaxn2);
+			merge_min(obj_diff_min, Gmin_idx, chunk_obj_diff_min, chunk_Gmin_idx);
+		}
 	}
 
 	gap=Math::max(Gmaxp+Gmaxp2,Gmaxn+Gmaxn2);
@@ -1184,24 +1310,40 @@ void Solver_NU::do_shrinking()
 	float64_t Gmax4 = -INF;	// max { y_i * grad(f)_i | y_i = -1, i in I_low(\alpha) }
 
 	// find maximal violating pair first
-	int32_t i;
-	for(i=0;i<active_size;i++)
+	#pragma omp parallel if (active_size >= PARALLEL_MIN_SIZE)
 	{
-		if(!is_upper_bound(i))
+		float64_t chunk_Gmax1 = -INF;
+		float64_t chunk_Gmax2 = -INF;
+		float64_t chunk_Gmax3 = -INF;
+		float64_t chunk_Gmax4 = -INF;
+
+		#pragma omp for nowait
+		for(int32_t i=0;i<active_size;i++)
 		{
-			if(y[i]==+1)
+			if(!is_upper_bound(i))
 			{
-				if(-G[i] > Gmax1) Gmax1 = -G[i];
+				if(y[i]==+1)
+				{
+					if(-G[i] > chunk_Gmax1) chunk_Gmax1 = -G[i];
+				}
+				else	if(-G[i] > chunk_Gmax4) chunk_Gmax4 = -G[i];
 			}
-			else	if(-G[i] > Gmax4) Gmax4 = -G[i];
-		}
-		if(!is_lower_bound(i))
-		{
-			if(y[i]==+1)
+			if(!is_lower_bound(i))
 			{
-				if(G[i] > Gmax2) Gmax2 = G[i];
+				if(y[i]==+1)
+				{
+					if(G[i] > chunk_Gmax2) chunk_Gmax2 = G[i];
+				}
+				else	if(G[i] > chunk_Gmax3) chunk_Gmax3 = G[i];
 			}
-			else	if(G[i] > Gmax3) Gmax3 = G[i];
+		}
+
+		#pragma omp critical
+		{
+			Gmax1 = Math::max(Gmax1, chunk_Gmax1);
+			Gmax2 = Math::max(Gmax2, chunk_Gmax2);
+			Gmax3 = Math::max(Gmax3, chunk_Gmax3);
+			Gmax4 = Math::max(Gmax4, chunk_Gmax4);
 		}
 	}
 
@@ -1212,20 +1354,12 @@ void Solver_NU::do_shrinking()
 		active_size = l;
 	}
 
-	for(i=0;i<active_size;i++)
-		if (be_shrunk(i, Gmax1, Gmax2, Gmax3, Gmax4))
-		{
-			active_size--;
-			while (active_size > i)
-			{
-				if (!be_shrunk(active_size, Gmax1, Gmax2, Gmax3, Gmax4))
-				{
-					swap_index(i,active_size);
-					break;
-				}
-				active_size--;
-			}
-		}
+	std::vector<uint8_t> shrunk(active_size);
+	#pragma omp parallel for if (active_size >= PARALLEL_MIN_SIZE)
+	for(int32_t i=0;i<active_size;i++)
+		shrunk[i] = be_shrunk(i, Gmax1, Gmax2, Gmax3, Gmax4);
+
+	shrink_active_set(shrunk);
 }
 
 float64_t Solver_NU::calculate_rho()
@@ -1829,6 +1963,35 @@ private:
 //
 // construct and solve various formulations
 //
+// feasible starting point from signed initial alphas: alphas whose sign does
+// not match the label are dropped, the others are clipped to [0, C] and, if a
+// bias is used, the larger class is scaled down until sum y_i alpha_i = 0
+static void init_c_svc_alpha(
+	const svm_problem *prob, const svm_parameter* param, const schar *y,
+	float64_t *alpha, float64_t Cp, float64_t Cn)
+{
+	int32_t l = prob->l;
+	float64_t sum_pos = 0, sum_neg = 0;
+
+	for(int32_t i=0;i<l;i++)
+	{
+		float64_t a = y[i]*param->alpha_init[prob->x[i]->index];
+		alpha[i] = Math::clamp(a, 0.0, y[i]>0 ? Cp : Cn);
+		if (y[i]>0) sum_pos += alpha[i]; else sum_neg += alpha[i];
+	}
+
+	if (!param->use_bias || sum_pos==sum_neg)
+		return;
+
+	float64_t scale = sum_pos>sum_neg ? sum_neg/sum_pos : sum_pos/sum_neg;
+	schar larger = sum_pos>sum_neg ? +1 : -1;
+	for(int32_t i=0;i<l;i++)
+	{
+		if (y[i]==larger)
+			alpha[i] *= scale;
+	}
+}
+
 static void solve_c_svc(
 	const svm_problem *prob, const svm_parameter* param,
 	float64_t *alpha, Solver::SolutionInfo* si, float64_t Cp, float64_t Cn)
@@ -1844,6 +2007,9 @@ static void solve_c_svc(
 		if(prob->y[i] > 0) y[i] = +1; else y[i]=-1;
 	}
 
+	if (param->alpha_init)
+		init_c_svc_alpha(prob, param, y, alpha, Cp, Cn);
+
 	Solver s;
 	s.Solve(l, SVC_Q(*prob,*param,y), prob->pv, y,
 		alpha, Cp, Cn, param->eps, si, param->shrinking, param->use_bias);
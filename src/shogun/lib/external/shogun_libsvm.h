@@ -124,6 +124,9 @@ struct svm_parameter
 	int32_t shrinking;
 	/** compute bias */
 	bool use_bias;
+	/** for C_SVC, signed alphas to start from (warm start), indexed by the
+	 * index of the training vectors or NULL to start from zero */
+	const float64_t* alpha_init = nullptr;
 };
 
 /** svm_model */
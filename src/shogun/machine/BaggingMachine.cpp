@@ -14,6 +14,7 @@
 #include <shogun/mathematics/linalg/LinalgNamespace.h>
 #include <shogun/evaluation/Evaluation.h>
 
+#include <exception>
 #include <utility>
 
 using namespace shogun;
@@ -141,21 +142,20 @@ bool BaggingMachine::train_machine(std::shared_ptr<Features> data)
 	if (m_bag_size == 0)
 		m_bag_size = m_features->get_num_vectors();
 
-	// clear the array, if previously trained
+	// clear the array, if previously trained, bags are stored at their index
 	m_bags.clear();
+	m_bags.resize(m_num_bags);
 
-	// reset the oob index vector
-	m_all_oob_idx = SGVector<bool>(m_features->get_num_vectors());
-	m_all_oob_idx.zero();
-
-
-	m_oob_indices.clear();
+	// reset the bitsets of the bags
+	auto num_vecs = m_features->get_num_vectors();
+	m_in_bag = SGMatrix<uint64_t>((num_vecs + 63) / 64, m_num_bags);
+	m_in_bag.zero();
 
 	SGMatrix<index_t> rnd_indicies(m_bag_size, m_num_bags);
 	random::fill_array(rnd_indicies, 0, m_bag_size - 1, m_prng);
 
 	auto pb = SG_PROGRESS(range(m_num_bags));
-#pragma omp parallel for
+#pragma omp parallel for if (train_bags_in_parallel())
 	for (int32_t i = 0; i < m_num_bags; ++i)
 	{
 		auto c=std::dynamic_pointer_cast<Machine>(m_machine->clone());
@@ -201,20 +201,27 @@ bool BaggingMachine::train_machine(std::shared_ptr<Features> data)
 		features->remove_subset();
 		labels->remove_subset();
 
-#pragma omp critical
-		{
-		// get out of bag indexes
-		auto oob = get_oob_indices(idx);
-		m_oob_indices.push_back(oob);
+		// each bag only writes its own column of the bitsets
+		uint64_t* in_bag = m_in_bag.get_column_vector(i);
+		for (index_t j = 0; j < idx.vlen; j++)
+			in_bag[idx[j] / 64] |= uint64_t(1) << (idx[j] % 64);
 
-		// add trained machine to bag array
-		m_bags.push_back(c);
-		}
+		m_bags[i] = c;
 
 		pb.print_progress();
 	}
 	pb.complete();
 
+	// vectors that are out of at least one bag
+	m_all_oob_idx = SGVector<bool>(num_vecs);
+#pragma omp parallel for
+	for (index_t i = 0; i < num_vecs; i++)
+	{
+		m_all_oob_idx[i] = false;
+		for (int32_t j = 0; j < m_num_bags && !m_all_oob_idx[i]; j++)
+			m_all_oob_idx[i] = is_out_of_bag(i, j);
+	}
+
 	return true;
 }
 
@@ -235,13 +242,41 @@ void BaggingMachine::register_parameters()
 	    &m_combination_rule, kCombinationRule,
 	    "Combination rule to use for aggregating", ParameterProperties::HYPER);
 	SG_ADD(&m_all_oob_idx, kAllOobIdx, "Indices of all oob vectors");
-	SG_ADD(&m_oob_indices, kOobIndices, "OOB indices for each machine");
+	SG_ADD(&m_in_bag, kInBag, "Bitsets of the training vectors of each bag");
+	SG_ADD(
+	    &m_oob_indices, kOobIndices,
+	    "OOB indices for each machine (deprecated, use in_bag)");
 	SG_ADD(&m_machine, kMachine, "machine to use for bagging");
 	SG_ADD(&m_oob_evaluation_metric, kOobEvaluationMetric,
 	    "metric to calculate the oob error");
 	watch_method(kOobError, &BaggingMachine::get_oob_error);
 }
 
+void BaggingMachine::load_serializable_post() noexcept(false)
+{
+	Machine::load_serializable_post();
+
+	if (m_oob_indices.empty())
+		return;
+
+	require(
+	    m_features, "Cannot restore the bags of {} without features",
+	    get_name());
+	auto num_vecs = m_features->get_num_vectors();
+	m_in_bag = SGMatrix<uint64_t>((num_vecs + 63) / 64, m_oob_indices.size());
+	m_in_bag.zero();
+	for (index_t i = 0; i < (index_t)m_oob_indices.size(); i++)
+	{
+		// every vector that is not out of the bag was trained on
+		uint64_t* in_bag = m_in_bag.get_column_vector(i);
+		for (index_t j = 0; j < num_vecs; j++)
+			in_bag[j / 64] |= uint64_t(1) << (j % 64);
+		for (auto j : m_oob_indices[i])
+			in_bag[j / 64] &= ~(uint64_t(1) << (j % 64));
+	}
+	m_oob_indices.clear();
+}
+
 void BaggingMachine::set_num_bags(int32_t num_bags)
 {
 	m_num_bags = num_bags;
@@ -301,40 +336,19 @@ float64_t BaggingMachine::get_oob_error() const
 	require(m_combination_rule, "Combination rule is not set!");
 	require(m_bags.size() > 0, "BaggingMachine is not trained!");
 
-	SGMatrix<float64_t> output(
-	    m_features->get_num_vectors(), m_bags.size());
-	if (m_labels->get_label_type() == LT_REGRESSION)
-		output.zero();
-	else
-		output.set_const(NAN);
-
-	/* TODO: add parallel support of applying the OOBs
-	  only possible when add_subset is thread-safe
-	#pragma omp parallel for num_threads(env()->get_num_threads())
-	*/
-	for (index_t i = 0; i < m_bags.size(); i++)
-	{
-		auto m = m_bags.at(i);
-		auto current_oob = m_oob_indices[i];
-
-		SGVector<index_t> oob(current_oob.data(), current_oob.size(), false);
-		m_features->add_subset(oob);
-
-		auto l = m->apply(m_features);
-		SGVector<float64_t> lv;
-		if (l!=NULL)
-			lv = std::dynamic_pointer_cast<DenseLabels>(l)->get_labels();
-		else
-			error("NULL returned by apply method");
-
-		// assign the values in the matrix (NAN) that are in-bag!
-		for (index_t j = 0; j < oob.vlen; j++)
-			output(oob[j], i) = lv[j];
-
-		m_features->remove_subset();
-
-
+	SGMatrix<float64_t> output = apply_oob_outputs();
 
+	// assign the values in the matrix (NAN) that are in-bag!
+	float64_t in_bag_output =
+	    m_labels->get_label_type() == LT_REGRESSION ? 0 : NAN;
+#pragma omp parallel for
+	for (index_t i = 0; i < output.num_cols; i++)
+	{
+		for (index_t j = 0; j < output.num_rows; j++)
+		{
+			if (!is_out_of_bag(j, i))
+				output(j, i) = in_bag_output;
+		}
 	}
 
 	std::vector<index_t> idx;
@@ -376,24 +390,66 @@ float64_t BaggingMachine::get_oob_error() const
 	return res;
 }
 
-std::vector<index_t> BaggingMachine::get_oob_indices(const SGVector<index_t>& in_bag)
+SGMatrix<float64_t> BaggingMachine::apply_oob_outputs() const
 {
-	SGVector<bool> out_of_bag(m_features->get_num_vectors());
-	out_of_bag.set_const(true);
+	auto num_vecs = m_features->get_num_vectors();
+	SGMatrix<float64_t> output(num_vecs, m_bags.size());
 
-	// mark the ones that are in_bag
-	for (index_t i = 0; i < in_bag.vlen; i++)
-		out_of_bag[in_bag[i]] &= false;
+	// the bags share m_features, so they can only be applied in parallel
+	// on shallow copies that carry their own subset stack
+	const bool parallel = env()->get_num_threads() > 1 &&
+	                      m_features->supports_shallow_subset_copy();
+	std::exception_ptr apply_error;
 
-	std::vector<index_t> oob;
-	// store the indicies of vectors that are out of the bag
-	for (index_t i = 0; i < out_of_bag.vlen; i++)
+#pragma omp parallel for if (parallel)
+	for (index_t i = 0; i < (index_t)m_bags.size(); i++)
 	{
-		if (out_of_bag[i])
+		// apply the bag only on the vectors that are out of it
+		std::vector<index_t> oob;
+		for (index_t j = 0; j < num_vecs; j++)
+		{
+			if (is_out_of_bag(j, i))
+				oob.push_back(j);
+		}
+		if (oob.empty())
+			continue;
+
+		try
 		{
-			oob.push_back(i);
-			m_all_oob_idx[i] = true;
+			auto features =
+			    parallel ? m_features->shallow_subset_copy() : m_features;
+
+			features->add_subset(
+			    SGVector<index_t>(oob.data(), oob.size(), false));
+			std::shared_ptr<Labels> l;
+			try
+			{
+				l = m_bags[i]->apply(features);
+			}
+			catch (...)
+			{
+				features->remove_subset();
+				throw;
+			}
+			features->remove_subset();
+
+			if (l == NULL)
+				error("NULL returned by apply method");
+
+			auto lv = l->as<DenseLabels>()->get_labels();
+			for (index_t j = 0; j < lv.vlen; j++)
+				output(oob[j], i) = lv[j];
+		}
+		catch (...)
+		{
+#pragma omp critical
+			if (!apply_error)
+				apply_error = std::current_exception();
 		}
 	}
-	return oob;
+
+	if (apply_error)
+		std::rethrow_exception(apply_error);
+
+	return output;
 }
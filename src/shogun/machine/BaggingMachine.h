@@ -15,6 +15,8 @@
 #include <shogun/mathematics/RandomMixin.h>
 #include <shogun/mathematics/RandomNamespace.h>
 
+#include <vector>
+
 namespace shogun
 {
 	class CombinationRule;
@@ -129,6 +131,10 @@ namespace shogun
 	protected:
 		bool train_machine(std::shared_ptr<Features> data=NULL) override;
 
+		/** restores the bitsets of models that were saved with the
+		 * out-of-bag indices of each bag */
+		void load_serializable_post() override;
+
 		/**
 		 * sets parameters of Machine - useful in Random Forest
 		 *
@@ -137,6 +143,16 @@ namespace shogun
 		 */
 		virtual void set_machine_parameters(std::shared_ptr<Machine> m, SGVector<index_t> idx);
 
+		/** whether the bags are trained in parallel, otherwise they are
+		 * trained one after another and the machine may use the threads
+		 *
+		 * @return true by default
+		 */
+		virtual bool train_bags_in_parallel() const
+		{
+			return true;
+		}
+
 		/** helper function for the apply_{regression,..} functions that
 		 * computes the output
 		 *
@@ -151,7 +167,7 @@ namespace shogun
 		 * @param data the data to compute the output for
 		 * @return predictions
 		 */
-		SGMatrix<float64_t>
+		virtual SGMatrix<float64_t>
 			apply_outputs_without_combination(std::shared_ptr<Features> data);
 
 		/** Register paramaters */
@@ -160,15 +176,24 @@ namespace shogun
 		/** Initialize the members with default values */
 		void init();
 
-		/**
-		 * get the vector of indices for feature vectors that are out of bag
+		/** whether a training vector is out of a bag
 		 *
-		 * @param in_bag vector of indices that are in bag.
-		 * NOTE: in_bag is a randomly generated with replacement
-		 * @return the vector of indices
+		 * @param vec index of the training vector
+		 * @param bag index of the bag
+		 * @return whether the bag was trained without the vector
 		 */
-		std::vector<index_t>
-		get_oob_indices(const SGVector<index_t>& in_bag);
+		bool is_out_of_bag(index_t vec, index_t bag) const
+		{
+			return !((m_in_bag(vec / 64, bag) >> (vec % 64)) & 1);
+		}
+
+		/** computes the outputs of each bag on the training vectors that
+		 * are out of it, used for the out of bag error
+		 *
+		 * @return predictions, one column per bag, only the entries of
+		 * vectors out of the bag are defined
+		 */
+		virtual SGMatrix<float64_t> apply_oob_outputs() const;
 
 	protected:
 		/** bags array */
@@ -192,7 +217,12 @@ namespace shogun
 		/** indices of all feature vectors that are out of bag */
 		SGVector<bool> m_all_oob_idx;
 
-		/** array of oob indices */
+		/** bitset of the training vectors of each bag: vector v is in bag b
+		 * if bit v%64 of m_in_bag(v/64, b) is set */
+		SGMatrix<uint64_t> m_in_bag;
+
+		/** out-of-bag indices of each bag, only read from models that were
+		 * saved before m_in_bag and converted when loading */
 		std::vector<std::vector<index_t>> m_oob_indices;
 
 		/** metric to calculate the oob error */
@@ -206,6 +236,7 @@ namespace shogun
 		static constexpr std::string_view kBags = "bags";
 		static constexpr std::string_view kCombinationRule = "combination_rule";
 		static constexpr std::string_view kAllOobIdx = "all_oob_idx";
+		static constexpr std::string_view kInBag = "in_bag";
 		static constexpr std::string_view kOobIndices = "oob_indices";
 		static constexpr std::string_view kMachine = "machine";
 		static constexpr std::string_view kOobError = "oob_error";
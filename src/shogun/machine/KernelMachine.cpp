@@ -14,6 +14,7 @@
 #include <shogun/labels/Labels.h>
 #include <shogun/labels/RegressionLabels.h>
 #include <shogun/machine/KernelMachine.h>
+#include <shogun/mathematics/linalg/LinalgNamespace.h>
 #include <utility>
 
 #ifdef HAVE_OPENMP
@@ -329,7 +330,18 @@ SGVector<float64_t> KernelMachine::apply_get_outputs(const std::shared_ptr<Featu
 		}
 		else
 		{
-			auto pb = SG_PROGRESS(range(num_vectors));
+			/* without linadd, the kernel between all support vectors and a
+			 * chunk of test vectors is evaluated with a single call and
+			 * reduced with the alphas */
+			bool linadd = kernel->has_property(KP_LINADD) &&
+			              kernel->get_is_initialized();
+			const int32_t chunk_size = linadd ? 1 : 256;
+			int32_t num_chunks = (num_vectors + chunk_size - 1) / chunk_size;
+			int32_t num_sv = get_num_support_vectors();
+			SGVector<index_t> sv_idx(m_svs.vector, num_sv, false);
+			SGVector<float64_t> alpha(m_alpha.vector, num_sv, false);
+
+			auto pb = SG_PROGRESS(range(num_chunks));
 			int32_t num_threads;
 			int64_t step;
 #pragma omp parallel shared(num_threads, step)
@@ -339,41 +351,47 @@ SGVector<float64_t> KernelMachine::apply_get_outputs(const std::shared_ptr<Featu
 #pragma omp single
 				{
 					num_threads = omp_get_num_threads();
-					step = num_vectors / num_threads;
+					step = num_chunks / num_threads;
 					num_threads--;
 				}
 				int32_t thread_num = omp_get_thread_num();
 #else
 				num_threads = 0;
-				step = num_vectors;
+				step = num_chunks;
 				int32_t thread_num = 0;
 #endif
 				int32_t start = thread_num * step;
 				int32_t end = (thread_num == num_threads)
-				                  ? num_vectors
+				                  ? num_chunks
 				                  : (thread_num + 1) * step;
 
-				for (int32_t vec = start; vec < end; vec++)
+				for (int32_t chunk = start; chunk < end; chunk++)
 				{
 					COMPUTATION_CONTROLLERS
 					pb.print_progress();
 
 					ASSERT(kernel)
-					if (kernel->has_property(KP_LINADD) &&
-					    (kernel->get_is_initialized()))
+					if (linadd)
 					{
-						float64_t score = kernel->compute_optimized(vec);
-						output[vec] = score + get_bias();
+						float64_t score = kernel->compute_optimized(chunk);
+						output[chunk] = score + get_bias();
+						continue;
 					}
-					else
+
+					int32_t first = chunk * chunk_size;
+					int32_t len = std::min(chunk_size, num_vectors - first);
+					SGVector<float64_t> scores(output.vector + first, len, false);
+					if (num_sv > 0)
 					{
-						float64_t score = 0;
-						for (int32_t i = 0; i < get_num_support_vectors(); i++)
-							score +=
-							    kernel->kernel(get_support_vector(i), vec) *
-							    get_alpha(i);
-						output[vec] = score + get_bias();
+						SGVector<index_t> vec_idx(len);
+						vec_idx.range_fill(first);
+						SGMatrix<float64_t> kmat(num_sv, len);
+						kernel->compute_block(sv_idx, vec_idx, kmat);
+						linalg::matrix_prod(kmat, alpha, scores, true);
+						linalg::add_scalar(scores, get_bias());
 					}
+					else
+						scores.set_const(get_bias());
 				}
 			}
 			pb.complete();
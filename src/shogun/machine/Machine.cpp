@@ -33,6 +33,8 @@ Machine::~Machine()
 
 bool Machine::train(std::shared_ptr<Features> data)
 {
+	materialize();
+
 	if (train_require_labels())
 	{
 		if (m_labels == NULL)
@@ -116,6 +118,7 @@ std::shared_ptr<Labels> Machine::apply(std::shared_ptr<Features> data)
 {
 	SG_TRACE("entering {}::apply({} at {})",
 			get_name(), data ? data->get_name() : "NULL", fmt::ptr(data.get()));
+	materialize();
 
 	std::shared_ptr<Labels> result=NULL;
 
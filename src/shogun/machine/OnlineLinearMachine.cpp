@@ -56,12 +56,23 @@ SGVector<float64_t> OnlineLinearMachine::apply_get_outputs(const std::shared_ptr
 
 	std::vector<float64_t> labels;
 	features->start_parser();
-	while (features->get_next_example())
+	if (features->has_property(FP_STREAMING_BATCH))
+	{
+		while (features->get_next_batch(STREAMING_DEFAULT_BATCH_SIZE))
+		{
+			auto outputs=features->dense_dot_batch(m_w, bias);
+			labels.insert(labels.end(), outputs.begin(), outputs.end());
+		}
+	}
+	else
 	{
-		float64_t current_lab=features->dense_dot(m_w.vector, m_w.vlen) + bias;
+		while (features->get_next_example())
+		{
+			float64_t current_lab=features->dense_dot(m_w.vector, m_w.vlen) + bias;
 
-		labels.push_back(current_lab);
-		features->release_example();
+			labels.push_back(current_lab);
+			features->release_example();
+		}
 	}
 	features->end_parser();
 
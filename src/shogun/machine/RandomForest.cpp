@@ -28,6 +28,7 @@
  * either expressed or implied, of the Shogun Development Team.
  */
 
+#include <shogun/base/ShogunEnv.h>
 #include <shogun/machine/RandomForest.h>
 #include <shogun/mathematics/linalg/LinalgNamespace.h>
 #include <shogun/multiclass/tree/RandomCARTree.h>
@@ -138,6 +139,24 @@ int32_t RandomForest::get_num_random_features() const
 	return m_machine->as<RandomCARTree>()->get_feature_subset_size();
 }
 
+void RandomForest::set_histogram(bool histogram)
+{
+	require(m_machine,"m_machine is NULL. It is expected to be RandomCARTree");
+	m_machine->as<RandomCARTree>()->set_histogram(histogram);
+}
+
+bool RandomForest::get_histogram() const
+{
+	require(m_machine,"m_machine is NULL. It is expected to be RandomCARTree");
+	return m_machine->as<RandomCARTree>()->get_histogram();
+}
+
+void RandomForest::set_max_bins(int32_t max_bins)
+{
+	require(m_machine,"m_machine is NULL. It is expected to be RandomCARTree");
+	m_machine->as<RandomCARTree>()->set_max_bins(max_bins);
+}
+
 void RandomForest::set_machine_parameters(std::shared_ptr<Machine> m, SGVector<index_t> idx)
 {
 	require(m,"Machine supplied is NULL");
@@ -158,11 +177,19 @@ void RandomForest::set_machine_parameters(std::shared_ptr<Machine> m, SGVector<i
 	}
 
 	tree->set_weights(weights);
-	tree->set_sorted_features(m_sorted_transposed_feats, m_sorted_indices);
+	if (tree->get_histogram())
+		tree->set_binned_features(m_binned_feats, m_bin_thresholds, m_num_bins);
+	else
+		tree->set_sorted_features(m_sorted_transposed_feats, m_sorted_indices);
 	// equate the machine problem types - cloning does not do this
 	tree->set_machine_problem_type(m_machine->as<RandomCARTree>()->get_machine_problem_type());
 }
 
+bool RandomForest::train_bags_in_parallel() const
+{
+	return m_num_bags>=env()->get_num_threads();
+}
+
 bool RandomForest::train_machine(std::shared_ptr<Features> data)
 {
 	if (data)
@@ -171,10 +198,56 @@ bool RandomForest::train_machine(std::shared_ptr<Features> data)
 	}
 	
 	require(m_features, "Training features not set!");
+	m_flat_forest.reset();
+
+	auto tree=m_machine->as<RandomCARTree>();
+	if (tree->get_histogram())
+		tree->pre_bin_features(m_features, m_binned_feats, m_bin_thresholds, m_num_bins);
+	else
+		tree->pre_sort_features(m_features, m_sorted_transposed_feats, m_sorted_indices);
+
+	if (!BaggingMachine::train_machine())
+		return false;
+
+	compile_forest();
+	return true;
+}
+
+void RandomForest::compile_forest()
+{
+	require(!m_bags.empty(), "Random forest is not trained");
+
+	std::vector<std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>>> roots;
+	for (const auto& bag : m_bags)
+	{
+		auto root=bag->as<RandomCARTree>()->get_root();
+		roots.push_back(root ? root->as<BinaryTreeMachineNode<CARTreeNodeData>>() : nullptr);
+	}
 
-	m_machine->as<RandomCARTree>()->pre_sort_features(m_features, m_sorted_transposed_feats, m_sorted_indices);
+	m_flat_forest=std::make_shared<FlatForest>(
+		roots, m_bags[0]->as<RandomCARTree>()->get_feature_types());
+}
+
+SGMatrix<float64_t> RandomForest::apply_outputs_without_combination(std::shared_ptr<Features> data)
+{
+	require(data, "Data required for apply");
+	auto dense=std::dynamic_pointer_cast<DenseFeatures<float64_t>>(data);
+	if (!dense)
+		return BaggingMachine::apply_outputs_without_combination(data);
+
+	if (!m_flat_forest)
+		compile_forest();
+
+	return m_flat_forest->apply(dense->get_feature_matrix());
+}
+
+SGMatrix<float64_t> RandomForest::apply_oob_outputs() const
+{
+	auto dense=std::dynamic_pointer_cast<DenseFeatures<float64_t>>(m_features);
+	if (!dense || !m_flat_forest)
+		return BaggingMachine::apply_oob_outputs();
 
-	return BaggingMachine::train_machine();
+	return m_flat_forest->apply(dense->get_feature_matrix(), m_in_bag);
 }
 
 SGVector<float64_t> RandomForest::get_feature_importances() const
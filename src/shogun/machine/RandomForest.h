@@ -33,6 +33,7 @@
 
 #include <shogun/lib/config.h>
 #include <shogun/machine/BaggingMachine.h>
+#include <shogun/multiclass/tree/FlatForest.h>
 
 namespace shogun
 {
@@ -137,6 +138,26 @@ public:
 	 * @return number of randomly chosen features during each node split
 	 */
 	int32_t get_num_random_features() const;
+
+	/** set whether the trees find splits from histograms of binned
+	 * features, the features are binned once for all trees
+	 *
+	 * @param histogram whether to use histogram mode
+	 */
+	void set_histogram(bool histogram);
+
+	/** get whether the trees find splits from histograms of binned features
+	 *
+	 * @return whether histogram mode is used
+	 */
+	bool get_histogram() const;
+
+	/** set max number of bins of a feature in histogram mode
+	 *
+	 * @param max_bins max number of bins, between 2 and 255
+	 */
+	void set_max_bins(int32_t max_bins);
+
 	/** get feature importances of previous trained, use Mean Decrease
 	 * Impurity(MDI)
 	 *
@@ -154,6 +175,33 @@ protected:
 	 */
 	void set_machine_parameters(std::shared_ptr<Machine> m, SGVector<index_t> idx) override;
 
+	/** trees are trained one after another if there are fewer trees than
+	 * threads, each of them is then grown on all threads
+	 *
+	 * @return whether there are at least as many trees as threads
+	 */
+	bool train_bags_in_parallel() const override;
+
+	/** computes the outputs of the trees on dense features with the flat
+	 * copy of the trees, which is compiled after training or on first use
+	 *
+	 * @param data the data to compute the output for
+	 * @return predictions, one column per tree
+	 */
+	SGMatrix<float64_t>
+		apply_outputs_without_combination(std::shared_ptr<Features> data) override;
+
+	/** computes the out of bag outputs of the trees on dense training
+	 * features in one pass over the flat copy of the trees, in which each
+	 * tree skips the vectors of its bag
+	 *
+	 * @return predictions, one column per tree
+	 */
+	SGMatrix<float64_t> apply_oob_outputs() const override;
+
+	/** compile the trained trees into a FlatForest */
+	void compile_forest();
+
 private:
 	/** initialize parameters */
 	void init();
@@ -167,6 +215,18 @@ private:
 
 	/** Indices of pre-sorted features */
 	SGMatrix<index_t> m_sorted_indices;
+
+	/** Binned features in histogram mode */
+	SGMatrix<uint8_t> m_binned_feats;
+
+	/** Upper bounds of the bins of the binned features */
+	SGMatrix<float64_t> m_bin_thresholds;
+
+	/** Number of bins of the binned features */
+	SGVector<index_t> m_num_bins;
+
+	/** Flat copy of the trained trees for prediction */
+	std::shared_ptr<FlatForest> m_flat_forest;
 #ifndef SWIG
 public:
 	static constexpr std::string_view kWeights = "weights";
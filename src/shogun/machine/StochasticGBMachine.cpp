@@ -33,6 +33,8 @@
 #include <shogun/machine/StochasticGBMachine.h>
 #include <shogun/mathematics/Math.h>
 #include <shogun/mathematics/RandomNamespace.h>
+#include <shogun/mathematics/linalg/LinalgNamespace.h>
+#include <shogun/multiclass/tree/CARTree.h>
 #include <shogun/optimization/lbfgs/lbfgs.h>
 
 using namespace shogun;
@@ -134,14 +136,66 @@ float64_t StochasticGBMachine::get_learning_rate() const
 	return m_learning_rate;
 }
 
+void StochasticGBMachine::set_tree_boosting(bool tree_boosting)
+{
+	m_tree_boosting=tree_boosting;
+}
+
+bool StochasticGBMachine::get_tree_boosting() const
+{
+	return m_tree_boosting;
+}
+
+void StochasticGBMachine::set_validation_data(std::shared_ptr<Features> feats, std::shared_ptr<Labels> labels)
+{
+	require(feats,"Supplied validation features are NULL");
+	require(labels,"Supplied validation labels are NULL");
+	require(feats->get_num_vectors()==labels->get_num_labels(),"Number of validation vectors ({}) should be the"
+		" number of validation labels ({})",feats->get_num_vectors(),labels->get_num_labels());
+
+	m_validation_features=std::move(feats);
+	m_validation_labels=std::move(labels);
+}
+
+void StochasticGBMachine::set_early_stopping_rounds(int32_t rounds)
+{
+	require(rounds>=0,"Number of early stopping rounds should not be negative. Supplied value is {}",rounds);
+	m_early_stopping_rounds=rounds;
+}
+
+int32_t StochasticGBMachine::get_early_stopping_rounds() const
+{
+	return m_early_stopping_rounds;
+}
+
 std::shared_ptr<RegressionLabels> StochasticGBMachine::apply_regression(std::shared_ptr<Features> data)
 {
 	require(data,"test data supplied is NULL");
 	auto feats=data->as<DenseFeatures<float64_t>>();
 
+	if (m_tree_boosting && !m_weak_learners.empty())
+	{
+		if (!m_flat_forest)
+		{
+			std::vector<std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>>> roots;
+			for (const auto& learner : m_weak_learners)
+				roots.push_back(learner->as<CARTree>()->get_root()->as<BinaryTreeMachineNode<CARTreeNodeData>>());
+
+			m_flat_forest=std::make_shared<FlatForest>(
+				roots, m_weak_learners[0]->as<CARTree>()->get_feature_types());
+		}
+
+		SGVector<float64_t> weights(m_gamma.size());
+		for (index_t i=0;i<weights.vlen;i++)
+			weights[i]=m_gamma[i]*m_learning_rate;
+
+		return std::make_shared<RegressionLabels>(
+			m_flat_forest->apply_weighted_sum(feats->get_feature_matrix(), weights));
+	}
+
 	SGVector<float64_t> retlabs(feats->get_num_vectors());
 	retlabs.fill_vector(retlabs.vector,retlabs.vlen,0);
-	for (int32_t i=0;i<m_num_iter;i++)
+	for (int32_t i=0;i<(int32_t)m_weak_learners.size();i++)
 	{
 		float64_t gamma=m_gamma[i];
 
@@ -173,6 +227,9 @@ bool StochasticGBMachine::train_machine(std::shared_ptr<Features> data)
 	// initialize weak learners array and gamma array
 	initialize_learners();
 
+	if (m_tree_boosting)
+		return train_boosted_trees(feats);
+
 	// cache predicted labels for intermediate models
 	auto interf=std::make_shared<RegressionLabels>(feats->get_num_vectors());
 
@@ -215,6 +272,135 @@ bool StochasticGBMachine::train_machine(std::shared_ptr<Features> data)
 	return true;
 }
 
+bool StochasticGBMachine::train_boosted_trees(std::shared_ptr<DenseFeatures<float64_t>> feats)
+{
+	auto prototype=m_machine->as<CARTree>();
+
+	// the binned features are indexed by the vectors of the data
+	if (feats->get_subset_stack()->has_subsets())
+		feats=std::make_shared<DenseFeatures<float64_t>>(feats->get_feature_matrix());
+
+	auto num_vecs=feats->get_num_vectors();
+	auto num_feats=feats->get_num_features();
+	auto labels=m_labels->as<DenseLabels>()->get_labels();
+
+	auto feature_types=prototype->get_feature_types();
+	if (feature_types.vlen!=num_feats)
+	{
+		feature_types=SGVector<bool>(num_feats);
+		linalg::set_const(feature_types, false);
+	}
+
+	// the features are binned once for all trees
+	SGMatrix<uint8_t> binned_feats;
+	SGMatrix<float64_t> bin_thresholds;
+	SGVector<index_t> num_bins;
+	prototype->pre_bin_features(feats, binned_feats, bin_thresholds, num_bins);
+
+	std::shared_ptr<DenseFeatures<float64_t>> validation_feats;
+	SGVector<float64_t> validation_labels;
+	SGVector<float64_t> validation_f;
+	if (m_validation_features)
+	{
+		validation_feats=m_validation_features->as<DenseFeatures<float64_t>>();
+		validation_labels=m_validation_labels->as<DenseLabels>()->get_labels();
+		validation_f=SGVector<float64_t>(validation_labels.vlen);
+		validation_f.zero();
+	}
+	bool early_stopping=validation_feats && m_early_stopping_rounds>0;
+	float64_t best_loss=Math::INFTY;
+	int32_t best_iter=0;
+
+	// predictions of the intermediate models
+	SGVector<float64_t> f(num_vecs);
+	f.zero();
+
+	index_t subset_size=m_subset_frac*num_vecs;
+	require(subset_size>0,"Subset fraction {} selects no vectors",m_subset_frac);
+	SGVector<index_t> idx(num_vecs);
+
+	for (auto i : SG_PROGRESS(range(m_num_iter)))
+	{
+		// the tree is trained on a view of the randomly chosen vectors
+		idx.range_fill();
+		SGVector<index_t> subset=idx;
+		if (subset_size<num_vecs)
+		{
+			random::shuffle(idx, m_prng);
+			subset=SGVector<index_t>(subset_size);
+			sg_memcpy(subset.vector,idx.vector,subset.vlen*sizeof(index_t));
+		}
+
+		// Newton steps of the chosen vectors, weighted by the second derivatives
+		SGVector<float64_t> hessians(subset.vlen);
+		SGVector<float64_t> steps(subset.vlen);
+		for (index_t j=0;j<subset.vlen;j++)
+		{
+			auto k=subset[j];
+			auto h=m_loss->second_derivative(f[k],labels[k]);
+			if (!(h>0))
+				h=1;
+
+			hessians[j]=h;
+			steps[j]=-m_loss->first_derivative(f[k],labels[k])/h;
+		}
+
+		auto tree=prototype->clone()->as<CARTree>();
+		tree->set_machine_problem_type(PT_REGRESSION);
+		tree->set_feature_types(feature_types);
+		tree->set_histogram(true);
+		tree->set_binned_features(binned_feats, bin_thresholds, num_bins);
+		tree->set_weights(hessians);
+		tree->set_labels(std::make_shared<RegressionLabels>(steps));
+		random::seed(tree, m_prng);
+		if (subset_size<num_vecs)
+			tree->train(view(feats, subset));
+		else
+			tree->train(feats);
+
+		// the leaf values are Newton steps, so no line search is needed
+		m_weak_learners.push_back(tree);
+		m_gamma.push_back(1.0);
+
+		// update intermediate function values
+		auto delta=tree->apply_regression(feats)->get_labels();
+		linalg::add(f, delta, f, 1.0, m_learning_rate);
+
+		if (validation_feats)
+		{
+			delta=tree->apply_regression(validation_feats)->get_labels();
+			linalg::add(validation_f, delta, validation_f, 1.0, m_learning_rate);
+
+			float64_t loss=mean_loss(validation_f, validation_labels);
+			if (loss<best_loss)
+			{
+				best_loss=loss;
+				best_iter=i;
+			}
+			else if (early_stopping && i-best_iter>=m_early_stopping_rounds)
+				break;
+		}
+	}
+
+	// drop the trees after the best iteration
+	if (early_stopping)
+	{
+		m_weak_learners.resize(best_iter+1);
+		m_gamma.resize(best_iter+1);
+	}
+
+	return true;
+}
+
+float64_t StochasticGBMachine::mean_loss(const SGVector<float64_t>& f, const SGVector<float64_t>& labels) const
+{
+	float64_t loss=0;
+	for (index_t i=0;i<labels.vlen;i++)
+		loss+=m_loss->loss(f[i],labels[i]);
+
+	return loss/labels.vlen;
+}
+
 float64_t StochasticGBMachine::compute_multiplier(
     const std::shared_ptr<RegressionLabels>& f, const std::shared_ptr<RegressionLabels>& hm, const std::shared_ptr<Labels>& labs)
 {
@@ -285,6 +471,7 @@ void StochasticGBMachine::initialize_learners()
 
 
 	m_gamma.clear();
+	m_flat_forest.reset();
 
 }
 
@@ -373,6 +560,8 @@ void StochasticGBMachine::init()
 	m_num_iter=0;
 	m_subset_frac=0;
 	m_learning_rate=0;
+	m_tree_boosting=false;
+	m_early_stopping_rounds=0;
 
 	m_weak_learners.clear();
 	m_gamma.clear();
@@ -384,4 +573,6 @@ void StochasticGBMachine::init()
 	SG_ADD(&m_learning_rate, kLearningRate, "learning rate");
 	SG_ADD(&m_weak_learners, kWeakLearners, "array of weak learners");
 	SG_ADD(&m_gamma, kGamma, "array of learner weights");
+	SG_ADD(&m_tree_boosting, kTreeBoosting, "whether to boost second order histogram trees");
+	SG_ADD(&m_early_stopping_rounds, kEarlyStoppingRounds, "number of iterations without improvement of the validation loss");
 }
@@ -38,6 +38,7 @@
 #include <shogun/loss/LossFunction.h>
 #include <shogun/machine/Machine.h>
 #include <shogun/mathematics/RandomMixin.h>
+#include <shogun/multiclass/tree/FlatForest.h>
 
 #include <tuple>
 
@@ -51,6 +52,14 @@ namespace shogun
  * For one dimensional optimization, this class uses the backtracking linesearch accessed via Shogun's L-BFGS class.
  * A concise description of the algorithm implemented can be found in the following link :
  * http://en.wikipedia.org/wiki/Gradient_boosting#Algorithm
+ *
+ * In tree boosting mode (see set_tree_boosting), the machine has to be a CARTree (or RandomCARTree, which samples the features
+ * considered in each split), which is used as template for the trees of the ensemble. Each tree is fit to the Newton steps
+ * -g/h of the loss, weighted by the second derivatives h, so its leaf values are the Newton steps -sum(g)/sum(h) of their vectors
+ * and no line search is needed. Vectors where the second derivative of the loss is not positive use h=1, i.e. a gradient step.
+ * The features are binned once for histogram split finding (see CARTree), and the trees are trained on views of the randomly
+ * chosen vectors without copying them. If validation data is supplied, training stops once the validation loss did not improve
+ * for the given number of iterations, and the trees after the best iteration are dropped. Predictions use a FlatForest of the trees.
  */
 class StochasticGBMachine : public RandomMixin<Machine>
 {
@@ -135,6 +144,40 @@ public:
 	 */
 	float64_t get_learning_rate() const;
 
+	/** set whether the ensemble is built from second order histogram
+	 * trees, the machine has to be a CARTree
+	 *
+	 * @param tree_boosting whether to use tree boosting mode
+	 */
+	void set_tree_boosting(bool tree_boosting);
+
+	/** get whether the ensemble is built from second order histogram trees
+	 *
+	 * @return whether tree boosting mode is used
+	 */
+	bool get_tree_boosting() const;
+
+	/** set validation data for early stopping in tree boosting mode
+	 *
+	 * @param feats validation features
+	 * @param labels validation labels
+	 */
+	void set_validation_data(std::shared_ptr<Features> feats, std::shared_ptr<Labels> labels);
+
+	/** set number of iterations without improvement of the validation loss
+	 * after which training stops in tree boosting mode
+	 *
+	 * @param rounds number of iterations, 0 to train all iterations
+	 */
+	void set_early_stopping_rounds(int32_t rounds);
+
+	/** get number of iterations without improvement of the validation loss
+	 * after which training stops
+	 *
+	 * @return number of iterations
+	 */
+	int32_t get_early_stopping_rounds() const;
+
 	/** apply_regression
 	 *
 	 * @param data test data
@@ -187,6 +230,21 @@ protected:
 		       std::shared_ptr<Labels>>
 	get_subset(std::shared_ptr<DenseFeatures<float64_t>> f, std::shared_ptr<RegressionLabels> interf);
 
+	/** train the ensemble in tree boosting mode
+	 *
+	 * @param feats training data
+	 * @return true
+	 */
+	bool train_boosted_trees(std::shared_ptr<DenseFeatures<float64_t>> feats);
+
+	/** mean loss of predictions
+	 *
+	 * @param f predictions
+	 * @param labels labels
+	 * @return mean loss
+	 */
+	float64_t mean_loss(const SGVector<float64_t>& f, const SGVector<float64_t>& labels) const;
+
 	/** reset arrays of weak learners and gamma values */
 	void initialize_learners();
 
@@ -231,6 +289,22 @@ protected:
 
 	/** gamma - weak learner weights */
 	std::vector<float64_t> m_gamma;
+
+	/** whether the ensemble is built from second order histogram trees */
+	bool m_tree_boosting;
+
+	/** number of iterations without improvement of the validation loss
+	 * after which training stops */
+	int32_t m_early_stopping_rounds;
+
+	/** validation features */
+	std::shared_ptr<Features> m_validation_features;
+
+	/** validation labels */
+	std::shared_ptr<Labels> m_validation_labels;
+
+	/** flat copy of the trees in tree boosting mode */
+	std::shared_ptr<FlatForest> m_flat_forest;
 #ifndef SWIG
 public:
 	static constexpr std::string_view kMachine = "machine";
@@ -240,6 +314,8 @@ public:
 	static constexpr std::string_view kLearningRate = "learning_rate";
 	static constexpr std::string_view kWeakLearners = "weak_learners";
 	static constexpr std::string_view kGamma = "gamma";
+	static constexpr std::string_view kTreeBoosting = "tree_boosting";
+	static constexpr std::string_view kEarlyStoppingRounds = "early_stopping_rounds";
 #endif
 };
 }/* shogun */
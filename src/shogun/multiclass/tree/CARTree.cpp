@@ -29,6 +29,7 @@
  */
 
 #include <algorithm>
+#include <exception>
 #include <iterator>
 #include <shogun/lib/View.h>
 #include <shogun/mathematics/Math.h>
@@ -38,12 +39,79 @@
 #include <shogun/multiclass/tree/CARTree.h>
 #include <shogun/multiclass/tree/FeatureImportanceTree.h>
 
+#ifdef HAVE_OPENMP
+#include <omp.h>
+#endif
+
 using namespace Eigen;
 using namespace shogun;
 
 const float64_t CARTree::MISSING=Math::MAX_REAL_NUMBER;
 const float64_t CARTree::EQ_DELTA=1e-7;
 const float64_t CARTree::MIN_SPLIT_GAIN=1e-7;
+const uint8_t CARTree::MISSING_BIN=255;
+
+namespace
+{
+	/** impurity of the sums of a histogram bin range, Gini index for
+	 * classification (num_classes>0) or least squares deviation for
+	 * regression */
+	float64_t histogram_impurity(
+	    const float64_t* stats, index_t num_classes, float64_t& total_weight)
+	{
+		if (num_classes)
+		{
+			total_weight=0;
+			float64_t gini=0;
+			for (index_t k=0;k<num_classes;++k)
+			{
+				total_weight+=stats[k];
+				gini+=stats[k]*stats[k];
+			}
+			return 1.0-(gini/(total_weight*total_weight));
+		}
+
+		total_weight=stats[0];
+		float64_t mean=stats[1]/total_weight;
+		return std::max(stats[2]/total_weight-mean*mean, 0.0);
+	}
+
+	/** best split of a feature in a node */
+	struct SplitCandidate
+	{
+		/** gain of the split */
+		float64_t gain=CARTree::MIN_SPLIT_GAIN;
+		/** max impurity of the node seen while searching the split */
+		float64_t impurity=0;
+		/** threshold of a continuous feature */
+		float64_t threshold=0;
+		/** last bin going left of a continuous feature in histogram mode */
+		index_t bin=-1;
+		/** number of vectors with missing values of the feature */
+		index_t num_missing=0;
+		/** which vectors go to the left child for a nominal feature */
+		SGVector<bool> is_left;
+		/** which categories (or bins) go to the left child for a nominal
+		 * feature */
+		SGVector<bool> feats_left;
+		/** categories of a nominal feature */
+		SGVector<float64_t> ufeats;
+	};
+
+	/** gain of splitting the node with sums total into left and right */
+	float64_t histogram_gain(
+	    const float64_t* left, const float64_t* right, const float64_t* total,
+	    index_t num_classes, float64_t& impurity)
+	{
+		float64_t total_lweight=0;
+		float64_t total_rweight=0;
+		float64_t total_weight=0;
+		impurity=histogram_impurity(total,num_classes,total_weight);
+		float64_t impurity_l=histogram_impurity(left,num_classes,total_lweight);
+		float64_t impurity_r=histogram_impurity(right,num_classes,total_rweight);
+		return impurity-(impurity_l*(total_lweight/total_weight))-(impurity_r*(total_rweight/total_weight));
+	}
+}
 
 CARTree::CARTree() : RandomMixin<FeatureImportanceTree<CARTreeNodeData>>()
 {
@@ -245,6 +313,41 @@ void CARTree::set_label_epsilon(float64_t ep)
 	m_label_epsilon=ep;
 }
 
+void CARTree::set_histogram(bool histogram)
+{
+	m_histogram=histogram;
+}
+
+bool CARTree::get_histogram() const
+{
+	return m_histogram;
+}
+
+void CARTree::set_max_bins(int32_t max_bins)
+{
+	require(max_bins>1 && max_bins<MISSING_BIN,"Max number of bins should be between 2 and {}. Supplied value is {}",MISSING_BIN-1,max_bins);
+	m_max_bins=max_bins;
+}
+
+int32_t CARTree::get_max_bins() const
+{
+	return m_max_bins;
+}
+
+index_t CARTree::get_split_subset_size(index_t num_feats)
+{
+	return 0;
+}
+
+bool CARTree::grow_in_parallel(index_t num_vecs) const
+{
+#ifdef HAVE_OPENMP
+	return num_vecs>=CART_PARALLEL_MIN_NODE_SIZE && omp_get_num_threads()>1;
+#else
+	return false;
+#endif
+}
+
 bool CARTree::types_set()
 {
 	return m_nominal.size() != 0;
@@ -293,7 +396,53 @@ bool CARTree::train_machine(std::shared_ptr<Features> data)
 	}
 
 	auto dense_labels = m_labels->as<DenseLabels>();
-	set_root(CARTtrain(dense_features,m_weights,dense_labels,0));
+	if (m_histogram)
+	{
+		if (!m_pre_bin)
+		{
+			pre_bin_features(dense_features, m_binned_features, m_bin_thresholds, m_num_bins);
+			// the binned features are indexed by the vectors of the data
+			if (dense_features->get_subset_stack()->has_subsets())
+				dense_features=std::make_shared<DenseFeatures<float64_t>>(dense_features->get_feature_matrix());
+		}
+		require(m_num_bins.vlen==num_features,"Number of binned features (currently {}) should be same as"
+					" number of features in data (presently {})",m_num_bins.vlen,num_features);
+
+		m_bin_offsets=SGVector<index_t>(num_features+1);
+		m_bin_offsets[0]=0;
+		for (index_t i=0;i<num_features;++i)
+			m_bin_offsets[i+1]=m_bin_offsets[i]+m_num_bins[i];
+
+		if (m_mode==PT_MULTICLASS)
+		{
+			auto labels_vec=dense_labels->get_labels();
+			std::vector<float64_t> classes(labels_vec.begin(), labels_vec.end());
+			std::sort(classes.begin(), classes.end());
+			classes.erase(std::unique(classes.begin(), classes.end()), classes.end());
+			m_histogram_classes=SGVector<float64_t>(classes.size());
+			std::copy(classes.begin(), classes.end(), m_histogram_classes.begin());
+		}
+	}
+
+	// the tree is grown by tasks of the threads of this region
+	std::shared_ptr<bnode_t> root;
+	std::exception_ptr train_error;
+	#pragma omp parallel num_threads(env()->get_num_threads()) if (num_vectors>=CART_PARALLEL_MIN_NODE_SIZE)
+	#pragma omp single
+	{
+		try
+		{
+			root=CARTtrain(dense_features,m_weights,dense_labels,0);
+		}
+		catch (...)
+		{
+			train_error=std::current_exception();
+		}
+	}
+
+	if (train_error)
+		std::rethrow_exception(train_error);
+	set_root(root);
 
 	if (m_apply_cv_pruning)
 	{
@@ -342,16 +491,374 @@ void CARTree::pre_sort_features(const std::shared_ptr<Features>& data, SGMatrix<
 
 }
 
+void CARTree::pre_bin_features(const std::shared_ptr<Features>& data, SGMatrix<uint8_t>& binned_feats, SGMatrix<float64_t>& bin_thresholds, SGVector<index_t>& num_bins)
+{
+	SGMatrix<float64_t> mat=(data)->as<DenseFeatures<float64_t>>()->get_feature_matrix();
+	auto num_feats=mat.num_rows;
+	auto num_vecs=mat.num_cols;
+	binned_feats=SGMatrix<uint8_t>(num_vecs, num_feats);
+	bin_thresholds=SGMatrix<float64_t>(m_max_bins, num_feats);
+	num_bins=SGVector<index_t>(num_feats);
+	bool nominal_set=(m_nominal.vlen==num_feats);
+
+	#pragma omp parallel for
+	for (index_t f=0;f<num_feats;++f)
+	{
+		std::vector<float64_t> values;
+		values.reserve(num_vecs);
+		for (index_t i=0;i<num_vecs;++i)
+		{
+			if (mat(f,i)!=MISSING)
+				values.push_back(mat(f,i));
+		}
+		std::sort(values.begin(), values.end());
+
+		// use each distinct value as bin if there are few, else quantiles
+		auto thresholds=bin_thresholds.get_column_vector(f);
+		index_t nb=0;
+		for (size_t i=0;i<values.size() && nb<=m_max_bins;++i)
+		{
+			if (!nb || values[i]!=thresholds[nb-1])
+			{
+				if (nb<m_max_bins)
+					thresholds[nb]=values[i];
+				++nb;
+			}
+		}
+
+		if (nb>m_max_bins)
+		{
+			// nominal features need a bin per category
+			if (nominal_set && m_nominal[f])
+			{
+				num_bins[f]=-1;
+				continue;
+			}
+
+			nb=0;
+			for (index_t b=1;b<=m_max_bins;++b)
+			{
+				auto t=values[(b*values.size()+m_max_bins-1)/m_max_bins-1];
+				if (!nb || t>thresholds[nb-1])
+					thresholds[nb++]=t;
+			}
+		}
+		num_bins[f]=nb;
+
+		auto bins=binned_feats.get_column_vector(f);
+		for (index_t i=0;i<num_vecs;++i)
+		{
+			if (mat(f,i)==MISSING)
+				bins[i]=MISSING_BIN;
+			else
+				bins[i]=std::lower_bound(thresholds, thresholds+nb, mat(f,i))-thresholds;
+		}
+	}
+
+	for (index_t f=0;f<num_feats;++f)
+	{
+		require(num_bins[f]>=0,"Nominal feature {} has more than {} categories, which is the max number of bins",f,m_max_bins);
+	}
+}
+
+void CARTree::set_binned_features(SGMatrix<uint8_t>& binned_feats, SGMatrix<float64_t>& bin_thresholds, SGVector<index_t>& num_bins)
+{
+	m_pre_bin=true;
+	m_binned_features=binned_feats;
+	m_bin_thresholds=bin_thresholds;
+	m_num_bins=num_bins;
+}
+
+index_t CARTree::histogram_stats() const
+{
+	if (m_mode==PT_MULTICLASS)
+		return m_histogram_classes.vlen+1;
+
+	return 4;
+}
+
+SGVector<float64_t> CARTree::build_histogram(
+    const SGVector<index_t>& indices, const SGVector<float64_t>& weights,
+    const SGVector<float64_t>& labels_vec,
+    const SGVector<index_t>& features) const
+{
+	auto num_stats=histogram_stats();
+	SGVector<float64_t> histogram(m_bin_offsets[m_num_bins.vlen]*num_stats);
+	linalg::zero(histogram);
+
+	SGVector<index_t> classes;
+	if (m_mode==PT_MULTICLASS)
+	{
+		classes=SGVector<index_t>(indices.vlen);
+		for (index_t i=0;i<indices.vlen;++i)
+		{
+			classes[i]=std::lower_bound(m_histogram_classes.begin(),
+			    m_histogram_classes.end(), labels_vec[i])-m_histogram_classes.begin();
+		}
+	}
+
+	// the tasks all add to the shared histogram
+	#pragma omp taskloop grainsize(1) default(shared) if (grow_in_parallel(indices.vlen))
+	for (index_t j=0;j<features.vlen;++j)
+	{
+		auto bins=m_binned_features.get_column_vector(features[j]);
+		auto hist=histogram.vector+m_bin_offsets[features[j]]*num_stats;
+		for (index_t i=0;i<indices.vlen;++i)
+		{
+			auto bin=bins[indices[i]];
+			if (bin==MISSING_BIN)
+				continue;
+
+			auto stats=hist+bin*num_stats;
+			if (m_mode==PT_MULTICLASS)
+			{
+				stats[classes[i]]+=weights[i];
+			}
+			else
+			{
+				stats[0]+=weights[i];
+				stats[1]+=weights[i]*labels_vec[i];
+				stats[2]+=weights[i]*labels_vec[i]*labels_vec[i];
+			}
+			stats[num_stats-1]+=1;
+		}
+	}
+
+	return histogram;
+}
+
+index_t CARTree::compute_best_attribute_histogram(
+    const SGVector<index_t>& indices, const SGVector<float64_t>& weights,
+    const SGVector<float64_t>& labels_vec, SGVector<float64_t>& histogram,
+    SGVector<float64_t>& left, SGVector<float64_t>& right,
+    SGVector<bool>& is_left_final, index_t& num_missing,
+    index_t& count_left, index_t& count_right, float64_t& impurity,
+    std::mt19937_64& prng, index_t subset_size)
+{
+	auto num_vecs=indices.vlen;
+	auto num_feats=m_num_bins.vlen;
+	auto num_stats=histogram_stats();
+	index_t num_classes=(m_mode==PT_MULTICLASS) ? m_histogram_classes.vlen : 0;
+
+	// if all labels same early stop
+	float64_t delta=0;
+	if (m_mode==PT_REGRESSION)
+		delta=m_label_epsilon;
+
+	auto label_range=std::minmax_element(labels_vec.begin(), labels_vec.end());
+	if (*label_range.second-*label_range.first<=delta)
+		return -1;
+
+	SGVector<index_t> idx(num_feats);
+	linalg::range_fill(idx);
+	if (subset_size)
+	{
+		random::shuffle(idx, prng);
+		idx.resize_vector(subset_size);
+	}
+
+	// the histogram of the node is only passed down if all features are used
+	if (!histogram.vlen || subset_size)
+		histogram=build_histogram(indices, weights, labels_vec, idx);
+
+	// best split of each feature, the features are searched in parallel
+	// in big nodes. The candidates have to be shared explicitly, tasks get
+	// private copies of the locals of the function by default
+	std::vector<SplitCandidate> candidates(idx.vlen);
+	#pragma omp taskloop grainsize(1) default(shared) if (grow_in_parallel(num_vecs))
+	for (index_t i=0;i<idx.vlen;++i)
+	{
+		auto& candidate=candidates[i];
+		auto f=idx[i];
+		auto hist=histogram.vector+m_bin_offsets[f]*num_stats;
+		auto num_bins=m_num_bins[f];
+
+		// the histogram only counts the non-missing values
+		SGVector<float64_t> total(num_stats);
+		SGVector<float64_t> left_stats(num_stats);
+		SGVector<float64_t> right_stats(num_stats);
+		linalg::zero(total);
+		for (index_t b=0;b<num_bins;++b)
+		{
+			for (index_t k=0;k<num_stats;++k)
+				total[k]+=hist[b*num_stats+k];
+		}
+		if (total[num_stats-1]<1)
+			continue;
+
+		float64_t max_impurity=MIN_SPLIT_GAIN;
+		if (m_nominal[f])
+		{
+			// categories present in the node
+			std::vector<index_t> categories;
+			for (index_t b=0;b<num_bins;++b)
+			{
+				if (hist[b*num_stats+num_stats-1]>0)
+					categories.push_back(b);
+			}
+			if (categories.size()<2)
+				continue;
+
+			// test all 2^(I-1)-1 possible division between two nodes
+			index_t num_cases=Math::pow(2,(index_t)categories.size()-1);
+			for (index_t k=1;k<num_cases;++k)
+			{
+				linalg::zero(left_stats);
+				for (index_t p=0;p<(index_t)categories.size();++p)
+				{
+					if ((k>>p)&1)
+					{
+						for (index_t s=0;s<num_stats;++s)
+							left_stats[s]+=hist[categories[p]*num_stats+s];
+					}
+				}
+				for (index_t s=0;s<num_stats;++s)
+					right_stats[s]=total[s]-left_stats[s];
+
+				auto g=histogram_gain(left_stats.vector, right_stats.vector, total.vector, num_classes, max_impurity);
+				candidate.impurity=std::max(max_impurity, candidate.impurity);
+				if (g>candidate.gain)
+				{
+					candidate.gain=g;
+					candidate.feats_left=SGVector<bool>(num_bins);
+					linalg::set_const(candidate.feats_left, false);
+					for (index_t p=0;p<(index_t)categories.size();++p)
+						candidate.feats_left[categories[p]]=(k>>p)&1;
+				}
+			}
+		}
+		else
+		{
+			// O(bins)
+			// find best split for non-nominal attribute - choose last bin going left
+			linalg::zero(left_stats);
+			for (index_t b=0;b<num_bins;++b)
+			{
+				if (hist[b*num_stats+num_stats-1]<1)
+					continue;
+
+				for (index_t s=0;s<num_stats;++s)
+				{
+					left_stats[s]+=hist[b*num_stats+s];
+					right_stats[s]=total[s]-left_stats[s];
+				}
+				if (right_stats[num_stats-1]<1)
+					break;
+
+				auto g=histogram_gain(left_stats.vector, right_stats.vector, total.vector, num_classes, max_impurity);
+				candidate.impurity=std::max(max_impurity, candidate.impurity);
+				if (g>candidate.gain)
+				{
+					candidate.gain=g;
+					candidate.bin=b;
+				}
+			}
+		}
+	}
+
+	// the first feature with the max gain wins, as in a sequential search
+	float64_t max_gain=MIN_SPLIT_GAIN;
+	index_t best=-1;
+	for (index_t i=0;i<idx.vlen;++i)
+	{
+		impurity=std::max(candidates[i].impurity, impurity);
+		if (candidates[i].gain>max_gain)
+		{
+			max_gain=candidates[i].gain;
+			best=i;
+		}
+	}
+
+	if (best==-1)
+		return -1;
+
+	index_t best_attribute=idx[best];
+	index_t best_bin=candidates[best].bin;
+	const auto& best_bins_left=candidates[best].feats_left;
+	auto bins=m_binned_features.get_column_vector(best_attribute);
+	auto thresholds=m_bin_thresholds.get_column_vector(best_attribute);
+	index_t num_non_missing=0;
+	if (m_nominal[best_attribute])
+	{
+		auto hist=histogram.vector+m_bin_offsets[best_attribute]*num_stats;
+		count_left=0;
+		count_right=0;
+		for (index_t b=0;b<best_bins_left.vlen;++b)
+		{
+			if (hist[b*num_stats+num_stats-1]<1)
+				continue;
+
+			if (best_bins_left[b])
+				++count_left;
+			else
+				++count_right;
+		}
+
+		if (left.vlen<count_left)
+			left.resize_vector(count_left);
+		if (right.vlen<count_right)
+			right.resize_vector(count_right);
+
+		index_t l=0;
+		index_t r=0;
+		for (index_t b=0;b<best_bins_left.vlen;++b)
+		{
+			if (hist[b*num_stats+num_stats-1]<1)
+				continue;
+
+			if (best_bins_left[b])
+				left[l++]=thresholds[b];
+			else
+				right[r++]=thresholds[b];
+		}
+
+		for (index_t i=0;i<num_vecs;++i)
+		{
+			auto bin=bins[indices[i]];
+			is_left_final[i]=(bin!=MISSING_BIN) && best_bins_left[bin];
+			if (bin!=MISSING_BIN)
+				++num_non_missing;
+		}
+	}
+	else
+	{
+		left[0]=thresholds[best_bin];
+		right[0]=thresholds[best_bin];
+		count_left=1;
+		count_right=1;
+
+		for (index_t i=0;i<num_vecs;++i)
+		{
+			auto bin=bins[indices[i]];
+			is_left_final[i]=(bin!=MISSING_BIN) && (bin<=best_bin);
+			if (bin!=MISSING_BIN)
+				++num_non_missing;
+		}
+	}
+	num_missing=num_vecs-num_non_missing;
+
+	return best_attribute;
+}
+
 std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>> CARTree::CARTtrain(std::shared_ptr<DenseFeatures<float64_t>> data, const SGVector<float64_t>& weights, std::shared_ptr<DenseLabels> labels, int32_t level)
+{
+	std::mt19937_64 prng(m_prng());
+	return CARTtrain(data, weights, labels, level, SGVector<float64_t>(), prng);
+}
+
+std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>> CARTree::CARTtrain(std::shared_ptr<DenseFeatures<float64_t>> data, const SGVector<float64_t>& weights, std::shared_ptr<DenseLabels> labels, int32_t level, SGVector<float64_t> histogram, std::mt19937_64& prng)
 {
 	require(labels,"labels have to be supplied");
 	require(data,"data matrix has to be supplied");
 
 	auto node=std::make_shared<bnode_t>();
 	auto labels_vec = labels->get_labels();
-	auto mat = data->get_feature_matrix();
-	auto num_feats=mat.num_rows;
-	auto num_vecs=mat.num_cols;
+	auto num_feats=data->get_num_features();
+	auto num_vecs=data->get_num_vectors();
+	// only copied if needed, the sorted or binned features are used instead
+	SGMatrix<float64_t> mat;
+	if (!m_pre_sort && !m_histogram)
+		mat=data->get_feature_matrix();
 
 	// calculate node label
 	switch(m_mode)
@@ -444,7 +951,20 @@ std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>> CARTree::CARTtrain(std::
 	int32_t best_attribute;
 
 	SGVector<index_t> indices(num_vecs);
-	if (m_pre_sort)
+	index_t subset_size=0;
+	if (m_histogram)
+	{
+		auto subset_stack = data->get_subset_stack();
+		if (subset_stack->has_subsets())
+			indices=(subset_stack->get_last_subset())->get_subset_idx();
+		else
+			linalg::range_fill(indices);
+		subset_size=get_split_subset_size(num_feats);
+		best_attribute = compute_best_attribute_histogram(
+		    indices, weights, labels_vec, histogram, left, right, left_final,
+		    num_missing_final, c_left, c_right, node_impurity, prng, subset_size);
+	}
+	else if (m_pre_sort)
 	{
 		auto subset_stack = data->get_subset_stack();
 		if (subset_stack->has_subsets())
@@ -453,12 +973,12 @@ std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>> CARTree::CARTtrain(std::
 			linalg::range_fill(indices);
 		best_attribute = compute_best_attribute(
 		    m_sorted_features, weights, labels, left, right, left_final,
-		    num_missing_final, c_left, c_right, node_impurity, 0, indices);
+		    num_missing_final, c_left, c_right, node_impurity, prng, 0, indices);
 	}
 	else
 		best_attribute = compute_best_attribute(
 		    mat, weights, labels, left, right, left_final, num_missing_final,
-		    c_left, c_right, node_impurity);
+		    c_left, c_right, node_impurity, prng);
 
 	if (best_attribute==-1)
 	{
@@ -475,6 +995,8 @@ std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>> CARTree::CARTtrain(std::
 
 	if (num_missing_final>0)
 	{
+		if (!mat.matrix)
+			mat=data->get_feature_matrix();
 		SGVector<bool> is_left_final(num_vecs-num_missing_final);
 		int32_t ilf=0;
 		for (int32_t i=0;i<num_vecs;++i)
@@ -508,17 +1030,80 @@ std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>> CARTree::CARTtrain(std::
 		}
 	}
 
-	// left child
-	auto feats_train = view(data, subsetl);
-	auto labels_train = view(labels, subsetl);
-	auto left_child =
-	    CARTtrain(feats_train, weightsl, labels_train, level + 1);
+	// histograms of the children, the one of the bigger child is the
+	// difference of the ones of the node and of the smaller child
+	SGVector<float64_t> histogram_left;
+	SGVector<float64_t> histogram_right;
+	if (m_histogram && !subset_size)
+	{
+		bool left_smaller=count_left<=num_vecs-count_left;
+		const auto& subset_small=left_smaller ? subsetl : subsetr;
+		SGVector<index_t> indices_small(subset_small.vlen);
+		SGVector<float64_t> weights_small(subset_small.vlen);
+		SGVector<float64_t> labels_small(subset_small.vlen);
+		for (index_t i=0;i<subset_small.vlen;++i)
+		{
+			indices_small[i]=indices[subset_small[i]];
+			weights_small[i]=weights[subset_small[i]];
+			labels_small[i]=labels_vec[subset_small[i]];
+		}
+
+		SGVector<index_t> all_feats(num_feats);
+		linalg::range_fill(all_feats);
+		auto histogram_small=build_histogram(indices_small, weights_small, labels_small, all_feats);
+		// the node histogram is not needed anymore
+		auto histogram_big=histogram;
+		linalg::add(histogram_big, histogram_small, histogram_big, 1.0, -1.0);
+
+		histogram_left=left_smaller ? histogram_small : histogram_big;
+		histogram_right=left_smaller ? histogram_big : histogram_small;
+	}
+	histogram=SGVector<float64_t>();
+
+	// the children draw their feature subsets from their own generators,
+	// so the tree doesn't depend on the order in which the tasks run
+	std::mt19937_64 prng_left(prng());
+	std::mt19937_64 prng_right(prng());
+
+	// the left child is grown in a task if both children are big
+	std::shared_ptr<bnode_t> left_child;
+	std::shared_ptr<bnode_t> right_child;
+	std::exception_ptr left_error;
+	std::exception_ptr right_error;
+	#pragma omp task shared(left_child, left_error) if (grow_in_parallel(std::min(count_left, num_vecs-count_left)))
+	{
+		try
+		{
+			auto feats_train = view(data, subsetl);
+			auto labels_train = view(labels, subsetl);
+			left_child =
+			    CARTtrain(feats_train, weightsl, labels_train, level + 1, histogram_left, prng_left);
+		}
+		catch (...)
+		{
+			left_error=std::current_exception();
+		}
+	}
+	histogram_left=SGVector<float64_t>();
 
 	// right child
-	feats_train = view(data, subsetr);
-	labels_train = view(labels, subsetr);
-	auto right_child =
-	    CARTtrain(feats_train, weightsr, labels_train, level + 1);
+	try
+	{
+		auto feats_train = view(data, subsetr);
+		auto labels_train = view(labels, subsetr);
+		right_child =
+		    CARTtrain(feats_train, weightsr, labels_train, level + 1, histogram_right, prng_right);
+	}
+	catch (...)
+	{
+		right_error=std::current_exception();
+	}
+	#pragma omp taskwait
+
+	if (left_error)
+		std::rethrow_exception(left_error);
+	if (right_error)
+		std::rethrow_exception(right_error);
 
 	// set node parameters
 	node->data.attribute_id=best_attribute;
@@ -561,7 +1146,7 @@ index_t CARTree::compute_best_attribute(
     std::shared_ptr<DenseLabels> labels, SGVector<float64_t>& left,
     SGVector<float64_t>& right, SGVector<bool>& is_left_final,
     index_t& num_missing_final, index_t& count_left, index_t& count_right,
-    float64_t& impurity, index_t subset_size,
+    float64_t& impurity, std::mt19937_64& prng, index_t subset_size,
     const SGVector<index_t>& active_indices)
 {
 	auto labels_vec=labels->get_labels();
@@ -601,13 +1186,11 @@ index_t CARTree::compute_best_attribute(
 	if (subset_size)
 	{
 		num_feats=subset_size;
-		random::shuffle(idx, m_prng);
+		random::shuffle(idx, prng);
 	}
 
-	float64_t max_gain=MIN_SPLIT_GAIN;
-	float64_t max_impurity = MIN_SPLIT_GAIN;
-	index_t best_attribute=-1;
-	float64_t best_threshold=0;
+	if (m_mode!=PT_MULTICLASS && m_mode!=PT_REGRESSION)
+		error("Undefined problem statement");
 
 	SGVector<int64_t> indices_mask;
 	SGVector<index_t> count_indices(mat.num_rows);
@@ -628,12 +1211,16 @@ index_t CARTree::compute_best_attribute(
 		}
 	}
 
+	// best split of each feature, the features are searched in parallel
+	// in big nodes. The candidates have to be shared explicitly, tasks get
+	// private copies of the locals of the function by default
+	std::vector<SplitCandidate> candidates(num_feats);
+	#pragma omp taskloop grainsize(1) default(shared) if (grow_in_parallel(num_vecs))
 	for (index_t i=0;i<num_feats;++i)
 	{
+		auto& candidate=candidates[i];
 		SGVector<float64_t> feats(num_vecs);
 		SGVector<index_t> sorted_args(num_vecs);
-		SGVector<index_t> temp_count_indices(count_indices.size());
-		sg_memcpy(temp_count_indices.vector, count_indices.vector, sizeof(index_t)*count_indices.size());
 
 		if (m_pre_sort)
 		{
@@ -666,11 +1253,14 @@ index_t CARTree::compute_best_attribute(
 			linalg::range_fill(sorted_args);
 			Math::qsort_index(feats.vector, sorted_args.vector, feats.size());
 		}
+
+		// weights of the classes of the vectors with non-missing values
+		SGVector<float64_t> wclasses=total_wclasses.clone();
 		auto n_nm_vecs = feats.vlen;
 		// number of non-missing vecs
 		while (feats[n_nm_vecs-1] == MISSING)
 		{
-			total_wclasses[simple_labels[sorted_args[n_nm_vecs-1]]]-=weights[sorted_args[n_nm_vecs-1]];
+			wclasses[simple_labels[sorted_args[n_nm_vecs-1]]]-=weights[sorted_args[n_nm_vecs-1]];
 			--n_nm_vecs;
 		}
 
@@ -678,6 +1268,7 @@ index_t CARTree::compute_best_attribute(
 		if (feats[n_nm_vecs-1]<=feats[0]+EQ_DELTA)
 			continue;
 
+		float64_t max_impurity = MIN_SPLIT_GAIN;
 		if (m_nominal[idx[i]])
 		{
 			SGVector<index_t> simple_feats(num_vecs);
@@ -742,50 +1333,26 @@ index_t CARTree::compute_best_attribute(
 				}
 
 				float64_t g=0;
-				switch(m_mode)
-				{
-					case PT_MULTICLASS:
-					    g = gain(wleft, wright, total_wclasses, max_impurity);
-					    impurity = std::max(max_impurity, impurity);
-					    break;
-				    case PT_REGRESSION:
-					    g = gain(
-					        wleft, wright, total_wclasses, ulabels,
-					        max_impurity);
-					    impurity = std::max(max_impurity, impurity);
-					    break;
-				    default:
-					    error("Undefined problem statement");
-				}
+				if (m_mode==PT_MULTICLASS)
+					g = gain(wleft, wright, wclasses, max_impurity);
+				else
+					g = gain(wleft, wright, wclasses, ulabels, max_impurity);
+				candidate.impurity = std::max(max_impurity, candidate.impurity);
 
-				if (g>max_gain)
+				if (g>candidate.gain)
 				{
-					best_attribute=idx[i];
-					max_gain=g;
-					sg_memcpy(is_left_final.vector,is_left.vector,is_left.vlen*sizeof(bool));
-					num_missing_final=num_vecs-n_nm_vecs;
-
-					count_left = std::count(feats_left.begin(), feats_left.end(), true);
-					count_right = c+1-count_left;
-
-					index_t l=0;
-					index_t r=0;
-					if (right.vlen < count_right)
-						right.resize_vector(count_right);
-					for (index_t w = 0; w < feats_left.vlen; ++w)
-					{
-						if (feats_left[w])
-							left[l++]=ufeats[w];
-						else
-							right[r++]=ufeats[w];
-					}
+					candidate.gain=g;
+					candidate.num_missing=num_vecs-n_nm_vecs;
+					candidate.is_left=is_left;
+					candidate.feats_left=feats_left;
+					candidate.ufeats=ufeats;
 				}
 			}
 		}
 		else
 		{
 			// O(N)
-			SGVector<float64_t> right_wclasses=total_wclasses.clone();
+			SGVector<float64_t> right_wclasses=wclasses.clone();
 			SGVector<float64_t> left_wclasses(n_ulabels);
 			linalg::zero(left_wclasses);
 
@@ -807,26 +1374,22 @@ index_t CARTree::compute_best_attribute(
 				if (m_mode == PT_MULTICLASS)
 				{
 					g = gain(
-					    left_wclasses, right_wclasses, total_wclasses,
+					    left_wclasses, right_wclasses, wclasses,
 					    max_impurity);
-					impurity = std::max(max_impurity, impurity);
 				}
-				else if (m_mode == PT_REGRESSION)
+				else
 				{
 					g = gain(
-					    left_wclasses, right_wclasses, total_wclasses, ulabels,
+					    left_wclasses, right_wclasses, wclasses, ulabels,
 					    max_impurity);
-					impurity = std::max(max_impurity, impurity);
 				}
-				else
-					error("Undefined problem statement");
+				candidate.impurity = std::max(max_impurity, candidate.impurity);
 
-				if (g>max_gain)
+				if (g>candidate.gain)
 				{
-					max_gain=g;
-					best_attribute=idx[i];
-					best_threshold=z;
-					num_missing_final=num_vecs-n_nm_vecs;
+					candidate.gain=g;
+					candidate.threshold=z;
+					candidate.num_missing=num_vecs-n_nm_vecs;
 				}
 
 				z=feats[j];
@@ -836,20 +1399,51 @@ index_t CARTree::compute_best_attribute(
 				left_wclasses[simple_labels[sorted_args[j]]]+=weights[sorted_args[j]];
 			}
 		}
+	}
 
-		// restore total_wclasses
-		while (n_nm_vecs<feats.vlen)
+	// the first feature with the max gain wins, as in a sequential search
+	float64_t max_gain=MIN_SPLIT_GAIN;
+	index_t best=-1;
+	for (index_t i=0;i<num_feats;++i)
+	{
+		impurity=std::max(candidates[i].impurity, impurity);
+		if (candidates[i].gain>max_gain)
 		{
-			total_wclasses[simple_labels[sorted_args[n_nm_vecs-1]]]+=weights[sorted_args[n_nm_vecs-1]];
-			++n_nm_vecs;
+			max_gain=candidates[i].gain;
+			best=i;
 		}
 	}
 
-	if (best_attribute==-1)
+	if (best==-1)
 		return -1;
 
-	if (!m_nominal[best_attribute])
+	index_t best_attribute=idx[best];
+	const auto& candidate=candidates[best];
+	num_missing_final=candidate.num_missing;
+	if (m_nominal[best_attribute])
+	{
+		sg_memcpy(is_left_final.vector,candidate.is_left.vector,candidate.is_left.vlen*sizeof(bool));
+
+		count_left = std::count(candidate.feats_left.begin(), candidate.feats_left.end(), true);
+		count_right = candidate.feats_left.vlen-count_left;
+
+		index_t l=0;
+		index_t r=0;
+		if (left.vlen < count_left)
+			left.resize_vector(count_left);
+		if (right.vlen < count_right)
+			right.resize_vector(count_right);
+		for (index_t w = 0; w < candidate.feats_left.vlen; ++w)
+		{
+			if (candidate.feats_left[w])
+				left[l++]=candidate.ufeats[w];
+			else
+				right[r++]=candidate.ufeats[w];
+		}
+	}
+	else
 	{
+		float64_t best_threshold=candidate.threshold;
 		left[0]=best_threshold;
 		right[0]=best_threshold;
 		count_left=1;
@@ -1500,6 +2094,9 @@ void CARTree::init()
 	m_weights=SGVector<float64_t>();
 	m_mode=PT_MULTICLASS;
 	m_pre_sort=false;
+	m_histogram=false;
+	m_max_bins=CART_DEFAULT_MAX_BINS;
+	m_pre_bin=false;
 	m_apply_cv_pruning=false;
 	m_folds=5;
 
@@ -1516,6 +2113,8 @@ void CARTree::init()
 	SG_ADD(&m_pre_sort, "pre_sort", "presort");
 	SG_ADD(&m_sorted_features, "sorted_features", "sorted feats");
 	SG_ADD(&m_sorted_indices, "sorted_indices", "sorted indices");
+	SG_ADD(&m_histogram, "histogram", "find splits from histograms of binned features");
+	SG_ADD(&m_max_bins, "max_bins", "max number of bins of a feature in histogram mode");
 	SG_ADD(&m_nominal, "nominal", "feature types");
 	SG_ADD(&m_weights, "weights", "weights");
 	SG_ADD(
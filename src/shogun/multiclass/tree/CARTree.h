@@ -44,6 +44,12 @@
 
 #include <vector>
 
+/** default number of bins of a feature in histogram mode */
+#define CART_DEFAULT_MAX_BINS 255
+/** min number of vectors of a node whose subtrees and split search are
+ * distributed among threads */
+#define CART_PARALLEL_MIN_NODE_SIZE 2048
+
 namespace shogun
 {
 
@@ -80,7 +86,23 @@ namespace shogun
  * have been sent to left/right child. If all possible surrogate splits are used up but some data points are still to be
  * assigned left/right child, majority rule is used, ie. the data points are assigned the child where majority of data points
  * have gone from the node. \n
- * cf. http://pic.dhe.ibm.com/infocenter/spssstat/v20r0m0/index.jsp?topic=%2Fcom.ibm.spss.statistics.help%2Falg_tree-cart.htm
+ * cf. http://pic.dhe.ibm.com/infocenter/spssstat/v20r0m0/index.jsp?topic=%2Fcom.ibm.spss.statistics.help%2Falg_tree-cart.htm \n \n
+ *
+ * HISTOGRAM MODE : \n
+ * Instead of scanning the exact sorted values of the features in every node, each feature can be quantized once into at most
+ * 255 bins, stored as one byte per value. Continuous features are split at quantiles of their values (or at each distinct value
+ * if there are few), nominal features get one bin per category. The best split of a node is then found from the histograms of
+ * the per-bin label weights of its vectors, which take O(N) per feature to build and O(bins) to scan. If all features are
+ * considered in each split, the histogram of the bigger child is computed by subtracting the one of the smaller child from the
+ * one of its parent. Splits of continuous features are restricted to the bin boundaries. \n \n
+ *
+ * PARALLEL TRAINING : \n
+ * The tree is grown by OpenMP tasks on env()->get_num_threads() threads. The left subtree of a node is grown in a new task if
+ * both children have at least CART_PARALLEL_MIN_NODE_SIZE vectors, and the best splits of the features of such big nodes are
+ * searched in parallel. Idle threads pick up pending tasks, so the threads move to the deep parts of the tree as the top nodes
+ * are done. When trained from within a parallel region, e.g. as a bag of a BaggingMachine, the tree is grown on one thread.
+ * Each node draws its random feature subset from its own generator, which is seeded by its parent, so randomized trees are
+ * the same on any number of threads.
  */
 class CARTree : public RandomMixin<FeatureImportanceTree<CARTreeNodeData>>
 {
@@ -238,6 +260,49 @@ public:
 
 	void set_sorted_features(SGMatrix<float64_t>& sorted_feats, SGMatrix<index_t>& sorted_indices);
 
+	/** set whether splits are found from histograms of binned features
+	 *
+	 * @param histogram whether to use histogram mode
+	 */
+	void set_histogram(bool histogram);
+
+	/** get whether splits are found from histograms of binned features
+	 *
+	 * @return whether histogram mode is used
+	 */
+	bool get_histogram() const;
+
+	/** set max number of bins of a feature in histogram mode
+	 *
+	 * @param max_bins max number of bins, between 2 and 255
+	 */
+	void set_max_bins(int32_t max_bins);
+
+	/** get max number of bins of a feature in histogram mode
+	 *
+	 * @return max number of bins
+	 */
+	int32_t get_max_bins() const;
+
+	/** quantize each feature into at most get_max_bins() bins for
+	 * histogram mode
+	 *
+	 * @param data training data
+	 * @param binned_feats bin of each feature (column) of each vector (row), MISSING_BIN for missing values
+	 * @param bin_thresholds upper bound of each bin (row) of each feature (column)
+	 * @param num_bins number of bins of each feature
+	 */
+	void pre_bin_features(const std::shared_ptr<Features>& data, SGMatrix<uint8_t>& binned_feats, SGMatrix<float64_t>& bin_thresholds, SGVector<index_t>& num_bins);
+
+	/** set features binned with pre_bin_features, which are used instead of
+	 * binning the training data in histogram mode
+	 *
+	 * @param binned_feats bin of each feature of each vector
+	 * @param bin_thresholds upper bound of each bin of each feature
+	 * @param num_bins number of bins of each feature
+	 */
+	void set_binned_features(SGMatrix<uint8_t>& binned_feats, SGMatrix<float64_t>& bin_thresholds, SGVector<index_t>& num_bins);
+
 	/**return feature importance
 	 * this way is the same as sklearn
 	 */
@@ -260,6 +325,33 @@ protected:
 	 */
 	virtual std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>> CARTtrain(std::shared_ptr<DenseFeatures<float64_t>> data, const SGVector<float64_t>& weights, std::shared_ptr<DenseLabels> labels, int32_t level);
 
+	/** CARTtrain - recursive CART training method
+	 *
+	 * @param data training data
+	 * @param weights vector of weights of data points
+	 * @param labels labels of data points
+	 * @param level current tree depth
+	 * @param histogram histogram of the node in histogram mode if it was computed from its parent and sibling, empty otherwise
+	 * @param prng generator of the random feature subsets of the subtree
+	 * @return pointer to the root of the CART subtree
+	 */
+	std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>> CARTtrain(std::shared_ptr<DenseFeatures<float64_t>> data, const SGVector<float64_t>& weights, std::shared_ptr<DenseLabels> labels, int32_t level, SGVector<float64_t> histogram, std::mt19937_64& prng);
+
+	/** get number of features chosen randomly in each node split
+	 *
+	 * @param num_feats number of features
+	 * @return number of features, 0 for all features
+	 */
+	virtual index_t get_split_subset_size(index_t num_feats);
+
+	/** whether the work of a node is distributed among the threads
+	 *
+	 * @param num_vecs number of vectors of the node
+	 * @return true if the node is big and the tree is grown on several
+	 * threads
+	 */
+	bool grow_in_parallel(index_t num_vecs) const;
+
 	/** modify labels for compute_best_attribute
 	 *
 	 * @param labels_vec labels vector
@@ -280,6 +372,7 @@ protected:
 	 * @param count_left stores number of feature values for left transition
 	 * @param count_right stores number of feature values for right transition
 	 * @param impurity impurity of current node
+	 * @param prng generator of the random feature subset
 	 * @return index to the best attribute
 	 */
 	virtual index_t compute_best_attribute(
@@ -287,9 +380,54 @@ protected:
 		std::shared_ptr<DenseLabels> labels, SGVector<float64_t>& left,
 		SGVector<float64_t>& right, SGVector<bool>& is_left_final,
 		index_t& num_missing, index_t& count_left, index_t& count_right,
-		float64_t& impurity, index_t subset_size = 0,
+		float64_t& impurity, std::mt19937_64& prng, index_t subset_size = 0,
 		const SGVector<index_t>& active_indices = SGVector<index_t>());
 
+	/** computes best attribute for CARTtrain from the histograms of the
+	 * binned features
+	 *
+	 * @param indices indices of the data points in the binned features
+	 * @param weights data weights
+	 * @param labels_vec data labels
+	 * @param histogram histogram of the node, built if empty
+	 * @param left stores feature values for left transition
+	 * @param right stores feature values for right transition
+	 * @param is_left_final stores which feature vectors go to the left child
+	 * @param num_missing number of missing attributes
+	 * @param count_left stores number of feature values for left transition
+	 * @param count_right stores number of feature values for right transition
+	 * @param impurity impurity of current node
+	 * @param prng generator of the random feature subset
+	 * @param subset_size number of randomly chosen features, 0 for all
+	 * @return index to the best attribute
+	 */
+	index_t compute_best_attribute_histogram(
+		const SGVector<index_t>& indices, const SGVector<float64_t>& weights,
+		const SGVector<float64_t>& labels_vec, SGVector<float64_t>& histogram,
+		SGVector<float64_t>& left, SGVector<float64_t>& right,
+		SGVector<bool>& is_left_final, index_t& num_missing,
+		index_t& count_left, index_t& count_right, float64_t& impurity,
+		std::mt19937_64& prng, index_t subset_size);
+
+	/** builds the histogram of the binned features of data points, which
+	 * holds histogram_stats() sums per bin: the weights of the classes
+	 * (classification) or the sums of weights, weighted labels and weighted
+	 * squared labels (regression), followed by the number of data points
+	 *
+	 * @param indices indices of the data points in the binned features
+	 * @param weights data weights
+	 * @param labels_vec data labels
+	 * @param features features whose bins are filled, the others are 0
+	 * @return histogram
+	 */
+	SGVector<float64_t> build_histogram(
+		const SGVector<index_t>& indices, const SGVector<float64_t>& weights,
+		const SGVector<float64_t>& labels_vec,
+		const SGVector<index_t>& features) const;
+
+	/** @return number of sums per bin of a histogram */
+	index_t histogram_stats() const;
+
 	/** handles missing values through surrogate splits
 	 *
 	 * @param data training data matrix
@@ -439,6 +577,9 @@ public:
 	/** equality epsilon */
 	static const float64_t EQ_DELTA;
 
+	/** bin of missing values in histogram mode */
+	static const uint8_t MISSING_BIN;
+
 protected:
 	/** Returns whether the type of various feature dimensions are specified
 	 * using is_nominal_feature
@@ -466,6 +607,31 @@ protected:
 	/** If pre sorted features are used in train */
 	bool m_pre_sort;
 
+	/** whether splits are found from histograms of binned features */
+	bool m_histogram;
+
+	/** max number of bins of a feature in histogram mode */
+	int32_t m_max_bins;
+
+	/** If pre binned features are used in train */
+	bool m_pre_bin;
+
+	/** bin of each feature (column) of each vector (row) */
+	SGMatrix<uint8_t> m_binned_features;
+
+	/** upper bound of each bin (row) of each feature (column) */
+	SGMatrix<float64_t> m_bin_thresholds;
+
+	/** number of bins of each feature */
+	SGVector<index_t> m_num_bins;
+
+	/** offset of the first bin of each feature in a histogram */
+	SGVector<index_t> m_bin_offsets;
+
+	/** sorted distinct labels of the training data in histogram mode
+	 * classification, which index the class weights in histograms */
+	SGVector<float64_t> m_histogram_classes;
+
 	/** flag indicating whether cross validation pruning has to be applied or not - false by default **/
 	bool m_apply_cv_pruning;
 
@@ -0,0 +1,195 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <shogun/io/SGIO.h>
+#include <shogun/mathematics/Math.h>
+#include <shogun/multiclass/tree/FlatForest.h>
+
+#include <algorithm>
+#include <queue>
+
+using namespace shogun;
+
+FlatForest::FlatForest(
+	const std::vector<std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>>>& roots,
+	const SGVector<bool>& nominal)
+: m_num_features(0)
+{
+	for (const auto& root : roots)
+	{
+		require(root, "Tree {} is not trained", m_roots.size());
+		add_tree(root, nominal);
+	}
+}
+
+void FlatForest::add_tree(
+	const std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>>& root,
+	const SGVector<bool>& nominal)
+{
+	m_roots.push_back(m_nodes.size());
+	m_nodes.emplace_back();
+
+	/* nodes whose slots are allocated but not filled yet, the children of a
+	 * node get their slots when it is filled */
+	std::queue<std::pair<std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>>, int32_t>> pending;
+	pending.emplace(root, m_roots.back());
+	while (!pending.empty())
+	{
+		auto tree_node=pending.front().first;
+		auto index=pending.front().second;
+		pending.pop();
+
+		Node node;
+		if (tree_node->data.num_leaves==1)
+		{
+			node.value=tree_node->data.node_label;
+			node.feature=LEAF;
+			node.left=0;
+		}
+		else
+		{
+			auto attribute=tree_node->data.attribute_id;
+			const auto& transit=tree_node->left()->data.transit_into_values;
+			require(attribute>=0 && attribute<nominal.vlen,
+				"Feature {} of a split is out of range", attribute);
+			m_num_features=Math::max(m_num_features, attribute+1);
+
+			if (nominal[attribute])
+			{
+				node.value=m_categories.size();
+				node.feature=NOMINAL_FEATURE-attribute;
+				m_categories.push_back(transit.vlen);
+				m_categories.insert(m_categories.end(), transit.begin(), transit.end());
+			}
+			else
+			{
+				node.value=transit[0];
+				node.feature=attribute;
+			}
+
+			node.left=m_nodes.size();
+			m_nodes.emplace_back();
+			m_nodes.emplace_back();
+			pending.emplace(tree_node->left(), node.left);
+			pending.emplace(tree_node->right(), node.left+1);
+		}
+		m_nodes[index]=node;
+	}
+}
+
+void FlatForest::traverse(const SGMatrix<float64_t>& data, index_t first,
+	index_t size, index_t tree, int32_t* current, const uint64_t* skip) const
+{
+	const float64_t* vectors=data.get_column_vector(first);
+	std::fill(current, current+size, m_roots[tree]);
+	if (skip)
+	{
+		for (index_t i=0; i<size; ++i)
+		{
+			const index_t vec=first+i;
+			if ((skip[vec/64]>>(vec%64))&1)
+				current[i]=SKIPPED;
+		}
+	}
+
+	// all vectors of the block descend one level per sweep
+	bool active=true;
+	while (active)
+	{
+		active=false;
+		for (index_t i=0; i<size; ++i)
+		{
+			if (current[i]==SKIPPED)
+				continue;
+
+			const Node& node=m_nodes[current[i]];
+			if (node.feature==LEAF)
+				continue;
+
+			active=true;
+			const float64_t* vec=vectors+i*data.num_rows;
+			bool left;
+			if (node.feature>=0)
+				left=vec[node.feature]<=node.value;
+			else
+			{
+				const float64_t value=vec[NOMINAL_FEATURE-node.feature];
+				const float64_t* categories=m_categories.data()+int64_t(node.value);
+				const float64_t* end=categories+1+int64_t(categories[0]);
+				left=std::find(categories+1, end, value)!=end;
+			}
+			current[i]=left ? node.left : node.left+1;
+		}
+	}
+}
+
+SGMatrix<float64_t> FlatForest::apply(const SGMatrix<float64_t>& data,
+	const SGMatrix<uint64_t>& skip) const
+{
+	require(data.num_rows>=m_num_features, "Trees split on {} features, "
+		"data has {}", m_num_features, data.num_rows);
+
+	const index_t num_vecs=data.num_cols;
+	const index_t num_trees=get_num_trees();
+	require(!skip.matrix || (skip.num_rows==(num_vecs+63)/64 &&
+		skip.num_cols==num_trees), "Skipped vectors should be a {}x{} "
+		"bitset, got {}x{}", (num_vecs+63)/64, num_trees, skip.num_rows,
+		skip.num_cols);
+	const index_t num_blocks=(num_vecs+FLAT_FOREST_BLOCK_SIZE-1)/FLAT_FOREST_BLOCK_SIZE;
+	SGMatrix<float64_t> output(num_vecs, num_trees);
+
+	#pragma omp parallel for
+	for (index_t block=0; block<num_blocks; ++block)
+	{
+		const index_t first=block*FLAT_FOREST_BLOCK_SIZE;
+		const index_t size=Math::min(num_vecs-first, index_t(FLAT_FOREST_BLOCK_SIZE));
+		int32_t current[FLAT_FOREST_BLOCK_SIZE];
+
+		for (index_t t=0; t<num_trees; ++t)
+		{
+			traverse(data, first, size, t, current,
+				skip.matrix ? skip.get_column_vector(t) : NULL);
+
+			float64_t* labels=output.get_column_vector(t)+first;
+			for (index_t i=0; i<size; ++i)
+				labels[i]=current[i]==SKIPPED ? NAN : m_nodes[current[i]].value;
+		}
+	}
+
+	return output;
+}
+
+SGVector<float64_t> FlatForest::apply_weighted_sum(
+	const SGMatrix<float64_t>& data, const SGVector<float64_t>& weights) const
+{
+	require(data.num_rows>=m_num_features, "Trees split on {} features, "
+		"data has {}", m_num_features, data.num_rows);
+	require(weights.vlen==get_num_trees(), "Number of weights ({}) should be "
+		"the number of trees ({})", weights.vlen, get_num_trees());
+
+	const index_t num_vecs=data.num_cols;
+	const index_t num_trees=get_num_trees();
+	const index_t num_blocks=(num_vecs+FLAT_FOREST_BLOCK_SIZE-1)/FLAT_FOREST_BLOCK_SIZE;
+	SGVector<float64_t> output(num_vecs);
+	output.zero();
+
+	#pragma omp parallel for
+	for (index_t block=0; block<num_blocks; ++block)
+	{
+		const index_t first=block*FLAT_FOREST_BLOCK_SIZE;
+		const index_t size=Math::min(num_vecs-first, index_t(FLAT_FOREST_BLOCK_SIZE));
+		int32_t current[FLAT_FOREST_BLOCK_SIZE];
+
+		float64_t* sums=output.vector+first;
+		for (index_t t=0; t<num_trees; ++t)
+		{
+			traverse(data, first, size, t, current);
+
+			for (index_t i=0; i<size; ++i)
+				sums[i]+=weights[t]*m_nodes[current[i]].value;
+		}
+	}
+
+	return output;
+}
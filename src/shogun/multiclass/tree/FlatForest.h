@@ -0,0 +1,138 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#ifndef __FLATFOREST_H__
+#define __FLATFOREST_H__
+
+#include <shogun/lib/config.h>
+
+#include <shogun/lib/SGMatrix.h>
+#include <shogun/lib/SGVector.h>
+#include <shogun/lib/common.h>
+#include <shogun/multiclass/tree/BinaryTreeMachineNode.h>
+#include <shogun/multiclass/tree/CARTreeNodeData.h>
+
+#include <memory>
+#include <vector>
+
+/** number of vectors which traverse a tree together in FlatForest::apply */
+#define FLAT_FOREST_BLOCK_SIZE 64
+
+namespace shogun
+{
+/** @brief FlatForest is a compiled, read-only copy of trained CART trees
+ * (see CARTree) for fast prediction.
+ *
+ * The nodes of all trees are stored in one array of 16 byte nodes, four per
+ * cache line, instead of being linked by pointers. Each tree is laid out in
+ * breadth first order, so its top levels, which every vector visits, share a
+ * few cache lines, and the two children of a node are adjacent. Predicting
+ * then needs no pointer chasing and no reference counting.
+ *
+ * apply() lets blocks of FLAT_FOREST_BLOCK_SIZE vectors traverse each tree in
+ * lockstep, one level per sweep over the block, which keeps the block and the
+ * hot nodes of the tree in cache and gives the CPU independent work to
+ * overlap. Blocks are distributed among threads.
+ */
+class FlatForest
+{
+	/** node of a tree */
+	struct alignas(16) Node
+	{
+		/** threshold of a continuous feature, offset of the categories of
+		 * a nominal feature in m_categories, or label of a leaf */
+		float64_t value;
+		/** feature of the split, NOMINAL_FEATURE-feature for nominal
+		 * features or LEAF for leaves */
+		int32_t feature;
+		/** index of the left child, the right child follows it */
+		int32_t left;
+	};
+
+public:
+	/** compile trees
+	 *
+	 * @param roots roots of the trained trees
+	 * @param nominal whether each feature is nominal
+	 */
+	FlatForest(
+		const std::vector<std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>>>& roots,
+		const SGVector<bool>& nominal);
+
+	/** @return number of trees */
+	index_t get_num_trees() const
+	{
+		return m_roots.size();
+	}
+
+	/** @return number of nodes of all trees */
+	index_t get_num_nodes() const
+	{
+		return m_nodes.size();
+	}
+
+	/** predict the labels of vectors with each tree
+	 *
+	 * @param data vectors (columns)
+	 * @param skip optional bitset of the vectors each tree does not
+	 * predict, e.g. the training vectors of its bag: vector v is skipped by
+	 * tree t if bit v%64 of skip(v/64, t) is set
+	 * @return labels, one column per tree, NaN for skipped vectors
+	 */
+	SGMatrix<float64_t> apply(const SGMatrix<float64_t>& data,
+		const SGMatrix<uint64_t>& skip=SGMatrix<uint64_t>()) const;
+
+	/** predict the weighted sums of the labels of the trees, e.g. for
+	 * boosted trees, without storing the label of each tree
+	 *
+	 * @param data vectors (columns)
+	 * @param weights weight of each tree
+	 * @return weighted sum of the labels of the trees of each vector
+	 */
+	SGVector<float64_t> apply_weighted_sum(
+		const SGMatrix<float64_t>& data, const SGVector<float64_t>& weights) const;
+
+private:
+	/** let a block of vectors traverse a tree
+	 *
+	 * @param data vectors
+	 * @param first index of the first vector of the block
+	 * @param size number of vectors of the block
+	 * @param tree index of the tree
+	 * @param current reached leaf of each vector of the block, SKIPPED for
+	 * skipped vectors (returned)
+	 * @param skip bitset of the vectors the tree skips, or NULL
+	 */
+	void traverse(const SGMatrix<float64_t>& data, index_t first,
+		index_t size, index_t tree, int32_t* current,
+		const uint64_t* skip=NULL) const;
+
+	/** append a tree in breadth first order
+	 *
+	 * @param root root of the tree
+	 * @param nominal whether each feature is nominal
+	 */
+	void add_tree(
+		const std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>>& root,
+		const SGVector<bool>& nominal);
+
+	/** feature of leaves */
+	static constexpr int32_t LEAF=-1;
+	/** nominal features are stored as NOMINAL_FEATURE-feature */
+	static constexpr int32_t NOMINAL_FEATURE=-2;
+	/** node reached by skipped vectors */
+	static constexpr int32_t SKIPPED=-1;
+
+	/** nodes of all trees */
+	std::vector<Node> m_nodes;
+	/** index of the root of each tree */
+	std::vector<int32_t> m_roots;
+	/** categories going left at nominal splits, each list starts with its
+	 * length */
+	std::vector<float64_t> m_categories;
+	/** number of features used by the splits */
+	index_t m_num_features;
+};
+}
+#endif /* __FLATFOREST_H__ */
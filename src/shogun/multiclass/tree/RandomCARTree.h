@@ -72,6 +72,14 @@ public:
 	index_t get_feature_subset_size() const { return m_randsubset_size; }
 
 protected:
+	/** get number of features chosen randomly in each node split,
+	 * sqrt of the number of features if the subset size is not set
+	 *
+	 * @param num_feats number of features
+	 * @return subset size
+	 */
+	index_t get_split_subset_size(index_t num_feats) override;
+
 	/** computes best attribute for CARTtrain
 	 *
 	 * @param mat data matrix
@@ -83,6 +91,7 @@ protected:
 	 * @param num_missing number of missing attributes
 	 * @param count_left stores number of feature values for left transition
 	 * @param count_right stores number of feature values for right transition
+	 * @param prng generator of the random feature subset
 	 * @return index to the best attribute
 	 */
 	index_t compute_best_attribute(
@@ -90,7 +99,7 @@ protected:
 		std::shared_ptr<DenseLabels> labels, SGVector<float64_t>& left,
 		SGVector<float64_t>& right, SGVector<bool>& is_left_final,
 		index_t& num_missing, index_t& count_left, index_t& count_right,
-		float64_t& impurity, index_t subset_size = 0,
+		float64_t& impurity, std::mt19937_64& prng, index_t subset_size = 0,
 		const SGVector<index_t>& active_indices = SGVector<index_t>()) override;
 
 private:
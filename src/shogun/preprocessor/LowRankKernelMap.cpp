@@ -0,0 +1,353 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <shogun/preprocessor/LowRankKernelMap.h>
+
+#include <shogun/clustering/KMeans.h>
+#include <shogun/distance/EuclideanDistance.h>
+#include <shogun/features/DenseFeatures.h>
+#include <shogun/io/SGIO.h>
+#include <shogun/mathematics/Math.h>
+#include <shogun/mathematics/RandomNamespace.h>
+#include <shogun/mathematics/UniformRealDistribution.h>
+#include <shogun/mathematics/eigen3.h>
+#include <shogun/mathematics/linalg/LinalgNamespace.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+using namespace shogun;
+using namespace Eigen;
+
+namespace
+{
+	/** number of vectors mapped at once */
+	const index_t LOWRANK_BLOCK_SIZE = 1024;
+}
+
+LowRankKernelMap::LowRankKernelMap() : RandomMixin<Preprocessor>()
+{
+	init();
+}
+
+LowRankKernelMap::LowRankKernelMap(
+    std::shared_ptr<Kernel> kernel, int32_t rank, ELowRankMethod method)
+    : RandomMixin<Preprocessor>()
+{
+	init();
+	m_kernel = std::move(kernel);
+	m_rank = rank;
+	m_method = method;
+}
+
+LowRankKernelMap::~LowRankKernelMap()
+{
+}
+
+void LowRankKernelMap::init()
+{
+	m_kernel = nullptr;
+	m_rank = 100;
+	m_effective_rank = 0;
+	m_method = LRM_INCOMPLETE_CHOLESKY;
+	m_landmark_selection = LS_UNIFORM;
+	m_tolerance = 1e-10;
+	m_landmarks = nullptr;
+
+	SG_ADD(&m_kernel, "kernel", "kernel to approximate", ParameterProperties::HYPER);
+	SG_ADD(
+	    &m_rank, "rank", "target rank of the approximation",
+	    ParameterProperties::HYPER | ParameterProperties::CONSTRAIN,
+	    SG_CONSTRAINT(positive<>()));
+	SG_ADD_OPTIONS(
+	    (machine_int_t*)&m_method, "method", "approximation method",
+	    ParameterProperties::NONE,
+	    SG_OPTIONS(LRM_INCOMPLETE_CHOLESKY, LRM_NYSTROM));
+	SG_ADD_OPTIONS(
+	    (machine_int_t*)&m_landmark_selection, "landmark_selection",
+	    "landmark selection of the Nystrom method", ParameterProperties::NONE,
+	    SG_OPTIONS(LS_UNIFORM, LS_LEVERAGE, LS_KMEANS));
+	SG_ADD(
+	    &m_tolerance, "tolerance",
+	    "incomplete Cholesky stops below this residual");
+	SG_ADD(&m_landmarks, "landmarks", "landmarks the kernel is evaluated on");
+	SG_ADD(&m_projection, "projection", "map from kernel values to features");
+}
+
+void LowRankKernelMap::fit(std::shared_ptr<Features> features)
+{
+	require(m_kernel, "Kernel not set");
+	require(features, "No features provided");
+	require(m_rank > 0, "Rank ({}) must be positive", m_rank);
+
+	index_t num_vectors = features->get_num_vectors();
+	m_effective_rank = m_rank;
+	if (m_rank > num_vectors)
+	{
+		io::warn(
+		    "Rank ({}) is larger than the number of vectors, using {}.",
+		    m_rank, num_vectors);
+		m_effective_rank = num_vectors;
+	}
+
+	switch (m_method)
+	{
+	case LRM_INCOMPLETE_CHOLESKY:
+		fit_incomplete_cholesky(features);
+		break;
+	case LRM_NYSTROM:
+		switch (m_landmark_selection)
+		{
+		case LS_UNIFORM:
+			m_landmarks = features->copy_subset(
+			    sample_uniform(num_vectors, m_effective_rank));
+			break;
+		case LS_LEVERAGE:
+			m_landmarks = features->copy_subset(sample_leverage(features));
+			break;
+		case LS_KMEANS:
+		{
+			auto dense =
+			    std::dynamic_pointer_cast<DenseFeatures<float64_t>>(features);
+			require(
+			    dense, "k-means landmarks require DenseFeatures<float64_t>, "
+			           "got {}",
+			    features->get_name());
+
+			auto kmeans = std::make_shared<KMeans>(
+			    m_effective_rank, std::make_shared<EuclideanDistance>(), true);
+			random::seed(kmeans, m_prng);
+			kmeans->train(dense);
+			m_landmarks = std::make_shared<DenseFeatures<float64_t>>(
+			    kmeans->get_cluster_centers());
+			break;
+		}
+		}
+		fit_nystrom(m_effective_rank);
+		break;
+	}
+
+	m_kernel->cleanup();
+	io::info(
+	    "Approximated kernel with rank {} using {} landmarks",
+	    m_projection.num_cols, m_projection.num_rows);
+
+	m_fitted.store(true);
+}
+
+void LowRankKernelMap::fit_incomplete_cholesky(
+    const std::shared_ptr<Features>& features)
+{
+	m_kernel->init(features, features);
+
+	index_t num_vectors = features->get_num_vectors();
+	SGVector<float64_t> residual = m_kernel->get_kernel_diagonal();
+	SGMatrix<float64_t> factor(num_vectors, m_effective_rank);
+	SGVector<index_t> all_idx(num_vectors);
+	all_idx.range_fill();
+
+	Map<MatrixXd> G(factor.matrix, factor.num_rows, factor.num_cols);
+	Map<VectorXd> d(residual.vector, residual.vlen);
+
+	std::vector<index_t> pivots;
+	for (index_t k = 0; k < m_effective_rank; k++)
+	{
+		index_t pivot;
+		if (d.maxCoeff(&pivot) <= m_tolerance)
+			break;
+
+		SGMatrix<float64_t> column(num_vectors, 1);
+		m_kernel->compute_block(all_idx, SGVector<index_t>({pivot}), column);
+
+		Map<VectorXd> col(column.matrix, num_vectors);
+		col -= G.leftCols(k) * G.row(pivot).head(k).transpose();
+		col /= std::sqrt(d[pivot]);
+		G.col(k) = col;
+
+		d -= col.cwiseAbs2();
+		pivots.push_back(pivot);
+		for (auto p : pivots)
+			d[p] = 0;
+	}
+
+	index_t rank = pivots.size();
+	require(rank > 0, "Kernel matrix is numerically zero");
+	SG_DEBUG("Incomplete Cholesky stopped at rank {}", rank)
+
+	// the factor at the pivots is lower triangular, the map of a vector is
+	// the solution of G_L phi = k_L
+	MatrixXd G_L(rank, rank);
+	for (index_t i = 0; i < rank; i++)
+		G_L.row(i) = G.row(pivots[i]).head(rank);
+
+	MatrixXd G_L_inv = G_L.triangularView<Lower>().solve(
+	    MatrixXd::Identity(rank, rank));
+	m_projection = SGMatrix<float64_t>(rank, rank);
+	Map<MatrixXd>(m_projection.matrix, rank, rank) = G_L_inv.transpose();
+
+	SGVector<index_t> landmark_idx(rank);
+	std::copy(pivots.begin(), pivots.end(), landmark_idx.begin());
+	m_landmarks = features->copy_subset(landmark_idx);
+}
+
+void LowRankKernelMap::fit_nystrom(index_t rank)
+{
+	m_kernel->init(m_landmarks, m_landmarks);
+	m_projection = nystrom_projection(m_kernel->get_kernel_matrix(), rank);
+}
+
+SGMatrix<float64_t> LowRankKernelMap::nystrom_projection(
+    SGMatrix<float64_t> kernel_matrix, index_t rank)
+{
+	Map<MatrixXd> K(
+	    kernel_matrix.matrix, kernel_matrix.num_rows, kernel_matrix.num_cols);
+	SelfAdjointEigenSolver<MatrixXd> solver(K);
+	const VectorXd& eigenvalues = solver.eigenvalues();
+	const MatrixXd& eigenvectors = solver.eigenvectors();
+
+	// eigenvalues are in increasing order
+	index_t num_landmarks = eigenvalues.size();
+	float64_t threshold = eigenvalues[num_landmarks - 1] * num_landmarks *
+	                      std::numeric_limits<float64_t>::epsilon();
+	index_t kept = 0;
+	while (kept < Math::min(rank, num_landmarks) &&
+	       eigenvalues[num_landmarks - kept - 1] > threshold)
+		kept++;
+	require(kept > 0, "Kernel matrix of the landmarks is numerically zero");
+
+	SGMatrix<float64_t> projection(num_landmarks, kept);
+	Map<MatrixXd> W(projection.matrix, num_landmarks, kept);
+	for (index_t i = 0; i < kept; i++)
+	{
+		index_t idx = num_landmarks - i - 1;
+		W.col(i) = eigenvectors.col(idx) / std::sqrt(eigenvalues[idx]);
+	}
+
+	return projection;
+}
+
+SGVector<index_t>
+LowRankKernelMap::sample_uniform(index_t num_vectors, index_t num_landmarks)
+{
+	SGVector<index_t> perm(num_vectors);
+	perm.range_fill();
+	random::shuffle(perm, m_prng);
+
+	SGVector<index_t> idx(num_landmarks);
+	std::copy(perm.begin(), perm.begin() + num_landmarks, idx.begin());
+	std::sort(idx.begin(), idx.end());
+	return idx;
+}
+
+SGVector<index_t>
+LowRankKernelMap::sample_leverage(const std::shared_ptr<Features>& features)
+{
+	index_t num_vectors = features->get_num_vectors();
+
+	// uniform Nystrom sketch of twice the target rank
+	index_t rank = m_effective_rank;
+	index_t sketch_rank = Math::min(2 * rank, num_vectors);
+	m_landmarks =
+	    features->copy_subset(sample_uniform(num_vectors, sketch_rank));
+	fit_nystrom(sketch_rank);
+
+	m_kernel->init(m_landmarks, features);
+	SGMatrix<float64_t> sketch = apply_projection(m_projection);
+
+	// rank-k leverage scores are the squared row norms of the top k left
+	// singular vectors of the sketched feature matrix
+	Map<MatrixXd> Phi(sketch.matrix, sketch.num_rows, sketch.num_cols);
+	SelfAdjointEigenSolver<MatrixXd> solver(Phi * Phi.transpose());
+	index_t dim = sketch.num_rows;
+	index_t kept = Math::min(rank, dim);
+	MatrixXd V(dim, kept);
+	for (index_t i = 0; i < kept; i++)
+	{
+		index_t idx = dim - i - 1;
+		float64_t eigenvalue = solver.eigenvalues()[idx];
+		V.col(i) = eigenvalue > 0
+		               ? VectorXd(solver.eigenvectors().col(idx) /
+		                          std::sqrt(eigenvalue))
+		               : VectorXd::Zero(dim);
+	}
+	VectorXd scores = (V.transpose() * Phi).colwise().squaredNorm();
+
+	// weighted sampling without replacement (Efraimidis & Spirakis), keeping
+	// the largest keys log(u)/w
+	UniformRealDistribution<float64_t> uniform(0.0, 1.0);
+	std::vector<std::pair<float64_t, index_t>> keys(num_vectors);
+	for (index_t i = 0; i < num_vectors; i++)
+	{
+		float64_t key = scores[i] > 0
+		                    ? std::log(uniform(m_prng)) / scores[i]
+		                    : -std::numeric_limits<float64_t>::infinity();
+		keys[i] = std::make_pair(key, i);
+	}
+	std::partial_sort(
+	    keys.begin(), keys.begin() + rank, keys.end(),
+	    [](const auto& a, const auto& b) { return a.first > b.first; });
+
+	SGVector<index_t> idx(rank);
+	for (index_t i = 0; i < rank; i++)
+		idx[i] = keys[i].second;
+	std::sort(idx.begin(), idx.end());
+	return idx;
+}
+
+SGMatrix<float64_t>
+LowRankKernelMap::apply_projection(const SGMatrix<float64_t>& projection)
+{
+	index_t num_landmarks = m_kernel->get_num_vec_lhs();
+	index_t num_vectors = m_kernel->get_num_vec_rhs();
+	require(
+	    num_landmarks == projection.num_rows,
+	    "Number of landmarks ({}) does not match the map ({}x{})",
+	    num_landmarks, projection.num_rows, projection.num_cols);
+
+	SGVector<index_t> landmark_idx(num_landmarks);
+	landmark_idx.range_fill();
+
+	SGMatrix<float64_t> result(projection.num_cols, num_vectors);
+	for (index_t begin = 0; begin < num_vectors; begin += LOWRANK_BLOCK_SIZE)
+	{
+		index_t len = Math::min(LOWRANK_BLOCK_SIZE, num_vectors - begin);
+		SGVector<index_t> idx(len);
+		idx.range_fill(begin);
+
+		SGMatrix<float64_t> kernel_block(num_landmarks, len);
+		m_kernel->compute_block(landmark_idx, idx, kernel_block);
+
+		SGMatrix<float64_t> result_block(
+		    result.get_column_vector(begin), result.num_rows, len, false);
+		linalg::matrix_prod(projection, kernel_block, result_block, true);
+	}
+
+	return result;
+}
+
+std::shared_ptr<Features>
+LowRankKernelMap::transform(std::shared_ptr<Features> features, bool inplace)
+{
+	assert_fitted();
+	require(features, "No features provided");
+
+	m_kernel->init(m_landmarks, features);
+	auto mapped = apply_projection(m_projection);
+	m_kernel->cleanup();
+
+	return std::make_shared<DenseFeatures<float64_t>>(mapped);
+}
+
+EFeatureClass LowRankKernelMap::get_feature_class()
+{
+	return C_ANY;
+}
+
+EFeatureType LowRankKernelMap::get_feature_type()
+{
+	return F_ANY;
+}
@@ -0,0 +1,222 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#ifndef LOWRANKKERNELMAP_H__
+#define LOWRANKKERNELMAP_H__
+
+#include <shogun/lib/config.h>
+
+#include <shogun/features/Features.h>
+#include <shogun/kernel/Kernel.h>
+#include <shogun/lib/common.h>
+#include <shogun/mathematics/RandomMixin.h>
+#include <shogun/preprocessor/Preprocessor.h>
+
+namespace shogun
+{
+
+/** method used to build the low-rank approximation */
+enum ELowRankMethod
+{
+	/** pivoted incomplete Cholesky decomposition */
+	LRM_INCOMPLETE_CHOLESKY = 0,
+	/** Nyström approximation from a set of landmarks */
+	LRM_NYSTROM = 1
+};
+
+/** how the landmarks of the Nyström approximation are chosen */
+enum ELandmarkSelection
+{
+	/** uniformly sampled training vectors */
+	LS_UNIFORM = 0,
+	/** training vectors sampled proportional to their (approximate)
+	 * statistical leverage scores */
+	LS_LEVERAGE = 1,
+	/** k-means cluster centers of the training vectors */
+	LS_KMEANS = 2
+};
+
+/** @brief Preprocessor LowRankKernelMap computes an explicit, low-rank feature
+ * map \f$\phi\f$ of an arbitrary kernel, such that
+ * \f$k({\bf x},{\bf x'})\approx\phi({\bf x})^\top\phi({\bf x'})\f$.
+ *
+ * The map is of the form \f$\phi({\bf x})=W^\top k_L({\bf x})\f$, where
+ * \f$k_L({\bf x})\f$ are the kernel values between \f${\bf x}\f$ and a set of
+ * landmarks L. It is fitted with either
+ *
+ * - pivoted incomplete Cholesky decomposition of the kernel matrix, where the
+ *   landmarks are the pivots and \f$W=G_L^{-\top}\f$ with \f$G_L\f$ the rows of
+ *   the Cholesky factor at the pivots. The decomposition stops at the target
+ *   rank or when the largest residual diagonal element falls below the
+ *   tolerance.
+ * - the Nyström method, where \f$W=U\Lambda^{-1/2}\f$ with \f$K_{LL}=U\Lambda
+ *   U^\top\f$, and the landmarks are sampled uniformly, by leverage scores, or
+ *   are k-means centers (DenseFeatures<float64_t> only).
+ *
+ * transform() returns the mapped vectors as DenseFeatures<float64_t>, so
+ * linear machines working on DotFeatures (e.g. LibLinear, SVMOcas or a linear
+ * GP) can be trained in time linear in the number of vectors instead of on
+ * the quadratic kernel matrix. Kernel values are computed in blocks via
+ * Kernel::compute_block(), the kernel matrix is never formed.
+ *
+ * Fine, S., & Scheinberg, K. (2001). Efficient SVM training using low-rank
+ * kernel representations. Journal of Machine Learning Research, 2, 243-264.
+ *
+ * Williams, C. K., & Seeger, M. (2001). Using the Nyström method to speed up
+ * kernel machines. Advances in neural information processing systems, 682-688.
+ */
+class LowRankKernelMap : public RandomMixin<Preprocessor>
+{
+public:
+	/** default constructor */
+	LowRankKernelMap();
+
+	/** constructor
+	 * @param kernel kernel to approximate
+	 * @param rank target rank of the approximation
+	 * @param method approximation method
+	 */
+	LowRankKernelMap(
+	    std::shared_ptr<Kernel> kernel, int32_t rank,
+	    ELowRankMethod method = LRM_INCOMPLETE_CHOLESKY);
+
+	~LowRankKernelMap() override;
+
+	void fit(std::shared_ptr<Features> features) override;
+
+	/** Apply the feature map to features. In-place mode is not supported.
+	 *	@param features features to transform, of the same type as the ones
+	 *	used in fit()
+	 *	@param inplace whether transform in place
+	 *	@return the mapped features as DenseFeatures<float64_t>
+	 */
+	std::shared_ptr<Features>
+	transform(std::shared_ptr<Features> features, bool inplace = true) override;
+
+	/** set how the landmarks of the Nyström method are chosen
+	 * @param selection landmark selection
+	 */
+	void set_landmark_selection(ELandmarkSelection selection)
+	{
+		m_landmark_selection = selection;
+	}
+
+	/** @return the landmarks the kernel is evaluated on */
+	std::shared_ptr<Features> get_landmarks() const
+	{
+		return m_landmarks;
+	}
+
+	/** @return matrix W of the map, one column per output dimension */
+	SGMatrix<float64_t> get_projection() const
+	{
+		return m_projection;
+	}
+
+	/** @return dimension of the mapped vectors, which might be smaller than
+	 * the target rank if the kernel matrix has lower rank */
+	int32_t get_dim_output() const
+	{
+		return m_projection.num_cols;
+	}
+
+	EFeatureClass get_feature_class() override;
+
+	EFeatureType get_feature_type() override;
+
+	/** @return object name */
+	const char* get_name() const override
+	{
+		return "LowRankKernelMap";
+	}
+
+	/** @return the type of preprocessor */
+	EPreprocessorType get_type() const override
+	{
+		return P_LOWRANKKERNELMAP;
+	}
+
+protected:
+	/** pivoted incomplete Cholesky decomposition of the kernel matrix of the
+	 * features the kernel is initialized with
+	 *
+	 * @param features training features
+	 */
+	void fit_incomplete_cholesky(const std::shared_ptr<Features>& features);
+
+	/** Nyström approximation from the landmarks in m_landmarks
+	 *
+	 * @param rank maximum rank of the approximation
+	 */
+	void fit_nystrom(index_t rank);
+
+	/** sample landmark indices
+	 *
+	 * @param num_vectors number of training vectors
+	 * @param num_landmarks number of landmarks to sample
+	 * @return sorted landmark indices
+	 */
+	SGVector<index_t>
+	sample_uniform(index_t num_vectors, index_t num_landmarks);
+
+	/** sample landmark indices proportional to approximate rank-k leverage
+	 * scores, which are computed from a uniform Nyström sketch of twice the
+	 * target rank
+	 *
+	 * @param features training features
+	 * @return sorted landmark indices
+	 */
+	SGVector<index_t>
+	sample_leverage(const std::shared_ptr<Features>& features);
+
+	/** compute \f$W^\top K_{L,X}\f$ for the vectors the kernel rhs is
+	 * initialized with, in blocks of vectors
+	 *
+	 * @param projection W
+	 * @return mapped vectors, one per column
+	 */
+	SGMatrix<float64_t> apply_projection(const SGMatrix<float64_t>& projection);
+
+	/** Nyström map \f$U\Lambda^{-1/2}\f$ of a landmark kernel matrix,
+	 * dropping numerically zero eigenvalues
+	 *
+	 * @param kernel_matrix kernel matrix of the landmarks
+	 * @param rank maximum number of eigenvectors to keep
+	 * @return the map, one column per kept eigenvector
+	 */
+	static SGMatrix<float64_t>
+	nystrom_projection(SGMatrix<float64_t> kernel_matrix, index_t rank);
+
+private:
+	void init();
+
+protected:
+	/** kernel to approximate */
+	std::shared_ptr<Kernel> m_kernel;
+
+	/** target rank */
+	int32_t m_rank;
+
+	/** rank used by the last fit, the target rank bounded by the number of
+	 * training vectors */
+	int32_t m_effective_rank;
+
+	/** approximation method */
+	ELowRankMethod m_method;
+
+	/** landmark selection of the Nyström method */
+	ELandmarkSelection m_landmark_selection;
+
+	/** incomplete Cholesky stops when no residual diagonal element of the
+	 * kernel matrix is larger than this */
+	float64_t m_tolerance;
+
+	/** landmarks */
+	std::shared_ptr<Features> m_landmarks;
+
+	/** map W, landmarks x output dimensions */
+	SGMatrix<float64_t> m_projection;
+};
+}
+#endif
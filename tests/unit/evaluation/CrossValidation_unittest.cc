@@ -13,6 +13,8 @@
 #include <shogun/evaluation/MeanSquaredError.h>
 
 #include <shogun/kernel/GaussianKernel.h>
+#include <shogun/kernel/LinearKernel.h>
+#include <shogun/kernel/normalizer/AvgDiagKernelNormalizer.h>
 #include <shogun/distance/EuclideanDistance.h>
 
 #include <shogun/classifier/svm/LibSVM.h>
@@ -92,6 +94,16 @@ protected:
 		return result;
 	}
 
+	auto test_kernel_cache()
+	{
+		init();
+		this->cv->put("seed", 1);
+		this->cv->set_kernel_cache_size(1);
+		env()->set_num_threads(4);
+		auto result = cv->evaluate()->get<float64_t>("mean");
+		return result;
+	}
+
 	auto test_multi_thread()
 	{
 		init();
@@ -192,3 +204,46 @@ TYPED_TEST(CrossValidationTests, single_multi_same_result)
 
 	EXPECT_NEAR(single, multi, 1e-7);
 }
+
+TYPED_TEST(CrossValidationTests, kernel_cache_same_result)
+{
+	auto uncached = this->test_single_thread();
+	auto cached = this->test_kernel_cache();
+
+	EXPECT_NEAR(uncached, cached, 1e-7);
+}
+
+class CrossValidationLibSVMTest : public CrossValidationTests<LibSVM>
+{
+};
+
+TEST_F(CrossValidationLibSVMTest, warm_start)
+{
+	auto cold = test_single_thread();
+
+	init();
+	cv->put("seed", 1);
+	cv->set_kernel_cache_size(1);
+	cv->set_warm_start(true);
+	auto warm = cv->evaluate()->get<float64_t>("mean");
+
+	// both solutions are optimal up to the solver's epsilon, which does not
+	// change any prediction
+	EXPECT_NEAR(cold, warm, 1e-7);
+}
+
+TEST_F(CrossValidationLibSVMTest, kernel_cache_fold_dependent_normalizer)
+{
+	auto evaluate = [this](int32_t cache_size) {
+		init();
+		// the average diagonal differs between the folds
+		auto kernel = std::make_shared<LinearKernel>();
+		kernel->set_normalizer(std::make_shared<AvgDiagKernelNormalizer>());
+		machine->set_kernel(kernel);
+		cv->put("seed", 1);
+		cv->set_kernel_cache_size(cache_size);
+		return cv->evaluate()->get<float64_t>("mean");
+	};
+
+	EXPECT_NEAR(evaluate(0), evaluate(1), 1e-7);
+}
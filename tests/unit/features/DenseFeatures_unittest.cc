@@ -16,6 +16,8 @@
 #include <shogun/lib/View.h>
 #include <shogun/util/zip_iterator.h>
 
+#include <atomic>
+#include <cstdio>
 #include <random>
 
 namespace shogun
@@ -34,6 +36,32 @@ public:
 	}
 };
 
+/** features computed on the fly, counting the computations */
+class ComputedDenseFeaturesMock : public DenseFeatures<float64_t>
+{
+public:
+	ComputedDenseFeaturesMock(int32_t cache_size, int32_t num_feat, int32_t num_vec)
+		: DenseFeatures<float64_t>(cache_size)
+	{
+		set_num_features(num_feat);
+		set_num_vectors(num_vec);
+	}
+
+	mutable std::atomic<int32_t> num_computed{0};
+
+protected:
+	float64_t* compute_feature_vector(int32_t num, int32_t& len,
+			float64_t* target) const override
+	{
+		num_computed++;
+		len=num_features;
+		float64_t* vec=target ? target : SG_MALLOC(float64_t, len);
+		for (int32_t i=0; i<len; i++)
+			vec[i]=num*len+i;
+		return vec;
+	}
+};
+
 }
 
 using namespace shogun;
@@ -332,4 +360,167 @@ TEST(DenseFeaturesTest, const_iterator)
         for (const auto& [test, truth]: zip_iterator(iter, tmp))
             EXPECT_EQ(test, truth);
     }
-}
\ No newline at end of file
+}
+
+TEST(DenseFeaturesTest, save_load_mapped)
+{
+	const char* fname = "DenseFeaturesTest_mapped.bin";
+	SGVector<float64_t> vals(20);
+	vals.range_fill();
+	auto mat = SGMatrix(vals, 5, 4);
+	auto feat = std::make_shared<DenseFeatures<float64_t>>(mat);
+	SGVector<index_t> subset{3, 1, 1};
+	feat->add_subset(subset);
+	feat->save_mapped(fname);
+
+	auto loaded = std::make_shared<DenseFeatures<float64_t>>();
+	loaded->load_mapped(fname);
+	EXPECT_TRUE(loaded->is_memory_mapped());
+	ASSERT_EQ(loaded->get_num_features(), mat.num_rows);
+	ASSERT_EQ(loaded->get_num_vectors(), subset.vlen);
+	auto loaded_mat = loaded->get_feature_matrix();
+	for (auto j : range(subset.vlen))
+	{
+		for (auto i : range(mat.num_rows))
+			EXPECT_EQ(loaded_mat(i, j), mat(i, subset[j]));
+	}
+
+	// modifications stay in memory
+	loaded_mat(0, 0) = -1;
+	auto other = std::make_shared<DenseFeatures<float64_t>>();
+	other->load_mapped(fname);
+	EXPECT_EQ(other->get_feature_matrix()(0, 0), mat(0, subset[0]));
+
+	// views share the mapping
+	auto loaded_view = view(other, SGVector<index_t>{2});
+	EXPECT_TRUE(loaded_view->is_memory_mapped());
+	EXPECT_EQ(loaded_view->get_feature_matrix()(4, 0), mat(4, subset[2]));
+
+	auto int_features = std::make_shared<DenseFeatures<int32_t>>();
+	EXPECT_THROW(int_features->load_mapped(fname), ShogunException);
+	remove(fname);
+}
+
+TEST(DenseFeaturesTest, compress)
+{
+	SGVector<float64_t> vals(60);
+	vals.range_fill();
+	auto mat = SGMatrix(vals, 3, 20);
+	auto feat = std::make_shared<DenseFeatures<float64_t>>(mat.clone());
+	feat->add_subset(SGVector<index_t>{5, 19, 0});
+
+#ifdef USE_GZIP
+	feat->compress(GZIP, 4);
+#else
+	feat->compress(UNCOMPRESSED, 4);
+#endif
+	EXPECT_TRUE(feat->is_compressed());
+	ASSERT_EQ(feat->get_num_vectors(), 3);
+	ASSERT_EQ(feat->get_num_features(), 3);
+
+	auto vec = feat->get_feature_vector(1);
+	for (auto i : range(mat.num_rows))
+		EXPECT_EQ(vec[i], mat(i, 19));
+
+	auto copy = feat->get_feature_matrix();
+	auto subset_copy = feat->copy_subset(SGVector<index_t>{2})
+		->as<DenseFeatures<float64_t>>();
+	auto duplicate = feat->duplicate()->as<DenseFeatures<float64_t>>();
+	for (auto i : range(mat.num_rows))
+	{
+		EXPECT_EQ(copy(i, 0), mat(i, 5));
+		EXPECT_EQ(subset_copy->get_feature_matrix()(i, 0), mat(i, 0));
+		EXPECT_EQ(duplicate->get_feature_vector(2)[i], mat(i, 0));
+	}
+
+	int32_t num_feat, num_vec;
+	EXPECT_THROW(feat->get_feature_matrix(num_feat, num_vec), ShogunException);
+
+	auto clone = feat->clone()->as<DenseFeatures<float64_t>>();
+	EXPECT_TRUE(clone->is_compressed());
+	ASSERT_EQ(clone->get_num_vectors(), 3);
+	EXPECT_TRUE(clone->get_feature_matrix().equals(copy));
+
+	feat->remove_subset();
+	feat->decompress();
+	EXPECT_FALSE(feat->is_compressed());
+	EXPECT_TRUE(feat->get_feature_matrix().equals(mat));
+}
+
+TEST(DenseFeaturesTest, feature_cache)
+{
+	const int32_t num_feat=4;
+	const int32_t num_vec=50;
+	for (int32_t cache_size : {0, 1})
+	{
+		auto feat=std::make_shared<ComputedDenseFeaturesMock>(
+			cache_size, num_feat, num_vec);
+
+		for (auto pass : range(2))
+		{
+			std::vector<int32_t> correct(num_vec, 0);
+			// static schedule, every thread gets the same vectors in both
+			// passes
+			#pragma omp parallel for schedule(static)
+			for (int32_t j=0; j<num_vec; j++)
+			{
+				auto vec=feat->get_feature_vector(j);
+				correct[j]=vec.vlen==num_feat && vec[num_feat-1]==j*num_feat+num_feat-1;
+			}
+			for (auto c : correct)
+				EXPECT_TRUE(c);
+		}
+
+		// threads only see their own vectors, which they compute once, so
+		// every lookup of the second pass is a hit
+		EXPECT_EQ(feat->num_computed, cache_size ? num_vec : 2*num_vec);
+
+		// the calling thread computed vector 0 as thread 0 of the team
+		int32_t num_computed=feat->num_computed;
+		auto vec=feat->get_feature_vector(0);
+		vec=feat->get_feature_vector(0);
+		EXPECT_EQ(feat->num_computed, num_computed+(cache_size ? 0 : 2));
+	}
+}
+
+TEST(DenseFeaturesTest, gather_feature_matrix)
+{
+	SGVector<float64_t> vals(40);
+	vals.range_fill();
+	auto mat = SGMatrix(vals, 4, 10);
+	auto feat = std::make_shared<DenseFeatures<float64_t>>(mat);
+
+	SGMatrix<float64_t> scratch;
+	EXPECT_EQ(feat->gather_feature_matrix(scratch).matrix, mat.matrix);
+	EXPECT_EQ(scratch.matrix, nullptr);
+
+	feat->add_subset(SGVector<index_t>{9, 7, 5, 3, 1});
+	feat->add_subset_in_place(SGVector<index_t>{4, 0, 2});
+	auto gathered = feat->gather_feature_matrix(scratch);
+	ASSERT_EQ(gathered.num_rows, 4);
+	ASSERT_EQ(gathered.num_cols, 3);
+	EXPECT_EQ(gathered.matrix, scratch.matrix);
+
+	const index_t expected_idx[] = {1, 9, 5};
+	for (auto j : range(3))
+	{
+		for (auto i : range(4))
+			EXPECT_EQ(gathered(i, j), mat(i, expected_idx[j]));
+	}
+
+	// in place subsets replace the active one
+	feat->remove_subset();
+	EXPECT_EQ(feat->get_num_vectors(), 10);
+
+	// a smaller gather reuses the scratch memory
+	feat->add_subset(SGVector<index_t>{2, 8});
+	auto* scratch_memory = scratch.matrix;
+	gathered = feat->gather_feature_matrix(scratch);
+	EXPECT_EQ(gathered.matrix, scratch_memory);
+	ASSERT_EQ(gathered.num_cols, 2);
+	for (auto i : range(4))
+	{
+		EXPECT_EQ(gathered(i, 0), mat(i, 2));
+		EXPECT_EQ(gathered(i, 1), mat(i, 8));
+	}
+}
@@ -12,6 +12,7 @@
 #include <shogun/io/stream/FileOutputStream.h>
 #include <shogun/lib/SGMatrix.h>
 #include <shogun/features/SparseFeatures.h>
+#include <cstdio>
 #include <string>
 
 using namespace shogun;
@@ -412,3 +413,44 @@ TEST(SparseFeaturesTest,subset_get_full_feature_vector_smaller)
 
 
 }
+
+TEST(SparseFeaturesTest,save_load_mapped)
+{
+	const char* fname="SparseFeaturesTest_mapped.bin";
+	SGMatrix<int32_t> data(3, 4);
+	data.zero();
+	data(0, 0)=1;
+	data(2, 0)=2;
+	data(1, 2)=3;
+	data(0, 3)=4;
+	data(1, 3)=5;
+	data(2, 3)=6;
+
+	auto features=std::make_shared<SparseFeatures<int32_t>>(data);
+	SGVector<index_t> subset_idx{3, 1, 0};
+	features->add_subset(subset_idx);
+	features->save_mapped(fname);
+
+	auto loaded=std::make_shared<SparseFeatures<int32_t>>();
+	loaded->load_mapped(fname);
+	EXPECT_TRUE(loaded->is_memory_mapped());
+	EXPECT_EQ(loaded->get_num_features(), data.num_rows);
+	ASSERT_EQ(loaded->get_num_vectors(), subset_idx.vlen);
+	EXPECT_EQ(loaded->get_sparse_feature_vector(1).num_feat_entries, 0);
+
+	SGMatrix<int32_t> full=loaded->get_full_feature_matrix();
+	for (index_t i=0; i<subset_idx.vlen; i++)
+	{
+		for (index_t j=0; j<data.num_rows; j++)
+			EXPECT_EQ(full(j, i), data(j, subset_idx[i]));
+	}
+
+	SGVector<index_t> view_idx{2};
+	loaded->add_subset(view_idx);
+	EXPECT_EQ(loaded->get_sparse_feature_vector(0).features[1].entry, data(2, 0));
+	loaded->remove_subset();
+
+	loaded->free_sparse_feature_matrix();
+	EXPECT_FALSE(loaded->is_memory_mapped());
+	remove(fname);
+}
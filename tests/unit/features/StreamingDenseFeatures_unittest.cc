@@ -137,3 +137,124 @@ TEST(StreamingDenseFeaturesTest, reset_stream)
 
 	feats->end_parser();
 }
+
+TEST(StreamingDenseFeaturesTest, parse_threads)
+{
+	index_t n=1000;
+	index_t dim=3;
+	char fname[] = "StreamingDenseFeatures_parse_threads.XXXXXX";
+	generate_temp_filename(fname);
+
+	SGMatrix<float64_t> data(dim,n);
+	for (index_t i=0; i<dim*n; ++i)
+		data.matrix[i] = i;
+
+	auto orig_feats=std::make_shared<DenseFeatures<float64_t>>(data);
+	auto saved_features = std::make_shared<CSVFile>(fname, 'w');
+	orig_feats->save(saved_features);
+	saved_features->close();
+
+	for (bool ordered : {true, false})
+	{
+		auto input = std::make_shared<StreamingAsciiFile>(fname);
+		input->set_delimiter(',');
+		auto feats
+			= std::make_shared<StreamingDenseFeatures<float64_t>>(input, false, 64);
+		feats->set_num_parse_threads(4, ordered);
+
+		SGVector<bool> seen(n);
+		seen.zero();
+		index_t i = 0;
+		feats->start_parser();
+		while (feats->get_next_example())
+		{
+			SGVector<float64_t> example = feats->get_vector();
+			ASSERT_EQ(dim, example.vlen);
+
+			index_t idx = example[0] / dim;
+			ASSERT_GE(idx, 0);
+			ASSERT_LT(idx, n);
+			if (ordered)
+				EXPECT_EQ(idx, i);
+			EXPECT_FALSE(seen[idx]);
+			seen[idx] = true;
+
+			for (index_t j = 0; j < dim; j++)
+				EXPECT_EQ(data(j, idx), example[j]);
+
+			feats->release_example();
+			i++;
+		}
+		feats->end_parser();
+		EXPECT_EQ(i, n);
+	}
+
+	std::remove(fname);
+}
+
+TEST(StreamingDenseFeaturesTest, get_next_batch)
+{
+	int32_t seed = 17;
+	index_t n=20;
+	index_t dim=3;
+	index_t batch_size=7;
+
+	std::mt19937_64 prng(seed);
+	NormalDistribution<float64_t> normal_dist;
+
+	SGMatrix<float64_t> data(dim,n);
+	for (index_t i=0; i<dim*n; ++i)
+		data.matrix[i]=normal_dist(prng);
+
+	SGVector<float32_t> w(dim);
+	for (index_t j=0; j<dim; j++)
+		w[j]=normal_dist(prng);
+	float32_t b=0.5;
+
+	auto orig_feats=std::make_shared<DenseFeatures<float64_t>>(data);
+	auto feats=std::make_shared<StreamingDenseFeatures<float64_t>>(orig_feats);
+	ASSERT_TRUE(feats->has_property(FP_STREAMING_BATCH));
+
+	SGVector<float32_t> sum(dim);
+	sum.zero();
+	SGVector<float32_t> expected_sum(dim);
+	expected_sum.zero();
+
+	index_t i=0;
+	feats->start_parser();
+	while (index_t num=feats->get_next_batch(batch_size))
+	{
+		EXPECT_EQ(num, Math::min(batch_size, n-i));
+		EXPECT_EQ(feats->get_batch_size(), num);
+
+		SGMatrix<float64_t> batch=feats->get_batch();
+		ASSERT_EQ(batch.num_rows, dim);
+		ASSERT_EQ(batch.num_cols, num);
+
+		SGVector<float32_t> outputs=feats->dense_dot_batch(w, b);
+		ASSERT_EQ(outputs.vlen, num);
+
+		SGVector<float32_t> alphas(num);
+		for (index_t k=0; k<num; k++)
+		{
+			float32_t expected=b;
+			for (index_t j=0; j<dim; j++)
+			{
+				EXPECT_DOUBLE_EQ(batch(j, k), data(j, i+k));
+				expected+=w[j]*data(j, i+k);
+			}
+			EXPECT_NEAR(outputs[k], expected, 1e-5);
+
+			alphas[k]=k+1;
+			for (index_t j=0; j<dim; j++)
+				expected_sum[j]+=alphas[k]*data(j, i+k);
+		}
+		feats->add_to_dense_vec_batch(alphas, sum);
+		i+=num;
+	}
+	feats->end_parser();
+
+	EXPECT_EQ(i, n);
+	for (index_t j=0; j<dim; j++)
+		EXPECT_NEAR(sum[j], expected_sum[j], 1e-4);
+}
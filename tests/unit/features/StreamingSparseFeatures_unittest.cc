@@ -82,3 +82,86 @@ TEST(StreamingSparseFeaturesTest, parse_file)
 
   std::remove(fname);
 }
+
+TEST(StreamingSparseFeaturesTest, get_next_batch)
+{
+  char fname[] = "StreamingSparseFeatures_get_next_batch.XXXXXX";
+  generate_temp_filename(fname);
+
+  int32_t num_vec=10;
+  int32_t num_feat=8;
+  int32_t batch_size=4;
+
+  SGSparseVector<float64_t>* data=SG_MALLOC(SGSparseVector<float64_t>, num_vec);
+  float64_t* labels=SG_MALLOC(float64_t, num_vec);
+  for (int32_t i=0; i<num_vec; i++)
+  {
+    data[i]=SGSparseVector<float64_t>(i%3+1);
+    labels[i]=i%2 ? 1 : -1;
+    for (int32_t j=0; j<data[i].num_feat_entries; j++)
+    {
+      data[i].features[j].feat_index=(i+3*j)%num_feat;
+      data[i].features[j].entry=0.5*(i+j+1);
+    }
+    data[i].sort_features();
+  }
+  auto fout = std::make_shared<LibSVMFile>(fname, 'w');
+  fout->set_sparse_matrix(data, num_feat, num_vec, labels);
+
+  SGVector<float32_t> w(num_feat);
+  for (int32_t j=0; j<num_feat; j++)
+    w[j]=j-2.5;
+  float32_t b=1;
+
+  auto file = std::make_shared<StreamingAsciiFile>(fname);
+  auto stream_features =
+    std::make_shared<StreamingSparseFeatures<float64_t>>(file, true, 8);
+  ASSERT_TRUE(stream_features->has_property(FP_STREAMING_BATCH));
+
+  SGVector<float32_t> sum(num_feat);
+  sum.zero();
+  SGVector<float32_t> expected_sum(num_feat);
+  expected_sum.zero();
+
+  stream_features->start_parser();
+  index_t i = 0;
+  while (index_t num = stream_features->get_next_batch(batch_size))
+  {
+    EXPECT_EQ(num, Math::min(batch_size, num_vec-i));
+    EXPECT_EQ(stream_features->get_batch_size(), num);
+
+    SGVector<float64_t> batch_labels = stream_features->get_batch_labels();
+    SGVector<float32_t> outputs = stream_features->dense_dot_batch(w, b);
+    SGVector<float32_t> alphas(num);
+    for (index_t k = 0; k < num; k++)
+    {
+      EXPECT_EQ(batch_labels[k], labels[i+k]);
+
+      SGSparseVector<float64_t> v = stream_features->get_batch_vector(k);
+      ASSERT_EQ(data[i+k].num_feat_entries, v.num_feat_entries);
+
+      float32_t expected = b;
+      alphas[k] = k+1;
+      for (index_t j = 0; j < v.num_feat_entries; j++)
+      {
+        EXPECT_EQ(data[i+k].features[j].feat_index, v.features[j].feat_index);
+        EXPECT_DOUBLE_EQ(data[i+k].features[j].entry, v.features[j].entry);
+        expected += w[v.features[j].feat_index]*v.features[j].entry;
+        expected_sum[v.features[j].feat_index] += alphas[k]*v.features[j].entry;
+      }
+      EXPECT_NEAR(outputs[k], expected, 1e-5);
+    }
+    stream_features->add_to_dense_vec_batch(alphas, sum);
+    i += num;
+  }
+  stream_features->end_parser();
+
+  EXPECT_EQ(i, num_vec);
+  for (int32_t j = 0; j < num_feat; j++)
+    EXPECT_NEAR(sum[j], expected_sum[j], 1e-5);
+
+  SG_FREE(data);
+  SG_FREE(labels);
+
+  std::remove(fname);
+}
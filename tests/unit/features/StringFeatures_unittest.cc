@@ -91,3 +91,47 @@ TEST(StringFeaturesTest,equals)
 
 
 }
+
+TEST(StringFeaturesTest, compress)
+{
+	std::mt19937_64 prng(25);
+	std::vector<SGVector<char>> strings = generateRandomStringData(prng);
+	auto f=std::make_shared<StringFeatures<char>>(strings, ALPHANUM);
+
+#ifdef USE_GZIP
+	f->compress(GZIP, 3);
+#else
+	f->compress(UNCOMPRESSED, 3);
+#endif
+	EXPECT_TRUE(f->is_compressed());
+	EXPECT_THROW(f->get_string_list(), ShogunException);
+	ASSERT_EQ(f->get_num_vectors(), (index_t) strings.size());
+
+	for (index_t i=f->get_num_vectors()-1; i>=0; --i)
+	{
+		EXPECT_EQ(f->get_vector_length(i), strings[i].vlen);
+		SGVector<char> vec=f->get_feature_vector(i);
+		EXPECT_TRUE(vec.equals(strings[i]));
+		f->free_feature_vector(vec, i);
+	}
+
+	auto subset_copy=f->copy_subset(SGVector<index_t>{4})->as<StringFeatures<char>>();
+	EXPECT_TRUE(subset_copy->get_feature_vector(0).equals(strings[4]));
+
+	auto clone=f->clone()->as<StringFeatures<char>>();
+	EXPECT_TRUE(clone->is_compressed());
+	auto appended=std::make_shared<StringFeatures<char>>(ALPHANUM);
+	appended->append_features(f);
+	for (index_t i=0; i<f->get_num_vectors(); ++i)
+	{
+		EXPECT_TRUE(clone->get_feature_vector(i).equals(strings[i]));
+		EXPECT_TRUE(appended->get_feature_vector(i).equals(strings[i]));
+	}
+	EXPECT_THROW(f->obtain_by_sliding_window(2, 1), ShogunException);
+
+	f->decompress();
+	EXPECT_FALSE(f->is_compressed());
+	const auto& list=f->get_string_list();
+	for (index_t i=0; i<f->get_num_vectors(); ++i)
+		EXPECT_TRUE(list[i].equals(strings[i]));
+}
@@ -194,3 +194,43 @@ TEST(CSVFileTest, string_list_char)
 	SG_FREE(lines_to_read);
 	unlink("CSVFileTest_string_list_char_output.txt");
 }
+
+TEST(CSVFileTest, matrix_from_stream)
+{
+	// streams that cannot be mapped are read line by line
+	char text[]="1,2,3\n4,5\n";
+
+	for (bool transposed : {false, true})
+	{
+		FILE* stream=fmemopen(text, strlen(text), "r");
+		ASSERT_NE(stream, nullptr);
+
+		auto fin=std::make_shared<CSVFile>(stream);
+		fin->set_transpose(transposed);
+		SGMatrix<float64_t> data(true);
+		fin->get_matrix(data.matrix, data.num_rows, data.num_cols);
+
+		// lines are vectors, the missing token is zero
+		float64_t lines[2][3]={{1, 2, 3}, {4, 5, 0}};
+		SGMatrix<float64_t> expected=transposed ?
+			SGMatrix<float64_t>(2, 3) : SGMatrix<float64_t>(3, 2);
+		for (int32_t l=0; l<2; l++)
+		{
+			for (int32_t t=0; t<3; t++)
+			{
+				if (transposed)
+					expected(l, t)=lines[l][t];
+				else
+					expected(t, l)=lines[l][t];
+			}
+		}
+
+		ASSERT_EQ(data.num_rows, expected.num_rows);
+		ASSERT_EQ(data.num_cols, expected.num_cols);
+		for (int32_t i=0; i<expected.num_rows; i++)
+		{
+			for (int32_t j=0; j<expected.num_cols; j++)
+				EXPECT_EQ(data(i, j), expected(i, j));
+		}
+	}
+}
@@ -0,0 +1,173 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <shogun/base/ShogunEnv.h>
+#include <shogun/io/CSVFile.h>
+#include <shogun/io/LibSVMFile.h>
+#include <shogun/io/MappedTextReader.h>
+#include <shogun/lib/SGSparseVector.h>
+
+#include <cstdio>
+#include <string>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+using namespace shogun;
+
+namespace
+{
+	const char* FILENAME="MappedTextReaderTest_output.txt";
+
+	FILE* write_text(const std::string& text)
+	{
+		FILE* f=fopen(FILENAME, "w");
+		fputs(text.c_str(), f);
+		fclose(f);
+		return fopen(FILENAME, "r");
+	}
+}
+
+TEST(MappedTextReaderTest, split_at_lines)
+{
+	std::string text;
+	for (int32_t i=0; i<100; i++)
+		text+=std::to_string(i*i)+",1.5\n\n";
+	text+="last";
+
+	FILE* f=write_text(text);
+	MappedTextReader reader(f);
+	ASSERT_TRUE(reader.is_mapped());
+	EXPECT_EQ(MappedTextReader::count_lines(reader.begin(), reader.end()), 101);
+
+	reader.skip_lines(1);
+	for (int32_t num_chunks : {1, 3, 7, 1000})
+	{
+		auto chunks=reader.split(num_chunks);
+		ASSERT_GE(chunks.size(), 2);
+		ASSERT_LE(chunks.size(), num_chunks+1);
+		EXPECT_EQ(chunks.front(), reader.begin());
+		EXPECT_EQ(chunks.back(), reader.end());
+
+		index_t num_lines=0;
+		for (size_t c=0; c+1<chunks.size(); c++)
+		{
+			// chunks start at the beginning of a line
+			EXPECT_EQ(*(chunks[c]-1), '\n');
+			num_lines+=MappedTextReader::count_lines(chunks[c], chunks[c+1]);
+		}
+		EXPECT_EQ(num_lines, 100);
+	}
+
+	fclose(f);
+	unlink(FILENAME);
+}
+
+TEST(MappedTextReaderTest, tokens)
+{
+	FILE* f=write_text("1, 2.5,,-3\n7:0.25\n");
+	MappedTextReader reader(f);
+	ASSERT_TRUE(reader.is_mapped());
+
+	bool delimiters[256]={};
+	delimiters[(uint8_t) ',']=true;
+	delimiters[(uint8_t) ' ']=true;
+
+	const char* pos=reader.begin();
+	const char *line_begin, *line_end, *token_begin, *token_end;
+	ASSERT_TRUE(MappedTextReader::next_line(pos, reader.end(), line_begin, line_end));
+
+	const float64_t expected[]={1, 2.5, -3};
+	for (auto value : expected)
+	{
+		ASSERT_TRUE(MappedTextReader::next_token(line_begin, line_end,
+			delimiters, token_begin, token_end));
+		EXPECT_EQ(MappedTextReader::parse<float64_t>(token_begin, token_end), value);
+	}
+	EXPECT_FALSE(MappedTextReader::next_token(line_begin, line_end,
+		delimiters, token_begin, token_end));
+
+	ASSERT_TRUE(MappedTextReader::next_line(pos, reader.end(), line_begin, line_end));
+	EXPECT_EQ(MappedTextReader::parse<int64_t>(line_begin, line_begin+1), 7);
+	EXPECT_EQ(MappedTextReader::parse<float32_t>(line_begin+2, line_end), 0.25);
+	EXPECT_FALSE(MappedTextReader::next_line(pos, reader.end(), line_begin, line_end));
+
+	fclose(f);
+	unlink(FILENAME);
+}
+
+TEST(MappedTextReaderTest, csv_file_in_chunks)
+{
+	// large enough to be split into several chunks
+	const int32_t num_lines=100000;
+	const int32_t num_feat=4;
+	std::string text="a,b,c,d\n";
+	for (int32_t i=0; i<num_lines; i++)
+	{
+		for (int32_t j=0; j<num_feat; j++)
+		{
+			text+=std::to_string((i%1000)*0.5-j);
+			text+=j+1<num_feat ? "," : "\n";
+		}
+	}
+	fclose(write_text(text));
+
+	auto num_threads=env()->get_num_threads();
+	env()->set_num_threads(4);
+	auto fin=std::make_shared<CSVFile>(FILENAME, 'r');
+	fin->set_lines_to_skip(1);
+	float64_t* matrix;
+	int32_t num_feat_from_file, num_vec_from_file;
+	fin->get_matrix(matrix, num_feat_from_file, num_vec_from_file);
+	env()->set_num_threads(num_threads);
+
+	ASSERT_EQ(num_feat_from_file, num_feat);
+	ASSERT_EQ(num_vec_from_file, num_lines);
+	for (int32_t i=0; i<num_lines; i++)
+	{
+		for (int32_t j=0; j<num_feat; j++)
+			EXPECT_EQ(matrix[j+int64_t(i)*num_feat], (i%1000)*0.5-j);
+	}
+
+	SG_FREE(matrix);
+	unlink(FILENAME);
+}
+
+TEST(MappedTextReaderTest, libsvm_file_in_chunks)
+{
+	const int32_t num_lines=100000;
+	std::string text;
+	for (int32_t i=0; i<num_lines; i++)
+	{
+		text+=i%2 ? "1" : "-1";
+		text+=" "+std::to_string(i%5+1)+":"+std::to_string((i%1000)*0.25);
+		text+=" 7:1\n";
+	}
+	fclose(write_text(text));
+
+	auto num_threads=env()->get_num_threads();
+	env()->set_num_threads(4);
+	auto fin=std::make_shared<LibSVMFile>(FILENAME, 'r');
+	SGSparseVector<float64_t>* matrix;
+	float64_t* labels;
+	int32_t num_feat, num_vec;
+	fin->get_sparse_matrix(matrix, num_feat, num_vec, labels);
+	env()->set_num_threads(num_threads);
+
+	ASSERT_EQ(num_feat, 7);
+	ASSERT_EQ(num_vec, num_lines);
+	for (int32_t i=0; i<num_lines; i++)
+	{
+		EXPECT_EQ(labels[i], i%2 ? 1 : -1);
+		ASSERT_EQ(matrix[i].num_feat_entries, 2);
+		EXPECT_EQ(matrix[i].features[0].feat_index, i%5);
+		EXPECT_EQ(matrix[i].features[0].entry, (i%1000)*0.25);
+		EXPECT_EQ(matrix[i].features[1].feat_index, 6);
+		EXPECT_EQ(matrix[i].features[1].entry, 1);
+	}
+
+	SG_FREE(matrix);
+	SG_FREE(labels);
+	unlink(FILENAME);
+}
@@ -0,0 +1,65 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <shogun/io/streaming/ParseBuffer.h>
+
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace shogun;
+
+TEST(ParseBufferTest, producer_consumer)
+{
+	const int32_t num_examples=10000;
+	for (int32_t batch_size : {1, 7, 64})
+	{
+		ParseBuffer<float64_t> buffer(50, batch_size);
+		buffer.set_free_vectors_on_destruct(false);
+
+		std::thread producer([&buffer]() {
+			for (int32_t i=0; i<num_examples; i++)
+			{
+				Example<float64_t>* ex=buffer.get_free_example();
+				ASSERT_NE(ex, nullptr);
+				ex->fv=SG_MALLOC(float64_t, 1);
+				ex->fv[0]=i;
+				ex->length=1;
+				ex->label=-i;
+				buffer.commit_example();
+			}
+			buffer.finish();
+		});
+
+		int32_t num_read=0;
+		while (Example<float64_t>* ex=buffer.get_next_example())
+		{
+			EXPECT_EQ(ex->fv[0], num_read);
+			EXPECT_EQ(ex->label, -num_read);
+			buffer.finalize_example(true);
+			num_read++;
+		}
+		producer.join();
+		EXPECT_EQ(num_read, num_examples);
+	}
+}
+
+TEST(ParseBufferTest, close_wakes_up_producer)
+{
+	ParseBuffer<float64_t> buffer(4, 2);
+	buffer.set_free_vectors_on_destruct(false);
+
+	std::thread producer([&buffer]() {
+		Example<float64_t> ex;
+		ex.fv=NULL;
+		ex.length=0;
+		ex.label=0;
+		// the ring is full after 4 examples and nobody reads them
+		while (buffer.write_example(&ex));
+	});
+
+	buffer.close();
+	producer.join();
+	EXPECT_EQ(buffer.get_next_example(), nullptr);
+}
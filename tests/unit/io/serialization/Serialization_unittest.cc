@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <numeric>
 
+#include <shogun/base/range.h>
 #include <shogun/io/ShogunErrc.h>
 #include <shogun/io/serialization/BitserySerializer.h>
 #include <shogun/io/serialization/BitseryDeserializer.h>
@@ -9,8 +11,14 @@
 #include <shogun/io/serialization/JsonDeserializer.h>
 #include <shogun/io/serialization/JsonSerializer.h>
 
+#include <shogun/features/CombinedFeatures.h>
 #include <shogun/features/DenseFeatures.h>
+#include <shogun/features/StringFeatures.h>
+#include <shogun/classifier/Perceptron.h>
 #include <shogun/kernel/GaussianKernel.h>
+#include <shogun/labels/MulticlassLabels.h>
+#include <shogun/machine/LinearMulticlassMachine.h>
+#include <shogun/multiclass/MulticlassOneVsRestStrategy.h>
 
 using namespace shogun;
 using namespace shogun::io;
@@ -145,3 +153,196 @@ TYPED_TEST(SerializationTest, serialize)
 
 	ASSERT_TRUE(obj->equals(deser_obj));
 }
+
+TYPED_TEST(SerializationTest, serialize_large_arrays)
+{
+	SGMatrix<float64_t> data(37, 101);
+	std::iota(data.begin(), data.end(), 0.5);
+	auto df = std::make_shared<DenseFeatures<float64_t>>(data);
+	SGMatrix<int32_t> int_data(13, 7);
+	std::iota(int_data.begin(), int_data.end(), -20);
+	auto int_df = std::make_shared<DenseFeatures<int32_t>>(int_data);
+
+	for (const auto& obj: {shared_ptr<SGObject>(df), shared_ptr<SGObject>(int_df)})
+	{
+		auto serializer = std::make_shared<typename TypeParam::first_type>();
+		auto stream = std::make_shared<DummyOutputStream>();
+		serializer->attach(stream);
+		serializer->write(obj);
+
+		auto deserializer = std::make_shared<typename TypeParam::second_type>();
+		auto istream = std::make_shared<DummyInputStream>(stream->buffer());
+		deserializer->attach(istream);
+		auto deser_obj = deserializer->read_object();
+
+		ASSERT_TRUE(obj->equals(deser_obj));
+	}
+}
+
+TYPED_TEST(SerializationTest, serialize_compressed_features)
+{
+#ifdef USE_GZIP
+	const auto compression = GZIP;
+#else
+	const auto compression = UNCOMPRESSED;
+#endif
+	SGMatrix<float64_t> data(5, 11);
+	std::iota(data.begin(), data.end(), 0.5);
+	auto df = std::make_shared<DenseFeatures<float64_t>>(data.clone());
+	df->compress(compression, 4);
+	std::vector<SGVector<char>> strings{
+		{'A', 'C', 'G'}, {}, {'T', 'T'}, {'G', 'A', 'T', 'C', 'A'}};
+	auto sf = std::make_shared<StringFeatures<char>>(strings, DNA);
+	sf->compress(compression, 3);
+
+	for (const auto& obj: {shared_ptr<SGObject>(df), shared_ptr<SGObject>(sf)})
+	{
+		auto serializer = std::make_shared<typename TypeParam::first_type>();
+		auto stream = std::make_shared<DummyOutputStream>();
+		serializer->attach(stream);
+		serializer->write(obj);
+
+		auto deserializer = std::make_shared<typename TypeParam::second_type>();
+		auto istream = std::make_shared<DummyInputStream>(stream->buffer());
+		deserializer->attach(istream);
+		auto deser_obj = deserializer->read_object();
+		ASSERT_NE(deser_obj, nullptr);
+
+		// the features are written decompressed and stay compressed
+		if (auto deser_df = std::dynamic_pointer_cast<DenseFeatures<float64_t>>(deser_obj))
+		{
+			EXPECT_FALSE(deser_df->is_compressed());
+			EXPECT_TRUE(deser_df->get_feature_matrix().equals(data));
+			EXPECT_TRUE(df->is_compressed());
+			EXPECT_TRUE(df->get_feature_matrix().equals(data));
+		}
+		else
+		{
+			auto deser_sf = deser_obj->template as<StringFeatures<char>>();
+			ASSERT_EQ(deser_sf->get_num_vectors(), (index_t) strings.size());
+			EXPECT_TRUE(sf->is_compressed());
+			for (index_t i = 0; i < (index_t) strings.size(); ++i)
+			{
+				EXPECT_TRUE(deser_sf->get_feature_vector(i).equals(strings[i]));
+				EXPECT_TRUE(sf->get_feature_vector(i).equals(strings[i]));
+			}
+		}
+	}
+}
+
+#ifdef USE_GZIP
+TEST(BitserySerializationTest, compressed_arrays)
+{
+	// compressible and too small to be compressed
+	SGMatrix<float64_t> data(100, 50);
+	for (index_t i = 0; i < data.size(); ++i)
+		data[i] = i % 7;
+	SGMatrix<float64_t> small_data {{1.0, 2.0}, {3.0, 4.0}};
+	auto obj = std::make_shared<CombinedFeatures>();
+	obj->append_feature_obj(std::make_shared<DenseFeatures<float64_t>>(small_data));
+	obj->append_feature_obj(std::make_shared<DenseFeatures<float64_t>>(data));
+
+	auto write = [&obj](E_COMPRESSION_TYPE compression) {
+		auto serializer = std::make_shared<BitserySerializer>();
+		serializer->set_compression(compression, 9);
+		auto stream = std::make_shared<DummyOutputStream>();
+		serializer->attach(stream);
+		serializer->write(obj);
+		return stream->buffer();
+	};
+	auto uncompressed = write(UNCOMPRESSED);
+	auto compressed = write(GZIP);
+	EXPECT_LT(compressed.size(), uncompressed.size() / 4);
+
+	for (auto lazy_threshold : {int64_t(0), int64_t(1)})
+	{
+		auto deserializer = std::make_shared<BitseryDeserializer>();
+		deserializer->set_lazy_threshold(lazy_threshold);
+		auto istream = std::make_shared<DummyInputStream>(compressed);
+		deserializer->attach(istream);
+		auto deser_obj = deserializer->read_object();
+		ASSERT_NE(deser_obj, nullptr);
+		ASSERT_TRUE(obj->equals(deser_obj));
+	}
+}
+#endif
+
+TEST(BitserySerializationTest, lazy_deserialization)
+{
+	SGMatrix<float64_t> small_data {{1.0, 2.0}, {3.0, 4.0}};
+	SGMatrix<float64_t> data(20, 2);
+	std::iota(data.begin(), data.end(), 1.0);
+	auto obj = std::make_shared<CombinedFeatures>();
+	obj->append_feature_obj(std::make_shared<DenseFeatures<float64_t>>(small_data));
+	obj->append_feature_obj(std::make_shared<DenseFeatures<float64_t>>(data));
+
+	auto serializer = std::make_shared<BitserySerializer>();
+	auto stream = std::make_shared<DummyOutputStream>();
+	serializer->attach(stream);
+	serializer->write(obj);
+
+	auto deserializer = std::make_shared<BitseryDeserializer>();
+	deserializer->set_lazy_threshold(data.size() * sizeof(float64_t));
+	auto istream = std::make_shared<DummyInputStream>(stream->buffer());
+	deserializer->attach(istream);
+	auto deser_obj = deserializer->read_object();
+	ASSERT_NE(deser_obj, nullptr);
+
+	// only the big features are deferred
+	auto deser_combined = deser_obj->as<CombinedFeatures>();
+	EXPECT_FALSE(deser_combined->is_lazy());
+	EXPECT_FALSE(deser_combined->get_feature_obj(0)->is_lazy());
+	EXPECT_TRUE(deser_combined->get_feature_obj(1)->is_lazy());
+
+	// and read on their first access
+	auto deser_df = deser_obj->get("feature_array", 1)->as<DenseFeatures<float64_t>>();
+	EXPECT_FALSE(deser_df->is_lazy());
+	auto deser_data = deser_df->get_feature_matrix();
+	ASSERT_EQ(deser_data.num_rows, data.num_rows);
+	ASSERT_EQ(deser_data.num_cols, data.num_cols);
+	for (index_t i = 0; i < data.size(); ++i)
+		EXPECT_EQ(deser_data[i], data[i]);
+
+	ASSERT_TRUE(obj->equals(deser_obj));
+}
+
+TEST(BitserySerializationTest, lazy_deserialization_apply)
+{
+	SGMatrix<float64_t> data(2, 30);
+	SGVector<float64_t> lab(30);
+	for (index_t i = 0; i < 30; ++i)
+	{
+		lab[i] = i % 3;
+		data(0, i) = (i % 3 == 0 ? 5.0 : (i % 3 == 1 ? 0.0 : -5.0)) + 0.1 * i;
+		data(1, i) = (i % 3 == 1 ? 5.0 : (i % 3 == 0 ? 0.0 : -5.0)) - 0.1 * i;
+	}
+	auto features = std::make_shared<DenseFeatures<float64_t>>(data);
+	auto labels = std::make_shared<MulticlassLabels>(lab);
+	auto machine = std::make_shared<LinearMulticlassMachine>(
+		std::make_shared<MulticlassOneVsRestStrategy>(), features,
+		std::make_shared<Perceptron>(), labels);
+	machine->train();
+	auto expected = machine->apply(features)->as<MulticlassLabels>();
+
+	auto serializer = std::make_shared<BitserySerializer>();
+	auto stream = std::make_shared<DummyOutputStream>();
+	serializer->attach(stream);
+	serializer->write(machine);
+
+	// defers all the binary machines of the multiclass machine
+	auto deserializer = std::make_shared<BitseryDeserializer>();
+	deserializer->set_lazy_threshold(1);
+	auto istream = std::make_shared<DummyInputStream>(stream->buffer());
+	deserializer->attach(istream);
+	auto deser_machine =
+		deserializer->read_object()->as<LinearMulticlassMachine>();
+	ASSERT_EQ(deser_machine->get_num_machines(), 3);
+	for (auto i : range(3))
+		EXPECT_TRUE(deser_machine->get_machine(i)->is_lazy());
+
+	// apply reads them before accessing their members
+	auto result = deser_machine->apply(features)->as<MulticlassLabels>();
+	for (auto i : range(3))
+		EXPECT_FALSE(deser_machine->get_machine(i)->is_lazy());
+	EXPECT_TRUE(expected->equals(result));
+}
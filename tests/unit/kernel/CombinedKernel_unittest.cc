@@ -192,6 +192,86 @@ TEST(CombinedKernelTest,weights)
 
 }
 
+TEST(CombinedKernelTest, compute_block)
+{
+	const index_t dim=3;
+	const index_t num_vec=20;
+	std::mt19937_64 prng(17);
+	std::normal_distribution<float64_t> dist;
+
+	SGMatrix<float64_t> data(dim, num_vec);
+	for (index_t i=0; i<dim*num_vec; i++)
+		data.matrix[i]=dist(prng);
+	auto feats=std::make_shared<DenseFeatures<float64_t>>(data);
+
+	auto combined=std::make_shared<CombinedKernel>();
+	combined->append_kernel(std::make_shared<GaussianKernel>(1.0));
+	combined->append_kernel(std::make_shared<GaussianKernel>(5.0));
+	combined->append_kernel(std::make_shared<GaussianKernel>(0.5));
+	combined->init(feats, feats);
+
+	SGVector<float64_t> weights(3);
+	weights[0]=0.2;
+	weights[1]=0.0;
+	weights[2]=0.8;
+	combined->set_subkernel_weights(weights);
+
+	SGVector<index_t> lhs_idx(7);
+	SGVector<index_t> rhs_idx(11);
+	for (index_t i=0; i<lhs_idx.vlen; i++)
+		lhs_idx[i]=(3*i+1)%num_vec;
+	for (index_t j=0; j<rhs_idx.vlen; j++)
+		rhs_idx[j]=(5*j+2)%num_vec;
+
+	SGVector<index_t> idx(num_vec/2);
+	SGVector<float64_t> alpha(num_vec/2);
+	for (index_t i=0; i<idx.vlen; i++)
+	{
+		idx[i]=2*i;
+		alpha[i]=dist(prng);
+	}
+
+	// without and with the subkernel row cache, the second repetition is
+	// served from the cache
+	for (auto cache_size : {0, 1})
+	{
+		combined->set_subkernel_cache_size(cache_size);
+
+		for (auto rep : range(2))
+		{
+			SGMatrix<float64_t> block(lhs_idx.vlen, rhs_idx.vlen);
+			combined->compute_block(lhs_idx, rhs_idx, block);
+			for (index_t i=0; i<lhs_idx.vlen; i++)
+			{
+				for (index_t j=0; j<rhs_idx.vlen; j++)
+				{
+					EXPECT_NEAR(
+						block(i, j), combined->kernel(lhs_idx[i], rhs_idx[j]),
+						1e-12) << "repetition " << rep;
+				}
+			}
+
+			auto forms=combined->compute_subkernel_quadratic_forms(idx, alpha);
+			ASSERT_EQ(forms.vlen, combined->get_num_kernels());
+			for (index_t k_idx=0; k_idx<combined->get_num_kernels(); k_idx++)
+			{
+				auto k=combined->get_kernel(k_idx);
+				float64_t expected=0;
+				for (index_t i=0; i<idx.vlen; i++)
+				{
+					for (index_t j=0; j<idx.vlen; j++)
+						expected+=alpha[i]*alpha[j]*k->kernel(idx[i], idx[j]);
+				}
+				EXPECT_NEAR(forms[k_idx], expected, 1e-10);
+			}
+		}
+	}
+
+	EXPECT_THROW(
+		combined->compute_subkernel_quadratic_forms(idx, SGVector<float64_t>(1)),
+		ShogunException);
+}
+
 //FIXME
 TEST(CombinedKernelTest, DISABLED_serialization)
 {
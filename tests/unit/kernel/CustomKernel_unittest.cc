@@ -15,6 +15,9 @@
 #include <shogun/mathematics/eigen3.h>
 #include <shogun/mathematics/Math.h>
 #include <shogun/mathematics/RandomNamespace.h>
+#include "../utils/Utils.h"
+
+#include <cstdio>
 
 using namespace shogun;
 using namespace Eigen;
@@ -190,6 +193,70 @@ TEST(CustomKernelTest,index_features_subset)
 
 
 
+}
+
+TEST(CustomKernelTest, triangle_kernel_matrix_from_file)
+{
+	index_t seed = 17;
+	float64_t epsilon=1e-6;
+	index_t n=7;
+
+	std::mt19937_64 prng(seed);
+
+	SGMatrix<float64_t> data(3,n);
+	generate_data(data);
+	auto feats=std::make_shared<DenseFeatures<float64_t>>(data);
+	auto gaussian=std::make_shared<GaussianKernel>(feats, feats, 2, 10);
+	SGMatrix<float64_t> kmg=gaussian->get_kernel_matrix();
+
+	char fname[] = "CustomKernel_triangle.XXXXXX";
+	generate_temp_filename(fname);
+
+	auto custom=std::make_shared<CustomKernel>();
+	custom->set_triangle_kernel_matrix_from_kernel(gaussian, fname);
+	EXPECT_TRUE(custom->is_memory_mapped());
+
+	/* map the file again, as when reusing a precomputed kernel */
+	auto mapped=std::make_shared<CustomKernel>();
+	mapped->set_triangle_kernel_matrix_from_file(fname);
+	EXPECT_TRUE(mapped->is_memory_mapped());
+	EXPECT_EQ(mapped->get_num_vec_lhs(), n);
+	EXPECT_EQ(mapped->get_num_vec_rhs(), n);
+
+	SGMatrix<float64_t> km=custom->get_kernel_matrix();
+	SGMatrix<float64_t> km_mapped=mapped->get_kernel_matrix();
+	for (index_t i=0; i<n; ++i)
+	{
+		for (index_t j=0; j<n; ++j)
+		{
+			EXPECT_NEAR(kmg(i, j), km(i, j), epsilon);
+			EXPECT_NEAR(kmg(i, j), km_mapped(i, j), epsilon);
+		}
+	}
+
+	/* blocks and subsets on the mapped matrix */
+	SGVector<index_t> r_idx(n);
+	r_idx.range_fill();
+	random::shuffle(r_idx, prng);
+	mapped->add_row_subset(r_idx);
+	mapped->add_col_subset(r_idx);
+
+	SGVector<index_t> rows({6, 0, 3});
+	SGVector<index_t> cols({1, 5, 2, 2});
+	SGMatrix<float64_t> block(rows.vlen, cols.vlen);
+	mapped->compute_block(rows, cols, block);
+	for (index_t i=0; i<rows.vlen; ++i)
+	{
+		for (index_t j=0; j<cols.vlen; ++j)
+			EXPECT_NEAR(kmg(r_idx[rows[i]], r_idx[cols[j]]), block(i, j), epsilon);
+	}
+
+	mapped->cleanup();
+	EXPECT_FALSE(mapped->is_memory_mapped());
+
+	custom=nullptr;
+	mapped=nullptr;
+	std::remove(fname);
 }
 
 TEST(CustomKernelTest, sum_symmetric_block)
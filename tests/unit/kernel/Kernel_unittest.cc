@@ -29,11 +29,21 @@
  */
 
 #include <gtest/gtest.h>
+#include <shogun/base/ShogunEnv.h>
 #include <shogun/lib/common.h>
 #include <shogun/lib/SGVector.h>
 #include <shogun/lib/SGMatrix.h>
 #include <shogun/features/DenseFeatures.h>
+#include <shogun/features/SparseFeatures.h>
+#include <shogun/features/StringFeatures.h>
+#include <shogun/kernel/CachedKernel.h>
+#include <shogun/kernel/ConstKernel.h>
 #include <shogun/kernel/GaussianKernel.h>
+#include <shogun/kernel/LinearKernel.h>
+#include <shogun/kernel/PolyKernel.h>
+#include <shogun/kernel/SigmoidKernel.h>
+#include <shogun/kernel/string/LinearStringKernel.h>
+#include <shogun/kernel/string/WeightedDegreeStringKernel.h>
 #include <shogun/mathematics/NormalDistribution.h>
 
 using namespace shogun;
@@ -370,3 +380,273 @@ TEST(Kernel, gaussian_get_kernel_matrix)
 
 
 }
+
+TEST(Kernel, get_kernel_matrix_tiled)
+{
+	const int32_t seed = 100;
+	// more vectors than fit in one tile
+	const index_t num_feats_p=300;
+	const index_t num_feats_q=280;
+	const index_t dim=5;
+
+	std::mt19937_64 prng(seed);
+	SGMatrix<float64_t> data_p = generate_std_norm_matrix(num_feats_p, dim, prng);
+	SGMatrix<float64_t> data_q = generate_std_norm_matrix(num_feats_q, dim, prng);
+	auto feats_p=std::make_shared<DenseFeatures<float64_t>>(data_p);
+	auto feats_q=std::make_shared<DenseFeatures<float64_t>>(data_q);
+
+	std::vector<std::shared_ptr<Kernel>> kernels{
+		std::make_shared<GaussianKernel>(10, 2.0),
+		std::make_shared<PolyKernel>(10, 3, 1.0, 0.5),
+		std::make_shared<SigmoidKernel>(10, 0.5, 0.1)};
+
+	for (auto& kernel : kernels)
+	{
+		kernel->init(feats_p, feats_p);
+		SGMatrix<float64_t> km=kernel->get_kernel_matrix();
+		for (index_t i=0; i<km.num_rows; i++)
+			for (index_t j=0; j<km.num_cols; ++j)
+				EXPECT_NEAR(kernel->kernel(i,j), km(i, j), 1E-12);
+
+		kernel->init(feats_p, feats_q);
+		km=kernel->get_kernel_matrix();
+		for (index_t i=0; i<km.num_rows; i++)
+			for (index_t j=0; j<km.num_cols; ++j)
+				EXPECT_NEAR(kernel->kernel(i,j), km(i, j), 1E-12);
+	}
+}
+
+TEST(Kernel, compute_block)
+{
+	const int32_t seed = 100;
+	const index_t num_feats_p=20;
+	const index_t num_feats_q=15;
+	const index_t dim=4;
+
+	std::mt19937_64 prng(seed);
+	SGMatrix<float64_t> data_p = generate_std_norm_matrix(num_feats_p, dim, prng);
+	SGMatrix<float64_t> data_q = generate_std_norm_matrix(num_feats_q, dim, prng);
+	auto feats_p=std::make_shared<DenseFeatures<float64_t>>(data_p);
+	auto feats_q=std::make_shared<DenseFeatures<float64_t>>(data_q);
+	auto sparse_p=std::make_shared<SparseFeatures<float64_t>>(data_p);
+	auto sparse_q=std::make_shared<SparseFeatures<float64_t>>(data_q);
+
+	// unordered indices with repetitions
+	SGVector<index_t> lhs_idx({3, 0, 17, 3, 9, 12});
+	SGVector<index_t> rhs_idx({14, 2, 2, 7, 0});
+
+	// dense matrix product, sparse matrix product and entrywise fallback
+	std::vector<std::tuple<std::shared_ptr<Kernel>, std::shared_ptr<Features>,
+		std::shared_ptr<Features>>> cases{
+		{std::make_shared<GaussianKernel>(10, 2.0), feats_p, feats_q},
+		{std::make_shared<LinearKernel>(), sparse_p, sparse_q},
+		{std::make_shared<ConstKernel>(2.5), feats_p, feats_q}};
+
+	for (auto& [kernel, lhs, rhs] : cases)
+	{
+		kernel->init(lhs, rhs);
+
+		SGMatrix<float64_t> block(lhs_idx.vlen, rhs_idx.vlen);
+		kernel->compute_block(lhs_idx, rhs_idx, block);
+		for (index_t i=0; i<lhs_idx.vlen; i++)
+			for (index_t j=0; j<rhs_idx.vlen; ++j)
+				EXPECT_NEAR(kernel->kernel(lhs_idx[i], rhs_idx[j]), block(i, j), 1E-12);
+
+		SGMatrix<float64_t> wrong_size(lhs_idx.vlen, rhs_idx.vlen+1);
+		EXPECT_THROW(kernel->compute_block(lhs_idx, rhs_idx, wrong_size),
+			ShogunException);
+		SGVector<index_t> out_of_range({0, num_feats_q});
+		SGMatrix<float64_t> out(lhs_idx.vlen, out_of_range.vlen);
+		EXPECT_THROW(kernel->compute_block(lhs_idx, out_of_range, out),
+			ShogunException);
+	}
+}
+
+TEST(Kernel, compute_block_strings)
+{
+	const int32_t seed = 100;
+	const index_t len=12;
+	const char acgt[]="ACGT";
+
+	std::mt19937_64 prng(seed);
+	std::uniform_int_distribution<int32_t> dist(0, 3);
+	auto random_dna=[&](index_t num_vec) {
+		std::vector<SGVector<char>> list;
+		for (index_t i=0; i<num_vec; i++)
+		{
+			SGVector<char> str(len);
+			for (index_t j=0; j<len; j++)
+				str[j]=acgt[dist(prng)];
+			list.push_back(str);
+		}
+		return std::make_shared<StringFeatures<char>>(list, DNA);
+	};
+	auto strings_p=random_dna(20);
+	auto strings_q=random_dna(15);
+
+	SGVector<index_t> lhs_idx({3, 0, 17, 3, 9, 12});
+	SGVector<index_t> rhs_idx({14, 2, 2, 7, 0});
+
+	std::vector<std::shared_ptr<Kernel>> kernels{
+		std::make_shared<LinearStringKernel>(),
+		std::make_shared<WeightedDegreeStringKernel>(3)};
+	for (auto& kernel : kernels)
+	{
+		kernel->init(strings_p, strings_q);
+
+		SGMatrix<float64_t> block(lhs_idx.vlen, rhs_idx.vlen);
+		kernel->compute_block(lhs_idx, rhs_idx, block);
+		for (index_t i=0; i<lhs_idx.vlen; i++)
+			for (index_t j=0; j<rhs_idx.vlen; ++j)
+				EXPECT_NEAR(kernel->kernel(lhs_idx[i], rhs_idx[j]), block(i, j), 1E-12);
+
+		SGVector<index_t> out_of_range({0, 15});
+		SGMatrix<float64_t> out(lhs_idx.vlen, out_of_range.vlen);
+		EXPECT_THROW(kernel->compute_block(lhs_idx, out_of_range, out),
+			ShogunException);
+	}
+}
+
+TEST(Kernel, cached_kernel_clone_shares_cache)
+{
+	const int32_t seed = 100;
+	const index_t num_feats=10;
+	const index_t dim=3;
+
+	std::mt19937_64 prng(seed);
+	SGMatrix<float64_t> data = generate_std_norm_matrix(num_feats, dim, prng);
+	auto feats=std::make_shared<DenseFeatures<float64_t>>(data);
+
+	auto gaussian=std::make_shared<GaussianKernel>(2);
+	auto cache=std::make_shared<KernelValueCache>(num_feats, 1);
+	auto kernel=std::make_shared<CachedKernel>(gaussian, cache);
+	kernel->init(feats, feats);
+	kernel->get_kernel_matrix();
+	EXPECT_EQ(cache->get_num_rows(), num_feats);
+
+	auto clone=kernel->clone()->as<CachedKernel>();
+	EXPECT_EQ(clone->get_cache(), cache);
+	clone->init(feats, feats);
+	auto matrix=clone->get_kernel_matrix();
+	EXPECT_EQ(cache->get_num_rows(), num_feats);
+	for (index_t i=0; i<num_feats; i++)
+	{
+		for (index_t j=0; j<num_feats; j++)
+			EXPECT_NEAR(matrix(i, j), gaussian->kernel(i, j), 1E-10);
+	}
+}
+
+#ifdef USE_SVMLIGHT
+TEST(Kernel, sharded_kernel_cache_rows)
+{
+	const int32_t seed = 100;
+	const index_t num_feats=20;
+	const index_t dim=3;
+
+	std::mt19937_64 prng(seed);
+	SGMatrix<float64_t> data = generate_std_norm_matrix(num_feats, dim, prng);
+	auto feats=std::make_shared<DenseFeatures<float64_t>>(data);
+
+	auto kernel=std::make_shared<GaussianKernel>(feats, feats, 2);
+	kernel->set_cache_num_shards(4);
+	EXPECT_EQ(kernel->get_cache_num_shards(), 4);
+
+	SGVector<int32_t> rows(num_feats);
+	rows.range_fill();
+	kernel->cache_multiple_kernel_rows(rows.vector, num_feats);
+	for (index_t i=0; i<num_feats; i++)
+		kernel->cache_kernel_row(i);
+
+	EXPECT_EQ(kernel->get_cache_misses(), num_feats);
+	EXPECT_EQ(kernel->get_cache_hits(), num_feats);
+	EXPECT_EQ(kernel->get_cache_evictions(), 0);
+
+	SGVector<float64_t> row(num_feats);
+	for (index_t i=0; i<num_feats; i++)
+	{
+		EXPECT_TRUE(kernel->kernel_cache_check(i));
+		kernel->get_kernel_row(i, NULL, row.vector, true);
+		for (index_t j=0; j<num_feats; j++)
+			EXPECT_NEAR(row[j], kernel->kernel(i, j), 1E-6);
+	}
+	EXPECT_EQ(kernel->get_cache_hits(), 2*num_feats);
+
+	kernel->reset_cache_statistics();
+	EXPECT_EQ(kernel->get_cache_hits(), 0);
+	EXPECT_EQ(kernel->get_cache_misses(), 0);
+}
+
+TEST(Kernel, sharded_kernel_cache_shrink)
+{
+	const int32_t seed = 100;
+	// more vectors than rows fit into the default cache, so that the
+	// number of cache lines grows when the cache is shrunk
+	const index_t num_feats=1500;
+	const index_t dim=3;
+
+	std::mt19937_64 prng(seed);
+	SGMatrix<float64_t> data = generate_std_norm_matrix(num_feats, dim, prng);
+	auto feats=std::make_shared<DenseFeatures<float64_t>>(data);
+
+	auto kernel=std::make_shared<GaussianKernel>(feats, feats, 2);
+	kernel->set_cache_num_shards(4);
+	for (index_t i=0; i<num_feats; i++)
+		kernel->cache_kernel_row(i);
+
+	// the lines of the shards change, the cached rows have to be moved
+	SGVector<int32_t> after(num_feats);
+	for (index_t i=0; i<num_feats; i++)
+		after[i]=i%4!=0;
+	kernel->kernel_cache_shrink(num_feats, num_feats/4, after.vector);
+
+	SGVector<float64_t> row(num_feats);
+	float64_t max_diff=0;
+	for (index_t i=0; i<num_feats; i++)
+	{
+		kernel->cache_kernel_row(i);
+		kernel->get_kernel_row(i, NULL, row.vector, true);
+		for (index_t j=0; j<num_feats; j++)
+			max_diff=std::max(max_diff, std::abs(row[j]-kernel->kernel(i, j)));
+	}
+	EXPECT_NEAR(max_diff, 0, 1E-6);
+}
+
+TEST(Kernel, sharded_kernel_cache_concurrent_rows)
+{
+	const int32_t seed = 100;
+	// more vectors than rows fit into the default cache, so that rows are
+	// evicted while others are read
+	const index_t num_feats=1500;
+	const index_t dim=3;
+
+	std::mt19937_64 prng(seed);
+	SGMatrix<float64_t> data = generate_std_norm_matrix(num_feats, dim, prng);
+	auto feats=std::make_shared<DenseFeatures<float64_t>>(data);
+
+	auto kernel=std::make_shared<GaussianKernel>(feats, feats, 2);
+	kernel->set_cache_num_shards(4);
+	env()->set_num_threads(4);
+
+	float64_t max_diff=0;
+	#pragma omp parallel for schedule(dynamic) num_threads(4) reduction(max:max_diff)
+	for (index_t i=0; i<2*num_feats; i++)
+	{
+		index_t r=(i*7)%num_feats;
+		if (i%3==0)
+			kernel->cache_kernel_row(r);
+		else if (i%3==1)
+		{
+			int32_t rows[]={r, (r+1)%num_feats};
+			kernel->cache_multiple_kernel_rows(rows, 2);
+		}
+
+		SGVector<float64_t> row(num_feats);
+		kernel->get_kernel_row(r, NULL, row.vector, true);
+		for (index_t j=0; j<num_feats; j++)
+			max_diff=std::max(max_diff, std::abs(row[j]-kernel->kernel(r, j)));
+	}
+	EXPECT_NEAR(max_diff, 0, 1E-6);
+	EXPECT_GT(kernel->get_cache_hits(), 0);
+	EXPECT_GT(kernel->get_cache_evictions(), 0);
+}
+#endif // USE_SVMLIGHT
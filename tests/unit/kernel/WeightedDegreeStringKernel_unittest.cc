@@ -0,0 +1,191 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <gtest/gtest.h>
+#include <shogun/features/StringFeatures.h>
+#include <shogun/kernel/normalizer/SqrtDiagKernelNormalizer.h>
+#include <shogun/kernel/string/WeightedDegreePositionStringKernel.h>
+#include <shogun/kernel/string/WeightedDegreeStringKernel.h>
+
+#include <random>
+
+using namespace shogun;
+
+namespace
+{
+	std::shared_ptr<StringFeatures<char>>
+	random_dna(index_t num_vec, index_t len, std::mt19937_64& prng)
+	{
+		const char acgt[]="ACGT";
+		std::uniform_int_distribution<int32_t> dist(0, 3);
+
+		std::vector<SGVector<char>> list;
+		for (index_t i=0; i<num_vec; i++)
+		{
+			SGVector<char> str(len);
+			for (index_t j=0; j<len; j++)
+				str[j]=acgt[dist(prng)];
+			list.push_back(str);
+		}
+
+		return std::make_shared<StringFeatures<char>>(list, DNA);
+	}
+
+	// compute_batch() against the sum of kernel values
+	void check_compute_batch(const std::shared_ptr<Kernel>& kernel,
+		std::mt19937_64& prng)
+	{
+		const index_t num_sv=kernel->get_num_vec_lhs();
+		const index_t num_vec=kernel->get_num_vec_rhs();
+		std::normal_distribution<float64_t> dist;
+
+		SGVector<int32_t> sv_idx(num_sv);
+		sv_idx.range_fill();
+		SGVector<float64_t> alphas(num_sv);
+		SGVector<int32_t> vec_idx(num_vec);
+		vec_idx.range_fill();
+		SGVector<float64_t> result(num_vec);
+
+		// the second call reuses the tries of the first, the third has to
+		// rebuild them for new alphas
+		for (auto call : {0, 1, 2})
+		{
+			if (call!=1)
+			{
+				for (index_t i=0; i<num_sv; i++)
+					alphas[i]=dist(prng);
+				alphas[1]=0;
+			}
+
+			result.zero();
+			kernel->compute_batch(num_vec, vec_idx.vector, result.vector,
+				num_sv, sv_idx.vector, alphas.vector, 1.0);
+
+			for (index_t j=0; j<num_vec; j++)
+			{
+				float64_t expected=0;
+				for (index_t i=0; i<num_sv; i++)
+					expected+=alphas[i]*kernel->kernel(i, j);
+				EXPECT_NEAR(result[j], expected, 1e-10);
+			}
+		}
+	}
+
+	SGVector<float64_t> random_position_weights(index_t len, std::mt19937_64& prng)
+	{
+		std::uniform_real_distribution<float64_t> dist(0.0, 2.0);
+		SGVector<float64_t> position_weights(len);
+		for (index_t i=0; i<len; i++)
+			position_weights[i]=dist(prng);
+		position_weights[0]=0;
+		position_weights[len/2]=0;
+
+		return position_weights;
+	}
+}
+
+TEST(WeightedDegreeStringKernel, compute_batch)
+{
+	std::mt19937_64 prng(17);
+	auto sv_feats=random_dna(23, 30, prng);
+	auto test_feats=random_dna(41, 30, prng);
+
+	auto kernel=std::make_shared<WeightedDegreeStringKernel>(5);
+	kernel->init(sv_feats, test_feats);
+	check_compute_batch(kernel, prng);
+}
+
+TEST(WeightedDegreePositionStringKernel, compute_batch)
+{
+	std::mt19937_64 prng(17);
+	auto sv_feats=random_dna(23, 30, prng);
+	auto test_feats=random_dna(41, 30, prng);
+
+	for (auto opt_type : {SLOWBUTMEMEFFICIENT, FASTBUTMEMHUNGRY})
+	{
+		auto kernel=std::make_shared<WeightedDegreePositionStringKernel>(
+			sv_feats, test_feats, 5);
+		kernel->set_optimization_type(opt_type);
+		kernel->init(sv_feats, test_feats);
+		check_compute_batch(kernel, prng);
+	}
+}
+
+TEST(WeightedDegreeStringKernel, compute_batch_position_weights)
+{
+	std::mt19937_64 prng(17);
+	auto sv_feats=random_dna(23, 30, prng);
+	auto test_feats=random_dna(41, 30, prng);
+
+	auto kernel=std::make_shared<WeightedDegreeStringKernel>(5);
+	kernel->init(sv_feats, test_feats);
+	kernel->set_position_weights(random_position_weights(30, prng));
+	check_compute_batch(kernel, prng);
+}
+
+TEST(WeightedDegreePositionStringKernel, compute_batch_position_weights)
+{
+	std::mt19937_64 prng(17);
+	auto sv_feats=random_dna(23, 30, prng);
+	auto test_feats=random_dna(41, 30, prng);
+	auto position_weights=random_position_weights(30, prng);
+
+	for (auto opt_type : {SLOWBUTMEMEFFICIENT, FASTBUTMEMHUNGRY})
+	{
+		auto kernel=std::make_shared<WeightedDegreePositionStringKernel>(
+			sv_feats, test_feats, 5);
+		kernel->set_optimization_type(opt_type);
+		kernel->init(sv_feats, test_feats);
+		kernel->set_position_weights(position_weights);
+		check_compute_batch(kernel, prng);
+	}
+}
+
+TEST(WeightedDegreeStringKernel, compute_batch_changed_settings)
+{
+	std::mt19937_64 prng(17);
+	auto sv_feats=random_dna(23, 30, prng);
+	auto test_feats=random_dna(41, 30, prng);
+
+	auto kernel=std::make_shared<WeightedDegreeStringKernel>(5);
+	kernel->init(sv_feats, test_feats);
+	kernel->set_position_weights(random_position_weights(30, prng));
+
+	const index_t num_sv=kernel->get_num_vec_lhs();
+	const index_t num_vec=kernel->get_num_vec_rhs();
+	std::normal_distribution<float64_t> dist;
+	SGVector<int32_t> sv_idx(num_sv);
+	sv_idx.range_fill();
+	SGVector<float64_t> alphas(num_sv);
+	for (index_t i=0; i<num_sv; i++)
+		alphas[i]=dist(prng);
+	SGVector<int32_t> vec_idx(num_vec);
+	vec_idx.range_fill();
+	SGVector<float64_t> result(num_vec);
+
+	// the alphas stay the same, so the tries of a call must not be reused
+	// after the position weights (zero ones included) or the normalizer
+	// changed
+	SGVector<float64_t> position_weights(30);
+	position_weights.set_const(0.5);
+	for (auto step : {0, 1, 2})
+	{
+		if (step==1)
+			kernel->set_position_weights(position_weights);
+		else if (step==2)
+			kernel->set_normalizer(std::make_shared<SqrtDiagKernelNormalizer>());
+
+		result.zero();
+		kernel->compute_batch(num_vec, vec_idx.vector, result.vector,
+			num_sv, sv_idx.vector, alphas.vector, 1.0);
+
+		for (index_t j=0; j<num_vec; j++)
+		{
+			float64_t expected=0;
+			for (index_t i=0; i<num_sv; i++)
+				expected+=alphas[i]*kernel->kernel(i, j);
+			EXPECT_NEAR(result[j], expected, 1e-10);
+		}
+	}
+}
@@ -0,0 +1,67 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+#include <gtest/gtest.h>
+
+#include <shogun/lib/CompressedVectorStore.h>
+
+#include <string>
+#include <vector>
+
+using namespace shogun;
+
+namespace
+{
+	std::vector<E_COMPRESSION_TYPE> compression_types()
+	{
+		std::vector<E_COMPRESSION_TYPE> types{UNCOMPRESSED};
+#ifdef USE_GZIP
+		types.push_back(GZIP);
+#endif
+#ifdef USE_SNAPPY
+		types.push_back(SNAPPY);
+#endif
+		return types;
+	}
+}
+
+TEST(CompressedVectorStoreTest, random_access)
+{
+	std::vector<std::string> strings;
+	for (int32_t i=0; i<100; i++)
+		strings.push_back(std::string(i%7, 'A'+i%4)+std::to_string(i));
+	strings[10].clear();
+
+	for (auto compression : compression_types())
+	{
+		CompressedVectorStore store(compression, 8);
+		for (const auto& s : strings)
+			store.append(s.data(), s.size());
+		store.finalize();
+		EXPECT_THROW(store.append("x", 1), ShogunException);
+
+		ASSERT_EQ(store.get_num_vectors(), (index_t) strings.size());
+		if (compression==UNCOMPRESSED)
+			EXPECT_EQ(store.get_compressed_size(), store.get_uncompressed_size());
+
+		// backwards, so blocks are evicted from the cache in between
+		for (index_t i=strings.size()-1; i>=0; i-=3)
+		{
+			ASSERT_EQ(store.get_size(i), strings[i].size());
+			std::string s(store.get_size(i), '\0');
+			store.get(i, &s[0]);
+			EXPECT_EQ(s, strings[i]);
+		}
+
+		std::vector<int32_t> matches(strings.size(), 0);
+		#pragma omp parallel for
+		for (index_t i=0; i<(index_t) strings.size(); i++)
+		{
+			std::string s(store.get_size(i), '\0');
+			store.get(i, &s[0]);
+			matches[i]=s==strings[i];
+		}
+		for (auto match : matches)
+			EXPECT_TRUE(match);
+	}
+}
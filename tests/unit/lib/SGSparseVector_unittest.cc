@@ -507,6 +507,37 @@ TEST(SGSparseVector, sparse_dot_not_sorted_features_different_length_last_index_
 	EXPECT_EQ(4, SGSparseVector<int32_t>::sparse_dot(v2, v1));
 }
 
+TEST(SGSparseVector, sparse_dot_sorted_features_very_different_length)
+{
+	// the short vector is searched in the long one
+	SGSparseVector<float64_t> v1 = SGSparseVector<float64_t>(4);
+	const int32_t idx[] = {0, 37, 38, 299};
+	for (int32_t i=0; i<v1.num_feat_entries; i++) {
+		v1.features[i].feat_index = idx[i];
+		v1.features[i].entry = i+1;
+	}
+
+	SGSparseVector<float64_t> v2 = SGSparseVector<float64_t>(100);
+	for (int32_t i=0; i<v2.num_feat_entries; i++) {
+		v2.features[i].feat_index = 3*i+1;
+		v2.features[i].entry = 0.5*(i+1);
+	}
+
+	// the only common index is 37 (v2 entry 12), 299 is not in v2
+	SGVector<float64_t> dense = v2.get_dense(300);
+	float64_t expected = v1.dense_dot(1.0, dense.vector, dense.vlen, 0.0);
+	EXPECT_NEAR(expected, 2*6.5, 1E-15);
+	EXPECT_NEAR(expected, SGSparseVector<float64_t>::sparse_dot(v1, v2), 1E-15);
+	EXPECT_NEAR(expected, SGSparseVector<float64_t>::sparse_dot(v2, v1), 1E-15);
+
+	// index 1 is the first entry of v2 and now matches as well
+	v1.features[0].feat_index = 1;
+	expected = v1.dense_dot(1.0, dense.vector, dense.vlen, 0.0);
+	EXPECT_NEAR(expected, 1*0.5 + 2*6.5, 1E-15);
+	EXPECT_NEAR(expected, SGSparseVector<float64_t>::sparse_dot(v1, v2), 1E-15);
+	EXPECT_NEAR(expected, SGSparseVector<float64_t>::sparse_dot(v2, v1), 1E-15);
+}
+
 /** @brief Fixture class template for typed tests of equals method */
 template <typename T>
 class SGSparseVectorEquals : public ::testing::Test
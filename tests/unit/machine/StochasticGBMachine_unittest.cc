@@ -177,3 +177,54 @@ TEST_F(StochasticGBMachineTest, sinusoid_curve_fitting_subset_fraction)
 	EXPECT_NEAR(ret[8], -0.4408978052, epsilon);
 	EXPECT_NEAR(ret[9], 0.5380825978, epsilon);
 }
+
+TEST_F(StochasticGBMachineTest, sinusoid_curve_fitting_tree_boosting)
+{
+	const int32_t seed = 2855;
+
+	SGVector<bool> ft(1);
+	ft[0] = false;
+	auto tree = std::make_shared<CARTree>(ft);
+	tree->set_max_depth(3);
+	auto sq = std::make_shared<SquaredLoss>();
+
+	auto sgbm = std::make_shared<StochasticGBMachine>(tree, sq, 100, 0.1, 0.8);
+	sgbm->put("seed", seed);
+	sgbm->set_tree_boosting(true);
+	sgbm->set_labels(train_labels);
+	sgbm->train(train_feats);
+
+	auto ret_labels = sgbm->apply_regression(test_feats);
+	auto mse = std::make_shared<MeanSquaredError>();
+	EXPECT_LT(mse->evaluate(ret_labels, test_labels), 0.05);
+	EXPECT_EQ(sgbm->get<std::vector<float64_t>>("gamma").size(), 100);
+}
+
+TEST_F(StochasticGBMachineTest, tree_boosting_early_stopping)
+{
+	const int32_t seed = 2855;
+	const int32_t num_iter = 500;
+
+	SGVector<bool> ft(1);
+	ft[0] = false;
+	auto tree = std::make_shared<CARTree>(ft);
+	tree->set_max_depth(3);
+	auto sq = std::make_shared<SquaredLoss>();
+
+	auto sgbm =
+	    std::make_shared<StochasticGBMachine>(tree, sq, num_iter, 0.3, 1.0);
+	sgbm->put("seed", seed);
+	sgbm->set_tree_boosting(true);
+	sgbm->set_validation_data(test_feats, test_labels);
+	sgbm->set_early_stopping_rounds(10);
+	sgbm->set_labels(train_labels);
+	sgbm->train(train_feats);
+
+	auto num_learners = sgbm->get<std::vector<float64_t>>("gamma").size();
+	EXPECT_GE(num_learners, 1);
+	EXPECT_LT(num_learners, num_iter);
+
+	auto ret_labels = sgbm->apply_regression(test_feats);
+	auto mse = std::make_shared<MeanSquaredError>();
+	EXPECT_LT(mse->evaluate(ret_labels, test_labels), 0.05);
+}
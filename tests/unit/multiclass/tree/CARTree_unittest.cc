@@ -29,10 +29,14 @@
  */
 
 #include <gtest/gtest.h>
+#include <shogun/ensemble/MajorityVote.h>
 #include <shogun/features/DenseFeatures.h>
+#include <shogun/labels/RegressionLabels.h>
 #include <shogun/lib/SGMatrix.h>
 #include <shogun/mathematics/linalg/LinalgNamespace.h>
+#include <shogun/machine/RandomForest.h>
 #include <shogun/multiclass/tree/CARTree.h>
+#include <shogun/multiclass/tree/RandomCARTree.h>
 
 #include <random>
 
@@ -665,3 +669,225 @@ TEST(CARTree,cv_prune_simple)
 
 
 }
+
+TEST(CARTree, histogram_fits_like_exact)
+{
+	int32_t seed = 100;
+	std::mt19937_64 prng(seed);
+	std::uniform_int_distribution<int32_t> uniform_int_dist(0, 19);
+
+	// few distinct values, so every value gets its own bin
+	SGMatrix<float64_t> data(3,200);
+	SGVector<float64_t> lab(200);
+	SGVector<float64_t> reg(200);
+	for (index_t i=0;i<data.num_cols;++i)
+	{
+		for (index_t j=0;j<data.num_rows;++j)
+			data(j,i)=uniform_int_dist(prng);
+
+		lab[i]=((data(0,i)+data(1,i)>19) ? 1 : 0)+((data(2,i)>14) ? 2 : 0);
+		reg[i]=2*data(0,i)+data(1,i);
+	}
+
+	auto feats=std::make_shared<DenseFeatures<float64_t>>(data);
+	SGVector<bool> ft(3);
+	linalg::set_const(ft, false);
+
+	auto exact=std::make_shared<CARTree>();
+	exact->set_labels(std::make_shared<MulticlassLabels>(lab));
+	exact->set_feature_types(ft);
+	exact->train(feats);
+
+	auto histogram=std::make_shared<CARTree>();
+	histogram->set_labels(std::make_shared<MulticlassLabels>(lab));
+	histogram->set_feature_types(ft);
+	histogram->set_histogram(true);
+	histogram->train(feats);
+
+	auto exact_res=exact->apply_multiclass(feats)->get_labels();
+	auto histogram_res=histogram->apply_multiclass(feats)->get_labels();
+	for (index_t i=0;i<lab.vlen;++i)
+	{
+		EXPECT_EQ(lab[i],exact_res[i]);
+		EXPECT_EQ(lab[i],histogram_res[i]);
+	}
+
+	histogram=std::make_shared<CARTree>(ft, PT_REGRESSION);
+	histogram->set_labels(std::make_shared<RegressionLabels>(reg));
+	histogram->set_histogram(true);
+	histogram->train(feats);
+
+	histogram_res=histogram->apply_regression(feats)->get_labels();
+	for (index_t i=0;i<reg.vlen;++i)
+		EXPECT_NEAR(reg[i],histogram_res[i],1e-8);
+}
+
+TEST(CARTree, histogram_quantile_bins)
+{
+	int32_t seed = 100;
+	std::mt19937_64 prng(seed);
+	std::uniform_real_distribution<float64_t> uniform_real_dist(0.0, 1.0);
+
+	SGMatrix<float64_t> data(2,1000);
+	SGVector<float64_t> lab(1000);
+	for (index_t i=0;i<data.num_cols;++i)
+	{
+		data(0,i)=uniform_real_dist(prng);
+		data(1,i)=uniform_real_dist(prng);
+		lab[i]=(data(0,i)>0.5) ? 1 : 0;
+	}
+	data(1,0)=CARTree::MISSING;
+
+	auto feats=std::make_shared<DenseFeatures<float64_t>>(data);
+	SGVector<bool> ft(2);
+	linalg::set_const(ft, false);
+
+	auto c=std::make_shared<CARTree>();
+	c->set_labels(std::make_shared<MulticlassLabels>(lab));
+	c->set_feature_types(ft);
+	c->set_histogram(true);
+	c->set_max_bins(32);
+
+	SGMatrix<uint8_t> binned;
+	SGMatrix<float64_t> thresholds;
+	SGVector<index_t> num_bins;
+	c->pre_bin_features(feats, binned, thresholds, num_bins);
+	EXPECT_EQ(32, num_bins[0]);
+	EXPECT_EQ(32, num_bins[1]);
+	EXPECT_EQ(CARTree::MISSING_BIN, binned(0,1));
+	for (index_t i=0;i<data.num_cols;++i)
+	{
+		for (index_t j=0;j<data.num_rows;++j)
+		{
+			if (data(j,i)==CARTree::MISSING)
+				continue;
+
+			auto bin=binned(i,j);
+			EXPECT_LE(data(j,i), thresholds(bin,j));
+			if (bin>0)
+				EXPECT_GT(data(j,i), thresholds(bin-1,j));
+		}
+	}
+
+	// a bin boundary lies within 1/32 of the best threshold
+	c->train(feats);
+	auto res=c->apply_multiclass(feats)->get_labels();
+	index_t correct=0;
+	for (index_t i=0;i<lab.vlen;++i)
+		correct+=(res[i]==lab[i]);
+	EXPECT_GE(correct, 950);
+}
+
+TEST(CARTree, parallel_same_as_sequential)
+{
+	int32_t seed = 100;
+	std::mt19937_64 prng(seed);
+	std::normal_distribution<float64_t> normal_dist(0.0, 1.0);
+
+	// big enough to grow the top nodes in parallel
+	SGMatrix<float64_t> data(4,3*CART_PARALLEL_MIN_NODE_SIZE);
+	SGVector<float64_t> lab(data.num_cols);
+	for (index_t i=0;i<data.num_cols;++i)
+	{
+		for (index_t j=0;j<data.num_rows;++j)
+			data(j,i)=normal_dist(prng);
+
+		lab[i]=(data(0,i)*data(1,i)+0.5*normal_dist(prng)>0) ? 1 : 0;
+	}
+
+	auto feats=std::make_shared<DenseFeatures<float64_t>>(data);
+	auto labels=std::make_shared<MulticlassLabels>(lab);
+	SGVector<bool> ft(4);
+	linalg::set_const(ft, false);
+
+	// random feature subsets are drawn from generators seeded per node,
+	// so randomized trees and forests are the same on any number of threads
+	auto make_tree=[&](bool randomized) -> std::shared_ptr<CARTree>
+	{
+		if (!randomized)
+			return std::make_shared<CARTree>(ft);
+
+		auto tree=std::make_shared<RandomCARTree>();
+		tree->set_feature_types(ft);
+		tree->set_feature_subset_size(2);
+		tree->put("seed", seed);
+		return tree;
+	};
+
+	auto num_threads=env()->get_num_threads();
+	for (auto randomized : {false, true})
+	{
+		for (auto histogram : {false, true})
+		{
+			env()->set_num_threads(1);
+			auto sequential=make_tree(randomized);
+			sequential->set_labels(labels);
+			sequential->set_histogram(histogram);
+			sequential->train(feats);
+
+			env()->set_num_threads(4);
+			auto parallel=make_tree(randomized);
+			parallel->set_labels(labels);
+			parallel->set_histogram(histogram);
+			parallel->train(feats);
+
+			EXPECT_GT(sequential->get_root()->data.num_leaves, 1);
+			EXPECT_EQ(sequential->get_root()->data.num_leaves,
+			    parallel->get_root()->data.num_leaves);
+			auto sequential_res=sequential->apply_multiclass(feats)->get_labels();
+			auto parallel_res=parallel->apply_multiclass(feats)->get_labels();
+			for (index_t i=0;i<lab.vlen;++i)
+				EXPECT_EQ(sequential_res[i],parallel_res[i]);
+		}
+	}
+
+	// with fewer trees than threads, each tree is grown on all threads
+	SGMatrix<float64_t> forest_res(lab.vlen, 2);
+	for (auto i : {0, 1})
+	{
+		env()->set_num_threads(i ? 4 : 1);
+		auto forest=std::make_shared<RandomForest>(feats, labels, 2, 2);
+		forest->set_feature_types(ft);
+		forest->set_combination_rule(std::make_shared<MajorityVote>());
+		forest->put("seed", seed);
+		forest->train(feats);
+		auto res=forest->apply_multiclass(feats)->get_labels();
+		std::copy(res.begin(), res.end(), forest_res.get_column_vector(i));
+	}
+	for (index_t i=0;i<lab.vlen;++i)
+		EXPECT_EQ(forest_res(i,0),forest_res(i,1));
+	env()->set_num_threads(num_threads);
+}
+
+TEST(CARTree, splits_separable_data)
+{
+	// one split on the first feature separates the classes
+	SGMatrix<float64_t> data(2,8);
+	SGVector<float64_t> lab(8);
+	for (index_t i=0;i<data.num_cols;++i)
+	{
+		data(0,i)=i;
+		data(1,i)=i%3;
+		lab[i]=i<4 ? 0 : 1;
+	}
+
+	auto feats=std::make_shared<DenseFeatures<float64_t>>(data);
+	SGVector<bool> ft(2);
+	linalg::set_const(ft, false);
+
+	for (auto histogram : {false, true})
+	{
+		auto c=std::make_shared<CARTree>(ft);
+		c->set_labels(std::make_shared<MulticlassLabels>(lab));
+		c->set_histogram(histogram);
+		c->train(feats);
+
+		auto root=c->get_root()->as<BinaryTreeMachineNode<CARTreeNodeData>>();
+		EXPECT_EQ(2,root->data.num_leaves);
+		EXPECT_EQ(0,root->data.attribute_id);
+
+		auto res=c->apply_multiclass(feats)->get_labels();
+		for (index_t i=0;i<lab.vlen;++i)
+			EXPECT_EQ(lab[i],res[i]);
+	}
+}
@@ -0,0 +1,153 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <gtest/gtest.h>
+#include "utils/Utils.h"
+#include <shogun/features/DenseFeatures.h>
+#include <shogun/labels/MulticlassLabels.h>
+#include <shogun/labels/RegressionLabels.h>
+#include <shogun/mathematics/linalg/LinalgNamespace.h>
+#include <shogun/multiclass/tree/CARTree.h>
+#include <shogun/multiclass/tree/FlatForest.h>
+
+#include <random>
+
+using namespace shogun;
+
+namespace
+{
+	std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>> root_of(
+		const std::shared_ptr<CARTree>& tree)
+	{
+		return tree->get_root()->as<BinaryTreeMachineNode<CARTreeNodeData>>();
+	}
+}
+
+TEST(FlatForest, same_as_trees_nominal)
+{
+	SGMatrix<float64_t> data(4, 14);
+	SGVector<float64_t> lab(14);
+	generate_toy_data_weather(data, lab);
+	auto feats=std::make_shared<DenseFeatures<float64_t>>(data);
+
+	SGVector<bool> ft(4);
+	linalg::set_const(ft, true);
+
+	std::vector<std::shared_ptr<CARTree>> trees;
+	std::vector<std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>>> roots;
+	for (index_t t=0; t<3; ++t)
+	{
+		// each tree is trained without one of the features
+		SGMatrix<float64_t> tree_data=data.clone();
+		for (index_t i=0; i<tree_data.num_cols; ++i)
+			tree_data(t, i)=1;
+
+		auto tree=std::make_shared<CARTree>(ft);
+		tree->set_labels(std::make_shared<MulticlassLabels>(lab));
+		tree->train(std::make_shared<DenseFeatures<float64_t>>(tree_data));
+		trees.push_back(tree);
+		roots.push_back(root_of(tree));
+	}
+
+	FlatForest forest(roots, ft);
+	EXPECT_EQ(3, forest.get_num_trees());
+
+	auto output=forest.apply(data);
+	ASSERT_EQ(data.num_cols, output.num_rows);
+	ASSERT_EQ(3, output.num_cols);
+	for (index_t t=0; t<3; ++t)
+	{
+		auto expected=trees[t]->apply_multiclass(feats)->get_labels();
+		for (index_t i=0; i<data.num_cols; ++i)
+			EXPECT_EQ(expected[i], output(i, t));
+	}
+}
+
+TEST(FlatForest, same_as_trees_continuous)
+{
+	int32_t seed = 17;
+	std::mt19937_64 prng(seed);
+	std::normal_distribution<float64_t> normal_dist(0.0, 1.0);
+
+	// more vectors than a block, and not a multiple of the block size
+	SGMatrix<float64_t> data(3, 5*FLAT_FOREST_BLOCK_SIZE+7);
+	SGVector<float64_t> lab(data.num_cols);
+	for (index_t i=0; i<data.num_cols; ++i)
+	{
+		for (index_t j=0; j<data.num_rows; ++j)
+			data(j, i)=normal_dist(prng);
+		lab[i]=data(0, i)*data(1, i)+data(2, i);
+	}
+	auto feats=std::make_shared<DenseFeatures<float64_t>>(data);
+
+	SGVector<bool> ft(3);
+	linalg::set_const(ft, false);
+
+	std::vector<std::shared_ptr<CARTree>> trees;
+	std::vector<std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>>> roots;
+	for (auto max_depth : {1, 4, 0})
+	{
+		auto tree=std::make_shared<CARTree>(ft, PT_REGRESSION);
+		tree->set_labels(std::make_shared<RegressionLabels>(lab));
+		tree->set_max_depth(max_depth);
+		tree->train(feats);
+		trees.push_back(tree);
+		roots.push_back(root_of(tree));
+	}
+
+	FlatForest forest(roots, ft);
+	EXPECT_EQ(2, roots[0]->data.num_leaves);
+	index_t num_nodes=0;
+	for (const auto& root : roots)
+		num_nodes+=2*root->data.num_leaves-1;
+	EXPECT_EQ(num_nodes, forest.get_num_nodes());
+
+	auto output=forest.apply(data);
+	for (index_t t=0; t<3; ++t)
+	{
+		auto expected=trees[t]->apply_regression(feats)->get_labels();
+		for (index_t i=0; i<data.num_cols; ++i)
+			EXPECT_EQ(expected[i], output(i, t));
+	}
+}
+
+TEST(FlatForest, skipped_vectors)
+{
+	SGMatrix<float64_t> data(4, 14);
+	SGVector<float64_t> lab(14);
+	generate_toy_data_weather(data, lab);
+
+	SGVector<bool> ft(4);
+	linalg::set_const(ft, true);
+
+	std::vector<std::shared_ptr<BinaryTreeMachineNode<CARTreeNodeData>>> roots;
+	for (index_t t=0; t<3; ++t)
+	{
+		auto tree=std::make_shared<CARTree>(ft);
+		tree->set_max_depth(t+1);
+		tree->set_labels(std::make_shared<MulticlassLabels>(lab));
+		tree->train(std::make_shared<DenseFeatures<float64_t>>(data));
+		roots.push_back(root_of(tree));
+	}
+	FlatForest forest(roots, ft);
+
+	// tree t skips every third vector, starting at t
+	SGMatrix<uint64_t> skip(1, 3);
+	skip.zero();
+	for (index_t i=0; i<data.num_cols; ++i)
+		skip(0, i%3)|=uint64_t(1)<<i;
+
+	auto expected=forest.apply(data);
+	auto output=forest.apply(data, skip);
+	for (index_t t=0; t<3; ++t)
+	{
+		for (index_t i=0; i<data.num_cols; ++i)
+		{
+			if (i%3==t)
+				EXPECT_TRUE(std::isnan(output(i, t)));
+			else
+				EXPECT_EQ(expected(i, t), output(i, t));
+		}
+	}
+}
@@ -34,6 +34,10 @@
 #include <shogun/ensemble/MeanRule.h>
 #include <shogun/evaluation/MulticlassAccuracy.h>
 #include <shogun/features/DenseFeatures.h>
+#include <shogun/io/serialization/BitseryDeserializer.h>
+#include <shogun/io/serialization/BitserySerializer.h>
+#include <shogun/io/stream/ByteArrayInputStream.h>
+#include <shogun/io/stream/ByteArrayOutputStream.h>
 #include <shogun/lib/SGMatrix.h>
 #include <shogun/machine/RandomForest.h>
 #include <shogun/mathematics/UniformIntDistribution.h>
@@ -262,3 +266,91 @@ TEST_F(RandomForestTest, score_consistent_with_binary_trivial_data)
 	EXPECT_NEAR(1.0, values_vector[8], 1e-1);
 	EXPECT_NEAR(1.0, values_vector[9], 1e-1);
 }
+
+class RandomForestOOB : public RandomForest
+{
+public:
+	using RandomForest::RandomForest;
+
+	SGMatrix<float64_t> flat_oob_outputs() const
+	{
+		return apply_oob_outputs();
+	}
+
+	SGMatrix<float64_t> bag_oob_outputs() const
+	{
+		return BaggingMachine::apply_oob_outputs();
+	}
+
+	bool oob(index_t vec, index_t bag) const
+	{
+		return is_out_of_bag(vec, bag);
+	}
+};
+
+TEST_F(RandomForestTest, oob_outputs_flat_forest_equals_bags)
+{
+	int32_t seed = 2343;
+	auto c = std::make_shared<RandomForestOOB>(
+	    weather_features_train, weather_labels_train, 20, 2);
+	c->set_feature_types(weather_ft);
+	c->set_combination_rule(std::make_shared<MajorityVote>());
+	c->put("seed", seed);
+	c->train(weather_features_train);
+
+	auto flat = c->flat_oob_outputs();
+	auto num_vecs = weather_features_train->get_num_vectors();
+	for (auto num_threads : {1, 4})
+	{
+		env()->set_num_threads(num_threads);
+		auto bags = c->bag_oob_outputs();
+		ASSERT_EQ(flat.num_rows, bags.num_rows);
+		ASSERT_EQ(flat.num_cols, bags.num_cols);
+
+		index_t num_oob = 0;
+		for (index_t i = 0; i < c->get_num_bags(); i++)
+		{
+			for (index_t j = 0; j < num_vecs; j++)
+			{
+				if (!c->oob(j, i))
+					continue;
+				EXPECT_EQ(flat(j, i), bags(j, i));
+				num_oob++;
+			}
+		}
+		EXPECT_GT(num_oob, 0);
+	}
+}
+
+TEST_F(RandomForestTest, oob_error_of_lazily_read_forest)
+{
+	int32_t seed = 2343;
+	auto c = std::make_shared<RandomForest>(
+	    weather_features_train, weather_labels_train, 20, 2);
+	c->set_feature_types(weather_ft);
+	c->set_combination_rule(std::make_shared<MajorityVote>());
+	std::shared_ptr<Evaluation> eval = std::make_shared<MulticlassAccuracy>();
+	c->put(BaggingMachine::kOobEvaluationMetric, eval);
+	c->put("seed", seed);
+	c->train(weather_features_train);
+	auto expected = c->get_oob_error();
+
+	auto stream = std::make_shared<io::ByteArrayOutputStream>();
+	auto serializer = std::make_shared<io::BitserySerializer>();
+	serializer->attach(stream);
+	serializer->write(c);
+	auto buffer = stream->content();
+
+	// the trees are read by the threads that apply them to their OOB
+	// vectors, without the forest being materialized first
+	for (auto num_threads : {1, 4})
+	{
+		env()->set_num_threads(num_threads);
+		auto deserializer = std::make_shared<io::BitseryDeserializer>();
+		deserializer->set_lazy_threshold(1);
+		deserializer->attach(std::make_shared<io::ByteArrayInputStream>(
+		    buffer.data(), buffer.size()));
+		auto deser = deserializer->read_object()->as<RandomForest>();
+		EXPECT_EQ(deser->get_oob_error(), expected);
+	}
+}
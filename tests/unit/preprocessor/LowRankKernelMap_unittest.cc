@@ -0,0 +1,118 @@
+/*
+ * This software is distributed under BSD 3-clause license (see LICENSE file).
+ */
+
+#include <gtest/gtest.h>
+#include <shogun/features/DenseFeatures.h>
+#include <shogun/kernel/GaussianKernel.h>
+#include <shogun/mathematics/NormalDistribution.h>
+#include <shogun/mathematics/RandomNamespace.h>
+#include <shogun/mathematics/linalg/LinalgNamespace.h>
+#include <shogun/preprocessor/LowRankKernelMap.h>
+
+#include <random>
+
+using namespace shogun;
+
+class LowRankKernelMapTest : public ::testing::Test
+{
+public:
+	virtual void SetUp()
+	{
+		std::mt19937_64 prng(seed);
+		NormalDistribution<float64_t> normal_dist;
+		SGMatrix<float64_t> mat(num_features, num_vectors);
+		random::fill_array(mat, normal_dist, prng);
+		features = std::make_shared<DenseFeatures<float64_t>>(mat);
+
+		kernel = std::make_shared<GaussianKernel>(width);
+		kernel->init(features, features);
+		kernel_matrix = kernel->get_kernel_matrix();
+		kernel->cleanup();
+	}
+
+	/* inner products of the mapped features */
+	SGMatrix<float64_t> approximation(const std::shared_ptr<LowRankKernelMap>& map)
+	{
+		auto mapped = map->transform(features)
+		                  ->as<DenseFeatures<float64_t>>()
+		                  ->get_feature_matrix();
+		EXPECT_EQ(mapped.num_rows, map->get_dim_output());
+		EXPECT_EQ(mapped.num_cols, num_vectors);
+		return linalg::matrix_prod(mapped, mapped, true, false);
+	}
+
+protected:
+	const int32_t seed = 100;
+	const index_t num_vectors = 40;
+	const index_t num_features = 3;
+	const float64_t width = 2.0;
+	std::shared_ptr<DenseFeatures<float64_t>> features;
+	std::shared_ptr<GaussianKernel> kernel;
+	SGMatrix<float64_t> kernel_matrix;
+};
+
+TEST_F(LowRankKernelMapTest, incomplete_cholesky_full_rank)
+{
+	auto map = std::make_shared<LowRankKernelMap>(
+	    kernel, num_vectors, LRM_INCOMPLETE_CHOLESKY);
+	map->fit(features);
+
+	auto approx = approximation(map);
+	for (index_t i = 0; i < num_vectors; i++)
+		for (index_t j = 0; j < num_vectors; j++)
+			EXPECT_NEAR(approx(i, j), kernel_matrix(i, j), 1e-5);
+}
+
+TEST_F(LowRankKernelMapTest, nystrom_full_rank)
+{
+	auto map =
+	    std::make_shared<LowRankKernelMap>(kernel, num_vectors, LRM_NYSTROM);
+	map->put(random::kSeed, seed);
+	map->fit(features);
+
+	auto approx = approximation(map);
+	for (index_t i = 0; i < num_vectors; i++)
+		for (index_t j = 0; j < num_vectors; j++)
+			EXPECT_NEAR(approx(i, j), kernel_matrix(i, j), 1e-5);
+}
+
+TEST_F(LowRankKernelMapTest, low_rank)
+{
+	const index_t rank = 10;
+	std::vector<std::shared_ptr<LowRankKernelMap>> maps;
+	maps.push_back(std::make_shared<LowRankKernelMap>(
+	    kernel, rank, LRM_INCOMPLETE_CHOLESKY));
+	for (auto selection : {LS_UNIFORM, LS_LEVERAGE, LS_KMEANS})
+	{
+		auto map = std::make_shared<LowRankKernelMap>(kernel, rank, LRM_NYSTROM);
+		map->set_landmark_selection(selection);
+		maps.push_back(map);
+	}
+
+	for (auto& map : maps)
+	{
+		map->put(random::kSeed, seed);
+		map->fit(features);
+		EXPECT_EQ(map->get_dim_output(), rank);
+
+		// the residual of the approximation is positive semi-definite
+		auto approx = approximation(map);
+		for (index_t i = 0; i < num_vectors; i++)
+			EXPECT_LE(approx(i, i), kernel_matrix(i, i) + 1e-8);
+	}
+}
+
+TEST_F(LowRankKernelMapTest, rank_larger_than_num_vectors)
+{
+	const index_t rank = 2 * num_vectors;
+	auto map = std::make_shared<LowRankKernelMap>(kernel, rank, LRM_NYSTROM);
+	map->put(random::kSeed, seed);
+	map->fit(features);
+	EXPECT_LE(map->get_dim_output(), num_vectors);
+
+	// the target rank is a hyper-parameter and not changed by fitting
+	EXPECT_EQ(map->get<int32_t>("rank"), rank);
+	auto clone = map->clone()->as<LowRankKernelMap>();
+	EXPECT_EQ(clone->get<int32_t>("rank"), rank);
+}